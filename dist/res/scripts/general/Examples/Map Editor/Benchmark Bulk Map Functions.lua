@@ -0,0 +1,127 @@
+-- Times the bulk map functions (count, each, find, filter, *Properties and
+-- set*Properties) against the equivalent per-object loops, and writes the
+-- results to the log
+-- Requires a map opened in the map editor. Properties are written back with
+-- their current values, so the map itself is not changed
+-------------------------------------------------------------------------------
+
+local map = App.mapEditor().map
+local runs = 3
+
+-- Runs [func] [runs] times and logs the fastest time taken
+local function benchmark(name, func)
+    local best
+    for run = 1, runs do
+        local start = App.runTimer()
+        func()
+        local time = App.runTimer() - start
+        if best == nil or time < best then
+            best = time
+        end
+    end
+    App.logMessage(string.format('%-48s %6d ms', name, best))
+end
+
+App.logMessage(string.format(
+    'Benchmarking %s: %d lines, %d sides, %d sectors, %d things',
+    map.name,
+    map:count('linedefs'),
+    map:count('sidedefs'),
+    map:count('sectors'),
+    map:count('things')))
+
+-- Count -----------------------------------------------------------------------
+
+benchmark('Count lines (#map.linedefs)', function()
+    local count = #map.linedefs
+end)
+
+benchmark('Count lines (map:count)', function()
+    local count = map:count('linedefs')
+end)
+
+-- Iterate ---------------------------------------------------------------------
+
+benchmark('Iterate lines (ipairs)', function()
+    for i, line in ipairs(map.linedefs) do
+        local x = line.x1
+    end
+end)
+
+benchmark('Iterate lines (map:each)', function()
+    for line in map:each('linedefs') do
+        local x = line.x1
+    end
+end)
+
+-- Get properties --------------------------------------------------------------
+
+benchmark('Get line specials (loop)', function()
+    local specials = {}
+    for i, line in ipairs(map.linedefs) do
+        specials[i] = line:intProperty('special')
+    end
+end)
+
+benchmark('Get line specials (map:intProperties)', function()
+    local specials = map:intProperties('linedefs', 'special')
+end)
+
+benchmark('Get side textures (loop)', function()
+    local textures = {}
+    for i, side in ipairs(map.sidedefs) do
+        textures[i] = side:stringProperty('texturemiddle')
+    end
+end)
+
+benchmark('Get side textures (map:stringProperties)', function()
+    local textures = map:stringProperties('sidedefs', 'texturemiddle')
+end)
+
+-- Find/filter -----------------------------------------------------------------
+
+benchmark('Find lines without special (loop)', function()
+    local found = {}
+    for i, line in ipairs(map.linedefs) do
+        if line:intProperty('special') == 0 then
+            found[#found + 1] = line
+        end
+    end
+end)
+
+benchmark('Find lines without special (map:find)', function()
+    local found = map:find('linedefs', 'special', 0)
+end)
+
+benchmark('Filter lines without special (map:filter)', function()
+    local found = map:filter('linedefs', function(line)
+        return line:intProperty('special') == 0
+    end)
+end)
+
+-- Set properties --------------------------------------------------------------
+
+local specials = map:intProperties('linedefs', 'special')
+local heights = map:intProperties('sectors', 'heightfloor')
+
+map:batchEdit('Benchmark', function()
+    benchmark('Set line specials (loop)', function()
+        for i, line in ipairs(map.linedefs) do
+            line:setIntProperty('special', specials[i])
+        end
+    end)
+
+    benchmark('Set line specials (map:setIntProperties)', function()
+        map:setIntProperties('linedefs', 'special', specials)
+    end)
+
+    benchmark('Set sector floor heights (loop)', function()
+        for i, sector in ipairs(map.sectors) do
+            sector:setIntProperty('heightfloor', heights[i])
+        end
+    end)
+
+    benchmark('Set sector floor heights (map:setIntProperties)', function()
+        map:setIntProperties('sectors', 'heightfloor', heights)
+    end)
+end)
@@ -51,8 +51,10 @@
 #include "OpenGL/Drawing.h"
 #include "Scripting/Lua.h"
 #include "Scripting/ScriptManager.h"
+#include "TextEditor/SymbolIndex.h"
 #include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
+#include "UI/Browser/ThumbnailLoader.h"
 #include "UI/SBrush.h"
 #include "Utility/Tokenizer.h"
 #include "SLADEWxApp.h"
@@ -86,6 +88,11 @@ string dir_separator = "/";
 Console        console_main;
 PaletteManager palette_manager;
 ArchiveManager archive_manager;
+
+// Batch mode (-batch command line option)
+string         batch_script;
+vector<string> batch_archives;
+int            batch_threads = 0;
 } // namespace App
 
 CVAR(Int, temp_location, 0, CVAR_SAVE)
@@ -93,6 +100,14 @@ CVAR(String, temp_location_custom, "", CVAR_SAVE)
 CVAR(Bool, setup_wizard_run, false, CVAR_SAVE)
 
 
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, max_worker_threads)
+
+
 // -----------------------------------------------------------------------------
 //
 // App Namespace Functions
@@ -172,7 +187,7 @@ void readConfigFile()
 			// Keep reading name/value pairs until we hit the ending '}'
 			while (!tz.checkOrEnd("}"))
 			{
-				readCVar(tz.current().text, tz.peek().text);
+				readCVar(tz.current().text(), tz.peek().text());
 				tz.adv(2);
 			}
 
@@ -184,7 +199,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				archive_manager.addBaseResourcePath(wxString::FromUTF8(UTF8(tz.current().text)));
+				archive_manager.addBaseResourcePath(wxString::FromUTF8(UTF8(tz.current().text())));
 				tz.adv();
 			}
 
@@ -196,7 +211,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				archive_manager.addRecentFile(wxString::FromUTF8(UTF8(tz.current().text)));
+				archive_manager.addRecentFile(wxString::FromUTF8(UTF8(tz.current().text())));
 				tz.adv();
 			}
 
@@ -212,7 +227,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				NodeBuilders::addBuilderPath(tz.current().text, tz.peek().text);
+				NodeBuilders::addBuilderPath(tz.current().text(), tz.peek().text());
 				tz.adv(2);
 			}
 
@@ -224,7 +239,7 @@ void readConfigFile()
 		{
 			while (!tz.checkOrEnd("}"))
 			{
-				Executables::setGameExePath(tz.current().text, tz.peek().text);
+				Executables::setGameExePath(tz.current().text(), tz.peek().text());
 				tz.adv(2);
 			}
 
@@ -248,12 +263,26 @@ vector<string> processCommandLine(vector<string>& args)
 	vector<string> to_open;
 
 	// Process command line args (except the first as it is normally the executable name)
-	for (auto& arg : args)
+	for (unsigned a = 0; a < args.size(); a++)
 	{
+		auto& arg = args[a];
+
 		// -nosplash: Disable splash window
 		if (S_CMPNOCASE(arg, "-nosplash"))
 			UI::enableSplash(false);
 
+		// -batch <script>: Run lua script on the given archives without the UI
+		else if (S_CMPNOCASE(arg, "-batch") && a + 1 < args.size())
+			batch_script = args[++a];
+
+		// -threads <count>: Maximum number of worker threads for batch mode
+		else if (S_CMPNOCASE(arg, "-threads") && a + 1 < args.size())
+		{
+			long threads;
+			if (args[++a].ToLong(&threads))
+				batch_threads = threads;
+		}
+
 		// -debug: Enable debug mode
 		else if (S_CMPNOCASE(arg, "-debug"))
 		{
@@ -351,11 +380,22 @@ bool App::init(vector<string>& args, double ui_scale)
 	Log::info("Loading configuration");
 	readConfigFile();
 
+	// Apply command line thread count over the saved one (not saved, batch
+	// mode doesn't write the config file)
+	if (isBatchMode() && batch_threads > 0)
+		max_worker_threads = batch_threads;
+
 	// Check that SLADE.pk3 can be found
 	Log::info("Loading resources");
 	archive_manager.init();
 	if (!archive_manager.resArchiveOK())
 	{
+		if (isBatchMode())
+		{
+			Log::error("Unable to find slade.pk3, make sure it exists in the same directory as the SLADE executable");
+			return false;
+		}
+
 		wxMessageBox(
 			"Unable to find slade.pk3, make sure it exists in the same directory as the "
 			"SLADE executable",
@@ -364,6 +404,24 @@ bool App::init(vector<string>& args, double ui_scale)
 		return false;
 	}
 
+	// Batch mode only needs what is required to open and process archives
+	if (isBatchMode())
+	{
+		batch_archives = paths_to_open;
+		if (!palette_manager.init())
+		{
+			Log::error("Failed to initialise palettes");
+			return false;
+		}
+		SIFormat::initFormats();
+		EntryDataFormat::initBuiltinFormats();
+		EntryType::loadEntryTypes();
+
+		init_ok = true;
+		Log::info("SLADE Initialisation OK (batch mode)");
+		return true;
+	}
+
 	// Init SActions
 	SAction::initWxId(26000);
 	SAction::initActions();
@@ -436,6 +494,9 @@ bool App::init(vector<string>& args, double ui_scale)
 	// Init script manager
 	ScriptManager::init();
 
+	// Trim the browser thumbnail cache to its size limit
+	ThumbnailLoader::pruneCache();
+
 	// Show the main window
 	MainEditor::windowWx()->Show(true);
 	wxTheApp->SetTopWindow(MainEditor::windowWx());
@@ -464,6 +525,31 @@ bool App::init(vector<string>& args, double ui_scale)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the application was started in batch mode (with the -batch
+// command line option), where no UI is shown
+// -----------------------------------------------------------------------------
+bool App::isBatchMode()
+{
+	return !batch_script.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Runs the batch mode script on the archives given on the command line.
+// Returns the exit code for the application (1 if any archive failed)
+// -----------------------------------------------------------------------------
+int App::runBatch()
+{
+	Log::info(S_FMT("Running script %s on %d archives", CHR(batch_script), (int)batch_archives.size()));
+	auto failed = Lua::runBatch(batch_script, batch_archives);
+
+	// Clean up
+	exiting = true;
+	EntryType::cleanupEntryTypes();
+
+	return failed > 0 ? 1 : 0;
+}
+
 // -----------------------------------------------------------------------------
 // Saves the SLADE configuration file
 // -----------------------------------------------------------------------------
@@ -565,6 +651,9 @@ void App::exit(bool save_config)
 	// Close all open archives
 	archive_manager.closeAll();
 
+	// Stop background symbol indexing
+	theSymbolIndex->stop();
+
 	// Clean up
 	EntryType::cleanupEntryTypes();
 
@@ -16,6 +16,8 @@ bool            isExiting();
 ArchiveManager& archiveManager();
 
 bool init(vector<string>& args, double ui_scale = 1.);
+bool isBatchMode();
+int  runBatch();
 void saveConfigFile();
 void exit(bool save_config);
 
@@ -57,7 +57,7 @@
 // -----------------------------------------------------------------------------
 namespace Global
 {
-string error = "";
+thread_local string error = "";
 
 int    beta_num    = 5;
 int    version_num = 3120;
@@ -244,7 +244,7 @@ public:
 
 		// Last 10 log lines
 		trace_ += "\nLast Log Messages:\n";
-		auto& log = Log::history();
+		auto log = Log::history();
 		for (auto a = log.size() - 10; a < log.size(); a++)
 			trace_ += log[a].message + "\n";
 
@@ -505,8 +505,15 @@ bool SLADEWxApp::singleInstanceCheck()
 // -----------------------------------------------------------------------------
 bool SLADEWxApp::OnInit()
 {
+	// Check for batch mode, which runs separately from any other instance
+	// (same test as App::processCommandLine, -batch is ignored without a script)
+	bool batch_mode = false;
+	for (int a = 1; a < argc - 1; a++)
+		if (S_CMPNOCASE(argv[a], "-batch"))
+			batch_mode = true;
+
 	// Check if an instance of SLADE is already running
-	if (!singleInstanceCheck())
+	if (!batch_mode && !singleInstanceCheck())
 	{
 		printf("Found active instance. Quitting.\n");
 		return false;
@@ -519,8 +526,11 @@ bool SLADEWxApp::OnInit()
 	wxSocketBase::Initialize();
 
 	// Start up file listener
-	file_listener_ = new MainAppFileListener();
-	file_listener_->Create("SLADE_MAFL");
+	if (!batch_mode)
+	{
+		file_listener_ = new MainAppFileListener();
+		file_listener_->Create("SLADE_MAFL");
+	}
 
 	// Setup system options
 	wxSystemOptions::SetOption("mac.listctrl.always_use_generic", 1);
@@ -569,6 +579,10 @@ bool SLADEWxApp::OnInit()
 	if (!App::init(args, ui_scale))
 		return false;
 
+	// Nothing else needed in batch mode, the batch is run in OnRun
+	if (App::isBatchMode())
+		return true;
+
 		// Check for updates
 #ifdef __WXMSW__
 	wxHTTP::Initialize();
@@ -584,6 +598,18 @@ bool SLADEWxApp::OnInit()
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Runs the application main loop, or the batch script (without the main loop)
+// in batch mode. Returns the application exit code
+// -----------------------------------------------------------------------------
+int SLADEWxApp::OnRun()
+{
+	if (App::isBatchMode())
+		return App::runBatch();
+
+	return wxApp::OnRun();
+}
+
 // -----------------------------------------------------------------------------
 // Application shutdown, run when program is closed
 // -----------------------------------------------------------------------------
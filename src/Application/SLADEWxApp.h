@@ -10,6 +10,7 @@ public:
 	~SLADEWxApp();
 
 	bool OnInit() override;
+	int  OnRun() override;
 	int  OnExit() override;
 	void OnFatalException() override;
 
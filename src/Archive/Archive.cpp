@@ -1304,6 +1304,28 @@ bool Archive::importDir(string directory)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Reads [size] bytes of [entry]'s data from [start] into [buf].
+// Archive formats that store entries uncompressed override this to read only
+// the requested part from the archive file, by default the entry's data is
+// loaded in full
+// -----------------------------------------------------------------------------
+bool Archive::readEntryData(ArchiveEntry* entry, void* buf, uint32_t size, uint32_t start)
+{
+	// Check entry
+	if (!checkEntry(entry))
+		return false;
+
+	MemChunk& mc = entry->getMCData();
+	if (start > mc.getSize() || size > mc.getSize() - start)
+		return false;
+
+	if (size > 0)
+		memcpy(buf, mc.getData() + start, size);
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Reverts [entry] to the data it contained at the last time the archive was
 // saved.
@@ -88,6 +88,7 @@ public:
 
 	// Misc
 	virtual bool     loadEntryData(ArchiveEntry* entry) = 0;
+	virtual bool     readEntryData(ArchiveEntry* entry, void* buf, uint32_t size, uint32_t start);
 	virtual unsigned numEntries();
 	virtual void     close();
 	void             entryStateChanged(ArchiveEntry* entry);
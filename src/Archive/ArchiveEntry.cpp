@@ -36,6 +36,7 @@
 #include "ArchiveEntry.h"
 #include "Archive.h"
 #include "General/Misc.h"
+#include "Utility/Parallel.h"
 #include "Utility/StringUtils.h"
 
 
@@ -234,6 +235,13 @@ ArchiveEntry::SPtr ArchiveEntry::getShared()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::setState(uint8_t state, bool silent)
 {
+	// Any modification invalidates the content hash
+	if (state > 0)
+	{
+		hash_valid_ = false;
+		revision_++;
+	}
+
 	if (state_locked_ || (state == 0 && this->state_ == 0))
 		return;
 
@@ -266,8 +274,10 @@ void ArchiveEntry::unloadData()
 	// Delete any data
 	data_.clear();
 
-	// Update variables etc
+	// Update variables etc (the data reloaded from the archive may differ, eg.
+	// when reverting changes)
 	setLoaded(false);
+	revision_++;
 }
 
 // -----------------------------------------------------------------------------
@@ -351,6 +361,7 @@ void ArchiveEntry::clearData()
 	// Reset attributes
 	size_        = 0;
 	data_loaded_ = false;
+	hash_valid_  = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -567,6 +578,29 @@ bool ArchiveEntry::read(void* buf, uint32_t size)
 	return data_.read(buf, size);
 }
 
+// -----------------------------------------------------------------------------
+// Reads [size] bytes of the entry data from [start] into [buf]. If the data
+// isn't loaded, only the requested part is read from the parent archive where
+// its format allows (see Archive::readEntryData).
+// Returns false if the range is outside the entry data or couldn't be read
+// -----------------------------------------------------------------------------
+bool ArchiveEntry::readData(void* buf, uint32_t size, uint32_t start)
+{
+	if (start > getSize() || size > getSize() - start)
+		return false;
+
+	// Read from the entry data if it's loaded (or can't be read from an archive)
+	Archive* parent_archive = getParent();
+	if (isLoaded() || !parent_archive)
+	{
+		if (size > 0)
+			memcpy(buf, data_.getData() + start, size);
+		return true;
+	}
+
+	return parent_archive->readEntryData(this, buf, size, start);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the entry's size as a string
 // -----------------------------------------------------------------------------
@@ -645,3 +679,127 @@ ArchiveEntry* ArchiveEntry::relativeEntry(const string& path, bool allow_absolut
 
 	return include;
 }
+
+// -----------------------------------------------------------------------------
+// Returns a 64-bit hash of the entry's data, loading it if needed. The hash is
+// cached until the entry data is modified
+// -----------------------------------------------------------------------------
+uint64_t ArchiveEntry::contentHash()
+{
+	if (!hasContentHash())
+	{
+		getMCData();
+		updateContentHash();
+	}
+
+	return hash_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [other] has exactly the same data as this entry
+// -----------------------------------------------------------------------------
+bool ArchiveEntry::sameData(ArchiveEntry* other)
+{
+	if (!other || getSize() != other->getSize())
+		return false;
+	if (other == this || getSize() == 0)
+		return true;
+
+	// Different hashes can't be the same data, otherwise compare the data
+	// itself to be sure
+	if (contentHash() != other->contentHash())
+		return false;
+
+	return memcmp(getData(), other->getData(), getSize()) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Calculates the data hash for the entry
+// -----------------------------------------------------------------------------
+void ArchiveEntry::updateContentHash()
+{
+	hash_       = Misc::hash64(data_.getData(), data_.getSize());
+	hash_size_  = data_.getSize();
+	hash_valid_ = true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveEntry Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Calculates data hashes for all [entries] that don't have one cached yet,
+// spread across multiple threads
+// -----------------------------------------------------------------------------
+void ArchiveEntry::computeContentHashes(const vector<ArchiveEntry*>& entries)
+{
+	// Entry data can only be loaded from the archive on this thread
+	vector<ArchiveEntry*> to_hash;
+	for (auto entry : entries)
+	{
+		if (entry->hasContentHash())
+			continue;
+
+		entry->getMCData();
+		to_hash.push_back(entry);
+	}
+
+	Parallel::forEach(to_hash.size(), [&](size_t index) { to_hash[index]->updateContentHash(); });
+}
+
+// -----------------------------------------------------------------------------
+// Returns groups of entries in [entries] that have identical data, each in the
+// order they are given. Only entries with the same size as another entry need
+// their data hashed (and compared)
+// -----------------------------------------------------------------------------
+vector<vector<ArchiveEntry*>> ArchiveEntry::findDuplicateData(const vector<ArchiveEntry*>& entries)
+{
+	// Group by size first
+	std::unordered_map<uint32_t, unsigned> size_count;
+	for (auto entry : entries)
+		size_count[entry->getSize()]++;
+
+	vector<ArchiveEntry*> candidates;
+	for (auto entry : entries)
+		if (size_count[entry->getSize()] > 1)
+			candidates.push_back(entry);
+
+	// Hash candidates in parallel
+	computeContentHashes(candidates);
+
+	// Group entries with the same hash, checking the data actually matches
+	vector<vector<ArchiveEntry*>>                  groups;
+	std::unordered_map<uint64_t, vector<unsigned>> hash_groups;
+	for (auto entry : candidates)
+	{
+		auto& indices = hash_groups[entry->contentHash()];
+		bool  found   = false;
+		for (auto index : indices)
+		{
+			if (groups[index][0]->sameData(entry))
+			{
+				groups[index].push_back(entry);
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+		{
+			indices.push_back(groups.size());
+			groups.push_back({ entry });
+		}
+	}
+
+	// Only return groups with duplicates
+	vector<vector<ArchiveEntry*>> duplicates;
+	for (auto& group : groups)
+		if (group.size() > 1)
+			duplicates.push_back(std::move(group));
+
+	return duplicates;
+}
@@ -98,6 +98,7 @@ public:
 	// Data access
 	bool     write(const void* data, uint32_t size);
 	bool     read(void* buf, uint32_t size);
+	bool     readData(void* buf, uint32_t size, uint32_t start);
 	bool     seek(uint32_t offset, uint32_t start) { return data_.seek(offset, start); }
 	uint32_t currentPos() { return data_.currentPos(); }
 
@@ -116,6 +117,15 @@ public:
 	bool          isInNamespace(string ns);
 	ArchiveEntry* relativeEntry(const string& path, bool allow_absolute_path = true) const;
 
+	// Content hash
+	uint64_t contentHash();
+	bool     hasContentHash() { return hash_valid_ && hash_size_ == getSize(); }
+	bool     sameData(ArchiveEntry* other);
+	unsigned revision() const { return revision_; }
+
+	static void                          computeContentHashes(const vector<ArchiveEntry*>& entries);
+	static vector<vector<ArchiveEntry*>> findDuplicateData(const vector<ArchiveEntry*>& entries);
+
 private:
 	// Entry Info
 	string           name_;
@@ -139,4 +149,12 @@ private:
 	ArchiveEntry* prev_;
 
 	size_t index_guess_; // for speed
+
+	// Content hash (cached until the entry data is modified)
+	uint64_t hash_       = 0;
+	uint32_t hash_size_  = 0;
+	bool     hash_valid_ = false;
+	unsigned revision_   = 0; // Incremented on any modification, to tell if cached info is out of date
+
+	void updateContentHash();
 };
@@ -38,6 +38,7 @@
 #include "General/Console/Console.h"
 #include "General/ResourceManager.h"
 #include "General/UI.h"
+#include "TextEditor/SymbolIndex.h"
 
 
 // -----------------------------------------------------------------------------
@@ -216,6 +217,9 @@ bool ArchiveManager::addArchive(Archive* archive)
 		// Add to resource manager
 		theResourceManager->addArchive(archive);
 
+		// Add to symbol index
+		theSymbolIndex->addArchive(archive);
+
 		// ZDoom also loads any WADs found in the root of a PK3 or directory
 		if ((archive->formatId() == "zip" || archive->formatId() == "folder") && auto_open_wads_root)
 		{
@@ -624,6 +628,9 @@ bool ArchiveManager::closeArchive(int index)
 	// Remove from resource manager
 	theResourceManager->removeArchive(open_archives_[index].archive);
 
+	// Remove from symbol index
+	theSymbolIndex->removeArchive(open_archives_[index].archive);
+
 	// Delete any embedded configuration
 	// Game::configuration().removeEmbeddedConfig(open_archives[index].archive->getFilename());
 
@@ -900,6 +907,7 @@ bool ArchiveManager::openBaseResource(int index)
 	if (base_resource_archive_)
 	{
 		theResourceManager->removeArchive(base_resource_archive_);
+		theSymbolIndex->removeArchive(base_resource_archive_);
 		delete base_resource_archive_;
 		base_resource_archive_ = nullptr;
 	}
@@ -928,6 +936,7 @@ bool ArchiveManager::openBaseResource(int index)
 		base_resource = index;
 		UI::hideSplash();
 		theResourceManager->addArchive(base_resource_archive_);
+		theSymbolIndex->addArchive(base_resource_archive_);
 		announce("base_resource_changed");
 		return true;
 	}
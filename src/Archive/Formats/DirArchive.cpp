@@ -312,6 +312,27 @@ bool DirArchive::loadEntryData(ArchiveEntry* entry)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Reads [size] bytes of an entry's data from [start] directly from its file,
+// without loading the rest of it
+// -----------------------------------------------------------------------------
+bool DirArchive::readEntryData(ArchiveEntry* entry, void* buf, uint32_t size, uint32_t start)
+{
+	if (!checkEntry(entry) || entry->isLoaded())
+		return Archive::readEntryData(entry, buf, size, start);
+
+	// Check range
+	if (start > entry->getSize() || size > entry->getSize() - start)
+		return false;
+
+	wxFile file(entry->exProp("filePath").getStringValue());
+	if (!file.IsOpened())
+		return false;
+
+	file.Seek(start, wxFromStart);
+	return file.Read(buf, size) == size;
+}
+
 // -----------------------------------------------------------------------------
 // Deletes the directory matching [path], starting from [base]. If [base] is
 // null, the root directory is used.
@@ -53,6 +53,7 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool readEntryData(ArchiveEntry* entry, void* buf, uint32_t size, uint32_t start) override;
 
 	// Dir stuff
 	bool removeDir(string path, ArchiveTreeNode* base = nullptr) override;
@@ -44,6 +44,7 @@
 // -----------------------------------------------------------------------------
 CVAR(Bool, wad_force_uppercase, true, CVAR_SAVE)
 CVAR(Bool, iwad_lock, true, CVAR_SAVE)
+CVAR(Bool, wad_dedup_lumps, false, CVAR_SAVE)
 
 namespace
 {
@@ -155,6 +156,51 @@ void WadArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	entry->exProp("Offset") = (int)offset;
 }
 
+// -----------------------------------------------------------------------------
+// Sets the offset of each entry for writing the wad, and returns the offset of
+// the directory. If wad_dedup_lumps is enabled, entries with identical data
+// share a single copy of it, and are set to false in [write_data]
+// -----------------------------------------------------------------------------
+uint32_t WadArchive::calculateEntryOffsets(vector<bool>& write_data)
+{
+	write_data.assign(numEntries(), true);
+
+	// Find entries with duplicate data
+	std::unordered_map<ArchiveEntry*, ArchiveEntry*> shared;
+	if (wad_dedup_lumps)
+	{
+		vector<ArchiveEntry*> entries;
+		for (uint32_t l = 0; l < numEntries(); l++)
+			if (getEntry(l)->getSize() > 0)
+				entries.push_back(getEntry(l));
+
+		for (auto& group : ArchiveEntry::findDuplicateData(entries))
+			for (unsigned a = 1; a < group.size(); a++)
+				shared[group[a]] = group[0];
+	}
+
+	uint32_t dir_offset = 12;
+	for (uint32_t l = 0; l < numEntries(); l++)
+	{
+		ArchiveEntry* entry = getEntry(l);
+
+		// Point duplicates at the data of the first entry in their group
+		// (which will always have its offset set already)
+		auto dup = shared.find(entry);
+		if (dup != shared.end())
+		{
+			setEntryOffset(entry, getEntryOffset(dup->second));
+			write_data[l] = false;
+			continue;
+		}
+
+		setEntryOffset(entry, dir_offset);
+		dir_offset += entry->getSize();
+	}
+
+	return dir_offset;
+}
+
 // -----------------------------------------------------------------------------
 // Updates the namespace list
 // -----------------------------------------------------------------------------
@@ -526,14 +572,9 @@ bool WadArchive::write(MemChunk& mc, bool update)
 	}
 
 	// Determine directory offset & individual lump offsets
-	uint32_t      dir_offset = 12;
+	vector<bool>  write_data;
+	uint32_t      dir_offset = calculateEntryOffsets(write_data);
 	ArchiveEntry* entry      = nullptr;
-	for (uint32_t l = 0; l < numEntries(); l++)
-	{
-		entry = getEntry(l);
-		setEntryOffset(entry, dir_offset);
-		dir_offset += entry->getSize();
-	}
 
 	// Clear/init MemChunk
 	mc.clear();
@@ -559,7 +600,8 @@ bool WadArchive::write(MemChunk& mc, bool update)
 	for (uint32_t l = 0; l < num_lumps; l++)
 	{
 		entry = getEntry(l);
-		mc.write(entry->getData(), entry->getSize());
+		if (write_data[l])
+			mc.write(entry->getData(), entry->getSize());
 	}
 
 	// Write the directory
@@ -610,14 +652,9 @@ bool WadArchive::write(string filename, bool update)
 	}
 
 	// Determine directory offset & individual lump offsets
-	uint32_t      dir_offset = 12;
+	vector<bool>  write_data;
+	uint32_t      dir_offset = calculateEntryOffsets(write_data);
 	ArchiveEntry* entry      = nullptr;
-	for (uint32_t l = 0; l < numEntries(); l++)
-	{
-		entry = getEntry(l);
-		setEntryOffset(entry, dir_offset);
-		dir_offset += entry->getSize();
-	}
 
 	// Setup wad type
 	char wad_type[4] = { 'P', 'W', 'A', 'D' };
@@ -634,7 +671,7 @@ bool WadArchive::write(string filename, bool update)
 	for (uint32_t l = 0; l < num_lumps; l++)
 	{
 		entry = getEntry(l);
-		if (entry->getSize())
+		if (entry->getSize() && write_data[l])
 		{
 			file.Write(entry->getData(), entry->getSize());
 		}
@@ -706,6 +743,36 @@ bool WadArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Reads [size] bytes of an entry's data from [start] directly from the wadfile,
+// without loading the rest of it
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool WadArchive::readEntryData(ArchiveEntry* entry, void* buf, uint32_t size, uint32_t start)
+{
+	// Loaded or encrypted (Jaguar) lumps are read from the full entry data
+	if (!checkEntry(entry) || entry->isLoaded() || entry->isEncrypted())
+		return Archive::readEntryData(entry, buf, size, start);
+
+	// Check range
+	if (start > entry->getSize() || size > entry->getSize() - start)
+		return false;
+
+	// Open wadfile
+	wxFile file(filename_);
+
+	// Check if opening the file failed
+	if (!file.IsOpened())
+	{
+		LOG_MESSAGE(1, "WadArchive::readEntryData: Failed to open wadfile %s", filename_);
+		return false;
+	}
+
+	// Seek to the position within the lump and read
+	file.Seek(getEntryOffset(entry) + start, wxFromStart);
+	return file.Read(buf, size) == size;
+}
+
 // -----------------------------------------------------------------------------
 // Override of Archive::addEntry to force entry addition to the root directory,
 // update namespaces if needed and rename the entry if necessary to be
@@ -1272,7 +1339,7 @@ void WadArchive::detectIncludes()
 					{
 						if (i >= 3) // skip '=' or '('
 							tz.adv();
-						string name = tz.next().text;
+						string name = tz.next().text();
 						if (i == 5) // skip ')'
 							tz.adv();
 						opt.match_name      = name;
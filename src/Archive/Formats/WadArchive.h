@@ -24,6 +24,7 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool readEntryData(ArchiveEntry* entry, void* buf, uint32_t size, uint32_t start) override;
 
 	// Entry addition/removal
 	ArchiveEntry* addEntry(
@@ -94,4 +95,6 @@ private:
 
 	bool           iwad_;
 	vector<NSPair> namespaces_;
+
+	uint32_t calculateEntryOffsets(vector<bool>& write_data);
 };
@@ -35,6 +35,7 @@
 #include "General/UI.h"
 #include "WadArchive.h"
 #include <fstream>
+#include <mutex>
 
 
 // -----------------------------------------------------------------------------
@@ -69,6 +70,38 @@ struct ZipFileHeader
 };
 } // namespace
 
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+std::mutex temp_file_mutex;
+
+// -----------------------------------------------------------------------------
+// Returns a path in the temp folder for [name] that isn't used by any other
+// temp file, and creates an empty file there to reserve it. Archives can be
+// opened and saved on multiple threads at once (eg. in batch mode), so this
+// must not be split into separate check and create steps
+// -----------------------------------------------------------------------------
+string reserveTempFile(const string& name)
+{
+	std::lock_guard<std::mutex> lock(temp_file_mutex);
+
+	string path = App::path(name, App::Dir::Temp);
+	int    n    = 1;
+	while (wxFileExists(path))
+		path = App::path(S_FMT("%s.%d", CHR(name), n++), App::Dir::Temp);
+
+	wxFile file;
+	file.Create(path);
+
+	return path;
+}
+} // namespace
+
 // -----------------------------------------------------------------------------
 //
 // ZipArchive Class Functions
@@ -219,7 +252,7 @@ bool ZipArchive::open(string filename)
 bool ZipArchive::open(MemChunk& mc)
 {
 	// Write the MemChunk to a temp file
-	string tempfile = App::path("slade-temp-open.zip", App::Dir::Temp);
+	string tempfile = reserveTempFile("slade-temp-open.zip");
 	mc.exportFile(tempfile);
 
 	// Load the file
@@ -240,7 +273,7 @@ bool ZipArchive::write(MemChunk& mc, bool update)
 	bool success = false;
 
 	// Write to a temporary file
-	string tempfile = App::path("slade-temp-write.zip", App::Dir::Temp);
+	string tempfile = reserveTempFile("slade-temp-write.zip");
 	if (write(tempfile, true))
 	{
 		// Load file into MemChunk
@@ -630,22 +663,7 @@ vector<ArchiveEntry*> ZipArchive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 void ZipArchive::generateTempFileName(string filename)
 {
-	wxFileName tfn(filename);
-	temp_file_ = App::path(tfn.GetFullName(), App::Dir::Temp);
-	if (wxFileExists(temp_file_))
-	{
-		// Make sure we don't overwrite an existing temp file
-		// (in case there are multiple zips open with the same name)
-		int n = 1;
-		while (1)
-		{
-			temp_file_ = App::path(S_FMT("%s.%d", CHR(tfn.GetFullName()), n), App::Dir::Temp);
-			if (!wxFileExists(temp_file_))
-				break;
-
-			n++;
-		}
-	}
+	temp_file_ = reserveTempFile(wxFileName(filename).GetFullName());
 }
 
 
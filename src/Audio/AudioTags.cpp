@@ -31,6 +31,25 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "AudioTags.h"
+#include "Archive/ArchiveEntry.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, snd_info_cache_size, 256, CVAR_SAVE)
+namespace
+{
+struct CachedInfo
+{
+	ArchiveEntry::WPtr entry;
+	unsigned           revision;
+	string             info;
+};
+vector<CachedInfo> info_cache; // Most recently used last
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -299,6 +318,120 @@ static const char * const speaker_pos[] =
 };
 // clang-format on
 
+
+// -----------------------------------------------------------------------------
+//
+// TagReader Class
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Read-only access to audio data for the tag parsers. Either wraps data that
+// is already in memory, or reads only the pages of an (unloaded) entry's data
+// that are actually accessed, so the headers and tags can be parsed without
+// loading the whole entry.
+// Anything past the end of the data reads as zeroes
+// -----------------------------------------------------------------------------
+class TagReader
+{
+public:
+	TagReader(MemChunk& mc) : mem_{ mc.getData() }, size_{ mc.getSize() } {}
+	TagReader(ArchiveEntry* entry) : entry_{ entry }, size_{ entry->getSize() }
+	{
+		if (entry->isLoaded())
+			mem_ = entry->getData();
+	}
+
+	size_t getSize() const { return size_; }
+
+	uint8_t operator[](size_t offset)
+	{
+		if (offset >= size_)
+			return 0;
+		if (mem_)
+			return mem_[offset];
+		return page(offset / READ_PAGE_SIZE)[offset % READ_PAGE_SIZE];
+	}
+
+	// Reads [size] bytes from [start] into [buf], returns false if any of them
+	// are past the end of the data
+	bool read(void* buf, size_t size, size_t start)
+	{
+		if (start > size_ || size > size_ - start)
+			return false;
+
+		memcpy(buf, data(start, size), size);
+		return true;
+	}
+
+	// Returns a pointer to [size] bytes of data from [offset], which stays
+	// valid for the lifetime of the reader
+	const char* data(size_t offset, size_t size)
+	{
+		if (offset <= size_ && size <= size_ - offset)
+		{
+			if (mem_)
+				return (const char*)mem_ + offset;
+
+			// Within a single page
+			size_t first = offset / READ_PAGE_SIZE;
+			if (size == 0 || (offset + size - 1) / READ_PAGE_SIZE == first)
+				return (const char*)page(first) + offset % READ_PAGE_SIZE;
+		}
+
+		// Otherwise copy to a (zero-padded) buffer
+		buffers_.emplace_back(size, 0);
+		auto& buffer = buffers_.back();
+		for (size_t a = 0; a < size && offset + a < size_; ++a)
+			buffer[a] = (*this)[offset + a];
+
+		return (const char*)buffer.data();
+	}
+
+private:
+	static const size_t READ_PAGE_SIZE = 4096;
+
+	const uint8_t*                    mem_   = nullptr;
+	ArchiveEntry*                     entry_ = nullptr;
+	size_t                            size_;
+	std::map<size_t, vector<uint8_t>> pages_;
+	vector<vector<uint8_t>>           buffers_; // Moving a vector keeps its data, so pointers to it stay valid
+	size_t                            last_index_ = 0;
+	const uint8_t*                    last_page_  = nullptr;
+
+	// Returns the data of page [index], reading it from the entry if needed
+	const uint8_t* page(size_t index)
+	{
+		if (last_page_ && last_index_ == index)
+			return last_page_;
+
+		auto& page = pages_[index];
+		if (page.empty())
+		{
+			size_t start = index * READ_PAGE_SIZE;
+			page.resize(READ_PAGE_SIZE, 0);
+			if (!entry_->readData(page.data(), size_ - start < READ_PAGE_SIZE ? size_ - start : READ_PAGE_SIZE, start))
+				LOG_MESSAGE(1, "Unable to read data of entry %s", entry_->getName());
+
+			// The archive may have had to load all the entry data to read it
+			if (entry_->isLoaded())
+				mem_ = entry_->getData();
+		}
+
+		last_index_ = index;
+		last_page_  = page.data();
+		return last_page_;
+	}
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
 string BuildID3v2GenreString(string content)
 {
 	string genre = "";
@@ -344,7 +477,7 @@ string BuildID3v2GenreString(string content)
 	return genre;
 }
 
-string ParseID3v1Tag(MemChunk& mc, size_t start)
+string ParseID3v1Tag(TagReader& mc, size_t start)
 {
 	id3v1_t tag;
 	string  version, title, artist, album, comment, genre, year;
@@ -395,7 +528,7 @@ string ParseID3v1Tag(MemChunk& mc, size_t start)
 	return ret;
 }
 
-string ParseID3v2Tag(MemChunk& mc, size_t start)
+string ParseID3v2Tag(TagReader& mc, size_t start)
 {
 	string version, title, artist, composer, copyright, album, genre, year, group, subtitle, track, comments;
 	bool   artists = false;
@@ -419,6 +552,9 @@ string ParseID3v2Tag(MemChunk& mc, size_t start)
 	while (s + step + 1 < end)
 	{
 		size_t fsize = v22 ? READ_B24(mc, s + 3) : READ_B32(mc, s + 4);
+		// Stop at (invalid) frames going past the end of the tag
+		if (fsize > end - s - step)
+			break;
 
 		// One byte for encoding
 		size_t tsize = fsize - 1;
@@ -592,12 +728,11 @@ string ParseID3v2Tag(MemChunk& mc, size_t start)
 
 #include <SFML/System.hpp>
 
-string ParseVorbisComment(MemChunk& mc, size_t start)
+string ParseVorbisComment(TagReader& mc, size_t start)
 {
-	sf::Clock   timer;
-	string      ret;
-	const char* data = (const char*)mc.getData();
-	size_t      end  = mc.getSize();
+	sf::Clock timer;
+	string    ret;
+	size_t    end = mc.getSize();
 
 	if (start + 10 > end)
 		return ret + "\nInvalid Vorbis comment segment (A)\n";
@@ -605,7 +740,7 @@ string ParseVorbisComment(MemChunk& mc, size_t start)
 	if (start + 10 + strlen > end)
 		return ret + "\nInvalid Vorbis comment segment (B)\n";
 
-	string vendor = string::FromUTF8(data + start + 4, strlen);
+	string vendor = string::FromUTF8(mc.data(start + 4, strlen), strlen);
 
 	size_t numcomments = READ_L32(mc, start + 4 + strlen);
 	size_t s           = start + 8 + strlen;
@@ -615,7 +750,7 @@ string ParseVorbisComment(MemChunk& mc, size_t start)
 		strlen = READ_L32(mc, s);
 		if (s + strlen + 4 > end)
 			return ret + "\nInvalid Vorbis comment segment (C)\n";
-		ret += string::FromUTF8(data + s + 4, strlen);
+		ret += string::FromUTF8(mc.data(s + 4, strlen), strlen);
 		ret += "\n";
 		s += 4 + strlen;
 	}
@@ -625,16 +760,15 @@ string ParseVorbisComment(MemChunk& mc, size_t start)
 	return ret;
 }
 
-string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk_t* cue, bool bigendian = false)
+// [cue] is the offset of the cue chunk, or 0 if there isn't one
+string parseIFFChunks(TagReader& mc, size_t s, size_t samplerate, size_t cue, bool bigendian = false)
 {
-	const wav_chunk_t* temp  = nullptr;
-	const char*        data  = (const char*)mc.getData();
-	const uint8_t*     udata = (const uint8_t*)data;
-	string             ret   = "";
+	const wav_chunk_t* temp = nullptr;
+	string             ret  = "";
 
 	while (s + 8 < mc.getSize())
 	{
-		temp            = (const wav_chunk_t*)(data + s);
+		temp            = (const wav_chunk_t*)mc.data(s, sizeof(wav_chunk_t));
 		size_t tempsize = bigendian ? wxUINT32_SWAP_ON_LE(temp->size) : wxUINT32_SWAP_ON_BE(temp->size);
 		size_t offset   = s + 8;
 		size_t end      = offset + tempsize;
@@ -649,7 +783,7 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 		if (temp->id[0] == 'b' && temp->id[1] == 'e' && temp->id[2] == 'x' && temp->id[3] == 't' && tempsize >= 602)
 		{
 			string              bextstr = "Broadcast extensions:\n";
-			const bext_chunk_t* bext    = (const bext_chunk_t*)(data + offset);
+			const bext_chunk_t* bext    = (const bext_chunk_t*)mc.data(offset, tempsize);
 			if (bext->Description[0])
 				bextstr += S_FMT("Description: %s\n", string::From8BitData(bext->Description, 256));
 			if (bext->Originator[0])
@@ -709,7 +843,7 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 				offset += 4;
 				while (offset + 8 < end)
 				{
-					const wav_chunk_t* chunk   = (const wav_chunk_t*)(data + offset);
+					const wav_chunk_t* chunk   = (const wav_chunk_t*)mc.data(offset, sizeof(wav_chunk_t));
 					size_t             chsz    = wxUINT32_SWAP_ON_BE(chunk->size);
 					string             tagname = S_FMT("%s: ", string::From8BitData(chunk->id, 4));
 					offset += 8;
@@ -760,7 +894,7 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 						else if (chunk->id[1] == 'T' && chunk->id[2] == 'C' && chunk->id[3] == 'H')
 							tagname = "Technician: ";
 					}
-					liststr += S_FMT("%s%s\n", tagname, string::From8BitData(data + offset, chsz));
+					liststr += S_FMT("%s%s\n", tagname, string::From8BitData(mc.data(offset, chsz), chsz));
 					offset += chsz;
 					if (offset % 2)
 						offset++;
@@ -771,24 +905,27 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 			else if (mc[offset] == 'a' && mc[offset + 1] == 'd' && mc[offset + 2] == 't' && mc[offset + 3] == 'l')
 			{
 				// We need to have a cue chunk, wav specs say there can be only one at most
-				if (cue && wxUINT32_SWAP_ON_BE(cue->size) >= 4)
+				size_t cuesize = cue ? READ_L32(mc, cue + 4) : 0;
+				if (cuesize >= 4 && cue + 8 + cuesize <= mc.getSize())
 				{
-					size_t cueofs        = 8 + (const char*)cue - data;
-					size_t cuesize       = wxUINT32_SWAP_ON_BE(cue->size);
-					size_t numcuepoints  = READ_L32(udata, cueofs);
+					size_t cueofs        = cue + 8;
+					size_t numcuepoints  = READ_L32(mc, cueofs);
 					bool*  alreadylisted = new bool[numcuepoints];
 					memset(alreadylisted, false, numcuepoints * sizeof(bool));
 					if (cuesize >= 4 + numcuepoints * sizeof(wav_cue_t))
 					{
-						string           liststr   = S_FMT("Associated Data List:\n%d cue points\n", numcuepoints);
-						const wav_cue_t* cuepoints = (const wav_cue_t*)(data + cueofs + 4);
-						size_t           ioffset   = offset + 4;
+						string           liststr = S_FMT("Associated Data List:\n%d cue points\n", numcuepoints);
+						const wav_cue_t* cuepoints =
+							(const wav_cue_t*)mc.data(cueofs + 4, numcuepoints * sizeof(wav_cue_t));
+						size_t ioffset = offset + 4;
 						while (ioffset < end)
 						{
-							const wav_chunk_t* note  = (const wav_chunk_t*)(data + ioffset);
+							const wav_chunk_t* note  = (const wav_chunk_t*)mc.data(ioffset, sizeof(wav_chunk_t));
 							size_t             isize = wxUINT32_SWAP_ON_BE(note->size);
 							ioffset += 8;
-							size_t cuepoint = READ_L32(udata, ioffset);
+							if (isize < 4 || ioffset + isize > end)
+								break;
+							size_t cuepoint = READ_L32(mc, ioffset);
 							int    cpindex  = -1;
 							for (size_t i = 0; i < numcuepoints; ++i)
 							{
@@ -812,7 +949,7 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 							}
 							if (note->id[0] == 'l' && note->id[1] == 'a' && note->id[2] == 'b' && note->id[3] == 'l')
 							{
-								string content = string::From8BitData(data + ioffset + 4, isize - 4);
+								string content = string::From8BitData(mc.data(ioffset + 4, isize - 4), isize - 4);
 								content.Trim();
 								liststr += S_FMT("Cue point %d label: %s\n", cuepoint, content);
 							}
@@ -822,13 +959,13 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 								liststr += S_FMT(
 									"Cue point %d: sample length %d, purpose %s\n",
 									cuepoint,
-									READ_L32(udata, (ioffset + 4)),
-									string::From8BitData(data + ioffset + 8, 4));
+									READ_L32(mc, (ioffset + 4)),
+									string::From8BitData(mc.data(ioffset + 8, 4), 4));
 							}
 							else if (
 								note->id[0] == 'n' && note->id[1] == 'o' && note->id[2] == 't' && note->id[3] == 'e')
 							{
-								string content = string::From8BitData(data + ioffset + 4, isize - 4);
+								string content = string::From8BitData(mc.data(ioffset + 4, isize - 4), isize - 4);
 								content.Trim();
 								liststr += S_FMT("Cue point %d note: %s\n", cuepoint, content);
 							}
@@ -837,19 +974,21 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 						}
 						ret += S_FMT("%s\n", liststr);
 					}
+					delete[] alreadylisted;
 				}
 			}
 		}
 		// Other ASCII metadata, if they aren't too big
 		else if (tempsize > 4 && tempsize < 8192)
 		{
-			bool pure_ascii = true;
-			bool zerochar   = false; // true if previous character was '\0'
+			const uint8_t* udata      = (const uint8_t*)mc.data(offset, tempsize);
+			bool           pure_ascii = true;
+			bool           zerochar   = false; // true if previous character was '\0'
 			for (size_t i = 0; pure_ascii && i < tempsize; ++i)
 			{
 				// Allow them to have several substrings separated by single null bytes
 				// This is found notably in afsp chunks.
-				if (udata[offset + i] == 0)
+				if (udata[i] == 0)
 				{
 					// Two nulls in a row? Then break.
 					if (zerochar == true)
@@ -860,10 +999,7 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 					zerochar = true;
 				}
 				// Only accept CR, LF, tabs, and printable characters
-				else if (
-					(udata[offset + i] < 0x20 && udata[offset + i] != 9 && udata[offset + i] != 10
-					 && udata[offset + i] != 13)
-					|| udata[offset + i] > 0x7E)
+				else if ((udata[i] < 0x20 && udata[i] != 9 && udata[i] != 10 && udata[i] != 13) || udata[i] > 0x7E)
 				{
 					pure_ascii = false;
 					break;
@@ -874,7 +1010,7 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 			if (pure_ascii)
 			{
 				char* asciidata = new char[tempsize];
-				memcpy(asciidata, data + offset, tempsize);
+				memcpy(asciidata, udata, tempsize);
 				for (size_t i = 0; i < tempsize - 1; ++i)
 					if (asciidata[i] == 0)
 						asciidata[i] = '\n';
@@ -889,7 +1025,9 @@ string parseIFFChunks(MemChunk& mc, size_t s, size_t samplerate, const wav_chunk
 }
 
 
-string Audio::getID3Tag(MemChunk& mc)
+string readWavInfo(TagReader& mc);
+
+string readID3Tag(TagReader& mc)
 {
 	// We actually identify RIFF-WAVE files as MP3 if they are encoded with
 	// the MP3 codec, but that means the metadata format is different, so
@@ -897,7 +1035,7 @@ string Audio::getID3Tag(MemChunk& mc)
 	// an ID3 tag anyway, provided it's nicely embedded in an "id3 " chunk.
 	if (mc.getSize() > 64 && mc[0] == 'R' && mc[1] == 'I' && mc[2] == 'F' && mc[3] == 'F' && mc[8] == 'W'
 		&& mc[9] == 'A' && mc[10] == 'V' && mc[11] == 'E')
-		return getWavInfo(mc);
+		return readWavInfo(mc);
 
 	string ret;
 	// Check for empty wasted space at the beginning, since it's apparently
@@ -930,6 +1068,8 @@ string Audio::getID3Tag(MemChunk& mc)
 			// Needs to be at least that big
 			if (mc.getSize() >= size + 4)
 				s += size;
+			else
+				break;
 		}
 	}
 	// It's also possible to get an ID3v1 (or v1.1) tag.
@@ -955,7 +1095,7 @@ string Audio::getID3Tag(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getOggComments(MemChunk& mc)
+string readOggComments(TagReader& mc)
 {
 	oggpageheader_t ogg;
 	vorbisheader_t  vorb;
@@ -968,6 +1108,11 @@ string Audio::getOggComments(MemChunk& mc)
 		mc.read(&ogg, 27, pagestart);
 		size_t pagesize = 27;
 
+		// The comment header is always within the first few pages, no need to
+		// go through the rest of the file
+		if (ogg.pagenum >= 3)
+			break;
+
 		for (int i = 0; i < ogg.segments && pagestart + 27 + i < end; ++i)
 		{
 			size_t segsize = mc[pagestart + 27 + i];
@@ -1001,7 +1146,7 @@ string Audio::getOggComments(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getFlacComments(MemChunk& mc)
+string readFlacComments(TagReader& mc)
 {
 	string ret = "";
 	// FLAC files begin with identifier "fLaC"; skip them
@@ -1026,10 +1171,9 @@ string Audio::getFlacComments(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getITComments(MemChunk& mc)
+string readITComments(TagReader& mc)
 {
-	const char*       data = (const char*)mc.getData();
-	const itheader_t* head = (const itheader_t*)data;
+	const itheader_t* head = (const itheader_t*)mc.data(0, sizeof(itheader_t));
 	size_t            s    = sizeof(itheader_t);
 
 	// Get song name
@@ -1041,8 +1185,8 @@ string Audio::getITComments(MemChunk& mc)
 		// To keep only valid strings, we trim whitespace and then print the string into itself.
 		// The second step gets rid of strings full of invalid characters where length() does not
 		// report the actual printable length correctly.
-		string comment =
-			string::From8BitData(data + wxUINT16_SWAP_ON_BE(head->msgoffset), wxUINT16_SWAP_ON_BE(head->msglength));
+		size_t msglength = wxUINT16_SWAP_ON_BE(head->msglength);
+		string comment   = string::From8BitData(mc.data(wxUINT16_SWAP_ON_BE(head->msgoffset), msglength), msglength);
 		comment.Trim();
 		comment = S_FMT("%s", comment);
 		if (comment.length())
@@ -1055,14 +1199,14 @@ string Audio::getITComments(MemChunk& mc)
 		ret += S_FMT("\n%d instruments:\n", wxUINT16_SWAP_ON_BE(head->insnum));
 	for (size_t i = 0; i < wxUINT16_SWAP_ON_BE(head->insnum); ++i)
 	{
-		size_t ofs = READ_L32(data, (offset + (i << 2)));
-		if (ofs > offset && ofs + 60 < mc.getSize() && data[ofs] == 'I' && data[ofs + 1] == 'M' && data[ofs + 2] == 'P'
-			&& data[ofs + 3] == 'I')
+		size_t ofs = READ_L32(mc, (offset + (i << 2)));
+		if (ofs > offset && ofs + 60 < mc.getSize() && mc[ofs] == 'I' && mc[ofs + 1] == 'M' && mc[ofs + 2] == 'P'
+			&& mc[ofs + 3] == 'I')
 		{
-			string instrument = string::From8BitData(data + ofs + 4, 12);
+			string instrument = string::From8BitData(mc.data(ofs + 4, 12), 12);
 			instrument.Trim();
 			instrument     = S_FMT("%s", instrument);
-			string comment = string::From8BitData(data + ofs + 32, 26);
+			string comment = string::From8BitData(mc.data(ofs + 32, 26), 26);
 			comment.Trim();
 			comment = S_FMT("%s", comment);
 			if (instrument.length() && comment.length())
@@ -1082,13 +1226,13 @@ string Audio::getITComments(MemChunk& mc)
 	{
 		size_t pos = offset + (i << 2);
 		size_t ofs = READ_L32(mc, pos);
-		if (ofs > offset && ofs + 60 < mc.getSize() && data[ofs] == 'I' && data[ofs + 1] == 'M' && data[ofs + 2] == 'P'
-			&& data[ofs + 3] == 'S')
+		if (ofs > offset && ofs + 60 < mc.getSize() && mc[ofs] == 'I' && mc[ofs + 1] == 'M' && mc[ofs + 2] == 'P'
+			&& mc[ofs + 3] == 'S')
 		{
-			string sample = string::From8BitData(data + ofs + 4, 12);
+			string sample = string::From8BitData(mc.data(ofs + 4, 12), 12);
 			sample.Trim();
 			sample         = S_FMT("%s", sample);
-			string comment = string::From8BitData(data + ofs + 20, 26);
+			string comment = string::From8BitData(mc.data(ofs + 20, 26), 26);
 			comment.Trim();
 			comment = S_FMT("%s", comment);
 			if (sample.length() && comment.length())
@@ -1103,13 +1247,12 @@ string Audio::getITComments(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getModComments(MemChunk& mc)
+string readModComments(TagReader& mc)
 {
-	const char* data = (const char*)mc.getData();
-	size_t      s    = 20;
+	size_t s = 20;
 
 	// Get song name
-	string ret = S_FMT("%s\n", string::From8BitData(data, 20));
+	string ret = S_FMT("%s\n", string::From8BitData(mc.data(0, 20), 20));
 
 	// Get instrument/sample comments
 	// We only recognize mods that have their magic identifier at offset 1080 (31 samples),
@@ -1117,7 +1260,7 @@ string Audio::getModComments(MemChunk& mc)
 	ret += "\n31 samples:\n";
 	for (size_t i = 0; i < 31; ++i)
 	{
-		string comment = string::From8BitData(data + s, 22);
+		string comment = string::From8BitData(mc.data(s, 22), 22);
 		comment.Trim();
 		comment = S_FMT("%s", comment);
 		if (comment.length())
@@ -1129,10 +1272,9 @@ string Audio::getModComments(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getS3MComments(MemChunk& mc)
+string readS3MComments(TagReader& mc)
 {
-	const char*        data = (const char*)mc.getData();
-	const s3mheader_t* head = (const s3mheader_t*)data;
+	const s3mheader_t* head = (const s3mheader_t*)mc.data(0, sizeof(s3mheader_t));
 	size_t             s    = 96;
 
 	// Get song name
@@ -1147,7 +1289,7 @@ string Audio::getS3MComments(MemChunk& mc)
 		size_t t = (READ_L16(mc, (s + 2 * i))) << 4;
 		if (t + 80 > mc.getSize())
 			return ret;
-		const s3msample_t* sample  = (const s3msample_t*)(data + t);
+		const s3msample_t* sample  = (const s3msample_t*)mc.data(t, sizeof(s3msample_t));
 		string             dosname = string::From8BitData(sample->dosname, 12);
 		dosname.Trim();
 		dosname        = S_FMT("%s", dosname);
@@ -1164,10 +1306,9 @@ string Audio::getS3MComments(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getXMComments(MemChunk& mc)
+string readXMComments(TagReader& mc)
 {
-	const char*       data = (const char*)mc.getData();
-	const xmheader_t* head = (const xmheader_t*)data;
+	const xmheader_t* head = (const xmheader_t*)mc.data(0, sizeof(xmheader_t));
 	size_t            s    = 60 + wxUINT32_SWAP_ON_BE(head->headersize);
 
 	// Get song name
@@ -1203,7 +1344,7 @@ string Audio::getXMComments(MemChunk& mc)
 			// To keep only valid strings, we trim whitespace and then print the string into itself.
 			// The second step gets rid of strings full of invalid characters where length() does not
 			// report the actual printable length correctly.
-			string comment = string::From8BitData(data + s + 4, 22);
+			string comment = string::From8BitData(mc.data(s + 4, 22), 22);
 			comment.Trim();
 			comment = S_FMT("%s", comment);
 			if (comment.length())
@@ -1220,7 +1361,7 @@ string Audio::getXMComments(MemChunk& mc)
 				for (size_t j = 0; j < samples && s + shsz < mc.getSize(); ++j)
 				{
 					size_t smsz = READ_L32(mc, s);
-					comment     = string::From8BitData(data + s + 18, 22);
+					comment     = string::From8BitData(mc.data(s + 18, 22), 22);
 					comment.Trim();
 					comment = S_FMT("%s", comment);
 					if (comment.length())
@@ -1240,7 +1381,7 @@ string Audio::getXMComments(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getSunInfo(MemChunk& mc)
+string readSunInfo(TagReader& mc)
 {
 	size_t datasize   = READ_B32(mc, 8);
 	size_t codec      = READ_B32(mc, 12);
@@ -1277,7 +1418,7 @@ string Audio::getSunInfo(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getVocInfo(MemChunk& mc)
+string readVocInfo(TagReader& mc)
 {
 	int            codec      = -1;
 	int            blockcount = 0;
@@ -1378,43 +1519,35 @@ string Audio::getVocInfo(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getWavInfo(MemChunk& mc)
+string readWavInfo(TagReader& mc)
 {
-	const char*           data  = (const char*)mc.getData();
-	const uint8_t*        udata = (const uint8_t*)data;
-	const wav_chunk_t*    head  = (const wav_chunk_t*)data;
-	const wav_chunk_t*    temp  = nullptr;
-	const wav_chunk_t*    wdat  = nullptr;
-	const wav_chunk_t*    fact  = nullptr;
-	const wav_chunk_t*    cue   = nullptr;
-	const wav_fmtchunk_t* fmt   = nullptr;
-	size_t                s     = 12;
+	const wav_chunk_t*    temp = nullptr;
+	const wav_chunk_t*    wdat = nullptr;
+	const wav_fmtchunk_t* fmt  = nullptr;
+	size_t                fact = 0;
+	size_t                cue  = 0;
+	size_t                s    = 12;
 
 	string chunksfound = "Chunks: ";
 
 	// Find data chunks
 	while (s + 8 < mc.getSize())
 	{
-		temp = (const wav_chunk_t*)(data + s);
+		temp = (const wav_chunk_t*)mc.data(s, sizeof(wav_chunk_t));
 		if (temp->id[0] == 'L' && temp->id[1] == 'I' && temp->id[2] == 'S' && temp->id[3] == 'T')
 			chunksfound += S_FMT(
-				"%s_%c%c%c%c, ",
-				string::From8BitData(temp->id, 4),
-				data[s + 8],
-				data[s + 9],
-				data[s + 10],
-				data[s + 11]);
+				"%s_%c%c%c%c, ", string::From8BitData(temp->id, 4), mc[s + 8], mc[s + 9], mc[s + 10], mc[s + 11]);
 		else
 			chunksfound += S_FMT("%s, ", string::From8BitData(temp->id, 4));
 
 		if (temp->id[0] == 'f' && temp->id[1] == 'm' && temp->id[2] == 't' && temp->id[3] == ' ')
-			fmt = (const wav_fmtchunk_t*)temp;
+			fmt = (const wav_fmtchunk_t*)mc.data(s, sizeof(wav_fmtchunk_t));
 		else if (temp->id[0] == 'd' && temp->id[1] == 'a' && temp->id[2] == 't' && temp->id[3] == 'a')
 			wdat = temp;
 		else if (temp->id[0] == 'f' && temp->id[1] == 'a' && temp->id[2] == 'c' && temp->id[3] == 't')
-			fact = temp;
+			fact = s;
 		else if (temp->id[0] == 'c' && temp->id[1] == 'u' && temp->id[2] == 'e' && temp->id[3] == ' ')
-			cue = temp;
+			cue = s;
 		size_t offset = 8 + wxUINT32_SWAP_ON_BE(temp->size);
 		if (offset % 2)
 			++offset;
@@ -1458,11 +1591,8 @@ string Audio::getWavInfo(MemChunk& mc)
 	size_t smplsize = fmt->blocksize;
 	size_t datasize = wdat->size;
 	size_t samples  = datasize / (smplsize > 0 ? smplsize : 1);
-	if (fact && wxUINT32_SWAP_ON_BE(fact->size) >= 4 && tag != 1)
-	{
-		size_t offset = (const uint8_t*)fact - udata + 8;
-		samples       = READ_L32(udata, offset);
-	}
+	if (fact && READ_L32(mc, fact + 4) >= 4 && tag != 1)
+		samples = READ_L32(mc, fact + 8);
 	size_t bps = wxUINT16_SWAP_ON_BE(fmt->bps);
 	if (tag == 65534 && bps != 0)
 		bps = wxUINT16_SWAP_ON_BE(fmt->vbps);
@@ -1495,14 +1625,11 @@ string Audio::getWavInfo(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getRmidInfo(MemChunk& mc)
+string readRmidInfo(TagReader& mc)
 {
-	const char*        data  = (const char*)mc.getData();
-	const uint8_t*     udata = (const uint8_t*)data;
-	const wav_chunk_t* head  = (const wav_chunk_t*)data;
-	const wav_chunk_t* temp  = nullptr;
-	const wav_chunk_t* cue   = nullptr;
-	size_t             s     = 12;
+	const wav_chunk_t* temp = nullptr;
+	size_t             cue  = 0;
+	size_t             s    = 12;
 
 	string chunksfound = "Chunks: ";
 	string ret         = "\n";
@@ -1510,20 +1637,15 @@ string Audio::getRmidInfo(MemChunk& mc)
 	// Find data chunks
 	while (s + 8 < mc.getSize())
 	{
-		temp = (const wav_chunk_t*)(data + s);
+		temp = (const wav_chunk_t*)mc.data(s, sizeof(wav_chunk_t));
 		if (temp->id[0] == 'L' && temp->id[1] == 'I' && temp->id[2] == 'S' && temp->id[3] == 'T')
 			chunksfound += S_FMT(
-				"%s_%c%c%c%c, ",
-				string::From8BitData(temp->id, 4),
-				data[s + 8],
-				data[s + 9],
-				data[s + 10],
-				data[s + 11]);
+				"%s_%c%c%c%c, ", string::From8BitData(temp->id, 4), mc[s + 8], mc[s + 9], mc[s + 10], mc[s + 11]);
 		else
 			chunksfound += S_FMT("%s, ", string::From8BitData(temp->id, 4));
 
 		if (temp->id[0] == 'c' && temp->id[1] == 'u' && temp->id[2] == 'e' && temp->id[3] == ' ')
-			cue = temp;
+			cue = s;
 		size_t offset = 8 + wxUINT32_SWAP_ON_BE(temp->size);
 		if (offset % 2)
 			++offset;
@@ -1536,37 +1658,33 @@ string Audio::getRmidInfo(MemChunk& mc)
 	return ret;
 }
 
-string Audio::getAiffInfo(MemChunk& mc)
+string readAiffInfo(TagReader& mc)
 {
-	const char*        data  = (const char*)mc.getData();
-	const uint8_t*     udata = (const uint8_t*)data;
-	const wav_chunk_t* head  = (const wav_chunk_t*)data;
-	const aiff_comm_t* comm  = nullptr;
-	const wav_chunk_t* temp  = nullptr;
-	const wav_chunk_t* cue   = nullptr;
-	size_t             s     = 12;
+	const aiff_comm_t* comm    = nullptr;
+	const wav_chunk_t* temp    = nullptr;
+	size_t             commofs = 0;
+	size_t             cue     = 0;
+	size_t             s       = 12;
 
 	string chunksfound = "Chunks: ";
 
 	// Find data chunks
 	while (s + 8 < mc.getSize())
 	{
-		temp = (const wav_chunk_t*)(data + s);
+		temp = (const wav_chunk_t*)mc.data(s, sizeof(wav_chunk_t));
 		if (temp->id[0] == 'L' && temp->id[1] == 'I' && temp->id[2] == 'S' && temp->id[3] == 'T')
 			chunksfound += S_FMT(
-				"%s_%c%c%c%c, ",
-				string::From8BitData(temp->id, 4),
-				data[s + 8],
-				data[s + 9],
-				data[s + 10],
-				data[s + 11]);
+				"%s_%c%c%c%c, ", string::From8BitData(temp->id, 4), mc[s + 8], mc[s + 9], mc[s + 10], mc[s + 11]);
 		else
 			chunksfound += S_FMT("%s, ", string::From8BitData(temp->id, 4));
 
 		if (temp->id[0] == 'C' && temp->id[1] == 'O' && temp->id[2] == 'M' && temp->id[3] == 'M')
-			comm = (const aiff_comm_t*)temp;
+		{
+			comm    = (const aiff_comm_t*)mc.data(s, sizeof(aiff_comm_t));
+			commofs = s;
+		}
 		else if (temp->id[0] == 'c' && temp->id[1] == 'u' && temp->id[2] == 'e' && temp->id[3] == ' ')
-			cue = temp;
+			cue = s;
 		size_t offset = 8 + wxUINT32_SWAP_ON_LE(temp->size);
 		if (offset % 2)
 			++offset;
@@ -1593,9 +1711,9 @@ string Audio::getAiffInfo(MemChunk& mc)
 	string format = "Format: ";
 	if (mc[11] == 'C' && comm->size > 22) // AIFC has larger COMMon chunk
 	{
-		const char* pos = ((const char*)comm) + 26;
-		format += wxString::From8BitData(pos + 5, *(pos + 4));
-		format += S_FMT(" (%s)", wxString::From8BitData(pos, 4));
+		size_t namelen = mc[commofs + 30];
+		format += wxString::From8BitData(mc.data(commofs + 31, namelen), namelen);
+		format += S_FMT(" (%s)", wxString::From8BitData(mc.data(commofs + 26, 4), 4));
 	}
 	else
 		format += "PCM (none)";
@@ -1619,3 +1737,158 @@ string Audio::getAiffInfo(MemChunk& mc)
 	ret += S_FMT("%s%s\n", parseIFFChunks(mc, 12, samplerate, cue, true), chunksfound);
 	return ret;
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Audio Namespace Functions
+//
+// -----------------------------------------------------------------------------
+string Audio::getID3Tag(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readID3Tag(reader);
+}
+
+string Audio::getOggComments(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readOggComments(reader);
+}
+
+string Audio::getFlacComments(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readFlacComments(reader);
+}
+
+string Audio::getITComments(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readITComments(reader);
+}
+
+string Audio::getModComments(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readModComments(reader);
+}
+
+string Audio::getS3MComments(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readS3MComments(reader);
+}
+
+string Audio::getXMComments(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readXMComments(reader);
+}
+
+string Audio::getWavInfo(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readWavInfo(reader);
+}
+
+string Audio::getVocInfo(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readVocInfo(reader);
+}
+
+string Audio::getSunInfo(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readSunInfo(reader);
+}
+
+string Audio::getRmidInfo(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readRmidInfo(reader);
+}
+
+string Audio::getAiffInfo(MemChunk& mc)
+{
+	TagReader reader(mc);
+	return readAiffInfo(reader);
+}
+
+// -----------------------------------------------------------------------------
+// Returns info about the audio in [entry], depending on its type. If the entry
+// data isn't loaded, only the parts of it needed are read from its archive.
+// The info is cached until the entry is modified
+// -----------------------------------------------------------------------------
+string Audio::getEntryInfo(ArchiveEntry* entry)
+{
+	// Check cache
+	auto shared = entry->getShared();
+	if (shared)
+	{
+		for (unsigned a = 0; a < info_cache.size(); a++)
+		{
+			if (info_cache[a].entry.lock() != shared)
+				continue;
+
+			auto cached = info_cache[a];
+			info_cache.erase(info_cache.begin() + a);
+			if (cached.revision != entry->revision())
+				break;
+
+			// Move to the end of the list (most recently used)
+			info_cache.push_back(cached);
+			return cached.info;
+		}
+	}
+
+	TagReader     mc(entry);
+	string        info;
+	const string& type = entry->getType()->id();
+	if (type == "snd_doom")
+	{
+		size_t samplerate = READ_L16(mc, 2);
+		size_t samples    = READ_L16(mc, 4);
+		info              = S_FMT("%lu samples at %lu Hz", (unsigned long)samples, (unsigned long)samplerate);
+	}
+	else if (type == "snd_speaker")
+		info = S_FMT("%lu samples", (unsigned long)READ_L16(mc, 2));
+	else if (type == "snd_audiot")
+		info = S_FMT("%lu samples", (unsigned long)READ_L16(mc, 0));
+	else if (type == "snd_sun")
+		info = readSunInfo(mc);
+	else if (type == "snd_voc")
+		info = readVocInfo(mc);
+	else if (type == "snd_wav")
+		info = readWavInfo(mc);
+	else if (type == "snd_mp3")
+		info = readID3Tag(mc);
+	else if (type == "snd_ogg")
+		info = readOggComments(mc);
+	else if (type == "snd_flac")
+		info = readFlacComments(mc);
+	else if (type == "snd_aiff")
+		info = readAiffInfo(mc);
+	else if (type == "mod_it")
+		info = readITComments(mc);
+	else if (type == "mod_mod")
+		info = readModComments(mc);
+	else if (type == "mod_s3m")
+		info = readS3MComments(mc);
+	else if (type == "mod_xm")
+		info = readXMComments(mc);
+	else if (type == "midi_rmid")
+		info = readRmidInfo(mc);
+
+	// Add to cache, removing the least recently used info if it's full
+	if (shared)
+	{
+		info_cache.push_back({ shared, entry->revision(), info });
+		auto max_size = (unsigned)std::max<int>(snd_info_cache_size, 1);
+		if (info_cache.size() > max_size)
+			info_cache.erase(info_cache.begin(), info_cache.end() - max_size);
+	}
+
+	return info;
+}
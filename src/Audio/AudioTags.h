@@ -1,5 +1,7 @@
 #pragma once
 
+class ArchiveEntry;
+
 namespace Audio
 {
 string getID3Tag(MemChunk& mc);
@@ -14,4 +16,6 @@ string getVocInfo(MemChunk& mc);
 string getSunInfo(MemChunk& mc);
 string getRmidInfo(MemChunk& mc);
 string getAiffInfo(MemChunk& mc);
+
+string getEntryInfo(ArchiveEntry* entry);
 } // namespace Audio
@@ -0,0 +1,250 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MIDIConverter.cpp
+// Description: MIDIConverter class - converts music entries to MIDI (and
+//              reads their length and info) on a background thread, with a
+//              cache of converted data by entry content
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MIDIConverter.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Misc.h"
+#include "MainEditor/Conversions.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+wxDEFINE_EVENT(wxEVT_THREAD_MIDI_CONVERTED, wxThreadEvent);
+CVAR(Int, snd_midi_cache_size, 32, CVAR_SAVE)
+namespace
+{
+struct CachedMIDI
+{
+	uint64_t                 key;
+	MIDIConverter::ResultPtr result;
+};
+vector<CachedMIDI> midi_cache; // Most recently used last
+std::mutex         midi_cache_mutex;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the cache key for [subsong] of [entry]
+// -----------------------------------------------------------------------------
+uint64_t cacheKey(ArchiveEntry* entry, int subsong)
+{
+	return Misc::hash64((const uint8_t*)&subsong, sizeof(int), entry->contentHash());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached result for [key], or nullptr if it isn't cached
+// -----------------------------------------------------------------------------
+MIDIConverter::ResultPtr findCached(uint64_t key)
+{
+	std::lock_guard<std::mutex> lock(midi_cache_mutex);
+	for (unsigned a = 0; a < midi_cache.size(); a++)
+	{
+		if (midi_cache[a].key != key)
+			continue;
+
+		// Move to the end of the list (most recently used)
+		auto cached = midi_cache[a];
+		midi_cache.erase(midi_cache.begin() + a);
+		midi_cache.push_back(cached);
+		return cached.result;
+	}
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [result] to the cache for [key], removing the least recently used
+// results if the cache is full
+// -----------------------------------------------------------------------------
+void addCached(uint64_t key, const MIDIConverter::ResultPtr& result)
+{
+	std::lock_guard<std::mutex> lock(midi_cache_mutex);
+	for (auto& cached : midi_cache)
+		if (cached.key == key)
+			return;
+
+	midi_cache.push_back({ key, result });
+	auto max_size = (unsigned)std::max<int>(snd_midi_cache_size, 1);
+	if (midi_cache.size() > max_size)
+		midi_cache.erase(midi_cache.begin(), midi_cache.end() - max_size);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MIDIConverter Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MIDIConverter class destructor
+// -----------------------------------------------------------------------------
+MIDIConverter::~MIDIConverter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	signal_.notify_one();
+
+	// Wait for any current conversion to finish
+	if (thread_.joinable())
+		thread_.join();
+}
+
+// -----------------------------------------------------------------------------
+// Begins converting [subsong] of [entry] in the background, replacing any
+// conversion that hasn't started yet. Returns the id of the request
+// -----------------------------------------------------------------------------
+unsigned MIDIConverter::convert(ArchiveEntry* entry, int subsong)
+{
+	// Copy entry data, since the entry can only be accessed from this thread
+	auto request     = std::make_unique<Request>();
+	request->key     = cacheKey(entry, subsong);
+	request->format  = entry->getType()->formatId();
+	request->subsong = subsong;
+	request->data.importMem(entry->getData(), entry->getSize());
+
+	unsigned id;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		id          = ++request_id_;
+		request->id = id;
+		pending_    = std::move(request);
+	}
+	signal_.notify_one();
+
+	// Start worker thread if needed
+	if (!thread_.joinable())
+		thread_ = std::thread(&MIDIConverter::run, this);
+
+	return id;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the result of the conversion for [request], or nullptr if it hasn't
+// finished or there has been a later request since
+// -----------------------------------------------------------------------------
+MIDIConverter::ResultPtr MIDIConverter::result(unsigned request)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return request == result_id_ && request == request_id_ ? result_ : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached conversion of [subsong] of [entry], or nullptr if it
+// hasn't been converted yet
+// -----------------------------------------------------------------------------
+MIDIConverter::ResultPtr MIDIConverter::cached(ArchiveEntry* entry, int subsong)
+{
+	return findCached(cacheKey(entry, subsong));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is a music format that can be converted to MIDI
+// -----------------------------------------------------------------------------
+bool MIDIConverter::canConvert(ArchiveEntry* entry)
+{
+	return entry->getType()->formatId().StartsWith("midi_");
+}
+
+// -----------------------------------------------------------------------------
+// Worker thread function, converts the latest pending request until stopped
+// -----------------------------------------------------------------------------
+void MIDIConverter::run()
+{
+	while (true)
+	{
+		std::unique_ptr<Request> request;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			signal_.wait(lock, [this]() { return stop_ || pending_; });
+			if (stop_)
+				return;
+
+			request = std::move(pending_);
+		}
+
+		// Convert (unless another converter has already done it)
+		auto result = findCached(request->key);
+		if (!result)
+		{
+			result = convertData(*request);
+			addCached(request->key, result);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			result_    = result;
+			result_id_ = request->id;
+		}
+
+		auto event = new wxThreadEvent(wxEVT_THREAD_MIDI_CONVERTED);
+		event->SetInt(request->id);
+		wxQueueEvent(handler_, event);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Converts the data in [request] to MIDI and reads its info
+// -----------------------------------------------------------------------------
+MIDIConverter::ResultPtr MIDIConverter::convertData(Request& request)
+{
+	auto result = std::make_shared<Result>();
+
+	if (request.format == "midi_mus") // MUS -> MIDI
+		result->success = Conversions::musToMidi(request.data, result->data);
+	else if (request.format == "midi_xmi" || request.format == "midi_hmi" || request.format == "midi_hmp")
+		result->success = Conversions::zmusToMidi(request.data, result->data, request.subsong, &result->num_tracks);
+	else if (request.format == "midi_gmid") // GMID -> MIDI
+		result->success = Conversions::gmidToMidi(request.data, result->data);
+	else
+		result->success = result->data.importMem(request.data.getData(), request.data.getSize());
+
+	if (result->success)
+		result->info = MIDIPlayer::readInfo(result->data);
+
+	return result;
+}
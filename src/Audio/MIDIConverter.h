@@ -0,0 +1,62 @@
+#pragma once
+
+#include "MIDIPlayer.h"
+#include <condition_variable>
+#include <thread>
+
+class ArchiveEntry;
+
+wxDECLARE_EVENT(wxEVT_THREAD_MIDI_CONVERTED, wxThreadEvent);
+
+// Converts music entries (MUS, HMI/HMP/XMI, GMID or MIDI) to MIDI and reads
+// their info on a background thread, sending a wxEVT_THREAD_MIDI_CONVERTED
+// event (with the request id as its int) to the handler when done. Only the
+// latest request is kept, any others still waiting are dropped.
+//
+// Converted MIDI is cached by entry content hash and subsong (shared between
+// all converters), so previewing the same music again needs no conversion
+class MIDIConverter
+{
+public:
+	struct Result
+	{
+		MemChunk         data;
+		MIDIPlayer::Info info;
+		int              num_tracks = 1;
+		bool             success    = false;
+	};
+	typedef std::shared_ptr<Result> ResultPtr;
+
+	MIDIConverter(wxEvtHandler* handler) : handler_{ handler } {}
+	~MIDIConverter();
+
+	unsigned  convert(ArchiveEntry* entry, int subsong = 0);
+	ResultPtr result(unsigned request);
+
+	static ResultPtr cached(ArchiveEntry* entry, int subsong = 0);
+	static bool      canConvert(ArchiveEntry* entry);
+
+private:
+	struct Request
+	{
+		unsigned id;
+		uint64_t key;
+		string   format;
+		MemChunk data;
+		int      subsong;
+	};
+
+	wxEvtHandler*            handler_;
+	std::unique_ptr<Request> pending_;
+	ResultPtr                result_;
+	unsigned                 result_id_  = 0;
+	unsigned                 request_id_ = 0;
+	std::mutex               mutex_;
+	std::condition_variable  signal_;
+	std::thread              thread_;
+	bool                     stop_ = false;
+
+	void run();
+
+	static ResultPtr convertData(Request& request);
+};
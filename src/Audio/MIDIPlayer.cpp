@@ -260,14 +260,19 @@ bool MIDIPlayer::openFile(string filename)
 }
 
 // -----------------------------------------------------------------------------
-// Opens the MIDI data contained in [mc] for playback.
+// Opens the MIDI data contained in [mc] for playback. If [info] is given it is
+// used as the data's info, rather than reading it again when needed.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
-bool MIDIPlayer::openData(MemChunk& mc)
+bool MIDIPlayer::openData(MemChunk& mc, const Info* info)
 {
 	// Open midi
 	mc.seek(0, SEEK_SET);
 	data_.importMem(mc.getData(), mc.getSize());
+	position_offset_ = 0;
+	info_read_       = info != nullptr;
+	if (info)
+		info_ = *info;
 
 	if (usetimidity)
 	{
@@ -403,7 +408,7 @@ int MIDIPlayer::getPosition()
 {
 	// We cannot query this information from fluidsynth or timidity,
 	// se we cheat by querying our own timer
-	return timer_.getElapsedTime().asMilliseconds();
+	return position_offset_ + timer_.getElapsedTime().asMilliseconds();
 }
 
 // -----------------------------------------------------------------------------
@@ -411,142 +416,29 @@ int MIDIPlayer::getPosition()
 // -----------------------------------------------------------------------------
 bool MIDIPlayer::setPosition(int pos)
 {
-	// Cannot currently seek in fluidsynth or timidity
+	// Seeking is only possible in fluidsynth 2.0+ (not timidity)
+#if !defined(NO_FLUIDSYNTH) && FLUIDSYNTH_VERSION_MAJOR >= 2
+	if (!usetimidity && fs_initialised_ && fs_player_)
+	{
+		if (fluid_player_seek(fs_player_, info().tickAt(pos)) != FLUID_OK)
+			return false;
+
+		position_offset_ = pos;
+		timer_.restart();
+		return true;
+	}
+#endif
+
 	return false;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the length (or maximum position) of the currently loaded MIDI stream,
-// in milliseconds.
-//
-// MIDI time division is the number of pulses per quarter note, aka PPQN, or
-// clock tick per beat; but it doesn't tell us how long a beat or a tick lasts.
-// To know that we also need to know the tempo which is a meta event and
-// therefore optional. The tempo tells us how many microseconds there are in a
-// quarter note, so from that and the PPQN we can compute how many microseconds
-// a time division lasts.
-// tempo / time_div = microseconds per tick
-// time_div / tempo = ticks per microsecond
-// We can also theoretically get the BPM this way, but in most game midi files
-// this value will be kinda meaningless since conversion between variant formats
-// can squeeze or stretch notes to fit a set PPQN, so ticks per microseconds
-// will generally be more accurate.
-// 60000000 / tempo = BPM
+// in milliseconds
 // -----------------------------------------------------------------------------
 int MIDIPlayer::getLength()
 {
-	size_t   microseconds  = 0;
-	size_t   pos           = 0;
-	size_t   end           = data_.getSize();
-	size_t   track_counter = 0;
-	uint16_t num_tracks    = 0;
-	uint16_t format        = 0;
-	uint16_t time_div      = 0;
-	int      tempo         = 500000; // Default value to assume if there are no tempo change event
-	bool     smpte         = false;
-
-	while (pos + 8 < end)
-	{
-		size_t chunk_name = READ_B32(data_, pos);
-		size_t chunk_size = READ_B32(data_, pos + 4);
-		pos += 8;
-		size_t  chunk_end      = pos + chunk_size;
-		uint8_t running_status = 0;
-		if (chunk_name == (size_t)(('M' << 24) | ('T' << 16) | ('h' << 8) | 'd')) // MThd
-		{
-			format     = READ_B16(data_, pos);
-			num_tracks = READ_B16(data_, pos + 2);
-			time_div   = READ_B16(data_, pos + 4);
-			if (data_[pos + 4] & 0x80)
-			{
-				smpte    = true;
-				time_div = (256 - data_[pos + 4]) * data_[pos + 5];
-			}
-			if (time_div == 0) // Not a valid MIDI file
-				return 0;
-		}
-		else if (chunk_name == (size_t)(('M' << 24) | ('T' << 16) | ('r' << 8) | 'k')) // MTrk
-		{
-			size_t tpos        = pos;
-			size_t tracklength = 0;
-			while (tpos + 4 < chunk_end)
-			{
-				// Read delta time
-				size_t dtime = 0;
-				for (int a = 0; a < 4; ++a)
-				{
-					dtime = (dtime << 7) + (data_[tpos] & 0x7F);
-					if ((data_[tpos++] & 0x80) != 0x80)
-						break;
-				}
-				// Compute length in microseconds
-				if (smpte)
-					tracklength += dtime * time_div;
-				else
-					tracklength += dtime * tempo / time_div;
-
-				// Update status
-				uint8_t evtype = 0;
-				uint8_t status = data_[tpos++];
-				size_t  evsize = 0;
-				if (status < 0x80)
-				{
-					evtype = status;
-					status = running_status;
-				}
-				else
-				{
-					running_status = status;
-					evtype         = data_[tpos++];
-				}
-				// Handle meta events
-				if (status == 0xFF)
-				{
-					evsize = 0;
-					for (int a = 0; a < 4; ++a)
-					{
-						evsize = (evsize << 7) + (data_[tpos] & 0x7F);
-						if ((data_[tpos++] & 0x80) != 0x80)
-							break;
-					}
-
-					// Tempo event is important
-					if (evtype == 0x51)
-						tempo = READ_B24(data_, tpos);
-
-					tpos += evsize;
-				}
-				// Handle other events. Program change and channel aftertouch
-				// have only one parameter, other non-meta events have two.
-				// Sysex events have variable length
-				else
-					switch (status & 0xF0)
-					{
-					case 0xC0: // Program Change
-					case 0xD0: // Channel Aftertouch
-						break;
-					case 0xF0: // Sysex events
-						evsize = 0;
-						for (int a = 0; a < 4; ++a)
-						{
-							evsize = (evsize << 7) + (data_[tpos] & 0x7F);
-							if ((data_[tpos++] & 0x80) != 0x80)
-								break;
-						}
-						tpos += evsize;
-						break;
-					default: tpos++; // Skip next parameter
-					}
-			}
-			// Is this the longest track yet?
-			// [TODO] MIDI Format 2 has different songs on different tracks
-			if (tracklength > microseconds)
-				microseconds = tracklength;
-		}
-		pos = chunk_end;
-	}
-	// MIDI durations are in microseconds
-	return (int)(microseconds / 1000);
+	return info().length;
 }
 
 // -----------------------------------------------------------------------------
@@ -571,8 +463,52 @@ bool MIDIPlayer::setVolume(int volume)
 }
 
 // -----------------------------------------------------------------------------
-// Parses the MIDI data to find text events, and return a string where they are
-// each on a separate line. MIDI text events include:
+// Returns the text events in the currently loaded MIDI stream, each on a
+// separate line (see readInfo)
+// -----------------------------------------------------------------------------
+string MIDIPlayer::getInfo()
+{
+	return info().text;
+}
+
+// -----------------------------------------------------------------------------
+// Returns info for the currently loaded MIDI stream, reading it from the data
+// if it wasn't given when opened
+// -----------------------------------------------------------------------------
+const MIDIPlayer::Info& MIDIPlayer::info()
+{
+	if (!info_read_)
+	{
+		info_      = readInfo(data_);
+		info_read_ = true;
+	}
+
+	return info_;
+}
+
+// -----------------------------------------------------------------------------
+// Reads timing and text event info from the MIDI data in [mc], in a single pass
+// over all tracks.
+//
+// MIDI time division is the number of pulses per quarter note, aka PPQN, or
+// clock tick per beat; but it doesn't tell us how long a beat or a tick lasts.
+// To know that we also need to know the tempo which is a meta event and
+// therefore optional. The tempo tells us how many microseconds there are in a
+// quarter note, so from that and the PPQN we can compute how many microseconds
+// a time division lasts.
+// tempo / time_div = microseconds per tick
+// time_div / tempo = ticks per microsecond
+// We can also theoretically get the BPM this way, but in most game midi files
+// this value will be kinda meaningless since conversion between variant formats
+// can squeeze or stretch notes to fit a set PPQN, so ticks per microseconds
+// will generally be more accurate.
+// 60000000 / tempo = BPM
+//
+// Tempo changes apply to all tracks, so they are collected from every track
+// and the time of each is worked out afterwards. This also allows converting
+// between ticks and time for seeking.
+//
+// MIDI text events include:
 // Text event (FF 01)
 // Copyright notice (FF 02)
 // Track title (FF 03)
@@ -581,110 +517,236 @@ bool MIDIPlayer::setVolume(int volume)
 // Marker (FF 06)
 // Cue point (FF 07)
 // -----------------------------------------------------------------------------
-string MIDIPlayer::getInfo()
+MIDIPlayer::Info MIDIPlayer::readInfo(const MemChunk& mc)
 {
-	string   ret           = wxEmptyString;
-	size_t   pos           = 0;
-	size_t   end           = data_.getSize();
-	size_t   track_counter = 0;
-	uint16_t num_tracks    = 0;
-	uint16_t format        = 0;
+	Info           info;
+	const uint8_t* data          = mc.getData();
+	size_t         pos           = 0;
+	size_t         end           = mc.getSize();
+	size_t         track_counter = 0;
+	size_t         max_ticks     = 0;
+	uint16_t       num_tracks    = 0;
+	uint16_t       format        = 0;
+
+	// Reads the byte at [index], or 0 if it is past the end of the data
+	auto byte = [&](size_t index) -> uint8_t { return index < end ? data[index] : 0; };
+
+	// Reads a variable length value at [index]
+	auto var_len = [&](size_t& index) {
+		size_t value = 0;
+		for (int a = 0; a < 4; ++a)
+		{
+			value = (value << 7) + (byte(index) & 0x7F);
+			if ((byte(index++) & 0x80) != 0x80)
+				break;
+		}
+		return value;
+	};
 
 	while (pos + 8 < end)
 	{
-		size_t chunk_name = READ_B32(data_, pos);
-		size_t chunk_size = READ_B32(data_, pos + 4);
+		size_t chunk_name = READ_B32(data, pos);
+		size_t chunk_size = READ_B32(data, pos + 4);
 		pos += 8;
-		size_t  chunk_end      = pos + chunk_size;
+		size_t  chunk_end      = std::min(pos + chunk_size, end);
 		uint8_t running_status = 0;
 		if (chunk_name == (size_t)(('M' << 24) | ('T' << 16) | ('h' << 8) | 'd')) // MThd
 		{
-			format            = READ_B16(data_, pos);
-			num_tracks        = READ_B16(data_, pos + 2);
-			uint16_t time_div = READ_B16(data_, pos + 4);
+			if (pos + 6 > end)
+				break;
+
+			format        = READ_B16(data, pos);
+			num_tracks    = READ_B16(data, pos + 2);
+			info.time_div = READ_B16(data, pos + 4);
 			if (format == 0)
-				ret += S_FMT("MIDI format 0 with time division %u\n", time_div);
+				info.text += S_FMT("MIDI format 0 with time division %u\n", info.time_div);
 			else
-				ret += S_FMT("MIDI format %u with %u tracks and time division %u\n", format, num_tracks, time_div);
+				info.text += S_FMT(
+					"MIDI format %u with %u tracks and time division %u\n", format, num_tracks, info.time_div);
+
+			if (data[pos + 4] & 0x80)
+			{
+				info.smpte    = true;
+				info.time_div = (256 - data[pos + 4]) * data[pos + 5];
+			}
+			if (info.time_div == 0) // Not a valid MIDI file
+				return info;
 		}
 		else if (chunk_name == (size_t)(('M' << 24) | ('T' << 16) | ('r' << 8) | 'k')) // MTrk
 		{
 			if (format == 2)
-				ret += S_FMT("\nTrack %u/%u\n", ++track_counter, num_tracks);
-			size_t tpos = pos;
+				info.text += S_FMT("\nTrack %u/%u\n", ++track_counter, num_tracks);
+
+			size_t tpos  = pos;
+			size_t ticks = 0;
 			while (tpos + 4 < chunk_end)
 			{
-				// Skip past delta time
-				for (int a = 0; a < 4; ++a)
-					if ((data_[tpos++] & 0x80) != 0x80)
-						break;
+				// Read delta time
+				ticks += var_len(tpos);
 
-				// Update status
-				uint8_t evtype = 0;
-				uint8_t status = data_[tpos++];
-				size_t  evsize = 0;
-				if (status < 0x80)
+				// Update status (data bytes without a status byte use the
+				// running status of the previous channel event)
+				uint8_t status = byte(tpos);
+				if (status >= 0x80)
 				{
-					evtype = status;
-					status = running_status;
+					tpos++;
+					if (status < 0xF0)
+						running_status = status;
 				}
 				else
-				{
-					running_status = status;
-					evtype         = data_[tpos++];
-				}
+					status = running_status;
+
 				// Handle meta events
 				if (status == 0xFF)
 				{
-					evsize = 0;
-					for (int a = 0; a < 4; ++a)
+					uint8_t evtype = byte(tpos++);
+					size_t  evsize = var_len(tpos);
+
+					// Tempo event is important
+					if (evtype == 0x51 && evsize >= 3)
 					{
-						evsize = (evsize << 7) + (data_[tpos] & 0x7F);
-						if ((data_[tpos++] & 0x80) != 0x80)
-							break;
+						int tempo = (byte(tpos) << 16) + (byte(tpos + 1) << 8) + byte(tpos + 2);
+						if (tempo > 0)
+							info.tempo_changes.push_back({ ticks, 0, tempo });
 					}
 
-					string tmp = wxEmptyString;
-					if (evtype > 0 && evtype < 8 && evsize)
-						tmp.Append((const char*)(&data_[tpos]), evsize);
-
-					switch (evtype)
+					// Text events
+					else if (evtype > 0 && evtype < 8 && evsize && tpos < end)
 					{
-					case 1: ret += S_FMT("Text: %s\n", tmp); break;
-					case 2: ret += S_FMT("Copyright: %s\n", tmp); break;
-					case 3: ret += S_FMT("Title: %s\n", tmp); break;
-					case 4: ret += S_FMT("Instrument: %s\n", tmp); break;
-					case 5: ret += S_FMT("Lyrics: %s\n", tmp); break;
-					case 6: ret += S_FMT("Marker: %s\n", tmp); break;
-					case 7: ret += S_FMT("Cue point: %s\n", tmp); break;
-					default: break;
+						string tmp;
+						tmp.Append((const char*)(data + tpos), std::min(evsize, end - tpos));
+
+						switch (evtype)
+						{
+						case 1: info.text += S_FMT("Text: %s\n", tmp); break;
+						case 2: info.text += S_FMT("Copyright: %s\n", tmp); break;
+						case 3: info.text += S_FMT("Title: %s\n", tmp); break;
+						case 4: info.text += S_FMT("Instrument: %s\n", tmp); break;
+						case 5: info.text += S_FMT("Lyrics: %s\n", tmp); break;
+						case 6: info.text += S_FMT("Marker: %s\n", tmp); break;
+						case 7: info.text += S_FMT("Cue point: %s\n", tmp); break;
+						default: break;
+						}
 					}
+
+					tpos += evsize;
+				}
+
+				// Handle sysex events, which have variable length
+				else if (status == 0xF0 || status == 0xF7)
+				{
+					size_t evsize = var_len(tpos);
 					tpos += evsize;
 				}
+
 				// Handle other events. Program change and channel aftertouch
-				// have only one parameter, other non-meta events have two.
-				// Sysex events have variable length
+				// have only one parameter, other non-meta events have two
 				else
 					switch (status & 0xF0)
 					{
 					case 0xC0: // Program Change
 					case 0xD0: // Channel Aftertouch
+						tpos++;
 						break;
-					case 0xF0: // Sysex events
-						evsize = 0;
-						for (int a = 0; a < 4; ++a)
-						{
-							evsize = (evsize << 7) + (data_[tpos] & 0x7F);
-							if ((data_[tpos++] & 0x80) != 0x80)
-								break;
-						}
-						tpos += evsize;
-						break;
-					default: tpos++; // Skip next parameter
+					default: tpos += 2;
 					}
 			}
+
+			// Is this the longest track yet?
+			// [TODO] MIDI Format 2 has different songs on different tracks
+			if (ticks > max_ticks)
+				max_ticks = ticks;
 		}
 		pos = chunk_end;
 	}
-	return ret;
+
+	// Work out the time of each tempo change, in order
+	std::stable_sort(
+		info.tempo_changes.begin(), info.tempo_changes.end(), [](const Info::Tempo& left, const Info::Tempo& right) {
+			return left.tick < right.tick;
+		});
+	uint64_t time  = 0;
+	size_t   tick  = 0;
+	int      tempo = 500000; // Default value to assume if there are no tempo change event
+	for (auto& change : info.tempo_changes)
+	{
+		time += info.microseconds(change.tick - tick, tempo);
+		change.time = time;
+		tick        = change.tick;
+		tempo       = change.tempo;
+	}
+
+	info.length = info.timeAt(max_ticks);
+	return info;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MIDIPlayer::Info Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the number of microseconds [ticks] last at [tempo]
+// -----------------------------------------------------------------------------
+uint64_t MIDIPlayer::Info::microseconds(size_t ticks, int tempo) const
+{
+	if (time_div == 0)
+		return 0;
+
+	// SMPTE time division is in ticks per second
+	if (smpte)
+		return (uint64_t)ticks * 1000000 / time_div;
+
+	return (uint64_t)ticks * tempo / time_div;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the time (in milliseconds) at [tick]
+// -----------------------------------------------------------------------------
+int MIDIPlayer::Info::timeAt(size_t tick) const
+{
+	// Find the last tempo change before the tick
+	auto change = std::upper_bound(
+		tempo_changes.begin(), tempo_changes.end(), tick, [](size_t value, const Tempo& change) {
+			return value < change.tick;
+		});
+	if (change == tempo_changes.begin())
+		return microseconds(tick, 500000) / 1000;
+
+	--change;
+	return (change->time + microseconds(tick - change->tick, change->tempo)) / 1000;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the tick at [time] (in milliseconds)
+// -----------------------------------------------------------------------------
+size_t MIDIPlayer::Info::tickAt(int time) const
+{
+	if (time_div == 0 || time <= 0)
+		return 0;
+
+	// Find the last tempo change before the time
+	uint64_t us     = (uint64_t)time * 1000;
+	auto     change = std::upper_bound(
+		tempo_changes.begin(), tempo_changes.end(), us, [](uint64_t value, const Tempo& change) {
+			return value < change.time;
+		});
+	size_t   tick  = 0;
+	uint64_t start = 0;
+	int      tempo = 500000;
+	if (change != tempo_changes.begin())
+	{
+		--change;
+		tick  = change->tick;
+		start = change->time;
+		tempo = change->tempo;
+	}
+
+	if (smpte)
+		return tick + (us - start) * time_div / 1000000;
+
+	return tick + (us - start) * time_div / tempo;
 }
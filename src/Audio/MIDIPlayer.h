@@ -3,6 +3,27 @@
 class MIDIPlayer
 {
 public:
+	// Timing and text event info read from MIDI data
+	struct Info
+	{
+		struct Tempo
+		{
+			size_t   tick;
+			uint64_t time; // Time of the tempo change in microseconds
+			int      tempo;
+		};
+
+		int           length   = 0; // Length in milliseconds
+		string        text;         // Text events, each on a separate line
+		uint16_t      time_div = 0;
+		bool          smpte    = false;
+		vector<Tempo> tempo_changes;
+
+		uint64_t microseconds(size_t ticks, int tempo) const;
+		int      timeAt(size_t tick) const;
+		size_t   tickAt(int time) const;
+	};
+
 	MIDIPlayer();
 	~MIDIPlayer();
 
@@ -22,7 +43,7 @@ public:
 	bool   initFluidsynth();
 	bool   reloadSoundfont();
 	bool   openFile(string filename);
-	bool   openData(MemChunk& mc);
+	bool   openData(MemChunk& mc, const Info* info = nullptr);
 	bool   play();
 	bool   pause();
 	bool   stop();
@@ -33,6 +54,8 @@ public:
 	bool   setVolume(int volume);
 	string getInfo();
 
+	static Info readInfo(const MemChunk& mc);
+
 private:
 	static MIDIPlayer* instance_;
 
@@ -50,6 +73,11 @@ private:
 	wxProcess* program_;
 	string     file_;
 	sf::Clock  timer_;
+	int        position_offset_ = 0; // Position when the timer was last restarted (after seeking)
+	Info       info_;
+	bool       info_read_ = false;
+
+	const Info& info();
 };
 
 // Define for less cumbersome MIDIPlayer::getInstance()
@@ -44,6 +44,7 @@
 #include "UI/Canvas/GfxCanvas.h"
 #include "UI/Controls/ColourBox.h"
 #include "UI/Controls/PaletteChooser.h"
+#include "Utility/Parallel.h"
 
 
 // -----------------------------------------------------------------------------
@@ -55,6 +56,22 @@ string GfxConvDialog::current_palette_name = "";
 string GfxConvDialog::target_palette_name  = "";
 CVAR(Bool, gfx_extraconv, false, CVAR_SAVE)
 
+namespace
+{
+// Working state for converting a single item on a worker thread
+struct ConvertJob
+{
+	SImage  image;
+	Palette pal_current;
+	Palette pal_target;
+	bool    has_pal_current = false;
+	bool    has_pal_target  = false;
+	bool    load            = false; // Image needs to be loaded from the entry
+	bool    valid           = false;
+	bool    writable        = false;
+};
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -633,16 +650,131 @@ void GfxConvDialog::onBtnConvert(wxCommandEvent& e)
 void GfxConvDialog::onBtnConvertAll(wxCommandEvent& e)
 {
 	// Show splash window
-	UI::showSplash("Converting Gfx...", true);
-
-	// Convert all images
-	for (size_t a = current_item; a < items.size(); a++)
+	UI::showSplash("Converting Gfx... (Esc to cancel)", true);
+
+	// Get conversion options for the current item
+	SIFormat::ConvertOptions base_opt;
+	getConvertOptions(base_opt);
+	auto format  = current_format.format;
+	auto coltype = current_format.coltype;
+
+	// Prepare remaining items on this thread, since palette lookups, textures
+	// and entry data loading can't be done from worker threads
+	size_t             first = current_item;
+	size_t             count = items.size() - first;
+	vector<ConvertJob> jobs(count);
+	for (size_t a = 0; a < count; a++)
 	{
-		applyConversion();
-		if (!nextItem())
-			break;
+		auto& item = items[first + a];
+		auto& job  = jobs[a];
+
+		// Copy palettes so each item has its own colour matching cache
+		auto pal_current = pal_chooser_current->getSelectedPalette(item.entry);
+		auto pal_target  = pal_chooser_target->getSelectedPalette(item.entry);
+		if (pal_current)
+		{
+			job.pal_current.copyPalette(pal_current);
+			job.has_pal_current = true;
+		}
+		if (pal_target)
+		{
+			job.pal_target.copyPalette(pal_target);
+			job.has_pal_target = true;
+		}
+
+		if (item.image.isValid())
+			continue;
+
+		if (item.entry)
+		{
+			if (item.entry->getType() == EntryType::unknownType())
+				EntryType::detectEntryType(item.entry);
+
+			// Jaguar formats need other entries, so load them here
+			if (item.entry->getType()->formatId().StartsWith("img_jaguar"))
+				Misc::loadImageFromEntry(&item.image, item.entry);
+			else
+			{
+				item.entry->getMCData();
+				job.load = true;
+			}
+		}
+		else if (item.texture)
+		{
+			if (item.force_rgba)
+				item.image.convertRGBA(item.palette);
+			item.texture->toImage(item.image, item.archive, item.palette, item.force_rgba);
+		}
 	}
 
+	// Load and convert items in parallel, applying results in order
+	size_t stop_at = items.size();
+	Parallel::forEachOrdered(
+		count,
+		[&](size_t index) {
+			auto& item = items[first + index];
+			auto& job  = jobs[index];
+
+			// Load image
+			if (job.load)
+				job.valid = Misc::loadImageFromEntry(&job.image, item.entry);
+			else if (item.image.isValid())
+			{
+				job.image.copyImage(&item.image);
+				job.valid = true;
+			}
+			if (!job.valid)
+				return;
+
+			// Check the image can be written in the selected format
+			job.writable = format->canWrite(job.image) && format->canWriteType((SIType)coltype);
+			if (!job.writable)
+				return;
+
+			// Do conversion
+			auto opt        = base_opt;
+			opt.pal_current = job.has_pal_current ? &job.pal_current : nullptr;
+			opt.pal_target  = job.has_pal_target ? &job.pal_target : nullptr;
+			format->convertWritable(job.image, opt);
+		},
+		[&](size_t index) {
+			auto& item = items[first + index];
+			auto& job  = jobs[index];
+
+			// Cancel event
+			if (wxGetKeyState(WXK_ESCAPE))
+			{
+				stop_at = first + index;
+				return false;
+			}
+
+			// Stop at any item that can't be written in the selected format,
+			// so the user can pick a different one for it
+			if (job.valid && !job.writable)
+			{
+				stop_at = first + index;
+				return false;
+			}
+
+			// Apply conversion
+			if (job.valid)
+			{
+				item.image.copyImage(&job.image);
+				item.modified   = true;
+				item.new_format = format;
+				item.palette    = pal_chooser_target->getSelectedPalette(item.entry);
+			}
+
+			UI::setSplashProgressMessage(S_FMT("%d of %lu", (int)(first + index + 1), items.size()));
+			UI::setSplashProgress((float)(index + 1) / (float)count);
+
+			return true;
+		});
+
+	// Go to the item we stopped at (closes the dialog if all were converted)
+	current_item = stop_at - 1;
+	nextItem();
+
 	// Hide splash window
 	UI::hideSplash();
 }
@@ -46,6 +46,7 @@
 //
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Bool, wad_force_uppercase)
+EXTERN_CVAR(Bool, wad_dedup_lumps)
 EXTERN_CVAR(Int, autosave_entry_changes)
 EXTERN_CVAR(Bool, percent_encoding)
 EXTERN_CVAR(Bool, auto_entry_replace)
@@ -231,6 +232,7 @@ wxPanel* EditingPrefsPanel::setupGeneralTab()
 
 	// Create controls
 	cb_wad_force_uppercase_  = new wxCheckBox(panel, -1, "Force uppercase entry names in Wad Archives");
+	cb_wad_dedup_lumps_      = new wxCheckBox(panel, -1, "Store entries with identical data only once in Wad Archives");
 	cb_zip_percent_encoding_ = new wxCheckBox(panel, -1, "Use percent encoding if needed outside of Wad Archives");
 	cb_auto_entry_replace_ =
 		new wxCheckBox(panel, -1, "Automatically replace entries with same name as drag-and-dropped files");
@@ -249,6 +251,7 @@ wxPanel* EditingPrefsPanel::setupGeneralTab()
 	WxUtils::layoutVertically(
 		panel->GetSizer(),
 		vector<wxObject*>{ cb_wad_force_uppercase_,
+						   cb_wad_dedup_lumps_,
 						   cb_zip_percent_encoding_,
 						   cb_auto_entry_replace_,
 						   cb_save_archive_with_map_,
@@ -300,6 +303,7 @@ wxPanel* EditingPrefsPanel::setupExternalTab()
 void EditingPrefsPanel::init()
 {
 	cb_wad_force_uppercase_->SetValue(wad_force_uppercase);
+	cb_wad_dedup_lumps_->SetValue(wad_dedup_lumps);
 	cb_zip_percent_encoding_->SetValue(percent_encoding);
 	cb_auto_entry_replace_->SetValue(auto_entry_replace);
 	cb_save_archive_with_map_->SetValue(save_archive_with_map);
@@ -318,6 +322,7 @@ void EditingPrefsPanel::init()
 void EditingPrefsPanel::applyPreferences()
 {
 	wad_force_uppercase       = cb_wad_force_uppercase_->GetValue();
+	wad_dedup_lumps           = cb_wad_dedup_lumps_->GetValue();
 	percent_encoding          = cb_zip_percent_encoding_->GetValue();
 	auto_entry_replace        = cb_auto_entry_replace_->GetValue();
 	save_archive_with_map     = cb_save_archive_with_map_->GetValue();
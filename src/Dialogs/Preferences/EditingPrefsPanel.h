@@ -19,6 +19,7 @@ private:
 
 	// General
 	wxCheckBox* cb_wad_force_uppercase_;
+	wxCheckBox* cb_wad_dedup_lumps_;
 	wxCheckBox* cb_zip_percent_encoding_;
 	wxCheckBox* cb_auto_entry_replace_;
 	wxCheckBox* cb_save_archive_with_map_;
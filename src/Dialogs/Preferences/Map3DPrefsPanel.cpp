@@ -48,6 +48,7 @@ EXTERN_CVAR(Bool, render_3d_sky)
 EXTERN_CVAR(Bool, camera_3d_show_distance)
 EXTERN_CVAR(Bool, mlook_invert_y)
 EXTERN_CVAR(Bool, render_shade_orthogonal_lines)
+EXTERN_CVAR(Bool, render_3d_portal_culling)
 
 
 // -----------------------------------------------------------------------------
@@ -116,7 +117,8 @@ Map3DPrefsPanel::Map3DPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 		{ cb_render_sky_       = new wxCheckBox(this, -1, "Render sky preview"),
 		  cb_show_distance_    = new wxCheckBox(this, -1, "Show distance under crosshair"),
 		  cb_invert_y_         = new wxCheckBox(this, -1, "Invert mouse Y axis"),
-		  cb_shade_orthogonal_ = new wxCheckBox(this, -1, "Shade orthogonal lines") },
+		  cb_shade_orthogonal_ = new wxCheckBox(this, -1, "Shade orthogonal lines"),
+		  cb_portal_culling_   = new wxCheckBox(this, -1, "Hide sectors that can't be seen from the camera") },
 		wxSizerFlags(0).Expand());
 
 	// Bind events
@@ -162,6 +164,7 @@ void Map3DPrefsPanel::init()
 	cb_show_distance_->SetValue(camera_3d_show_distance);
 	cb_invert_y_->SetValue(mlook_invert_y);
 	cb_shade_orthogonal_->SetValue(render_shade_orthogonal_lines);
+	cb_portal_culling_->SetValue(render_3d_portal_culling);
 
 	updateDistanceControls();
 }
@@ -223,6 +226,7 @@ void Map3DPrefsPanel::applyPreferences()
 	camera_3d_show_distance       = cb_show_distance_->GetValue();
 	mlook_invert_y                = cb_invert_y_->GetValue();
 	render_shade_orthogonal_lines = cb_shade_orthogonal_->GetValue();
+	render_3d_portal_culling      = cb_portal_culling_->GetValue();
 }
 
 
@@ -27,6 +27,7 @@ private:
 	wxCheckBox*   cb_show_distance_;
 	wxCheckBox*   cb_invert_y_;
 	wxCheckBox*   cb_shade_orthogonal_;
+	wxCheckBox*   cb_portal_culling_;
 
 	// Events
 	void onSliderMaxRenderDistChanged(wxCommandEvent& e);
@@ -0,0 +1,294 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextSearchDialog.cpp
+// Description: Dialog for 'Find/Replace in Text Entries' functionality, allows
+//              searching (and replacing) text in all text entries in an
+//              archive. Results are listed as they are found
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextSearchDialog.h"
+#include "General/UI.h"
+#include "UI/Lists/ListView.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// TextSearchDialog Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// TextSearchDialog class constructor
+// -----------------------------------------------------------------------------
+TextSearchDialog::TextSearchDialog(wxWindow* parent, Archive* archive, UndoManager* undo_manager) :
+	wxDialog(
+		parent,
+		-1,
+		"Find/Replace in Text Entries",
+		wxDefaultPosition,
+		wxDefaultSize,
+		wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
+	archive_{ archive },
+	undo_manager_{ undo_manager }
+{
+	// Setup sizer
+	wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+	SetSizer(sizer);
+
+	// Find/replace text
+	wxGridBagSizer* gbsizer = new wxGridBagSizer(UI::pad(), UI::pad());
+	sizer->Add(gbsizer, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, UI::padLarge());
+	text_find_       = new wxTextCtrl(this, -1, "", wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
+	text_replace_    = new wxTextCtrl(this, -1, "");
+	btn_search_      = new wxButton(this, -1, "Search");
+	btn_replace_all_ = new wxButton(this, -1, "Replace All");
+	gbsizer->Add(new wxStaticText(this, -1, "Find:"), { 0, 0 }, { 1, 1 }, wxALIGN_CENTER_VERTICAL);
+	gbsizer->Add(text_find_, { 0, 1 }, { 1, 1 }, wxEXPAND);
+	gbsizer->Add(btn_search_, { 0, 2 }, { 1, 1 }, wxEXPAND);
+	gbsizer->Add(new wxStaticText(this, -1, "Replace:"), { 1, 0 }, { 1, 1 }, wxALIGN_CENTER_VERTICAL);
+	gbsizer->Add(text_replace_, { 1, 1 }, { 1, 1 }, wxEXPAND);
+	gbsizer->Add(btn_replace_all_, { 1, 2 }, { 1, 1 }, wxEXPAND);
+	gbsizer->AddGrowableCol(1, 1);
+
+	// Options
+	cb_match_case_ = new wxCheckBox(this, -1, "Match Case");
+	cb_regex_      = new wxCheckBox(this, -1, "Regular Expression");
+	cb_whole_word_ = new wxCheckBox(this, -1, "Whole Word");
+	cb_nested_     = new wxCheckBox(this, -1, "Search Nested Archives");
+	cb_nested_->SetValue(true);
+	wxBoxSizer* hbox = new wxBoxSizer(wxHORIZONTAL);
+	hbox->Add(cb_match_case_, 0, wxEXPAND | wxRIGHT, UI::padLarge());
+	hbox->Add(cb_regex_, 0, wxEXPAND | wxRIGHT, UI::padLarge());
+	hbox->Add(cb_whole_word_, 0, wxEXPAND | wxRIGHT, UI::padLarge());
+	hbox->Add(cb_nested_, 0, wxEXPAND);
+	sizer->AddSpacer(UI::pad());
+	sizer->Add(hbox, 0, wxEXPAND | wxLEFT | wxRIGHT, UI::padLarge());
+
+	// Results list
+	list_results_ = new ListView(this, -1);
+	list_results_->enableSizeUpdate(false);
+	list_results_->AppendColumn("Entry");
+	list_results_->AppendColumn("Line");
+	list_results_->AppendColumn("Text");
+	list_results_->SetInitialSize(wxSize(UI::scalePx(600), UI::scalePx(300)));
+	sizer->AddSpacer(UI::pad());
+	sizer->Add(list_results_, 1, wxEXPAND | wxLEFT | wxRIGHT, UI::padLarge());
+
+	// Status + dialog buttons
+	label_status_ = new wxStaticText(this, -1, "");
+	btn_close_    = new wxButton(this, -1, "Close");
+	hbox          = new wxBoxSizer(wxHORIZONTAL);
+	hbox->Add(label_status_, 1, wxALIGN_CENTER_VERTICAL | wxRIGHT, UI::pad());
+	hbox->Add(btn_close_, 0, wxEXPAND);
+	sizer->AddSpacer(UI::pad());
+	sizer->Add(hbox, 0, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, UI::padLarge());
+
+	// Setup dialog layout
+	SetInitialSize(wxSize(-1, -1));
+	Layout();
+	Fit();
+	SetMinSize(GetBestSize());
+	CenterOnParent();
+
+	// Bind events
+	btn_search_->Bind(wxEVT_BUTTON, &TextSearchDialog::onBtnSearch, this);
+	text_find_->Bind(wxEVT_TEXT_ENTER, &TextSearchDialog::onBtnSearch, this);
+	btn_replace_all_->Bind(wxEVT_BUTTON, &TextSearchDialog::onBtnReplaceAll, this);
+	btn_close_->Bind(wxEVT_BUTTON, &TextSearchDialog::onBtnClose, this);
+	list_results_->Bind(wxEVT_LIST_ITEM_ACTIVATED, &TextSearchDialog::onResultActivated, this);
+	timer_results_.Bind(wxEVT_TIMER, &TextSearchDialog::onTimer, this);
+	cb_regex_->Bind(wxEVT_CHECKBOX, [&](wxCommandEvent&) { cb_whole_word_->Enable(!cb_regex_->GetValue()); });
+
+	text_find_->SetFocus();
+}
+
+// -----------------------------------------------------------------------------
+// TextSearchDialog class destructor
+// -----------------------------------------------------------------------------
+TextSearchDialog::~TextSearchDialog()
+{
+	timer_results_.Stop();
+	search_.cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the search options currently selected in the dialog
+// -----------------------------------------------------------------------------
+TextSearch::Options TextSearchDialog::options() const
+{
+	TextSearch::Options opt;
+	opt.find       = text_find_->GetValue();
+	opt.match_case = cb_match_case_->GetValue();
+	opt.regex      = cb_regex_->GetValue();
+	opt.whole_word = !opt.regex && cb_whole_word_->GetValue();
+	opt.nested     = cb_nested_->GetValue();
+	return opt;
+}
+
+// -----------------------------------------------------------------------------
+// Adds any new results from the running search to the list
+// -----------------------------------------------------------------------------
+void TextSearchDialog::addResults()
+{
+	auto results = search_.takeResults();
+	if (results.empty())
+		return;
+
+	list_results_->Freeze();
+	for (auto& result : results)
+	{
+		wxArrayString row;
+		row.Add(result.path);
+		row.Add(S_FMT("%d", result.line));
+		row.Add(result.text);
+		list_results_->addItem(list_results_->GetItemCount(), row);
+		results_.push_back(result);
+	}
+	list_results_->enableSizeUpdate(true);
+	list_results_->updateSize();
+	list_results_->enableSizeUpdate(false);
+	list_results_->Thaw();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the status text with the search progress
+// -----------------------------------------------------------------------------
+void TextSearchDialog::updateStatus()
+{
+	if (search_.running())
+		label_status_->SetLabel(S_FMT(
+			"Searching... (%d/%d entries, %d matches)",
+			search_.numSearched(),
+			search_.numEntries(),
+			(int)results_.size()));
+	else
+		label_status_->SetLabel(
+			S_FMT("%d matches in %d entries", (int)results_.size(), search_.numEntries()));
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// TextSearchDialog Class Events
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Called when the 'Search' button is clicked (or enter is pressed in the find
+// text box)
+// -----------------------------------------------------------------------------
+void TextSearchDialog::onBtnSearch(wxCommandEvent& e)
+{
+	timer_results_.Stop();
+	search_.cancel();
+	list_results_->DeleteAllItems();
+	results_.clear();
+
+	if (!search_.start(archive_, options()))
+	{
+		if (!text_find_->GetValue().empty())
+			wxMessageBox(Global::error, "Search Failed", wxICON_ERROR);
+		label_status_->SetLabel("");
+		return;
+	}
+
+	updateStatus();
+	timer_results_.Start(100);
+}
+
+// -----------------------------------------------------------------------------
+// Called when the 'Replace All' button is clicked
+// -----------------------------------------------------------------------------
+void TextSearchDialog::onBtnReplaceAll(wxCommandEvent& e)
+{
+	auto opt = options();
+	if (opt.find.empty())
+		return;
+
+	if (opt.regex && !TextSearch::regexValid(opt))
+	{
+		wxMessageBox("Invalid regular expression", "Replace Failed", wxICON_ERROR);
+		return;
+	}
+
+	// Stop searching, the results won't be valid after replacing
+	timer_results_.Stop();
+	search_.cancel();
+	list_results_->DeleteAllItems();
+	results_.clear();
+
+	wxBusyCursor busy;
+	auto         count = TextSearch::replaceAll(archive_, opt, text_replace_->GetValue(), undo_manager_);
+	if (count > 0)
+		replaced_ = true;
+
+	label_status_->SetLabel(S_FMT("Replaced %d occurrences", (int)count));
+}
+
+// -----------------------------------------------------------------------------
+// Called when the 'Close' button is clicked
+// -----------------------------------------------------------------------------
+void TextSearchDialog::onBtnClose(wxCommandEvent& e)
+{
+	EndModal(wxID_CANCEL);
+}
+
+// -----------------------------------------------------------------------------
+// Called when a result in the list is activated (double-clicked or enter
+// pressed), closes the dialog to open the entry at the matched line
+// -----------------------------------------------------------------------------
+void TextSearchDialog::onResultActivated(wxListEvent& e)
+{
+	long index = e.GetIndex();
+	if (index < 0 || index >= (long)results_.size())
+		return;
+
+	selected_entry_ = results_[index].entry;
+	selected_line_  = results_[index].nested ? 0 : results_[index].line;
+	EndModal(wxID_OK);
+}
+
+// -----------------------------------------------------------------------------
+// Called when the results timer fires, adds new results to the list
+// -----------------------------------------------------------------------------
+void TextSearchDialog::onTimer(wxTimerEvent& e)
+{
+	bool running = search_.running();
+	addResults();
+	updateStatus();
+
+	if (!running)
+	{
+		// Get any results added after the last check
+		addResults();
+		updateStatus();
+		timer_results_.Stop();
+	}
+}
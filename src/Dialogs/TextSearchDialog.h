@@ -0,0 +1,51 @@
+#pragma once
+
+#include "MainEditor/TextSearch.h"
+
+class Archive;
+class ListView;
+class UndoManager;
+
+class TextSearchDialog : public wxDialog
+{
+public:
+	TextSearchDialog(wxWindow* parent, Archive* archive, UndoManager* undo_manager = nullptr);
+	~TextSearchDialog();
+
+	ArchiveEntry* selectedEntry() const { return selected_entry_; }
+	int           selectedLine() const { return selected_line_; }
+	bool          replaced() const { return replaced_; }
+
+private:
+	Archive*                  archive_;
+	UndoManager*              undo_manager_;
+	TextSearch                search_;
+	vector<TextSearch::Match> results_;
+	wxTimer                   timer_results_;
+	ArchiveEntry*             selected_entry_ = nullptr;
+	int                       selected_line_  = 0;
+	bool                      replaced_       = false;
+
+	wxTextCtrl*   text_find_;
+	wxTextCtrl*   text_replace_;
+	wxCheckBox*   cb_match_case_;
+	wxCheckBox*   cb_regex_;
+	wxCheckBox*   cb_whole_word_;
+	wxCheckBox*   cb_nested_;
+	ListView*     list_results_;
+	wxStaticText* label_status_;
+	wxButton*     btn_search_;
+	wxButton*     btn_replace_all_;
+	wxButton*     btn_close_;
+
+	TextSearch::Options options() const;
+	void                addResults();
+	void                updateStatus();
+
+	// Events
+	void onBtnSearch(wxCommandEvent& e);
+	void onBtnReplaceAll(wxCommandEvent& e);
+	void onBtnClose(wxCommandEvent& e);
+	void onResultActivated(wxListEvent& e);
+	void onTimer(wxTimerEvent& e);
+};
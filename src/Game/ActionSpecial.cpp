@@ -177,6 +177,31 @@ string ActionSpecial::stringDesc() const
 	return ret;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the action special definition to binary stream [out]
+// -----------------------------------------------------------------------------
+void ActionSpecial::write(wxDataOutputStream& out) const
+{
+	out.WriteString(name_);
+	out.WriteString(group_);
+	out.Write32((int)tagged_);
+	out.Write32(number_);
+	args_.write(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the action special definition from binary stream [in], as written by
+// ActionSpecial::write
+// -----------------------------------------------------------------------------
+void ActionSpecial::read(wxDataInputStream& in)
+{
+	name_   = in.ReadString();
+	group_  = in.ReadString();
+	tagged_ = (TagType)in.Read32();
+	number_ = (int)in.Read32();
+	args_.read(in);
+}
+
 // -----------------------------------------------------------------------------
 // Initialises the global (static) action special types
 // -----------------------------------------------------------------------------
@@ -28,6 +28,8 @@ public:
 	void   reset();
 	void   parse(ParseTreeNode* node, Arg::SpecialMap* shared_args);
 	string stringDesc() const;
+	void   write(wxDataOutputStream& out) const;
+	void   read(wxDataInputStream& in);
 
 	static const ActionSpecial& unknown() { return unknown_; }
 	static const ActionSpecial& generalSwitched() { return gen_switched_; }
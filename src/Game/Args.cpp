@@ -256,6 +256,54 @@ void Arg::parse(ParseTreeNode* node, SpecialMap* shared_args)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes the arg definition to binary stream [out]
+// -----------------------------------------------------------------------------
+void Arg::write(wxDataOutputStream& out) const
+{
+	out.WriteString(name);
+	out.WriteString(desc);
+	out.Write32(type);
+
+	out.Write32(custom_values.size());
+	for (auto& cv : custom_values)
+	{
+		out.WriteString(cv.name);
+		out.Write32(cv.value);
+	}
+
+	out.Write32(custom_flags.size());
+	for (auto& cf : custom_flags)
+	{
+		out.WriteString(cf.name);
+		out.Write32(cf.value);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the arg definition from binary stream [in], as written by Arg::write
+// -----------------------------------------------------------------------------
+void Arg::read(wxDataInputStream& in)
+{
+	name = in.ReadString();
+	desc = in.ReadString();
+	type = (int)in.Read32();
+
+	custom_values.resize(in.Read32());
+	for (auto& cv : custom_values)
+	{
+		cv.name  = in.ReadString();
+		cv.value = (int)in.Read32();
+	}
+
+	custom_flags.resize(in.Read32());
+	for (auto& cf : custom_flags)
+	{
+		cf.name  = in.ReadString();
+		cf.value = (int)in.Read32();
+	}
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -293,3 +341,23 @@ string ArgSpec::stringDesc(int values[5], string values_str[2]) const
 
 	return ret;
 }
+
+// -----------------------------------------------------------------------------
+// Writes the arg spec to binary stream [out]
+// -----------------------------------------------------------------------------
+void ArgSpec::write(wxDataOutputStream& out) const
+{
+	out.Write32(count);
+	for (auto& arg : args)
+		arg.write(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the arg spec from binary stream [in], as written by ArgSpec::write
+// -----------------------------------------------------------------------------
+void ArgSpec::read(wxDataInputStream& in)
+{
+	count = (int)in.Read32();
+	for (auto& arg : args)
+		arg.read(in);
+}
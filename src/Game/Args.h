@@ -37,6 +37,8 @@ struct Arg
 	string valueString(int value) const;
 	string speedLabel(int value) const;
 	void   parse(ParseTreeNode* node, SpecialMap* shared_args);
+	void   write(wxDataOutputStream& out) const;
+	void   read(wxDataInputStream& in);
 };
 
 struct ArgSpec
@@ -50,5 +52,7 @@ struct ArgSpec
 	const Arg& operator[](int index) const { return args[index]; }
 
 	string stringDesc(int values[5], string values_str[2]) const;
+	void   write(wxDataOutputStream& out) const;
+	void   read(wxDataInputStream& in);
 };
 } // namespace Game
@@ -39,6 +39,7 @@
 #include "Decorate.h"
 #include "GenLineSpecial.h"
 #include "General/Console/Console.h"
+#include "General/Misc.h"
 #include "MapEditor/SLADEMap/SLADEMap.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -55,6 +56,168 @@ using namespace Game;
 EXTERN_CVAR(String, game_configuration)
 EXTERN_CVAR(String, port_configuration)
 CVAR(Bool, debug_configuration, false, CVAR_SAVE)
+CVAR(Bool, game_config_cache, true, CVAR_SAVE)
+
+namespace
+{
+// Binary configuration cache header (bump the version if the format changes)
+const uint32_t CONFIG_CACHE_MAGIC   = 0x43474353; // 'SCGC'
+const uint32_t CONFIG_CACHE_VERSION = 1;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Binary cache value writers
+// -----------------------------------------------------------------------------
+void writeValue(wxDataOutputStream& out, int value)
+{
+	out.Write32(value);
+}
+void writeValue(wxDataOutputStream& out, const string& value)
+{
+	out.WriteString(value);
+}
+void writeValue(wxDataOutputStream& out, const Configuration::Flag& flag)
+{
+	out.Write32(flag.flag);
+	out.WriteString(flag.name);
+	out.WriteString(flag.udmf);
+	out.Write8(flag.activation);
+}
+void writeValue(wxDataOutputStream& out, const gc_mapinfo_t& map)
+{
+	out.WriteString(map.mapname);
+	out.WriteString(map.sky1);
+	out.WriteString(map.sky2);
+}
+template<typename T> void writeValue(wxDataOutputStream& out, const T& value)
+{
+	value.write(out);
+}
+
+// -----------------------------------------------------------------------------
+// Binary cache value readers
+// -----------------------------------------------------------------------------
+void readValue(wxDataInputStream& in, int& value)
+{
+	value = (int)in.Read32();
+}
+void readValue(wxDataInputStream& in, string& value)
+{
+	value = in.ReadString();
+}
+void readValue(wxDataInputStream& in, Configuration::Flag& flag)
+{
+	flag.flag       = (int)in.Read32();
+	flag.name       = in.ReadString();
+	flag.udmf       = in.ReadString();
+	flag.activation = in.Read8() > 0;
+}
+void readValue(wxDataInputStream& in, gc_mapinfo_t& map)
+{
+	map.mapname = in.ReadString();
+	map.sky1    = in.ReadString();
+	map.sky2    = in.ReadString();
+}
+template<typename T> void readValue(wxDataInputStream& in, T& value)
+{
+	value.read(in);
+}
+
+// -----------------------------------------------------------------------------
+// Writes all values in [list] to binary stream [out]
+// -----------------------------------------------------------------------------
+template<typename T> void writeList(wxDataOutputStream& out, const vector<T>& list)
+{
+	out.Write32(list.size());
+	for (auto& value : list)
+		writeValue(out, value);
+}
+
+// -----------------------------------------------------------------------------
+// Replaces the contents of [list] with values read from binary stream [in]
+// -----------------------------------------------------------------------------
+template<typename T> void readList(wxDataInputStream& in, vector<T>& list)
+{
+	list.clear();
+	list.resize(in.Read32());
+	for (auto& value : list)
+		readValue(in, value);
+}
+
+// -----------------------------------------------------------------------------
+// Writes all key/value pairs in [map] to binary stream [out]
+// -----------------------------------------------------------------------------
+template<typename K, typename V> void writeMap(wxDataOutputStream& out, const std::map<K, V>& map)
+{
+	out.Write32(map.size());
+	for (auto& i : map)
+	{
+		writeValue(out, i.first);
+		writeValue(out, i.second);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Replaces the contents of [map] with key/value pairs read from binary stream
+// [in]
+// -----------------------------------------------------------------------------
+template<typename K, typename V> void readMap(wxDataInputStream& in, std::map<K, V>& map)
+{
+	map.clear();
+	unsigned count = in.Read32();
+	for (unsigned a = 0; a < count && in.IsOk(); a++)
+	{
+		K key;
+		readValue(in, key);
+		readValue(in, map[key]);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes feature support [map] to binary stream [out]
+// -----------------------------------------------------------------------------
+template<typename F> void writeFeatures(wxDataOutputStream& out, const std::map<F, bool>& map)
+{
+	out.Write32(map.size());
+	for (auto& i : map)
+	{
+		out.Write32((int)i.first);
+		out.Write8(i.second);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Replaces feature support [map] with values read from binary stream [in]
+// -----------------------------------------------------------------------------
+template<typename F> void readFeatures(wxDataInputStream& in, std::map<F, bool>& map)
+{
+	map.clear();
+	unsigned count = in.Read32();
+	for (unsigned a = 0; a < count && in.IsOk(); a++)
+	{
+		auto feature = (F)in.Read32();
+		map[feature] = in.Read8() > 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the binary cache file for configuration [game]+[port]
+// in map [format]
+// -----------------------------------------------------------------------------
+string configCachePath(const string& game, const string& port, uint8_t format)
+{
+	string name = port.IsEmpty() ? game : game + "_" + port;
+	return Misc::cachePath(S_FMT("config_%s_%d.dat", name, format));
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -70,6 +233,7 @@ CVAR(Bool, debug_configuration, false, CVAR_SAVE)
 Configuration::Configuration()
 {
 	setDefaults();
+	initBasicFlagHandles();
 }
 
 // -----------------------------------------------------------------------------
@@ -84,9 +248,13 @@ void Configuration::setDefaults()
 {
 	udmf_namespace_ = "";
 	defaults_line_.clear();
+	defaults_line_udmf_.clear();
 	defaults_side_.clear();
+	defaults_side_udmf_.clear();
 	defaults_sector_.clear();
+	defaults_sector_udmf_.clear();
 	defaults_thing_.clear();
+	defaults_thing_udmf_.clear();
 	maps_.clear();
 	sky_flat_        = "F_SKY1";
 	script_language_ = "";
@@ -533,6 +701,7 @@ bool Configuration::readConfiguration(string& cfg, string source, uint8_t format
 		thing_types_.clear();
 		flags_thing_.clear();
 		flags_line_.clear();
+		triggers_line_.clear();
 		sector_types_.clear();
 		udmf_vertex_props_.clear();
 		udmf_linedef_props_.clear();
@@ -872,6 +1041,7 @@ bool Configuration::readConfiguration(string& cfg, string source, uint8_t format
 // -----------------------------------------------------------------------------
 bool Configuration::openConfig(string game, string port, uint8_t format)
 {
+	auto   start = App::runTimer();
 	string full_config;
 
 	// Get game configuration as string
@@ -941,15 +1111,42 @@ bool Configuration::openConfig(string game, string port, uint8_t format)
 		test.Close();
 	}
 
-	// Read fully built configuration
-	bool ok = true;
-	if (readConfiguration(full_config, "full.cfg", format))
+	// Load from the binary cache if it was built from the same configuration
+	// text, otherwise read fully built configuration (and cache it)
+	bool     ok         = true;
+	auto     utf8       = full_config.ToUTF8();
+	uint32_t hash       = Misc::crc((const uint8_t*)utf8.data(), utf8.length());
+	string   cache_path = configCachePath(game, port, format);
+	if (game_config_cache && readCache(cache_path, hash))
+	{
+		current_game_      = game;
+		current_port_      = port;
+		game_configuration = game;
+		port_configuration = port;
+		Log::info(
+			1,
+			S_FMT(
+				"Read game configuration \"%s\" + \"%s\" from cache (%ldms)",
+				current_game_,
+				current_port_,
+				App::runTimer() - start));
+	}
+	else if (readConfiguration(full_config, "full.cfg", format))
 	{
 		current_game_      = game;
 		current_port_      = port;
 		game_configuration = game;
 		port_configuration = port;
-		LOG_MESSAGE(1, "Read game configuration \"%s\" + \"%s\"", current_game_, current_port_);
+		Log::info(
+			1,
+			S_FMT(
+				"Read game configuration \"%s\" + \"%s\" (%ldms)",
+				current_game_,
+				current_port_,
+				App::runTimer() - start));
+
+		if (game_config_cache && !writeCache(cache_path, hash))
+			Log::warning(S_FMT("Unable to write game configuration cache \"%s\"", cache_path));
 	}
 	else
 	{
@@ -977,6 +1174,129 @@ bool Configuration::openConfig(string game, string port, uint8_t format)
 	return ok;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the current configuration to a binary cache file at [filename],
+// tagged with [source_hash] (the hash of the configuration text it was read
+// from). Embedded SLADECFG configurations should not be read in yet, since they
+// depend on the open resources
+// -----------------------------------------------------------------------------
+bool Configuration::writeCache(const string& filename, uint32_t source_hash) const
+{
+	wxMemoryOutputStream stream;
+	wxDataOutputStream   out(stream);
+
+	// Source info
+	out.WriteString(Global::version);
+	out.Write32(source_hash);
+
+	// Game section
+	out.WriteString(udmf_namespace_);
+	out.WriteString(sky_flat_);
+	out.WriteString(script_language_);
+	out.Write32(boom_sector_flag_start_);
+	for (auto supported : map_formats_)
+		out.Write8(supported);
+	writeList(out, light_levels_);
+	writeList(out, maps_);
+	writeFeatures(out, supported_features_);
+	writeFeatures(out, udmf_features_);
+
+	// Definitions
+	writeMap(out, action_specials_);
+	writeMap(out, thing_types_);
+	writeMap(out, tt_group_defaults_);
+	writeList(out, flags_thing_);
+	writeList(out, flags_line_);
+	writeList(out, triggers_line_);
+	writeMap(out, sector_types_);
+	writeMap(out, udmf_vertex_props_);
+	writeMap(out, udmf_linedef_props_);
+	writeMap(out, udmf_sidedef_props_);
+	writeMap(out, udmf_sector_props_);
+	writeMap(out, udmf_thing_props_);
+	writeList(out, special_presets_);
+
+	// Defaults
+	defaults_line_.write(out);
+	defaults_line_udmf_.write(out);
+	defaults_side_.write(out);
+	defaults_side_udmf_.write(out);
+	defaults_sector_.write(out);
+	defaults_sector_udmf_.write(out);
+	defaults_thing_.write(out);
+	defaults_thing_udmf_.write(out);
+
+	return Misc::writeCacheFile(filename, CONFIG_CACHE_MAGIC, CONFIG_CACHE_VERSION, stream);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the configuration from the binary cache file at [filename]. Returns
+// false if the cache doesn't exist, is invalid or out of date, or wasn't built
+// from configuration text matching [source_hash]
+// -----------------------------------------------------------------------------
+bool Configuration::readCache(const string& filename, uint32_t source_hash)
+{
+	// Load cache file into memory
+	MemChunk mc;
+	if (!Misc::readCacheFile(filename, CONFIG_CACHE_MAGIC, CONFIG_CACHE_VERSION, mc))
+		return false;
+
+	wxMemoryInputStream stream(mc.getData(), mc.getSize());
+	wxDataInputStream   in(stream);
+
+	// Check it was built from the same configuration text
+	if (in.ReadString() != Global::version || in.Read32() != source_hash || !in.IsOk())
+		return false;
+
+	setDefaults();
+
+	// Game section
+	udmf_namespace_         = in.ReadString();
+	sky_flat_               = in.ReadString();
+	script_language_        = in.ReadString();
+	boom_sector_flag_start_ = (int)in.Read32();
+	for (auto& supported : map_formats_)
+		supported = in.Read8() > 0;
+	readList(in, light_levels_);
+	readList(in, maps_);
+	readFeatures(in, supported_features_);
+	readFeatures(in, udmf_features_);
+
+	// Definitions
+	readMap(in, action_specials_);
+	readMap(in, thing_types_);
+	readMap(in, tt_group_defaults_);
+	readList(in, flags_thing_);
+	readList(in, flags_line_);
+	readList(in, triggers_line_);
+	readMap(in, sector_types_);
+	readMap(in, udmf_vertex_props_);
+	readMap(in, udmf_linedef_props_);
+	readMap(in, udmf_sidedef_props_);
+	readMap(in, udmf_sector_props_);
+	readMap(in, udmf_thing_props_);
+	readList(in, special_presets_);
+
+	// Defaults
+	defaults_line_.read(in);
+	defaults_line_udmf_.read(in);
+	defaults_side_.read(in);
+	defaults_side_udmf_.read(in);
+	defaults_sector_.read(in);
+	defaults_sector_udmf_.read(in);
+	defaults_thing_.read(in);
+	defaults_thing_udmf_.read(in);
+
+	// Check everything was read
+	if (!in.IsOk())
+	{
+		Log::warning(S_FMT("Game configuration cache \"%s\" is invalid, ignoring", filename));
+		return false;
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the action special definition for [id]
 // -----------------------------------------------------------------------------
@@ -1074,81 +1394,115 @@ bool Configuration::thingFlagSet(unsigned index, MapThing* thing)
 // -----------------------------------------------------------------------------
 bool Configuration::thingFlagSet(string flag, MapThing* thing, int map_format)
 {
-	// If UDMF, just get the bool value
-	if (map_format == MAP_UDMF)
-		return thing->boolProperty(flag);
+	return thingFlagSet(thingFlagHandle(flag, map_format), thing);
+}
 
-	// Get current flags
-	unsigned long flags = thing->intProperty("flags");
+// -----------------------------------------------------------------------------
+// Returns true if the basic flag matching [flag] is set for [thing]
+// -----------------------------------------------------------------------------
+bool Configuration::thingBasicFlagSet(string flag, MapThing* thing, int map_format)
+{
+	return thingFlagSet(thingBasicFlagHandle(flag, map_format), thing);
+}
 
-	// Iterate through flags
-	for (size_t i = 0; i < flags_thing_.size(); ++i)
+// -----------------------------------------------------------------------------
+// Returns a handle to the thing flag matching [flag] (UDMF name) for
+// [map_format]
+// -----------------------------------------------------------------------------
+Configuration::FlagHandle Configuration::thingFlagHandle(const string& flag, int map_format)
+{
+	FlagHandle handle;
+	handle.udmf = flag;
+
+	// If UDMF, the flag is a bool property
+	if (map_format == MAP_UDMF)
 	{
-		if (flags_thing_[i].udmf == flag)
-			return !!(flags & flags_thing_[i].flag);
+		handle.use_udmf = true;
+		return handle;
 	}
+
+	// Find flag
+	for (auto& thing_flag : flags_thing_)
+		if (thing_flag.udmf == flag)
+		{
+			handle.mask = thing_flag.flag;
+			return handle;
+		}
+
 	LOG_MESSAGE(2, "Flag %s does not exist in this configuration", flag);
-	return false;
+	return handle;
 }
 
 // -----------------------------------------------------------------------------
-// Returns true if the basic flag matching [flag] is set for [thing]
+// Returns a handle to the basic thing flag matching [flag] for [map_format]
 // -----------------------------------------------------------------------------
-bool Configuration::thingBasicFlagSet(string flag, MapThing* thing, int map_format)
+Configuration::FlagHandle Configuration::thingBasicFlagHandle(const string& flag, int map_format)
 {
-	// If UDMF, just get the bool value
-	if (map_format == MAP_UDMF)
-		return thing->boolProperty(flag);
+	FlagHandle handle;
+	handle.udmf = flag;
 
-	// Get current flags
-	unsigned long flags = thing->intProperty("flags");
+	// If UDMF, the flag is a bool property
+	if (map_format == MAP_UDMF)
+	{
+		handle.use_udmf = true;
+		return handle;
+	}
 
 	// Hexen-style flags in Hexen-format maps
 	bool hexen = map_format == MAP_HEXEN;
 
 	// Easy Skill
 	if (flag == "skill2" || flag == "skill1")
-		return !!(flags & 1);
+		handle.mask = 1;
 
 	// Medium Skill
 	else if (flag == "skill3")
-		return !!(flags & 2);
+		handle.mask = 2;
 
 	// Hard Skill
 	else if (flag == "skill4" || flag == "skill5")
-		return !!(flags & 4);
+		handle.mask = 4;
 
 	// Game mode flags
 	else if (flag == "single")
 	{
 		// Single Player
 		if (hexen)
-			return !!(flags & 256);
+			handle.mask = 256;
 		// *Not* Multiplayer
 		else
-			return !(flags & 16);
+		{
+			handle.mask     = 16;
+			handle.inverted = true;
+		}
 	}
 	else if (flag == "coop")
 	{
 		// Coop
 		if (hexen)
-			return !!(flags & 512);
+			handle.mask = 512;
 		// *Not* Not In Coop
 		else if (supported_features_[Feature::Boom])
-			return !(flags & 64);
+		{
+			handle.mask     = 64;
+			handle.inverted = true;
+		}
 		else
-			return true;
+			handle.always = true;
 	}
 	else if (flag == "dm")
 	{
 		// Deathmatch
 		if (hexen)
-			return !!(flags & 1024);
+			handle.mask = 1024;
 		// *Not* Not In DM
 		else if (supported_features_[Feature::Boom])
-			return !(flags & 32);
+		{
+			handle.mask     = 32;
+			handle.inverted = true;
+		}
 		else
-			return true;
+			handle.always = true;
 	}
 
 	// Hexen class flags
@@ -1156,17 +1510,62 @@ bool Configuration::thingBasicFlagSet(string flag, MapThing* thing, int map_form
 	{
 		// Fighter
 		if (flag == "class1")
-			return !!(flags & 32);
+			handle.mask = 32;
 		// Cleric
 		else if (flag == "class2")
-			return !!(flags & 64);
+			handle.mask = 64;
 		// Mage
 		else if (flag == "class3")
-			return !!(flags & 128);
+			handle.mask = 128;
 	}
 
 	// Not basic
-	return thingFlagSet(flag, thing, map_format);
+	if (handle.mask == 0 && !handle.always)
+		return thingFlagHandle(flag, map_format);
+
+	return handle;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the flag for [handle] is set for [thing]
+// -----------------------------------------------------------------------------
+bool Configuration::thingFlagSet(const FlagHandle& flag, MapThing* thing)
+{
+	if (flag.use_udmf)
+		return thing->boolProperty(flag.udmf);
+
+	return flag.isSet(thing->intProperty("flags"));
+}
+
+// -----------------------------------------------------------------------------
+// Returns a bitmask with bit n set if [flags][n] is set for [thing], reading
+// the thing's flags only once. Only the first 64 flags are checked
+// -----------------------------------------------------------------------------
+uint64_t Configuration::thingFlagBits(const vector<FlagHandle>& flags, MapThing* thing)
+{
+	uint64_t bits       = 0;
+	unsigned raw_flags  = 0;
+	bool     raw_loaded = false;
+	for (unsigned a = 0; a < flags.size() && a < 64; ++a)
+	{
+		bool set;
+		if (flags[a].use_udmf)
+			set = thing->boolProperty(flags[a].udmf);
+		else
+		{
+			if (!raw_loaded)
+			{
+				raw_flags  = thing->intProperty("flags");
+				raw_loaded = true;
+			}
+			set = flags[a].isSet(raw_flags);
+		}
+
+		if (set)
+			bits |= 1ull << a;
+	}
+
+	return bits;
 }
 
 // -----------------------------------------------------------------------------
@@ -1460,21 +1859,7 @@ bool Configuration::lineFlagSet(unsigned index, MapLine* line)
 // -----------------------------------------------------------------------------
 bool Configuration::lineFlagSet(string flag, MapLine* line, int map_format)
 {
-	// If UDMF, just get the bool value
-	if (map_format == MAP_UDMF)
-		return line->boolProperty(flag);
-
-	// Get current flags
-	unsigned long flags = line->intProperty("flags");
-
-	// Iterate through flags
-	for (size_t i = 0; i < flags_line_.size(); ++i)
-	{
-		if (flags_line_[i].udmf == flag)
-			return !!(flags & flags_line_[i].flag);
-	}
-	LOG_MESSAGE(2, "Flag %s does not exist in this configuration", flag);
-	return false;
+	return lineFlagSet(lineFlagHandle(flag, map_format), line);
 }
 
 // -----------------------------------------------------------------------------
@@ -1484,31 +1869,117 @@ bool Configuration::lineFlagSet(string flag, MapLine* line, int map_format)
 // -----------------------------------------------------------------------------
 bool Configuration::lineBasicFlagSet(string flag, MapLine* line, int map_format)
 {
-	// If UDMF, just get the bool value
+	return lineFlagSet(lineBasicFlagHandle(flag, map_format), line);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the basic [flag] is set for [line]
+// -----------------------------------------------------------------------------
+bool Configuration::lineBasicFlagSet(LineBasicFlag flag, MapLine* line, int map_format)
+{
+	return lineFlagSet(lineBasicFlag(flag, map_format), line);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a handle to the line flag matching [flag] (UDMF name) for
+// [map_format]
+// -----------------------------------------------------------------------------
+Configuration::FlagHandle Configuration::lineFlagHandle(const string& flag, int map_format)
+{
+	FlagHandle handle;
+	handle.udmf = flag;
+
+	// If UDMF, the flag is a bool property
 	if (map_format == MAP_UDMF)
-		return line->boolProperty(flag);
+	{
+		handle.use_udmf = true;
+		return handle;
+	}
 
-	// Get current flags
-	unsigned long flags = line->intProperty("flags");
+	// Find flag
+	for (auto& line_flag : flags_line_)
+		if (line_flag.udmf == flag)
+		{
+			handle.mask = line_flag.flag;
+			return handle;
+		}
+
+	LOG_MESSAGE(2, "Flag %s does not exist in this configuration", flag);
+	return handle;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a handle to the basic line flag matching [flag] (UDMF name) for
+// [map_format]
+// -----------------------------------------------------------------------------
+Configuration::FlagHandle Configuration::lineBasicFlagHandle(const string& flag, int map_format)
+{
+	FlagHandle handle;
+	handle.udmf = flag;
+
+	// If UDMF, the flag is a bool property
+	if (map_format == MAP_UDMF)
+	{
+		handle.use_udmf = true;
+		return handle;
+	}
 
 	// Impassable
 	if (flag == "blocking")
-		return !!(flags & 1);
+		handle.mask = 1;
 
 	// Two Sided
 	else if (flag == "twosided")
-		return !!(flags & 4);
+		handle.mask = 4;
 
 	// Upper unpegged
 	else if (flag == "dontpegtop")
-		return !!(flags & 8);
+		handle.mask = 8;
 
 	// Lower unpegged
 	else if (flag == "dontpegbottom")
-		return !!(flags & 16);
+		handle.mask = 16;
 
 	// Not basic
-	return lineFlagSet(flag, line, map_format);
+	else
+		return lineFlagHandle(flag, map_format);
+
+	return handle;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (pre-resolved) handle to the basic line [flag] for [map_format]
+// -----------------------------------------------------------------------------
+const Configuration::FlagHandle& Configuration::lineBasicFlag(LineBasicFlag flag, int map_format) const
+{
+	if (map_format < 0 || map_format > MAP_UNKNOWN)
+		map_format = MAP_UNKNOWN;
+
+	return line_basic_flags_[map_format][(int)flag];
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the flag for [handle] is set for [line]
+// -----------------------------------------------------------------------------
+bool Configuration::lineFlagSet(const FlagHandle& flag, MapLine* line)
+{
+	if (flag.use_udmf)
+		return line->boolProperty(flag.udmf);
+
+	return flag.isSet(line->intProperty("flags"));
+}
+
+// -----------------------------------------------------------------------------
+// Resolves the handles for all basic line flags in each map format. These
+// don't depend on the game configuration so only need to be done once
+// -----------------------------------------------------------------------------
+void Configuration::initBasicFlagHandles()
+{
+	static const char* line_basic_flags[] = { "blocking", "twosided", "dontpegtop", "dontpegbottom" };
+
+	for (int format = 0; format <= MAP_UNKNOWN; ++format)
+		for (int flag = 0; flag < (int)LineBasicFlag::Count; ++flag)
+			line_basic_flags_[format][flag] = lineBasicFlagHandle(line_basic_flags[flag], format);
 }
 
 // -----------------------------------------------------------------------------
@@ -69,6 +69,29 @@ public:
 		bool   activation;
 	};
 
+	// A thing/line flag resolved for a map format, so it can be checked
+	// repeatedly without looking it up by name each time
+	struct FlagHandle
+	{
+		string   udmf;             // UDMF property name (UDMF maps)
+		unsigned mask     = 0;     // Bit(s) in the 'flags' property (other map formats)
+		bool     inverted = false; // Flag is set when the bit is *not* set
+		bool     always   = false; // Flag is always set (no equivalent in this game/format)
+		bool     use_udmf = false;
+
+		bool isSet(unsigned flags) const { return always || (((flags & mask) != 0) != inverted); }
+	};
+
+	enum class LineBasicFlag
+	{
+		Blocking = 0,
+		TwoSided,
+		DontPegTop,
+		DontPegBottom,
+
+		Count
+	};
+
 	Configuration();
 	~Configuration();
 
@@ -107,6 +130,10 @@ public:
 		bool    clear       = true);
 	bool openConfig(string game, string port = "", uint8_t format = MAP_UNKNOWN);
 
+	// Binary configuration cache
+	bool writeCache(const string& filename, uint32_t source_hash) const;
+	bool readCache(const string& filename, uint32_t source_hash);
+
 	// Action specials
 	const ActionSpecial& actionSpecial(unsigned id);
 	string               actionSpecialName(int special);
@@ -126,6 +153,12 @@ public:
 	void   setThingFlag(string udmf_name, MapThing* thing, int map_format, bool set = true);
 	void   setThingBasicFlag(string flag, MapThing* line, int map_format, bool set = true);
 
+	// Thing flag handles
+	FlagHandle thingFlagHandle(const string& udmf_name, int map_format);
+	FlagHandle thingBasicFlagHandle(const string& flag, int map_format);
+	bool       thingFlagSet(const FlagHandle& flag, MapThing* thing);
+	uint64_t   thingFlagBits(const vector<FlagHandle>& flags, MapThing* thing);
+
 	// DECORATE
 	bool parseDecorateDefs(Archive* archive);
 	void clearDecorateDefs();
@@ -149,6 +182,13 @@ public:
 	void        setLineFlag(string udmf_name, MapLine* line, int map_format, bool set = true);
 	void        setLineBasicFlag(string flag, MapLine* line, int map_format, bool set = true);
 
+	// Line flag handles
+	FlagHandle        lineFlagHandle(const string& udmf_name, int map_format);
+	FlagHandle        lineBasicFlagHandle(const string& flag, int map_format);
+	const FlagHandle& lineBasicFlag(LineBasicFlag flag, int map_format) const;
+	bool              lineFlagSet(const FlagHandle& flag, MapLine* line);
+	bool              lineBasicFlagSet(LineBasicFlag flag, MapLine* line, int map_format);
+
 	// Line action (SPAC) triggers
 	string        spacTriggerString(MapLine* line, int map_format);
 	int           spacTriggerIndexHexen(MapLine* line);
@@ -216,6 +256,7 @@ private:
 	vector<Flag> flags_thing_;
 	vector<Flag> flags_line_;
 	vector<Flag> triggers_line_;
+	FlagHandle   line_basic_flags_[MAP_UNKNOWN + 1][(int)LineBasicFlag::Count];
 
 	// Sector types
 	std::map<int, string> sector_types_;
@@ -247,5 +288,7 @@ private:
 
 	// Special Presets
 	vector<SpecialPreset> special_presets_;
+
+	void initBasicFlagHandles();
 };
 } // namespace Game
@@ -34,9 +34,11 @@
 #include "Archive/Archive.h"
 #include "Configuration.h"
 #include "Game.h"
+#include "General/Misc.h"
 #include "ThingType.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <mutex>
 
 using namespace Game;
 
@@ -49,7 +51,39 @@ using namespace Game;
 namespace
 {
 EntryType* etype_decorate = nullptr;
-}
+
+// A single parsed DECORATE definition, before being applied to a ThingType
+struct DecorateDef
+{
+	bool           actor = false; // False for old-style (non-actor) definitions
+	int            ednum = -1;
+	string         name;
+	string         class_name;
+	string         parent;
+	string         group;
+	vector<string> filters;
+	PropertyList   props;
+};
+
+// The parsed contents of a single DECORATE entry
+struct DecorateUnit
+{
+	struct Include
+	{
+		unsigned index; // Index of the first definition after the #include
+		string   path;
+		unsigned line;
+	};
+
+	vector<DecorateDef> defs;
+	vector<Include>     includes;
+};
+
+// Parsed DECORATE units, keyed by the hash of their entry data
+std::map<uint64_t, std::shared_ptr<DecorateUnit>> decorate_units;
+std::mutex                                        decorate_units_mutex;
+const size_t                                      MAX_CACHED_UNITS = 4096;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -78,9 +112,9 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 		if (tz.checkNext(":"))
 		{
 			// Add to list of current states
-			states.push_back(tz.current().text.Lower());
+			states.push_back(tz.current().text().Lower());
 			if (state_first.empty())
-				state_first = tz.current().text.Lower();
+				state_first = tz.current().text().Lower();
 
 			tz.adv();
 		}
@@ -97,9 +131,9 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 			}
 
 			// Set sprite for current states (if it is defined)
-			if (!(tz.current().text.Contains("#") || tz.current().text.Contains("-")))
+			if (!(tz.current().text().Contains("#") || tz.current().text().Contains("-")))
 				for (auto& state : states)
-					state_sprites[state] = tz.current().text + tz.peek().text[0];
+					state_sprites[state] = tz.current().text() + tz.peek().text()[0];
 
 			states.clear();
 			tz.adv();
@@ -235,19 +269,21 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 }
 
 // -----------------------------------------------------------------------------
-// Parses a DECORATE 'actor' definition
+// Parses a DECORATE 'actor' definition into [unit]
 // -----------------------------------------------------------------------------
-void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateActor(Tokenizer& tz, DecorateUnit& unit)
 {
+	DecorateDef def;
+	def.actor = true;
+
 	// Get actor name
-	string name       = tz.next().text;
-	string actor_name = name;
-	string parent;
+	def.name       = tz.next().text();
+	def.class_name = def.name;
 
 	// Check for inheritance
 	// string next = tz.peekToken();
 	if (tz.advIfNext(":"))
-		parent = tz.next().text;
+		def.parent = tz.next().text();
 
 	// Check for replaces
 	if (tz.checkNextNC("replaces"))
@@ -258,18 +294,14 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 		tz.adv();
 
 	// Check for no editor number (ie can't be placed in the map)
-	int ednum;
 	if (!tz.peek().isInteger())
-		ednum = -1;
+		def.ednum = -1;
 	else
-		tz.next().toInt(ednum);
+		tz.next().toInt(def.ednum);
 
-	PropertyList found_props;
-	bool         available       = false;
-	bool         filters_present = false;
-	bool         sprite_given    = false;
-	bool         title_given     = false;
-	string       group;
+	auto& found_props  = def.props;
+	bool  sprite_given = false;
+	bool  title_given  = false;
 
 	// Skip "native" keyword if present
 	tz.advIfNextNC("native");
@@ -289,34 +321,30 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			// Title
 			else if (tz.checkNC("//$Title"))
 			{
-				name        = tz.getLine();
+				def.name    = tz.getLine();
 				title_given = true;
 				continue;
 			}
 
 			// Game filter
 			else if (tz.checkNC("game"))
-			{
-				filters_present = true;
-				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text))
-					available = true;
-			}
+				def.filters.push_back(tz.next().text());
 
 			// Tag
 			else if (!title_given && tz.checkNC("tag"))
-				name = tz.next().text;
+				def.name = tz.next().text();
 
 			// Category
 			else if (tz.checkNC("//$Group") || tz.checkNC("//$Category"))
 			{
-				group = tz.getLine();
+				def.group = tz.getLine();
 				continue;
 			}
 
 			// Sprite
 			else if (tz.checkNC("//$EditorSprite") || tz.checkNC("//$Sprite"))
 			{
-				found_props["sprite"] = tz.next().text;
+				found_props["sprite"] = tz.next().text();
 				sprite_given          = true;
 			}
 
@@ -363,11 +391,11 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 
 			// Icon
 			else if (tz.checkNC("//$Icon"))
-				found_props["icon"] = tz.next().text;
+				found_props["icon"] = tz.next().text();
 
 			// DB2 Color
 			else if (tz.checkNC("//$Color"))
-				found_props["color"] = tz.next().text;
+				found_props["color"] = tz.next().text();
 
 			// SLADE 3 Colour (overrides DB2 color)
 			// Good thing US spelling differs from ABC (Aussie/Brit/Canuck) spelling! :p
@@ -385,11 +413,11 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			else if (tz.checkNC("translation"))
 			{
 				string translation = "\"";
-				translation += tz.next().text;
+				translation += tz.next().text();
 				while (tz.checkNext(","))
 				{
-					translation += tz.next().text; // ,
-					translation += tz.next().text; // next range
+					translation += tz.next().text(); // ,
+					translation += tz.next().text(); // next range
 				}
 				translation += "\"";
 				found_props["translation"] = translation;
@@ -400,7 +428,7 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 				found_props["solid"] = true;
 
 			// Unrecognised DB comment prop
-			else if (tz.current().text.StartsWith("//$"))
+			else if (tz.current().startsWith("//$"))
 			{
 				tz.advToNextLine();
 				continue;
@@ -416,66 +444,18 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			tz.adv();
 		}
 
-		LOG_MESSAGE(3, "Parsed actor %s: %d", name, ednum);
+		LOG_MESSAGE(3, "Parsed actor %s: %d", def.name, def.ednum);
 	}
 	else
-		LOG_MESSAGE(1, "Warning: Invalid actor definition for %s", name);
-
-	// Ignore actors filtered for other games,
-	// and actors with a negative or null type
-	if (available || !filters_present)
-	{
-		string group_path = group.empty() ? "Decorate" : "Decorate/" + group;
-
-		// Find existing definition or create it
-		ThingType* def = nullptr;
-		if (ednum <= 0)
-		{
-			for (auto& ptype : parsed)
-				if (S_CMPNOCASE(ptype.className(), actor_name))
-				{
-					def = &ptype;
-					break;
-				}
-
-			if (!def)
-			{
-				parsed.push_back(ThingType(name, group_path, actor_name));
-				def = &parsed.back();
-			}
-		}
-		else
-			def = &types[ednum];
-
-		// Add/update definition
-		def->define(ednum, name, group_path);
-
-		// Set group defaults (if any)
-		if (!group.empty())
-		{
-			auto& group_defaults = configuration().thingTypeGroupDefaults(group);
-			if (!group_defaults.group().empty())
-				def->copy(group_defaults);
-		}
+		LOG_MESSAGE(1, "Warning: Invalid actor definition for %s", def.name);
 
-		// Inherit from parent
-		if (!parent.empty())
-			for (auto& ptype : parsed)
-				if (S_CMPNOCASE(ptype.className(), parent))
-				{
-					def->copy(ptype);
-					break;
-				}
-
-		// Set parsed properties
-		def->loadProps(found_props);
-	}
+	unit.defs.push_back(std::move(def));
 }
 
 // -----------------------------------------------------------------------------
-// Parses an old-style (non-actor) DECORATE definition
+// Parses an old-style (non-actor) DECORATE definition into [unit]
 // -----------------------------------------------------------------------------
-void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
+void parseDecorateOld(Tokenizer& tz, DecorateUnit& unit)
 {
 	string       name, sprite, group;
 	bool         spritefound = false;
@@ -484,12 +464,12 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 	int          type       = -1;
 	PropertyList found_props;
 	if (tz.checkNext("{"))
-		name = tz.current().text;
+		name = tz.current().text();
 	// DamageTypes aren't old DECORATE format, but we handle them here to skip over them
 	else if (tz.checkNC("pickup") || tz.checkNC("breakable") || tz.checkNC("projectile") || tz.checkNC("damagetype"))
 	{
-		group = tz.current().text;
-		name  = tz.next().text;
+		group = tz.current().text();
+		name  = tz.next().text();
 	}
 	tz.adv(); // skip '{'
 	do
@@ -505,13 +485,13 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 		// else if (S_CMPNOCASE(token, "Sprite"))
 		else if (tz.checkNC("sprite"))
 		{
-			sprite      = tz.next().text;
+			sprite      = tz.next().text();
 			spritefound = true;
 		}
 		// else if (S_CMPNOCASE(token, "Frames"))
 		else if (tz.checkNC("frames"))
 		{
-			string   frames = tz.next().text;
+			string   frames = tz.next().text();
 			unsigned pos    = 0;
 			if (frames.length() > 0)
 			{
@@ -552,10 +532,12 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 			found_props["sprite"] = sprite + frame + '?';
 
 		// Add type
-		types[type].define(type, name, group.empty() ? "Decorate" : "Decorate/" + group);
-
-		// Set parsed properties
-		types[type].loadProps(found_props);
+		DecorateDef def;
+		def.ednum = type;
+		def.name  = name;
+		def.group = group;
+		def.props = found_props;
+		unit.defs.push_back(std::move(def));
 
 		LOG_MESSAGE(3, "Parsed %s %s: %d", group.length() ? group : "decoration", name, type);
 	}
@@ -564,15 +546,16 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 }
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// Tokenizes and parses the DECORATE definitions in [data] into [unit].
+// #includes are only recorded, they are resolved when the unit is applied
 // -----------------------------------------------------------------------------
-void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateUnit(MemChunk& data, const string& source, DecorateUnit& unit)
 {
 	// Init tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters(":,{}");
 	tz.enableDecorate(true);
-	tz.openMem(entry->getMCData(), entry->getName());
+	tz.openMem(data, source);
 
 	// --- Parse ---
 	while (!tz.atEnd())
@@ -580,32 +563,180 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 		// Check for #include
 		if (tz.checkNC("#include"))
 		{
-			auto inc_entry = entry->relativeEntry(tz.next().text);
-
-			// Check #include path could be resolved
-			if (!inc_entry)
-			{
-				Log::warning(S_FMT(
-					"Warning parsing DECORATE entry %s: "
-					"Unable to find #included entry \"%s\" at line %d, skipping",
-					CHR(entry->getName()),
-					CHR(tz.current().text),
-					tz.current().line_no));
-			}
-			else
-				parseDecorateEntry(inc_entry, types, parsed);
+			DecorateUnit::Include inc;
+			inc.index = unit.defs.size();
+			inc.path  = tz.next().text();
+			inc.line  = tz.current().line_no;
+			unit.includes.push_back(inc);
 
 			tz.adv();
 		}
 
 		// Check for actor definition
 		else if (tz.checkNC("actor"))
-			parseDecorateActor(tz, types, parsed);
+			parseDecorateActor(tz, unit);
 		else
-			parseDecorateOld(tz, types); // Old DECORATE definitions might be found
+			parseDecorateOld(tz, unit); // Old DECORATE definitions might be found
 
 		tz.advIf("}");
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the parsed DECORATE unit for [entry], from the cache if an entry
+// with identical content has been parsed previously.
+// If [allow_load] is false the entry data won't be loaded from the archive
+// (needed when called from a worker thread)
+// -----------------------------------------------------------------------------
+std::shared_ptr<DecorateUnit> decorateUnit(ArchiveEntry* entry, bool allow_load = true)
+{
+	auto& data = entry->getMCData(allow_load);
+	auto  hash = Misc::hash64(data.getData(), data.getSize());
+
+	{
+		std::lock_guard<std::mutex> lock(decorate_units_mutex);
+		auto                        cached = decorate_units.find(hash);
+		if (cached != decorate_units.end())
+			return cached->second;
+	}
+
+	auto unit = std::make_shared<DecorateUnit>();
+	parseDecorateUnit(data, entry->getName(), *unit);
+
+	std::lock_guard<std::mutex> lock(decorate_units_mutex);
+	if (decorate_units.size() >= MAX_CACHED_UNITS)
+		decorate_units.clear();
+	decorate_units[hash] = unit;
+
+	return unit;
+}
+
+// -----------------------------------------------------------------------------
+// Parses [entries] and all entries they #include (recursively) into the unit
+// cache, spreading the parsing across worker threads. Definitions are still
+// applied serially in #include order afterwards, so the result is the same
+// as parsing everything on one thread
+// -----------------------------------------------------------------------------
+void parseDecorateUnits(const vector<ArchiveEntry*>& entries)
+{
+	parseIncludedEntries(entries, [](ArchiveEntry* entry) {
+		vector<string> paths;
+		for (auto& inc : decorateUnit(entry, false)->includes)
+			paths.push_back(inc.path);
+		return paths;
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Adds/updates the thing type for the parsed definition [def] in [types] (or
+// [parsed] if it has no editor number)
+// -----------------------------------------------------------------------------
+void applyDecorateDef(const DecorateDef& def, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	// Copy properties, since loading them can modify the list
+	auto props = def.props;
+
+	// Old-style definition
+	if (!def.actor)
+	{
+		types[def.ednum].define(def.ednum, def.name, def.group.empty() ? "Decorate" : "Decorate/" + def.group);
+		types[def.ednum].loadProps(props);
+		return;
+	}
+
+	// Ignore actors filtered for other games
+	if (!def.filters.empty())
+	{
+		bool  available = false;
+		auto& game      = gameDef(configuration().currentGame());
+		for (auto& filter : def.filters)
+			if (game.supportsFilter(filter))
+			{
+				available = true;
+				break;
+			}
+
+		if (!available)
+			return;
+	}
+
+	string group_path = def.group.empty() ? "Decorate" : "Decorate/" + def.group;
+
+	// Find existing definition or create it
+	ThingType* type = nullptr;
+	if (def.ednum <= 0)
+	{
+		for (auto& ptype : parsed)
+			if (S_CMPNOCASE(ptype.className(), def.class_name))
+			{
+				type = &ptype;
+				break;
+			}
+
+		if (!type)
+		{
+			parsed.push_back(ThingType(def.name, group_path, def.class_name));
+			type = &parsed.back();
+		}
+	}
+	else
+		type = &types[def.ednum];
+
+	// Add/update definition
+	type->define(def.ednum, def.name, group_path);
+
+	// Set group defaults (if any)
+	if (!def.group.empty())
+	{
+		auto& group_defaults = configuration().thingTypeGroupDefaults(def.group);
+		if (!group_defaults.group().empty())
+			type->copy(group_defaults);
+	}
+
+	// Inherit from parent
+	if (!def.parent.empty())
+		for (auto& ptype : parsed)
+			if (S_CMPNOCASE(ptype.className(), def.parent))
+			{
+				type->copy(ptype);
+				break;
+			}
+
+	// Set parsed properties
+	type->loadProps(props);
+}
+
+// -----------------------------------------------------------------------------
+// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// -----------------------------------------------------------------------------
+void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	auto unit = decorateUnit(entry);
+
+	// Apply definitions and #includes in the order they appear in the entry
+	unsigned index = 0;
+	for (auto& inc : unit->includes)
+	{
+		for (; index < inc.index; ++index)
+			applyDecorateDef(unit->defs[index], types, parsed);
+
+		auto inc_entry = entry->relativeEntry(inc.path);
+
+		// Check #include path could be resolved
+		if (!inc_entry)
+		{
+			Log::warning(S_FMT(
+				"Warning parsing DECORATE entry %s: "
+				"Unable to find #included entry \"%s\" at line %d, skipping",
+				CHR(entry->getName()),
+				CHR(inc.path),
+				inc.line));
+		}
+		else
+			parseDecorateEntry(inc_entry, types, parsed);
+	}
+	for (; index < unit->defs.size(); ++index)
+		applyDecorateDef(unit->defs[index], types, parsed);
 
 	// Set entry type
 	if (etype_decorate && entry->getType() != etype_decorate)
@@ -646,6 +777,7 @@ bool Game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, v
 		etype_decorate = nullptr;
 
 	// Parse DECORATE entries
+	parseDecorateUnits(decorate_entries);
 	for (auto entry : decorate_entries)
 		parseDecorateEntry(entry, types, parsed);
 
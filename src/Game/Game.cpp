@@ -36,7 +36,9 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "Configuration.h"
+#include "General/Misc.h"
 #include "TextEditor/TextLanguage.h"
+#include "Utility/Parallel.h"
 #include "Utility/Parser.h"
 #include "ZScript.h"
 #include <thread>
@@ -63,6 +65,7 @@ std::unique_ptr<Listener> listener;
 CVAR(String, game_configuration, "", CVAR_SAVE)
 CVAR(String, port_configuration, "", CVAR_SAVE)
 CVAR(String, zdoom_pk3_path, "", CVAR_SAVE)
+EXTERN_CVAR(Bool, game_config_cache)
 
 
 // -----------------------------------------------------------------------------
@@ -306,6 +309,41 @@ void Game::updateCustomDefinitions()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Calls [parse] for [entries] and all entries they #include (recursively),
+// spread across worker threads. [parse] returns the #include paths found in
+// the entry it was given. Entry data is loaded beforehand on this thread, so
+// [parse] should only access it via getMCData(false)
+// -----------------------------------------------------------------------------
+void Game::parseIncludedEntries(
+	const vector<ArchiveEntry*>&                        entries,
+	const std::function<vector<string>(ArchiveEntry*)>& parse)
+{
+	vector<ArchiveEntry*>   pending = entries;
+	std::set<ArchiveEntry*> queued(entries.begin(), entries.end());
+	while (!pending.empty())
+	{
+		// Entry data can only be loaded from the archive on this thread
+		for (auto entry : pending)
+			entry->getMCData();
+
+		vector<vector<string>> includes(pending.size());
+		Parallel::forEach(pending.size(), [&](size_t index) { includes[index] = parse(pending[index]); });
+
+		// Next, parse any #included entries not already done
+		vector<ArchiveEntry*> next;
+		for (unsigned a = 0; a < pending.size(); ++a)
+			for (auto& path : includes[a])
+			{
+				auto inc_entry = pending[a]->relativeEntry(path);
+				if (inc_entry && queued.insert(inc_entry).second)
+					next.push_back(inc_entry);
+			}
+
+		pending = next;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Returns the tagged type of the parsed tree node [tagged]
 // -----------------------------------------------------------------------------
@@ -460,8 +498,16 @@ void Game::init()
 			}
 			else
 			{
+				// Use previously parsed ZScript units where the entries are unchanged
+				auto parse_cache = Misc::cachePath("zscript_units.dat");
+				if (game_config_cache)
+					ZScript::loadParseCache(parse_cache);
+
 				zscript_base.parseZScript(zscript_entry);
 
+				if (game_config_cache)
+					ZScript::saveParseCache(parse_cache);
+
 				auto lang = TextLanguage::fromId("zscript");
 				if (lang)
 					lang->loadZScript(zscript_base);
@@ -1,5 +1,6 @@
 #pragma once
 
+class ArchiveEntry;
 class ParseTreeNode;
 
 namespace Game
@@ -107,5 +108,8 @@ TagType parseTagged(ParseTreeNode* tagged);
 
 // Custom definitions (ZScript, DECORATE, EDF, etc.)
 void updateCustomDefinitions();
+void parseIncludedEntries(
+	const vector<ArchiveEntry*>&                        entries,
+	const std::function<vector<string>(ArchiveEntry*)>& parse);
 
 } // namespace Game
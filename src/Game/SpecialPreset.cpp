@@ -125,6 +125,39 @@ ParseTreeNode* SpecialPreset::write(ParseTreeNode* parent)
 	return node;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the special preset to binary stream [out]
+// -----------------------------------------------------------------------------
+void SpecialPreset::write(wxDataOutputStream& out) const
+{
+	out.WriteString(name);
+	out.WriteString(group);
+	out.Write32(special);
+	for (auto arg : args)
+		out.Write32(arg);
+
+	out.Write32(flags.size());
+	for (auto& flag : flags)
+		out.WriteString(flag);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the special preset from binary stream [in], as written by
+// SpecialPreset::write
+// -----------------------------------------------------------------------------
+void SpecialPreset::read(wxDataInputStream& in)
+{
+	name    = in.ReadString();
+	group   = in.ReadString();
+	special = (int)in.Read32();
+	for (auto& arg : args)
+		arg = (int)in.Read32();
+
+	flags.resize(in.Read32());
+	for (auto& flag : flags)
+		flag = in.ReadString();
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -14,6 +14,8 @@ struct SpecialPreset
 
 	void           parse(ParseTreeNode* node);
 	ParseTreeNode* write(ParseTreeNode* parent);
+	void           write(wxDataOutputStream& out) const;
+	void           read(wxDataInputStream& in);
 };
 
 const vector<SpecialPreset>& customSpecialPresets();
@@ -477,6 +477,79 @@ void ThingType::loadProps(PropertyList& props, bool decorate, bool zscript)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes the thing type definition to binary stream [out]
+// -----------------------------------------------------------------------------
+void ThingType::write(wxDataOutputStream& out) const
+{
+	out.WriteString(name_);
+	out.WriteString(group_);
+	out.WriteString(class_name_);
+	out.Write32(number_);
+	out.Write8(colour_.r);
+	out.Write8(colour_.g);
+	out.Write8(colour_.b);
+	out.Write8(colour_.a);
+	out.Write32(radius_);
+	out.Write32(height_);
+	out.WriteDouble(scale_.x);
+	out.WriteDouble(scale_.y);
+	out.Write8(angled_);
+	out.Write8(hanging_);
+	out.Write8(shrink_);
+	out.Write8(fullbright_);
+	out.Write8(decoration_);
+	out.Write8(decorate_);
+	out.Write8(solid_);
+	out.Write32(zeth_icon_);
+	out.Write32(next_type_);
+	out.Write32(next_args_);
+	out.Write32(flags_);
+	out.Write32((int)tagged_);
+	out.WriteString(sprite_);
+	out.WriteString(icon_);
+	out.WriteString(translation_);
+	out.WriteString(palette_);
+	args_.write(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the thing type definition from binary stream [in], as written by
+// ThingType::write
+// -----------------------------------------------------------------------------
+void ThingType::read(wxDataInputStream& in)
+{
+	name_        = in.ReadString();
+	group_       = in.ReadString();
+	class_name_  = in.ReadString();
+	number_      = (int)in.Read32();
+	colour_.r    = in.Read8();
+	colour_.g    = in.Read8();
+	colour_.b    = in.Read8();
+	colour_.a    = in.Read8();
+	radius_      = (int)in.Read32();
+	height_      = (int)in.Read32();
+	scale_.x     = in.ReadDouble();
+	scale_.y     = in.ReadDouble();
+	angled_      = in.Read8() > 0;
+	hanging_     = in.Read8() > 0;
+	shrink_      = in.Read8() > 0;
+	fullbright_  = in.Read8() > 0;
+	decoration_  = in.Read8() > 0;
+	decorate_    = in.Read8() > 0;
+	solid_       = in.Read8() > 0;
+	zeth_icon_   = (int)in.Read32();
+	next_type_   = (int)in.Read32();
+	next_args_   = (int)in.Read32();
+	flags_       = (int)in.Read32();
+	tagged_      = (TagType)in.Read32();
+	sprite_      = in.ReadString();
+	icon_        = in.ReadString();
+	translation_ = in.ReadString();
+	palette_     = in.ReadString();
+	args_.read(in);
+}
+
 
 // -----------------------------------------------------------------------------
 //
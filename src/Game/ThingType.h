@@ -64,6 +64,8 @@ public:
 	void   parse(ParseTreeNode* node);
 	string stringDesc() const;
 	void   loadProps(PropertyList& props, bool decorate = true, bool zscript = false);
+	void   write(wxDataOutputStream& out) const;
+	void   read(wxDataInputStream& in);
 
 	static const ThingType& unknown() { return unknown_; }
 	static void             initGlobal();
@@ -185,6 +185,49 @@ void UDMFProperty::parse(ParseTreeNode* node, string group)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes the UDMF property definition to binary stream [out]
+// -----------------------------------------------------------------------------
+void UDMFProperty::write(wxDataOutputStream& out) const
+{
+	out.WriteString(property_);
+	out.WriteString(name_);
+	out.WriteString(group_);
+	out.Write32((int)type_);
+	out.Write8(flag_);
+	out.Write8(trigger_);
+	out.Write8(has_default_);
+	out.Write8(show_always_);
+	out.Write8(internal_only_);
+	default_value_.write(out);
+
+	out.Write32(values_.size());
+	for (auto& value : values_)
+		value.write(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the UDMF property definition from binary stream [in], as written by
+// UDMFProperty::write
+// -----------------------------------------------------------------------------
+void UDMFProperty::read(wxDataInputStream& in)
+{
+	property_      = in.ReadString();
+	name_          = in.ReadString();
+	group_         = in.ReadString();
+	type_          = (Type)in.Read32();
+	flag_          = in.Read8() > 0;
+	trigger_       = in.Read8() > 0;
+	has_default_   = in.Read8() > 0;
+	show_always_   = in.Read8() > 0;
+	internal_only_ = in.Read8() > 0;
+	default_value_.read(in);
+
+	values_.resize(in.Read32());
+	for (auto& value : values_)
+		value.read(in);
+}
+
 // -----------------------------------------------------------------------------
 // Returns a string representation of the UDMF property definition
 // -----------------------------------------------------------------------------
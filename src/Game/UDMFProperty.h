@@ -40,6 +40,8 @@ public:
 	bool                    internalOnly() const { return internal_only_; }
 
 	void parse(ParseTreeNode* node, string group);
+	void write(wxDataOutputStream& out) const;
+	void read(wxDataInputStream& in);
 
 	string getStringRep();
 
@@ -33,7 +33,10 @@
 #include "ZScript.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
+#include "Game.h"
+#include "General/Misc.h"
 #include "Utility/Tokenizer.h"
+#include <mutex>
 
 using namespace ZScript;
 
@@ -61,6 +64,31 @@ bool dump_parsed_states    = false;
 bool dump_parsed_functions = false;
 
 string db_comment = "//$";
+
+// The parsed contents of a single ZScript entry
+struct ParsedUnit
+{
+	struct Include
+	{
+		unsigned index; // Index of the first statement after the #include
+		string   path;
+		unsigned line;
+	};
+
+	vector<ParsedStatement> statements;
+	vector<Include>         includes;
+};
+
+// Parsed ZScript units, keyed by the hash of their entry data. Units loaded
+// from the cache file are kept separately and moved over when first used, so
+// that only units still in use are written back
+std::map<uint64_t, std::shared_ptr<ParsedUnit>> parsed_units;
+std::map<uint64_t, std::shared_ptr<ParsedUnit>> loaded_units;
+bool                                            parsed_units_changed = false;
+std::mutex                                      parsed_units_mutex;
+const size_t                                    MAX_CACHED_UNITS    = 4096;
+const uint32_t                                  PARSE_CACHE_MAGIC   = 0x5A534355; // ZSCU
+const uint32_t                                  PARSE_CACHE_VERSION = 2;
 } // namespace ZScript
 
 
@@ -183,39 +211,29 @@ bool checkKeywordValueStatement(const vector<string>& tokens, unsigned index, co
 }
 
 // -----------------------------------------------------------------------------
-// Parses all statements/blocks in [entry], adding them to [parsed]
+// Tokenizes and parses all statements/blocks in [data] into [unit].
+// #includes are only recorded, they are resolved when the unit is added
 // -----------------------------------------------------------------------------
-void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
+void parseUnit(MemChunk& data, ParsedUnit& unit)
 {
 	Tokenizer tz;
 	tz.setSpecialCharacters(CHR(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-[]&!?."));
 	tz.enableDecorate(true);
 	tz.setCommentTypes(Tokenizer::CommentTypes::CPPStyle | Tokenizer::CommentTypes::CStyle);
-	tz.openMem(entry->getMCData(), "ZScript");
-
-	// Log::info(2, S_FMT("Parsing ZScript entry \"%s\"", entry->getPath(true)));
+	tz.openMem(data, "ZScript");
 
 	while (!tz.atEnd())
 	{
 		// Preprocessor
-		if (tz.current().text.StartsWith("#"))
+		if (tz.current().startsWith("#"))
 		{
 			if (tz.checkNC("#include"))
 			{
-				auto inc_entry = entry->relativeEntry(tz.next().text);
-
-				// Check #include path could be resolved
-				if (!inc_entry)
-				{
-					Log::warning(S_FMT(
-						"Warning parsing ZScript entry %s: "
-						"Unable to find #included entry \"%s\" at line %u, skipping",
-						CHR(entry->getName()),
-						CHR(tz.current().text),
-						tz.current().line_no));
-				}
-				else
-					parseBlocks(inc_entry, parsed);
+				ParsedUnit::Include inc;
+				inc.index = unit.statements.size();
+				inc.path  = tz.next().text();
+				inc.line  = tz.current().line_no;
+				unit.includes.push_back(inc);
 			}
 
 			tz.advToNextLine();
@@ -230,12 +248,121 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
 		}
 
 		// ZScript
-		parsed.push_back({});
-		parsed.back().entry = entry;
-		if (!parsed.back().parse(tz))
-			parsed.pop_back();
+		unit.statements.push_back({});
+		if (!unit.statements.back().parse(tz))
+			unit.statements.pop_back();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the parsed ZScript unit for [entry], from the cache if an entry with
+// identical content has been parsed previously.
+// If [allow_load] is false the entry data won't be loaded from the archive
+// (needed when called from a worker thread)
+// -----------------------------------------------------------------------------
+std::shared_ptr<ParsedUnit> parsedUnit(ArchiveEntry* entry, bool allow_load = true)
+{
+	auto& data = entry->getMCData(allow_load);
+	auto  hash = Misc::hash64(data.getData(), data.getSize());
+
+	{
+		std::lock_guard<std::mutex> lock(parsed_units_mutex);
+		auto                        cached = parsed_units.find(hash);
+		if (cached != parsed_units.end())
+			return cached->second;
+
+		auto loaded = loaded_units.find(hash);
+		if (loaded != loaded_units.end())
+		{
+			auto unit = loaded->second;
+			loaded_units.erase(loaded);
+			parsed_units[hash] = unit;
+			return unit;
+		}
 	}
 
+	auto unit = std::make_shared<ParsedUnit>();
+	parseUnit(data, *unit);
+
+	std::lock_guard<std::mutex> lock(parsed_units_mutex);
+	if (parsed_units.size() >= MAX_CACHED_UNITS)
+		parsed_units.clear();
+	parsed_units[hash] = unit;
+	parsed_units_changed = true;
+
+	return unit;
+}
+
+// -----------------------------------------------------------------------------
+// Parses [entry] and all entries it #includes (recursively) into the unit
+// cache, spreading the parsing across worker threads. Statements are still
+// added serially in #include order by parseBlocks afterwards, so the result
+// is the same as parsing everything on one thread
+// -----------------------------------------------------------------------------
+void parseUnits(ArchiveEntry* entry)
+{
+	Game::parseIncludedEntries({ entry }, [](ArchiveEntry* e) {
+		vector<string> paths;
+		for (auto& inc : parsedUnit(e, false)->includes)
+			paths.push_back(inc.path);
+		return paths;
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Adds a copy of [statement] to [parsed], with it (and all its child
+// statements) referencing [entry]
+// -----------------------------------------------------------------------------
+void addStatement(const ParsedStatement& statement, ArchiveEntry* entry, vector<ParsedStatement>& parsed)
+{
+	parsed.push_back(statement);
+
+	vector<ParsedStatement*> to_set{ &parsed.back() };
+	while (!to_set.empty())
+	{
+		auto current = to_set.back();
+		to_set.pop_back();
+
+		current->entry = entry;
+		for (auto& child : current->block)
+			to_set.push_back(&child);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in [entry], adding them to [parsed]
+// -----------------------------------------------------------------------------
+void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed)
+{
+	// Log::info(2, S_FMT("Parsing ZScript entry \"%s\"", entry->getPath(true)));
+
+	auto unit = parsedUnit(entry);
+
+	// Add statements and #includes in the order they appear in the entry
+	unsigned index = 0;
+	for (auto& inc : unit->includes)
+	{
+		for (; index < inc.index; ++index)
+			addStatement(unit->statements[index], entry, parsed);
+
+		auto inc_entry = entry->relativeEntry(inc.path);
+
+		// Check #include path could be resolved
+		if (!inc_entry)
+		{
+			Log::warning(S_FMT(
+				"Warning parsing ZScript entry %s: "
+				"Unable to find #included entry \"%s\" at line %u, skipping",
+				CHR(entry->getName()),
+				CHR(inc.path),
+				inc.line));
+		}
+		else
+			parseBlocks(inc_entry, parsed);
+	}
+	for (; index < unit->statements.size(); ++index)
+		addStatement(unit->statements[index], entry, parsed);
+
 	// Set entry type
 	if (etype_zscript && entry->getType() != etype_zscript)
 		entry->setType(etype_zscript);
@@ -253,6 +380,104 @@ bool isKeyword(const string& word)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Tokenizes and parses all statements/blocks in [data] into [statements].
+// Any #includes are ignored
+// -----------------------------------------------------------------------------
+void parseStatements(MemChunk& data, vector<ParsedStatement>& statements)
+{
+	ParsedUnit unit;
+	parseUnit(data, unit);
+	statements = std::move(unit.statements);
+}
+
+// -----------------------------------------------------------------------------
+// Loads previously parsed ZScript units from the cache file at [filename].
+// Returns false if the file doesn't exist or is invalid
+// -----------------------------------------------------------------------------
+bool loadParseCache(const string& filename)
+{
+	MemChunk mc;
+	if (!Misc::readCacheFile(filename, PARSE_CACHE_MAGIC, PARSE_CACHE_VERSION, mc))
+		return false;
+
+	wxMemoryInputStream stream(mc.getData(), mc.getSize());
+	wxDataInputStream   in(stream);
+
+	// Units parsed by a different SLADE version may not match the current parser
+	if (in.ReadString() != Global::version || !in.IsOk())
+		return false;
+
+	std::map<uint64_t, std::shared_ptr<ParsedUnit>> units;
+	auto                                            count = in.Read32();
+	for (unsigned a = 0; a < count && in.IsOk(); ++a)
+	{
+		auto hash = in.Read64();
+		auto unit = std::make_shared<ParsedUnit>();
+
+		unit->statements.resize(in.Read32());
+		for (auto& statement : unit->statements)
+			statement.read(in);
+
+		unit->includes.resize(in.Read32());
+		for (auto& inc : unit->includes)
+		{
+			inc.index = in.Read32();
+			inc.path  = in.ReadString();
+			inc.line  = in.Read32();
+		}
+
+		units[hash] = unit;
+	}
+
+	if (!in.IsOk())
+		return false;
+
+	std::lock_guard<std::mutex> lock(parsed_units_mutex);
+	loaded_units = std::move(units);
+
+	Log::info(2, S_FMT("Loaded %lu cached ZScript units", loaded_units.size()));
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes all parsed ZScript units used so far to the cache file at [filename],
+// if any entries needed parsing since the cache was loaded
+// -----------------------------------------------------------------------------
+bool saveParseCache(const string& filename)
+{
+	std::lock_guard<std::mutex> lock(parsed_units_mutex);
+	if (!parsed_units_changed && loaded_units.empty())
+		return true;
+
+	wxMemoryOutputStream stream;
+	wxDataOutputStream   out(stream);
+	out.WriteString(Global::version);
+	out.Write32(parsed_units.size());
+	for (auto& i : parsed_units)
+	{
+		out.Write64(i.first);
+
+		out.Write32(i.second->statements.size());
+		for (auto& statement : i.second->statements)
+			statement.write(out);
+
+		out.Write32(i.second->includes.size());
+		for (auto& inc : i.second->includes)
+		{
+			out.Write32(inc.index);
+			out.WriteString(inc.path);
+			out.Write32(inc.line);
+		}
+	}
+
+	parsed_units_changed = false;
+	loaded_units.clear();
+
+	return Misc::writeCacheFile(filename, PARSE_CACHE_MAGIC, PARSE_CACHE_VERSION, stream);
+}
+
 } // namespace ZScript
 
 
@@ -920,6 +1145,7 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 	// Parse into tree of expressions and blocks
 	auto                    start = App::runTimer();
 	vector<ParsedStatement> parsed;
+	parseUnits(entry);
 	parseBlocks(entry, parsed);
 	Log::debug(2, S_FMT("parseBlocks: %ldms", App::runTimer() - start));
 	start = App::runTimer();
@@ -1066,9 +1292,9 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			return true;
 
 		// DB comment
-		if (tz.current().text.StartsWith(db_comment))
+		if (tz.current().startsWith("//$"))
 		{
-			tokens.push_back(tz.current().text);
+			tokens.push_back(tz.current().text());
 			tokens.push_back(tz.getLine());
 			return true;
 		}
@@ -1099,7 +1325,7 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			break;
 
 		// Array initializer: ... = { ... }
-		if (tz.current().text.Cmp("=") == 0 && tz.peek() == '{')
+		if (tz.check('=') && tz.peek() == '{')
 		{
 			tokens.emplace_back("=");
 			tokens.emplace_back("{");
@@ -1108,7 +1334,7 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			continue;
 		}
 
-		tokens.push_back(tz.current().text);
+		tokens.push_back(tz.current().text());
 		tz.adv();
 	}
 
@@ -1131,6 +1357,38 @@ bool ParsedStatement::parse(Tokenizer& tz)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes this statement (and its block) to [out]
+// -----------------------------------------------------------------------------
+void ParsedStatement::write(wxDataOutputStream& out) const
+{
+	out.Write32(line);
+
+	out.Write32(tokens.size());
+	for (auto& token : tokens)
+		out.WriteString(token);
+
+	out.Write32(block.size());
+	for (auto& statement : block)
+		statement.write(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads this statement (and its block) from [in]
+// -----------------------------------------------------------------------------
+void ParsedStatement::read(wxDataInputStream& in)
+{
+	line = in.Read32();
+
+	tokens.resize(in.Read32());
+	for (auto& token : tokens)
+		token = in.ReadString();
+
+	block.resize(in.Read32());
+	for (auto& statement : block)
+		statement.read(in);
+}
+
 // -----------------------------------------------------------------------------
 // Dumps this statement to the log (debug), indenting by 2*[indent] spaces
 // -----------------------------------------------------------------------------
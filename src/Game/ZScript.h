@@ -19,6 +19,10 @@ struct ParsedStatement
 
 	bool parse(Tokenizer& tz);
 	void dump(int indent = 0);
+
+	// Binary (cache) serialization
+	void write(wxDataOutputStream& out) const;
+	void read(wxDataInputStream& in);
 };
 
 class Enumerator
@@ -188,4 +192,11 @@ private:
 	vector<Variable>   variables_;
 	vector<Function>   functions_; // needed? dunno if global functions are a thing
 };
+
+// Parses all statements/blocks in [data], without resolving #includes
+void parseStatements(MemChunk& data, vector<ParsedStatement>& statements);
+
+// Parsed entry cache (persisted between sessions)
+bool loadParseCache(const string& filename);
+bool saveParseCache(const string& filename);
 } // namespace ZScript
@@ -22,11 +22,11 @@ struct Message
 	string formattedMessageLine() const;
 };
 
-const vector<Message>& history();
-int                    verbosity();
-void                   setVerbosity(int verbosity);
-void                   init();
-vector<Message*>       since(time_t time, MessageType type = MessageType::Any);
+vector<Message> history(unsigned start = 0);
+int             verbosity();
+void            setVerbosity(int verbosity);
+void            init();
+vector<Message> since(time_t time, MessageType type = MessageType::Any);
 
 void message(MessageType type, int level, const char* text);
 void message(MessageType type, int level, const wxString& text);
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "General/Misc.h"
+#include "App.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveEntry.h"
 #include "Graphics/SImage/SIFormat.h"
@@ -702,6 +703,184 @@ uint32_t Misc::crc(const uint8_t* buf, uint32_t len)
 	return update_crc(0xffffffffL, buf, len) ^ 0xffffffffL;
 }
 
+// 64-bit hash stuff (this is the XXH64 algorithm, so results are the same as
+// xxHash's reference implementation)
+namespace
+{
+const uint64_t prime64_1 = 11400714785074694791ULL;
+const uint64_t prime64_2 = 14029467366897019727ULL;
+const uint64_t prime64_3 = 1609587929392839161ULL;
+const uint64_t prime64_4 = 9650029242287828579ULL;
+const uint64_t prime64_5 = 2870177450012600261ULL;
+
+inline uint64_t rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const uint8_t* p)
+{
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return wxUINT64_SWAP_ON_BE(v);
+}
+
+inline uint32_t read32(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return wxUINT32_SWAP_ON_BE(v);
+}
+
+inline uint64_t hashRound(uint64_t acc, uint64_t input)
+{
+	acc += input * prime64_2;
+	acc = rotl64(acc, 31);
+	return acc * prime64_1;
+}
+
+inline uint64_t hashMergeRound(uint64_t acc, uint64_t val)
+{
+	acc ^= hashRound(0, val);
+	return acc * prime64_1 + prime64_4;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Returns a 64-bit hash of the bytes buf[0..len-1]. Much less likely to collide
+// than crc, and faster too
+// -----------------------------------------------------------------------------
+uint64_t Misc::hash64(const uint8_t* buf, uint32_t len, uint64_t seed)
+{
+	const uint8_t* p   = buf;
+	const uint8_t* end = buf + len;
+	uint64_t       h;
+
+	if (len >= 32)
+	{
+		const uint8_t* limit = end - 32;
+		uint64_t       v1    = seed + prime64_1 + prime64_2;
+		uint64_t       v2    = seed + prime64_2;
+		uint64_t       v3    = seed;
+		uint64_t       v4    = seed - prime64_1;
+
+		do
+		{
+			v1 = hashRound(v1, read64(p));
+			v2 = hashRound(v2, read64(p + 8));
+			v3 = hashRound(v3, read64(p + 16));
+			v4 = hashRound(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+		h = hashMergeRound(h, v1);
+		h = hashMergeRound(h, v2);
+		h = hashMergeRound(h, v3);
+		h = hashMergeRound(h, v4);
+	}
+	else
+		h = seed + prime64_5;
+
+	h += len;
+
+	while (p + 8 <= end)
+	{
+		h ^= hashRound(0, read64(p));
+		h = rotl64(h, 27) * prime64_1 + prime64_4;
+		p += 8;
+	}
+
+	if (p + 4 <= end)
+	{
+		h ^= (uint64_t)read32(p) * prime64_1;
+		h = rotl64(h, 23) * prime64_2 + prime64_3;
+		p += 4;
+	}
+
+	while (p < end)
+	{
+		h ^= (*p) * prime64_5;
+		h = rotl64(h, 11) * prime64_1;
+		++p;
+	}
+
+	h ^= h >> 33;
+	h *= prime64_2;
+	h ^= h >> 29;
+	h *= prime64_3;
+	h ^= h >> 32;
+
+	return h;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the full path to cache file [filename], creating the cache directory
+// if needed
+// -----------------------------------------------------------------------------
+string Misc::cachePath(const string& filename)
+{
+	string dir = App::path("cache", App::Dir::User);
+	if (!wxDirExists(dir))
+		wxMkdir(dir);
+
+	return App::path("cache/" + filename, App::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Writes [data] to cache file [filename] (full path), with a header containing
+// [magic], [version] and a checksum of the data. The file is written via a
+// temp file so an interrupted write can't leave a partial cache behind
+// -----------------------------------------------------------------------------
+bool Misc::writeCacheFile(const string& filename, uint32_t magic, uint32_t version, wxMemoryOutputStream& data)
+{
+	if (!data.IsOk())
+		return false;
+
+	vector<uint8_t> buffer(data.GetLength());
+	data.CopyTo(buffer.data(), buffer.size());
+	uint32_t header[4] = { magic, version, (uint32_t)buffer.size(), crc(buffer.data(), buffer.size()) };
+
+	// Write to a temp file first, removing it again if anything fails
+	string temp_file = filename + ".tmp";
+	bool   ok;
+	{
+		wxFile file(temp_file, wxFile::write);
+		ok = file.IsOpened() && file.Write(header, sizeof(header)) == sizeof(header)
+			 && file.Write(buffer.data(), buffer.size()) == buffer.size();
+	}
+
+	if (ok)
+		ok = wxRenameFile(temp_file, filename, true);
+
+	if (!ok && wxFileExists(temp_file))
+		wxRemoveFile(temp_file);
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the data in cache file [filename] (full path) into [data]. Returns
+// false if the file doesn't exist, or its header doesn't match [magic] and
+// [version], or the data is damaged
+// -----------------------------------------------------------------------------
+bool Misc::readCacheFile(const string& filename, uint32_t magic, uint32_t version, MemChunk& data)
+{
+	MemChunk mc;
+	if (!wxFileExists(filename) || !mc.importFile(filename))
+		return false;
+
+	// Check header
+	uint32_t header[4];
+	if (!mc.read(header, sizeof(header), 0))
+		return false;
+	if (header[0] != magic || header[1] != version || header[2] != mc.getSize() - sizeof(header)
+		|| header[3] != crc(mc.getData() + sizeof(header), header[2]))
+		return false;
+
+	return data.importMem(mc.getData() + sizeof(header), header[2]);
+}
+
 
 // -----------------------------------------------------------------------------
 // Find the given name in a texture lump and returns a point2_t which contains
@@ -799,7 +978,7 @@ void Misc::readWindowInfo(Tokenizer& tz)
 	tz.advIf("{");
 	while (!tz.check("}") && !tz.atEnd())
 	{
-		string id     = tz.current().text;
+		string id     = tz.current().text();
 		int    width  = tz.next().asInt();
 		int    height = tz.next().asInt();
 		int    left   = tz.next().asInt();
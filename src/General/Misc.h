@@ -29,6 +29,7 @@ string   sizeAsString(uint32_t size);
 string   lumpNameToFileName(string lump);
 string   fileNameToLumpName(string file);
 uint32_t crc(const uint8_t* buf, uint32_t len);
+uint64_t hash64(const uint8_t* buf, uint32_t len, uint64_t seed = 0);
 hsl_t    rgbToHsl(double r, double g, double b);
 rgba_t   hslToRgb(double h, double s, double t);
 lab_t    rgbToLab(double r, double g, double b);
@@ -59,4 +60,9 @@ WindowInfo getWindowInfo(string id);
 void       setWindowInfo(string id, int width, int height, int left, int top);
 void       readWindowInfo(Tokenizer& tz);
 void       writeWindowInfo(wxFile& file);
+
+// Binary cache files (in the user dir 'cache' folder)
+string cachePath(const string& filename);
+bool   writeCacheFile(const string& filename, uint32_t magic, uint32_t version, wxMemoryOutputStream& data);
+bool   readCacheFile(const string& filename, uint32_t magic, uint32_t version, MemChunk& data);
 } // namespace Misc
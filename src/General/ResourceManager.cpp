@@ -45,6 +45,101 @@
 // -----------------------------------------------------------------------------
 ResourceManager* ResourceManager::instance_ = nullptr;
 string           ResourceManager::doom64_hash_table_[65536];
+namespace
+{
+// Entry namespaces relevant to resources (bitmask)
+enum Namespace
+{
+	NSGlobal   = 1 << 0,
+	NSPatches  = 1 << 1,
+	NSSprites  = 1 << 2,
+	NSGraphics = 1 << 3,
+	NSHires    = 1 << 4,
+	NSTextures = 1 << 5,
+	NSFlats    = 1 << 6,
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the resource namespace flags for [entry]. The namespace is detected
+// only once here, since detection can be costly (eg. marker lookup in wads)
+// -----------------------------------------------------------------------------
+unsigned namespaceFlags(ArchiveEntry* entry)
+{
+	auto archive = entry->getParent();
+	if (!archive)
+		return 0;
+
+	auto ns = archive->detectNamespace(entry);
+	if (ns == "global")
+		// Graphics namespace doesn't exist in wad files, global is used instead
+		return archive->formatId() == "wad" ? NSGlobal | NSGraphics : NSGlobal;
+	if (ns == "patches")
+		return NSPatches;
+	if (ns == "sprites")
+		return NSSprites;
+	if (ns == "graphics")
+		return NSGraphics;
+	if (ns == "hires")
+		return NSHires;
+	if (ns == "textures")
+		return NSTextures;
+	if (ns == "flats")
+		return NSFlats;
+
+	return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from the resource [name] in [map], removing the resource
+// itself if it no longer has any entries
+// -----------------------------------------------------------------------------
+void removeEntryFromMap(EntryResourceMap& map, const string& name, ArchiveEntry* entry)
+{
+	auto i = map.find(name);
+	if (i == map.end())
+		return;
+
+	i->second.remove(entry);
+	if (i->second.length() == 0)
+		map.erase(i);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the resource [name] in [map], or nullptr if it doesn't exist
+// -----------------------------------------------------------------------------
+template<typename T, typename R = typename T::mapped_type> R* findResource(T& map, const string& name)
+{
+	auto i = map.find(name);
+	return i != map.end() ? &i->second : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all resources in [map], sorted by name
+// -----------------------------------------------------------------------------
+template<typename T, typename R = typename T::mapped_type>
+vector<std::pair<const string*, R*>> sortedResources(T& map)
+{
+	typedef std::pair<const string*, R*> Item;
+
+	vector<Item> list;
+	list.reserve(map.size());
+	for (auto& i : map)
+		list.emplace_back(&i.first, &i.second);
+
+	std::sort(list.begin(), list.end(), [](const Item& a, const Item& b) { return a.first->Cmp(*b.first) < 0; });
+
+	return list;
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -66,15 +161,17 @@ void EntryResource::add(ArchiveEntry::SPtr& entry)
 // -----------------------------------------------------------------------------
 // Removes matching [entry] from the resource
 // -----------------------------------------------------------------------------
-void EntryResource::remove(ArchiveEntry::SPtr& entry)
+void EntryResource::remove(ArchiveEntry* entry)
 {
-	unsigned a = 0;
-	while (a < entries_.size())
+	// Also clears out any expired entries
+	auto i = entries_.begin();
+	while (i != entries_.end())
 	{
-		if (entries_[a].lock() == entry)
-			entries_.erase(entries_.begin() + a);
+		auto locked = i->lock();
+		if (!locked || locked.get() == entry)
+			i = entries_.erase(i);
 		else
-			++a;
+			++i;
 	}
 }
 
@@ -192,8 +289,10 @@ void ResourceManager::addArchive(Archive* archive)
 	// Go through entries
 	vector<ArchiveEntry::SPtr> entries;
 	archive->getEntryTreeAsList(entries);
+	auto& records = entry_records_[archive];
+	records.reserve(records.size() + entries.size());
 	for (auto& entry : entries)
-		addEntry(entry);
+		addEntry(entry, records, false);
 
 	// Listen to the archive
 	listenTo(archive);
@@ -211,11 +310,15 @@ void ResourceManager::removeArchive(Archive* archive)
 	if (!archive)
 		return;
 
-	// Go through entries
-	vector<ArchiveEntry::SPtr> entries;
-	archive->getEntryTreeAsList(entries);
-	for (auto& entry : entries)
-		removeEntry(entry, false, true);
+	// Remove everything registered from the archive
+	auto records = entry_records_.find(archive);
+	if (records != entry_records_.end())
+	{
+		for (auto& record : records->second)
+			removeRecord(record.first, record.second);
+
+		entry_records_.erase(records);
+	}
 
 	// Announce resource update
 	announce("resources_updated");
@@ -242,10 +345,29 @@ uint16_t ResourceManager::getTextureHash(const string& name)
 // Adds an entry to be managed
 // -----------------------------------------------------------------------------
 void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
+{
+	if (!entry.get() || !entry->getParent())
+		return;
+
+	addEntry(entry, entry_records_[entry->getParent()], log);
+}
+
+// -----------------------------------------------------------------------------
+// Adds an entry to be managed, recording what it was added as in [records]
+// -----------------------------------------------------------------------------
+void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, EntryRecordMap& records, bool log)
 {
 	if (!entry.get())
 		return;
 
+	// Remove any previous registration of the entry
+	auto existing = records.find(entry.get());
+	if (existing != records.end())
+	{
+		removeRecord(entry.get(), existing->second);
+		records.erase(existing);
+	}
+
 	// Detect type if unknown
 	if (entry->getType() == EntryType::unknownType())
 		EntryType::detectEntryType(entry.get());
@@ -253,50 +375,77 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 	// Get entry type
 	EntryType* type = entry->getType();
 
+	// Check for TEXTUREx entry
+	int txentry = 0;
+	if (type->id() == "texturex")
+		txentry = 1;
+	else if (type->id() == "zdtextures")
+		txentry = 2;
+
+	// Nothing to do if the entry can't be a resource
+	bool palette = type->id() == "palette";
+	bool gfx     = type->editor() == "gfx";
+	if (!palette && !gfx && txentry == 0)
+		return;
+
 	// Get resource name (extension cut, uppercase)
 	string lname = entry->getUpperNameNoExt();
-	string name  = entry->getUpperNameNoExt().Truncate(8);
+	string name  = lname;
+	name.Truncate(8);
 	// Talon1024 - Get resource path (uppercase, without leading slash)
 	string path = entry->getPath(true).Upper().Mid(1);
 
 	if (log)
 		Log::debug(S_FMT("Adding entry %s to resource manager", path));
 
+	EntryRecord record;
+	record.name = name;
+	record.path = path;
+
 	// Check for palette entry
-	if (type->id() == "palette")
+	if (palette)
+	{
 		palettes_[name].add(entry);
+		record.maps |= Palettes;
+	}
 
 	// Check for various image entries, so only accept images
-	if (type->editor() == "gfx")
+	if (gfx)
 	{
 		// Reject graphics that are not in a valid namespace:
 		// Patches in wads can be in the global namespace as well, and
-		// ZDoom textures can use sprites and graphics as patches
-		if (!entry->isInNamespace("global") && !entry->isInNamespace("patches") && !entry->isInNamespace("sprites")
-			&& !entry->isInNamespace("graphics") &&
-			// Stand-alone textures can also be found in the hires namespace
-			!entry->isInNamespace("hires") && !entry->isInNamespace("textures") &&
-			// Flats are kinda boring in comparison
-			!entry->isInNamespace("flats"))
+		// ZDoom textures can use sprites and graphics as patches.
+		// Stand-alone textures can also be found in the hires namespace,
+		// and flats are kinda boring in comparison
+		unsigned ns = namespaceFlags(entry.get());
+		if (ns == 0)
+		{
+			if (record.maps)
+				records[entry.get()] = std::move(record);
 			return;
+		}
 
+		bool treeless    = entry->getParent()->isTreeless();
 		bool addToFpOnly = true;
 
 		// Check for patch entry
-		if (type->extraProps().propertyExists("patch") || entry->isInNamespace("patches")
-			|| entry->isInNamespace("sprites"))
+		if (type->extraProps().propertyExists("patch") || ns & (NSPatches | NSSprites))
 		{
-			if (patches_[name].length() == 0)
+			auto& res = patches_[name];
+			if (res.length() == 0)
 			{
 				addToFpOnly = false;
 			}
-			patches_[name].add(entry);
-			if (!entry->getParent()->isTreeless())
+			res.add(entry);
+			record.maps |= Patches;
+			if (!treeless)
 			{
 				patches_fp_[path].add(entry);
-				if ((lname.Len() > 8 || patches_[name].length() > 0) && addToFpOnly)
+				record.maps |= PatchesFp;
+				if ((lname.Len() > 8 || res.length() > 0) && addToFpOnly)
 				{
 					patches_fp_only_[path].add(entry);
+					record.maps |= PatchesFpOnly;
 				}
 			}
 		}
@@ -304,30 +453,36 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 		addToFpOnly = true;
 
 		// Check for flat entry
-		if (type->id() == "gfx_flat" || entry->isInNamespace("flats"))
+		if (type->id() == "gfx_flat" || ns & NSFlats)
 		{
-			if (flats_[name].length() == 0)
+			auto& res = flats_[name];
+			if (res.length() == 0)
 			{
 				addToFpOnly = false;
 			}
-			flats_[name].add(entry);
-			if (!entry->getParent()->isTreeless())
+			res.add(entry);
+			record.maps |= Flats;
+			if (!treeless)
 			{
 				flats_fp_[path].add(entry);
-				if ((lname.Len() > 8 || flats_[name].length() > 0) && addToFpOnly)
+				record.maps |= FlatsFp;
+				if ((lname.Len() > 8 || res.length() > 0) && addToFpOnly)
 				{
 					flats_fp_only_[path].add(entry);
+					record.maps |= FlatsFpOnly;
 				}
 			}
 		}
 
 		// Check for stand-alone texture entry
-		if (entry->isInNamespace("textures") || entry->isInNamespace("hires"))
+		if (ns & (NSTextures | NSHires))
 		{
 			satextures_[name].add(entry);
-			if (!entry->getParent()->isTreeless())
+			record.maps |= SATextures;
+			if (!treeless)
 			{
 				satextures_fp_[path].add(entry);
+				record.maps |= SATexturesFp;
 			}
 
 			// Add name to hash table
@@ -335,12 +490,6 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 		}
 	}
 
-	// Check for TEXTUREx entry
-	int txentry = 0;
-	if (type->id() == "texturex")
-		txentry = 1;
-	else if (type->id() == "zdtextures")
-		txentry = 2;
 	if (txentry > 0)
 	{
 		// Load patch table if needed
@@ -362,74 +511,91 @@ void ResourceManager::addEntry(ArchiveEntry::SPtr& entry, bool log)
 
 		// Add all textures to resources
 		CTexture* tex;
+		record.textures.reserve(tx.nTextures());
 		for (unsigned a = 0; a < tx.nTextures(); a++)
 		{
 			tex = tx.getTexture(a);
 			textures_[tex->getName()].add(tex, entry->getParent());
+			record.textures.push_back(tex->getName());
 		}
+		record.maps |= CompositeTextures;
 	}
-}
 
-void removeEntryFromMap(EntryResourceMap& map, const string& name, ArchiveEntry::SPtr& entry, bool full_check)
-{
-	if (full_check)
-		for (auto& i : map)
-			i.second.remove(entry);
-	else
-		map[name].remove(entry);
+	if (record.maps)
+		records[entry.get()] = std::move(record);
 }
 
 // -----------------------------------------------------------------------------
 // Removes a managed entry
 // -----------------------------------------------------------------------------
-void ResourceManager::removeEntry(ArchiveEntry::SPtr& entry, bool log, bool full_check)
+void ResourceManager::removeEntry(ArchiveEntry* entry, bool log)
 {
-	if (!entry.get())
+	if (!entry)
 		return;
 
-	// Get resource name (extension cut, uppercase)
-	string name = entry->getUpperNameNoExt().Truncate(8);
-	string path = entry->getPath(true).Upper().Mid(1);
+	// Find the entry's record
+	auto records = entry_records_.find(entry->getParent());
+	if (records == entry_records_.end())
+		return;
+	auto record = records->second.find(entry);
+	if (record == records->second.end())
+		return;
 
 	if (log)
-		Log::debug(S_FMT("Removing entry %s from resource manager", path));
+		Log::debug(S_FMT("Removing entry %s from resource manager", record->second.path));
+
+	removeRecord(entry, record->second);
+	records->second.erase(record);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from all resources listed in its [record]
+// -----------------------------------------------------------------------------
+void ResourceManager::removeRecord(ArchiveEntry* entry, EntryRecord& record)
+{
+	auto& name = record.name;
+	auto& path = record.path;
 
 	// Remove from palettes
-	removeEntryFromMap(palettes_, name, entry, full_check);
+	if (record.maps & Palettes)
+		removeEntryFromMap(palettes_, name, entry);
 
 	// Remove from patches
-	removeEntryFromMap(patches_, name, entry, full_check);
-	removeEntryFromMap(patches_fp_, path, entry, full_check);
-	removeEntryFromMap(patches_fp_only_, path, entry, full_check);
+	if (record.maps & Patches)
+		removeEntryFromMap(patches_, name, entry);
+	if (record.maps & PatchesFp)
+		removeEntryFromMap(patches_fp_, path, entry);
+	if (record.maps & PatchesFpOnly)
+		removeEntryFromMap(patches_fp_only_, path, entry);
 
 	// Remove from flats
-	removeEntryFromMap(flats_, name, entry, full_check);
-	removeEntryFromMap(flats_fp_, path, entry, full_check);
-	removeEntryFromMap(flats_fp_only_, path, entry, full_check);
+	if (record.maps & Flats)
+		removeEntryFromMap(flats_, name, entry);
+	if (record.maps & FlatsFp)
+		removeEntryFromMap(flats_fp_, path, entry);
+	if (record.maps & FlatsFpOnly)
+		removeEntryFromMap(flats_fp_only_, path, entry);
 
 	// Remove from stand-alone textures
-	removeEntryFromMap(satextures_, name, entry, full_check);
-	removeEntryFromMap(satextures_fp_, path, entry, full_check);
+	if (record.maps & SATextures)
+		removeEntryFromMap(satextures_, name, entry);
+	if (record.maps & SATexturesFp)
+		removeEntryFromMap(satextures_fp_, path, entry);
 
-	// Check for TEXTUREx entry
-	int txentry = 0;
-	if (entry->getType()->id() == "texturex")
-		txentry = 1;
-	else if (entry->getType()->id() == "zdtextures")
-		txentry = 2;
-	if (txentry > 0)
+	// Remove all composite texture resources defined in the entry
+	if (record.maps & CompositeTextures)
 	{
-		// Read texture list
-		TextureXList tx;
-		PatchTable   ptable;
-		if (txentry == 1)
-			tx.readTEXTUREXData(entry.get(), ptable);
-		else
-			tx.readTEXTURESData(entry.get());
+		auto parent = entry->getParent();
+		for (auto& tex_name : record.textures)
+		{
+			auto res = textures_.find(tex_name);
+			if (res == textures_.end())
+				continue;
 
-		// Remove all texture resources
-		for (unsigned a = 0; a < tx.nTextures(); a++)
-			textures_[tx.getTexture(a)->getName()].remove(entry->getParent());
+			res->second.remove(parent);
+			if (res->second.length() == 0)
+				textures_.erase(res);
+		}
 	}
 }
 
@@ -438,12 +604,8 @@ void ResourceManager::removeEntry(ArchiveEntry::SPtr& entry, bool log, bool full
 // -----------------------------------------------------------------------------
 void ResourceManager::listAllPatches()
 {
-	EntryResourceMap::iterator i = patches_.begin();
-	while (i != patches_.end())
-	{
-		LOG_MESSAGE(1, "%s (%d)", i->first, i->second.length());
-		++i;
-	}
+	for (auto& i : sortedResources(patches_))
+		LOG_MESSAGE(1, "%s (%d)", *i.first, i.second->length());
 }
 
 // -----------------------------------------------------------------------------
@@ -451,9 +613,9 @@ void ResourceManager::listAllPatches()
 // -----------------------------------------------------------------------------
 void ResourceManager::getAllPatchEntries(vector<ArchiveEntry*>& list, Archive* priority, bool fullPath)
 {
-	for (auto& i : patches_)
+	for (auto& i : sortedResources(patches_))
 	{
-		auto entry = i.second.getEntry(priority);
+		auto entry = i.second->getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -461,9 +623,9 @@ void ResourceManager::getAllPatchEntries(vector<ArchiveEntry*>& list, Archive* p
 	if (!fullPath)
 		return;
 
-	for (auto& i : patches_fp_only_)
+	for (auto& i : sortedResources(patches_fp_only_))
 	{
-		auto entry = i.second.getEntry(priority);
+		auto entry = i.second->getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -475,30 +637,32 @@ void ResourceManager::getAllPatchEntries(vector<ArchiveEntry*>& list, Archive* p
 void ResourceManager::getAllTextures(vector<TextureResource::Texture*>& list, Archive* priority, Archive* ignore)
 {
 	// Add all primary textures to the list
-	for (auto& i : textures_)
+	for (auto& i : sortedResources(textures_))
 	{
+		auto& resource = *i.second;
+
 		// Skip if no entries
-		if (i.second.length() == 0)
+		if (resource.length() == 0)
 			continue;
 
 		// Go through resource textures
-		TextureResource::Texture* res = i.second.textures_[0].get();
-		for (int a = 0; a < i.second.length(); a++)
+		TextureResource::Texture* res = resource.textures_[0].get();
+		for (int a = 0; a < resource.length(); a++)
 		{
-			res = i.second.textures_[a].get();
+			res = resource.textures_[a].get();
 
 			// Skip if it's in the 'ignore' archive
 			if (res->parent == ignore)
 				continue;
 
 			// If it's in the 'priority' archive, exit loop
-			if (priority && i.second.textures_[a]->parent == priority)
+			if (priority && resource.textures_[a]->parent == priority)
 				break;
 
 			// Otherwise, if it's in a 'later' archive than the current resource, set it
 			if (App::archiveManager().archiveIndex(res->parent)
-				<= App::archiveManager().archiveIndex(i.second.textures_[a]->parent))
-				res = i.second.textures_[a].get();
+				<= App::archiveManager().archiveIndex(resource.textures_[a]->parent))
+				res = resource.textures_[a].get();
 		}
 
 		// Add texture resource to the list
@@ -513,9 +677,9 @@ void ResourceManager::getAllTextures(vector<TextureResource::Texture*>& list, Ar
 void ResourceManager::getAllTextureNames(vector<string>& list)
 {
 	// Add all primary textures to the list
-	for (auto& i : textures_)
-		if (i.second.length() > 0) // Ignore if no entries
-			list.push_back(i.first);
+	for (auto& i : sortedResources(textures_))
+		if (i.second->length() > 0) // Ignore if no entries
+			list.push_back(*i.first);
 }
 
 // -----------------------------------------------------------------------------
@@ -523,9 +687,9 @@ void ResourceManager::getAllTextureNames(vector<string>& list)
 // -----------------------------------------------------------------------------
 void ResourceManager::getAllFlatEntries(vector<ArchiveEntry*>& list, Archive* priority, bool fullPath)
 {
-	for (auto& i : flats_)
+	for (auto& i : sortedResources(flats_))
 	{
-		auto entry = i.second.getEntry(priority);
+		auto entry = i.second->getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -533,9 +697,9 @@ void ResourceManager::getAllFlatEntries(vector<ArchiveEntry*>& list, Archive* pr
 	if (!fullPath)
 		return;
 
-	for (auto& i : flats_fp_only_)
+	for (auto& i : sortedResources(flats_fp_only_))
 	{
-		auto entry = i.second.getEntry(priority);
+		auto entry = i.second->getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -547,9 +711,9 @@ void ResourceManager::getAllFlatEntries(vector<ArchiveEntry*>& list, Archive* pr
 void ResourceManager::getAllFlatNames(vector<string>& list)
 {
 	// Add all primary flats to the list
-	for (auto& i : flats_)
-		if (i.second.length() > 0) // Ignore if no entries
-			list.push_back(i.first);
+	for (auto& i : sortedResources(flats_))
+		if (i.second->length() > 0) // Ignore if no entries
+			list.push_back(*i.first);
 }
 
 // -----------------------------------------------------------------------------
@@ -558,7 +722,8 @@ void ResourceManager::getAllFlatNames(vector<string>& list)
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getPaletteEntry(const string& palette, Archive* priority)
 {
-	return palettes_[palette.Upper()].getEntry(priority);
+	auto res = findResource(palettes_, palette.Upper());
+	return res ? res->getEntry(priority) : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -575,13 +740,16 @@ ArchiveEntry* ResourceManager::getPatchEntry(const string& patch, const string&
 	if (!nspace.CmpNoCase("textures"))
 		return getTextureEntry(patch, "textures", priority);
 
-	ArchiveEntry* entry = patches_[patch.Upper()].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	string name = patch.Upper();
+	auto   res  = findResource(patches_, name);
+	if (res)
+		if (auto entry = res->getEntry(priority, nspace, true))
+			return entry;
 
-	entry = patches_fp_[patch.Upper()].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	res = findResource(patches_fp_, name);
+	if (res)
+		if (auto entry = res->getEntry(priority, nspace, true))
+			return entry;
 
 	return nullptr;
 }
@@ -593,16 +761,18 @@ ArchiveEntry* ResourceManager::getPatchEntry(const string& patch, const string&
 ArchiveEntry* ResourceManager::getFlatEntry(const string& flat, Archive* priority)
 {
 	// Check resource with matching name exists
-	EntryResource& res = flats_[flat.Upper()];
+	string name = flat.Upper();
+	auto   res  = findResource(flats_, name);
 
 	// Return most relevant entry
-	ArchiveEntry* entry = res.getEntry(priority);
-	if (entry)
-		return entry;
+	if (res)
+		if (auto entry = res->getEntry(priority))
+			return entry;
 
-	entry = flats_fp_[flat.Upper()].getEntry(priority, "flats", true);
-	if (entry)
-		return entry;
+	res = findResource(flats_fp_, name);
+	if (res)
+		if (auto entry = res->getEntry(priority, "flats", true))
+			return entry;
 
 	return nullptr;
 }
@@ -613,13 +783,16 @@ ArchiveEntry* ResourceManager::getFlatEntry(const string& flat, Archive* priorit
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getTextureEntry(const string& texture, const string& nspace, Archive* priority)
 {
-	ArchiveEntry* entry = satextures_[texture.Upper()].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	string name = texture.Upper();
+	auto   res  = findResource(satextures_, name);
+	if (res)
+		if (auto entry = res->getEntry(priority, nspace, true))
+			return entry;
 
-	entry = satextures_fp_[texture.Upper()].getEntry(priority, nspace, true);
-	if (entry)
-		return entry;
+	res = findResource(satextures_fp_, name);
+	if (res)
+		if (auto entry = res->getEntry(priority, nspace, true))
+			return entry;
 
 	return nullptr;
 }
@@ -631,9 +804,10 @@ ArchiveEntry* ResourceManager::getTextureEntry(const string& texture, const stri
 CTexture* ResourceManager::getTexture(const string& texture, Archive* priority, Archive* ignore)
 {
 	// Check texture resource with matching name exists
-	TextureResource& res = textures_[texture.Upper()];
-	if (res.textures_.empty())
+	auto found = findResource(textures_, texture.Upper());
+	if (!found || found->textures_.empty())
 		return nullptr;
+	auto& res = *found;
 
 	// Go through resource textures
 	CTexture* tex    = &res.textures_[0].get()->tex;
@@ -677,7 +851,7 @@ void ResourceManager::onAnnouncement(Announcer* announcer, string event_name, Me
 		event_data.read(&ptr, sizeof(wxUIntPtr), 4);
 		ArchiveEntry* entry = (ArchiveEntry*)wxUIntToPtr(ptr);
 		auto          esp   = entry->getParent()->entryAtPathShared(entry->getPath(true));
-		removeEntry(esp, true);
+		removeEntry(entry, true);
 		addEntry(esp, true);
 		announce("resources_updated");
 	}
@@ -688,8 +862,7 @@ void ResourceManager::onAnnouncement(Announcer* announcer, string event_name, Me
 		wxUIntPtr ptr;
 		event_data.read(&ptr, sizeof(wxUIntPtr), sizeof(int));
 		ArchiveEntry* entry = (ArchiveEntry*)wxUIntToPtr(ptr);
-		auto          esp   = entry->getParent()->entryAtPathShared(entry->getPath(true));
-		removeEntry(esp, true);
+		removeEntry(entry, true);
 		announce("resources_updated");
 	}
 
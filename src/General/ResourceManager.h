@@ -31,7 +31,7 @@ public:
 	virtual ~EntryResource() {}
 
 	void add(ArchiveEntry::SPtr& entry);
-	void remove(ArchiveEntry::SPtr& entry);
+	void remove(ArchiveEntry* entry);
 
 	int length() override { return entries_.size(); }
 
@@ -70,8 +70,8 @@ private:
 	vector<std::unique_ptr<Texture>> textures_;
 };
 
-typedef std::map<string, EntryResource>   EntryResourceMap;
-typedef std::map<string, TextureResource> TextureResourceMap;
+typedef std::unordered_map<string, EntryResource, wxStringHash, wxStringEqual>   EntryResourceMap;
+typedef std::unordered_map<string, TextureResource, wxStringHash, wxStringEqual> TextureResourceMap;
 
 class ResourceManager : public Listener, public Announcer
 {
@@ -91,7 +91,7 @@ public:
 	void removeArchive(Archive* archive);
 
 	void addEntry(ArchiveEntry::SPtr& entry, bool log = false);
-	void removeEntry(ArchiveEntry::SPtr& entry, bool log = false, bool full_check = false);
+	void removeEntry(ArchiveEntry* entry, bool log = false);
 
 	void listAllPatches();
 	void getAllPatchEntries(vector<ArchiveEntry*>& list, Archive* priority, bool fullPath = false);
@@ -117,6 +117,32 @@ public:
 	static string getTextureName(uint16_t hash) { return doom64_hash_table_[hash]; }
 
 private:
+	// Resource maps an entry can be registered in (bitmask)
+	enum ResourceMap
+	{
+		Palettes          = 1 << 0,
+		Patches           = 1 << 1,
+		PatchesFp         = 1 << 2,
+		PatchesFpOnly     = 1 << 3,
+		Flats             = 1 << 4,
+		FlatsFp           = 1 << 5,
+		FlatsFpOnly       = 1 << 6,
+		SATextures        = 1 << 7,
+		SATexturesFp      = 1 << 8,
+		CompositeTextures = 1 << 9,
+	};
+
+	// Records what an entry was registered as, so it can be removed again
+	// without looking anything up (the entry may have been renamed since)
+	struct EntryRecord
+	{
+		string         name;
+		string         path;
+		unsigned       maps = 0;
+		vector<string> textures;
+	};
+	typedef std::unordered_map<ArchiveEntry*, EntryRecord> EntryRecordMap;
+
 	EntryResourceMap palettes_;
 	EntryResourceMap patches_;
 	EntryResourceMap patches_fp_;      // Full path
@@ -130,6 +156,12 @@ private:
 	// EntryResourceMap	satextures_fp_only_; // Probably not needed
 	TextureResourceMap textures_; // Composite textures (defined in a TEXTUREx/TEXTURES lump)
 
+	// Registered entries, grouped by parent archive
+	std::unordered_map<Archive*, EntryRecordMap> entry_records_;
+
+	void addEntry(ArchiveEntry::SPtr& entry, EntryRecordMap& records, bool log);
+	void removeRecord(ArchiveEntry* entry, EntryRecord& record);
+
 	static ResourceManager* instance_;
 	static string           doom64_hash_table_[65536];
 };
@@ -231,7 +231,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 {
 	// Read basic info
 	type_ = type;
-	name_ = tz.next().text.Upper();
+	name_ = tz.next().text().Upper();
 	tz.adv(); // Skip ,
 	offset_x_ = tz.next().asInt();
 	tz.adv(); // Skip ,
@@ -264,14 +264,14 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 			{
 				// Build translation string
 				string translate;
-				string temp = tz.next().text;
+				string temp = tz.next().text();
 				if (temp.Contains("="))
 					temp = S_FMT("\"%s\"", temp);
 				translate += temp;
 				while (tz.checkNext(","))
 				{
-					translate += tz.next().text; // add ','
-					temp = tz.next().text;
+					translate += tz.next().text(); // add ','
+					temp = tz.next().text();
 					if (temp.Contains("="))
 						temp = S_FMT("\"%s\"", temp);
 					translate += temp;
@@ -289,7 +289,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 				blendtype_ = 2;
 
 				// Read first value
-				string first = tz.next().text;
+				string first = tz.next().text();
 
 				// If no second value, it's just a colour string
 				if (!tz.checkNext(","))
@@ -321,7 +321,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 						colour_.b = tz.next().asInt();
 						if (!tz.checkNext(","))
 						{
-							Log::error(S_FMT("Invalid TEXTURES definition, expected ',', got '%s'", tz.peek().text));
+							Log::error(S_FMT("Invalid TEXTURES definition, expected ',', got '%s'", tz.peek().text()));
 							return false;
 						}
 						tz.adv(); // Skip ,
@@ -337,7 +337,7 @@ bool CTPatchEx::parse(Tokenizer& tz, Type type)
 
 			// Style
 			if (tz.checkNC("Style"))
-				style_ = tz.next().text;
+				style_ = tz.next().text();
 
 			// Read next property name
 			tz.adv();
@@ -730,7 +730,7 @@ bool CTexture::parse(Tokenizer& tz, string type)
 	type_     = type;
 	extended_ = true;
 	defined_  = false;
-	name_     = tz.next().text.Upper();
+	name_     = tz.next().text().Upper();
 	tz.adv(); // Skip ,
 	width_ = tz.next().asInt();
 	tz.adv(); // Skip ,
@@ -809,7 +809,7 @@ bool CTexture::parseDefine(Tokenizer& tz)
 	type_               = "Define";
 	extended_           = true;
 	defined_            = true;
-	name_               = tz.next().text.Upper();
+	name_               = tz.next().text().Upper();
 	def_width_          = tz.next().asInt();
 	def_height_         = tz.next().asInt();
 	width_              = def_width_;
@@ -54,6 +54,35 @@ CVAR(Float, col_match_l, 1.0, CVAR_SAVE)
 EXTERN_CVAR(Float, col_greyscale_r);
 EXTERN_CVAR(Float, col_greyscale_g);
 EXTERN_CVAR(Float, col_greyscale_b);
+namespace
+{
+const size_t MAX_CACHED_MATCHES = 1 << 20;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the colour matching method selected by the col_match cvar
+// -----------------------------------------------------------------------------
+Palette::ColourMatch defaultColourMatch()
+{
+	// Be nice if there was an easier way to convert from int -> enum class,
+	// but then that's kind of the point of them I guess
+	static vector<Palette::ColourMatch> cm_convert = {
+		Palette::ColourMatch::Default, Palette::ColourMatch::Old, Palette::ColourMatch::RGB,
+		Palette::ColourMatch::HSL,     Palette::ColourMatch::C76, Palette::ColourMatch::C94,
+		Palette::ColourMatch::C2K,     Palette::ColourMatch::Stop,
+	};
+
+	return cm_convert[col_match];
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -78,11 +107,36 @@ Palette::Palette(unsigned size) : colours_{ size }, colours_hsl_{ size }, colour
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Palette class copy constructor (lookup data for nearestColour isn't copied)
+// -----------------------------------------------------------------------------
+Palette::Palette(const Palette& copy) :
+	colours_{ copy.colours_ },
+	colours_hsl_{ copy.colours_hsl_ },
+	colours_lab_{ copy.colours_lab_ },
+	index_trans_{ copy.index_trans_ }
+{
+}
+
 // -----------------------------------------------------------------------------
 // Palette class destructor
 // -----------------------------------------------------------------------------
 Palette::~Palette() {}
 
+// -----------------------------------------------------------------------------
+// Palette assignment operator (lookup data for nearestColour isn't copied)
+// -----------------------------------------------------------------------------
+Palette& Palette::operator=(const Palette& copy)
+{
+	colours_     = copy.colours_;
+	colours_hsl_ = copy.colours_hsl_;
+	colours_lab_ = copy.colours_lab_;
+	index_trans_ = copy.index_trans_;
+	colourChanged();
+
+	return *this;
+}
+
 // -----------------------------------------------------------------------------
 // Reads colour information from raw data (MemChunk)
 // -----------------------------------------------------------------------------
@@ -92,6 +146,8 @@ bool Palette::loadMem(MemChunk& mc)
 	if (mc.getSize() < 3)
 		return false;
 
+	colourChanged();
+
 	// Read in colours
 	mc.seek(0, SEEK_SET);
 	int c = 0;
@@ -126,6 +182,8 @@ bool Palette::loadMem(const uint8_t* data, uint32_t size)
 	if (size < 3)
 		return false;
 
+	colourChanged();
+
 	// Read in colours
 	int c = 0;
 	for (size_t a = 0; a < size; a += 3)
@@ -440,6 +498,7 @@ bool Palette::loadFile(const string& filename, Format format)
 // -----------------------------------------------------------------------------
 void Palette::setColour(uint8_t index, rgba_t col)
 {
+	colourChanged();
 	colours_[index].set(col);
 	colours_[index].index = index;
 	colours_lab_[index]   = Misc::rgbToLab(col.dr(), col.dg(), col.db());
@@ -451,6 +510,7 @@ void Palette::setColour(uint8_t index, rgba_t col)
 // -----------------------------------------------------------------------------
 void Palette::setColourR(uint8_t index, uint8_t val)
 {
+	colourChanged();
 	colours_[index].r   = val;
 	colours_lab_[index] = Misc::rgbToLab(colours_[index].dr(), colours_[index].dg(), colours_[index].db());
 	colours_hsl_[index] = Misc::rgbToHsl(colours_[index].dr(), colours_[index].dg(), colours_[index].db());
@@ -461,6 +521,7 @@ void Palette::setColourR(uint8_t index, uint8_t val)
 // -----------------------------------------------------------------------------
 void Palette::setColourG(uint8_t index, uint8_t val)
 {
+	colourChanged();
 	colours_[index].g   = val;
 	colours_lab_[index] = Misc::rgbToLab(colours_[index].dr(), colours_[index].dg(), colours_[index].db());
 	colours_hsl_[index] = Misc::rgbToHsl(colours_[index].dr(), colours_[index].dg(), colours_[index].db());
@@ -471,6 +532,7 @@ void Palette::setColourG(uint8_t index, uint8_t val)
 // -----------------------------------------------------------------------------
 void Palette::setColourB(uint8_t index, uint8_t val)
 {
+	colourChanged();
 	colours_[index].b   = val;
 	colours_lab_[index] = Misc::rgbToLab(colours_[index].dr(), colours_[index].dg(), colours_[index].db());
 	colours_hsl_[index] = Misc::rgbToHsl(colours_[index].dr(), colours_[index].dg(), colours_[index].db());
@@ -508,6 +570,7 @@ void Palette::setGradient(uint8_t startIndex, uint8_t endIndex, rgba_t startCol,
 			-1,
 			a + startIndex);
 		colours_[a + startIndex].set(gradCol);
+		colourChanged();
 	}
 }
 
@@ -586,24 +649,124 @@ double Palette::colourDiff(rgba_t& rgb, hsl_t& hsl, lab_t& lab, int index, Colou
 }
 
 // -----------------------------------------------------------------------------
-// Returns the index of the closest colour in the palette to [colour]
+// Returns the index of the closest colour in the palette to [colour] using
+// 'Old' (integer) or 'RGB' matching. Distances to all colours are calculated
+// first (in a loop the compiler can vectorize) and then searched, which gives
+// the same result as checking each colour with colourDiff
+// -----------------------------------------------------------------------------
+short Palette::nearestColourRGB(rgba_t& colour, ColourMatch match, const MatchCache& cache)
+{
+	if (match == ColourMatch::Old)
+	{
+		int r = colour.r, g = colour.g, b = colour.b;
+		int dist[256];
+		for (int a = 0; a < 256; a++)
+		{
+			int d1  = r - cache.ir[a];
+			int d2  = g - cache.ig[a];
+			int d3  = b - cache.ib[a];
+			dist[a] = (d1 * d1) + (d2 * d2) + (d3 * d3);
+		}
+
+		int   min_d = 999999;
+		short index = 0;
+		for (short a = 0; a < 256; a++)
+			if (dist[a] < min_d)
+			{
+				min_d = dist[a];
+				index = a;
+			}
+
+		return index;
+	}
+
+	double r = colour.dr(), g = colour.dg(), b = colour.db();
+	double w1 = cache.weights[0], w2 = cache.weights[1], w3 = cache.weights[2];
+	double dist[256];
+	for (int a = 0; a < 256; a++)
+	{
+		double d1 = (r - cache.dr[a]) * w1;
+		double d2 = (g - cache.dg[a]) * w2;
+		double d3 = (b - cache.db[a]) * w3;
+		dist[a]   = (d1 * d1) + (d2 * d2) + (d3 * d3);
+	}
+
+	double min_d = 999999;
+	short  index = 0;
+	for (short a = 0; a < 256; a++)
+		if (dist[a] < min_d)
+		{
+			min_d = dist[a];
+			index = a;
+		}
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [colour].
+// Results are cached per colour, so converting images with many pixels of the
+// same colour only needs to search the palette once for each unique colour
 // -----------------------------------------------------------------------------
 short Palette::nearestColour(rgba_t colour, ColourMatch match)
 {
+	if (match == ColourMatch::Default)
+		match = defaultColourMatch();
+
+	// (Re)build lookup data if needed
+	float weights[6] = { col_match_r, col_match_g, col_match_b, col_match_h, col_match_s, col_match_l };
+	if (!match_cache_ || memcmp(match_cache_->weights, weights, sizeof(weights)) != 0)
+	{
+		match_cache_ = std::make_unique<MatchCache>();
+		memcpy(match_cache_->weights, weights, sizeof(weights));
+		for (int a = 0; a < 256; a++)
+		{
+			match_cache_->ir[a] = colours_[a].r;
+			match_cache_->ig[a] = colours_[a].g;
+			match_cache_->ib[a] = colours_[a].b;
+			match_cache_->dr[a] = colours_[a].dr();
+			match_cache_->dg[a] = colours_[a].dg();
+			match_cache_->db[a] = colours_[a].db();
+		}
+	}
+
+	// Check for a previous result
+	uint32_t key   = colour.r << 16 | colour.g << 8 | colour.b | (uint32_t)match << 24;
+	auto     found = match_cache_->nearest.find(key);
+	if (found != match_cache_->nearest.end())
+		return found->second;
+
+	// Search palette
+	short index;
+	if (match == ColourMatch::Old || match == ColourMatch::RGB)
+		index = nearestColourRGB(colour, match, *match_cache_);
+	else
+		index = findNearestColour(colour, match);
+
+	// Don't let the cache grow unbounded for images with huge numbers of
+	// different colours
+	if (match_cache_->nearest.size() >= MAX_CACHED_MATCHES)
+		match_cache_->nearest.clear();
+	match_cache_->nearest[key] = index;
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [colour] by
+// comparing against every colour in the palette (ie. without any cached
+// results or lookup data)
+// -----------------------------------------------------------------------------
+short Palette::findNearestColour(rgba_t colour, ColourMatch match)
+{
+	if (match == ColourMatch::Default)
+		match = defaultColourMatch();
+
 	double min_d = 999999;
 	short  index = 0;
 	hsl_t  chsl  = Misc::rgbToHsl(colour);
 	lab_t  clab  = Misc::rgbToLab(colour);
 
-	// Be nice if there was an easier way to convert from int -> enum class,
-	// but then that's kind of the point of them I guess
-	static vector<ColourMatch> cm_convert = {
-		ColourMatch::Default, ColourMatch::Old, ColourMatch::RGB, ColourMatch::HSL,
-		ColourMatch::C76,     ColourMatch::C94, ColourMatch::C2K, ColourMatch::Stop,
-	};
-	if (match == ColourMatch::Default)
-		match = cm_convert[col_match];
-
 	double delta;
 	for (short a = 0; a < 256; a++)
 	{
@@ -870,3 +1033,58 @@ void Palette::invert(int start, int end)
 		setColour(i, colours_[i]); // Just to update the HSL values
 	}
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+#include "App.h"
+#include "General/Console/Console.h"
+#include "Graphics/Palette/PaletteManager.h"
+
+CONSOLE_COMMAND(test_palette_match, 0, false)
+{
+	long count = 1000000;
+	if (!args.empty())
+		args[0].ToLong(&count);
+
+	// Random colours, with plenty of repeats as in a typical image
+	vector<rgba_t> colours(count);
+	srand(1);
+	for (auto& colour : colours)
+		colour.set(rand() % 64 * 4, rand() % 64 * 4, rand() % 64 * 4, 255);
+
+	vector<Palette::ColourMatch> modes = { Palette::ColourMatch::Old, Palette::ColourMatch::RGB,
+										   Palette::ColourMatch::HSL, Palette::ColourMatch::C76,
+										   Palette::ColourMatch::C94, Palette::ColourMatch::C2K };
+	vector<string>               names = { "Old", "RGB", "HSL", "CIE76", "CIE94", "CIEDE2000" };
+
+	Palette pal;
+	pal.copyPalette(App::paletteManager()->globalPalette());
+	for (unsigned m = 0; m < modes.size(); m++)
+	{
+		vector<short> expected(count), result(count);
+
+		// Full search
+		auto start = App::runTimer();
+		for (long a = 0; a < count; a++)
+			expected[a] = pal.findNearestColour(colours[a], modes[m]);
+		auto time_search = App::runTimer() - start;
+
+		// Cached/accelerated
+		start = App::runTimer();
+		for (long a = 0; a < count; a++)
+			result[a] = pal.nearestColour(colours[a], modes[m]);
+		auto time_cached = App::runTimer() - start;
+
+		Log::console(S_FMT(
+			"%s: full search %ldms, nearestColour %ldms%s",
+			CHR(names[m]),
+			time_search,
+			time_cached,
+			expected == result ? "" : " (RESULTS DIFFER)"));
+	}
+}
@@ -26,8 +26,11 @@ public:
 	};
 
 	Palette(unsigned size = 256);
+	Palette(const Palette& copy);
 	~Palette();
 
+	Palette& operator=(const Palette& copy);
+
 	rgba_t colour(uint8_t index) { return colours_[index]; }
 	short  transIndex() { return index_trans_; }
 
@@ -48,6 +51,7 @@ public:
 	void   copyPalette(Palette* copy);
 	short  findColour(rgba_t colour);
 	short  nearestColour(rgba_t colour, ColourMatch match = ColourMatch::Default);
+	short  findNearestColour(rgba_t colour, ColourMatch match = ColourMatch::Default);
 	size_t countColours();
 	void   applyTranslation(Translation* trans);
 
@@ -71,5 +75,18 @@ private:
 	vector<lab_t>  colours_lab_;
 	short          index_trans_;
 
+	// Lookup data for nearestColour, built on first use and discarded
+	// whenever a colour changes
+	struct MatchCache
+	{
+		std::unordered_map<uint32_t, short> nearest;                   // Key is rgb | (match << 24)
+		float                               weights[6];                // col_match_* cvar values used
+		int                                 ir[256], ig[256], ib[256]; // For Old matching
+		double                              dr[256], dg[256], db[256]; // For RGB matching
+	};
+	std::unique_ptr<MatchCache> match_cache_;
+
 	double colourDiff(rgba_t& rgb, hsl_t& hsl, lab_t& lab, int index, ColourMatch match);
+	short  nearestColourRGB(rgba_t& colour, ColourMatch match, const MatchCache& cache);
+	void   colourChanged() { match_cache_.reset(); }
 };
@@ -50,6 +50,40 @@ EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Copies [width]x[height] pixels of [bpp] bytes each from [src] to [dest],
+// where the source pixel at x,y goes to dest pixel [base] + x*[dx] + y*[dy].
+// Used for rotating and mirroring, the row loop keeps the inner loop free of
+// divisions and branches
+// -----------------------------------------------------------------------------
+void remapPixels(const uint8_t* src, uint8_t* dest, int width, int height, int bpp, int base, int dx, int dy)
+{
+	for (int y = 0; y < height; ++y)
+	{
+		const uint8_t* row = src + y * width * bpp;
+		int            j   = base + y * dy;
+		if (bpp == 1)
+		{
+			for (int x = 0; x < width; ++x, j += dx)
+				dest[j] = row[x];
+		}
+		else
+		{
+			for (int x = 0; x < width; ++x, j += dx)
+				memcpy(dest + j * bpp, row + x * bpp, bpp);
+		}
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SImage Class Functions
@@ -110,21 +144,26 @@ bool SImage::getRGBAData(MemChunk& mc, Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
-		uint8_t rgba[4];
-		for (int a = 0; a < width_ * height_; a++)
+		// Build colour lookup table
+		uint8_t lut[256 * 4];
+		for (int c = 0; c < 256; c++)
 		{
-			// Get colour
-			rgba_t col = pal->colour(data_[a]);
-
-			// Set alpha
-			if (mask_)
-				col.a = mask_[a];
-			else
-				col.a = 255;
+			rgba_t col = pal->colour(c);
+			col.a      = 255;
+			col.write(lut + c * 4);
+		}
 
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
+		// Write colours directly to the MemChunk
+		uint8_t* out       = &mc[0];
+		int      numpixels = width_ * height_;
+		for (int a = 0; a < numpixels; a++)
+			memcpy(out + a * 4, lut + data_[a] * 4, 4);
+		if (mask_)
+		{
+			for (int a = 0; a < numpixels; a++)
+				out[a * 4 + 3] = mask_[a];
 		}
+		mc.seek(numpixels * 4, SEEK_SET);
 
 		return true;
 	}
@@ -132,16 +171,12 @@ bool SImage::getRGBAData(MemChunk& mc, Palette* pal)
 	// Convert if alpha map
 	else if (type_ == ALPHAMAP)
 	{
-		uint8_t rgba[4];
-		rgba_t  col;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get pixel as colour (greyscale)
-			col.set(data_[a], data_[a], data_[a], data_[a]);
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
-		}
+		// Get pixels as colour (greyscale)
+		uint8_t* out       = &mc[0];
+		int      numpixels = width_ * height_;
+		for (int a = 0; a < numpixels; a++)
+			memset(out + a * 4, data_[a], 4);
+		mc.seek(numpixels * 4, SEEK_SET);
 	}
 
 	return false; // Invalid image type
@@ -848,25 +883,33 @@ bool SImage::maskFromBrightness(Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
-		// Go through pixel data
-		for (int a = 0; a < width_ * height_; a++)
+		// Build brightness lookup table
+		uint8_t lut[256];
+		for (int c = 0; c < 256; c++)
 		{
-			// Set mask from pixel colour brightness value
-			rgba_t col = pal->colour(data_[a]);
-			mask_[a]   = ((double)col.r * 0.3) + ((double)col.g * 0.59) + ((double)col.b * 0.11);
+			rgba_t col = pal->colour(c);
+			lut[c]     = ((double)col.r * 0.3) + ((double)col.g * 0.59) + ((double)col.b * 0.11);
 		}
+
+		// Set mask from pixel colour brightness value
+		for (int a = 0; a < width_ * height_; a++)
+			mask_[a] = lut[data_[a]];
 	}
 	else if (type_ == RGBA)
 	{
-		// Go through pixel data
-		unsigned c = 0;
-		for (int a = 0; a < width_ * height_; a++)
+		// Precalculate the weighted value of each channel level
+		double lr[256], lg[256], lb[256];
+		for (int c = 0; c < 256; c++)
 		{
-			// Set alpha from pixel colour brightness value
-			data_[c + 3] = (double)data_[c] * 0.3 + (double)data_[c + 1] * 0.59 + (double)data_[c + 2] * 0.11;
-			// Skip alpha
-			c += 4;
+			lr[c] = (double)c * 0.3;
+			lg[c] = (double)c * 0.59;
+			lb[c] = (double)c * 0.11;
 		}
+
+		// Set alpha from pixel colour brightness value
+		int numbytes = width_ * height_ * 4;
+		for (int c = 0; c < numbytes; c += 4)
+			data_[c + 3] = lr[data_[c]] + lg[data_[c + 1]] + lb[data_[c + 2]];
 	}
 	// ALPHAMASK type is already a brightness mask
 
@@ -887,35 +930,20 @@ bool SImage::cutoffMask(uint8_t threshold)
 	{
 		// Paletted, go through mask
 		for (int a = 0; a < width_ * height_; a++)
-		{
-			if (mask_[a] > threshold)
-				mask_[a] = 255;
-			else
-				mask_[a] = 0;
-		}
+			mask_[a] = mask_[a] > threshold ? 255 : 0;
 	}
 	else if (type_ == RGBA)
 	{
 		// RGBA format, go through alpha channel
-		uint32_t c = 0;
-		for (int a = 3; a < width_ * height_ * 4; a += 4)
-		{
-			if (data_[a] > threshold)
-				data_[a] = 255;
-			else
-				data_[a] = 0;
-		}
+		int numbytes = width_ * height_ * 4;
+		for (int a = 3; a < numbytes; a += 4)
+			data_[a] = data_[a] > threshold ? 255 : 0;
 	}
 	else if (type_ == ALPHAMAP)
 	{
 		// Alpha map, go through pixels
 		for (int a = 0; a < width_ * height_; a++)
-		{
-			if (data_[a] > threshold)
-				data_[a] = 255;
-			else
-				data_[a] = 0;
-		}
+			data_[a] = data_[a] > threshold ? 255 : 0;
 	}
 	else
 		return false;
@@ -1081,44 +1109,40 @@ bool SImage::rotate(int angle)
 	else
 		return false;
 
+	// Get destination of the first pixel and the steps along x and y
+	int base, dx, dy;
+	switch (angle)
+	{
+		// Urgh maths...
+	case 90:
+		base = (nh - 1) * nw;
+		dx   = -nw;
+		dy   = 1;
+		break;
+	case 180:
+		base = numpixels - 1;
+		dx   = -1;
+		dy   = -width_;
+		break;
+	case 270:
+		base = nw - 1;
+		dx   = nw;
+		dy   = -1;
+		break;
+	default: return false;
+	}
+
 	// Create new data and mask
 	nd = new uint8_t[numpixels * numbpp];
 	if (mask_)
-		nm = new uint8_t[numpixels * numbpp];
+		nm = new uint8_t[numpixels];
 	else
 		nm = nullptr;
 
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
-	{
-		switch (angle)
-		{
-			// Urgh maths...
-		case 90: j = (((nh - 1) - (i % width_)) * nw) + (i / width_); break;
-		case 180: j = (numpixels - 1) - i; break;
-		case 270: j = ((i % width_) * nw) + ((nw - 1) - (i / width_)); break;
-		default:
-			delete[] nd;
-			if (mask_)
-				delete[] nm;
-			return false;
-		}
-		if (j >= numpixels)
-		{
-			LOG_MESSAGE(1, "Pixel %i remapped to %i, how did this even happen?", i, j);
-			delete[] nd;
-			if (mask_)
-				delete[] nm;
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
-		{
-			nd[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_)
-				nm[(j * numbpp) + k] = mask_[(i * numbpp) + k];
-		}
-	}
+	// Remap pixels
+	remapPixels(data_, nd, width_, height_, numbpp, base, dx, dy);
+	if (mask_)
+		remapPixels(mask_, nm, width_, height_, 1, base, dx, dy);
 
 	// It worked, yay
 	clearData();
@@ -1152,33 +1176,17 @@ bool SImage::mirror(bool vertical)
 	// Create new data and mask
 	nd = new uint8_t[numpixels * numbpp];
 	if (mask_)
-		nm = new uint8_t[numpixels * numbpp];
+		nm = new uint8_t[numpixels];
 	else
 		nm = nullptr;
 
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
-	{
-		if (vertical)
-			j = (((height_ - 1) - (i / width_)) * width_) + (i % width_);
-		else // horizontal
-			j = ((i / width_) * width_) + ((width_ - 1) - (i % width_));
-		if (j >= numpixels)
-		{
-			LOG_MESSAGE(1, "Pixel %i remapped to %i, how did this even happen?", i, j);
-			delete[] nd;
-			if (mask_)
-				delete[] nm;
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
-		{
-			nd[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_)
-				nm[(j * numbpp) + k] = mask_[(i * numbpp) + k];
-		}
-	}
+	// Remap pixels
+	int base = vertical ? (height_ - 1) * width_ : width_ - 1;
+	int dx   = vertical ? 1 : -1;
+	int dy   = vertical ? -width_ : width_;
+	remapPixels(data_, nd, width_, height_, numbpp, base, dx, dy);
+	if (mask_)
+		remapPixels(mask_, nm, width_, height_, 1, base, dx, dy);
 
 	// It worked, yay
 	clearData();
@@ -1378,6 +1386,13 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 	else
 		newdata = data_;
 
+	// Translated colours, a translation always gives the same result for the
+	// same input so each distinct colour only needs translating once
+	// (for truecolour, first is false if the colour isn't in the palette)
+	rgba_t                                                pal_translated[256];
+	bool                                                  pal_done[256] = {};
+	std::unordered_map<uint32_t, std::pair<bool, rgba_t>> rgba_translated;
+
 	// Go through pixels
 	for (int p = 0; p < width_ * height_; p++)
 	{
@@ -1388,19 +1403,36 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 		rgba_t col;
 		int    q = p * bpp;
 		if (type_ == PALMASK)
-			col.set(pal->colour(data_[p]));
+		{
+			if (!pal_done[data_[p]])
+			{
+				pal_translated[data_[p]] = tr->translate(pal->colour(data_[p]), pal);
+				pal_done[data_[p]]       = true;
+			}
+			col = pal_translated[data_[p]];
+		}
 		else if (type_ == RGBA)
 		{
-			col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
+			uint32_t key;
+			memcpy(&key, data_ + q, 4);
+			auto i = rgba_translated.find(key);
+			if (i == rgba_translated.end())
+			{
+				col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
+
+				// skip colours that don't match exactly to the palette
+				col.index    = pal->nearestColour(col);
+				bool matched = col.equals(pal->colour(col.index));
+				if (matched)
+					col = tr->translate(col, pal);
 
-			// skip colours that don't match exactly to the palette
-			col.index = pal->nearestColour(col);
-			if (!col.equals(pal->colour(col.index)))
+				i = rgba_translated.emplace(key, std::make_pair(matched, col)).first;
+			}
+			if (!i->second.first)
 				continue;
+			col = i->second.second;
 		}
 
-		col = tr->translate(col, pal);
-
 		if (truecolor)
 		{
 			q              = p * 4;
@@ -1644,37 +1676,59 @@ bool SImage::colourise(rgba_t colour, Palette* pal, int start, int stop)
 	if (has_palette_ || !pal)
 		pal = &palette_;
 
-	// Go through all pixels
-	uint8_t bpp = getBpp();
-	rgba_t  col;
-	for (int a = 0; a < width_ * height_ * bpp; a += bpp)
+	// Precalculate the weighted value of each channel level
+	double wr[256], wg[256], wb[256];
+	double grey_r = col_greyscale_r;
+	double grey_g = col_greyscale_g;
+	double grey_b = col_greyscale_b;
+	for (int c = 0; c < 256; c++)
 	{
-		// Skip colors out of range if desired
-		if (type_ == PALMASK && start >= 0 && stop >= start && stop < 256)
-		{
-			if (data_[a] < start || data_[a] > stop)
-				continue;
-		}
-
-		// Get current pixel colour
-		if (type_ == RGBA)
-			col.set(data_[a], data_[a + 1], data_[a + 2], data_[a + 3]);
-		else
-			col.set(pal->colour(data_[a]));
+		wr[c] = c * grey_r;
+		wg[c] = c * grey_g;
+		wb[c] = c * grey_b;
+	}
 
-		// Colourise it
-		float grey = (col.r * col_greyscale_r + col.g * col_greyscale_g + col.b * col_greyscale_b) / 255.0f;
+	// Colourises [col]. The weighted sum must be done in double precision,
+	// with float tables some colours come out one level off
+	auto colourised = [&](rgba_t col) {
+		float grey = (wr[col.r] + wg[col.g] + wb[col.b]) / 255.0f;
 		if (grey > 1.0)
 			grey = 1.0;
 		col.r = colour.r * grey;
 		col.g = colour.g * grey;
 		col.b = colour.b * grey;
+		return col;
+	};
 
-		// Set pixel colour
-		if (type_ == RGBA)
-			col.write(data_ + a);
+	// Truecolour, go through all pixels
+	if (type_ == RGBA)
+	{
+		rgba_t col;
+		for (int a = 0; a < width_ * height_ * 4; a += 4)
+		{
+			col.set(data_[a], data_[a + 1], data_[a + 2], data_[a + 3]);
+			colourised(col).write(data_ + a);
+		}
+
+		return true;
+	}
+
+	// Paletted, each palette index always maps to the same colour so only
+	// look up the nearest colour once per index used
+	short lut[256];
+	for (int c = 0; c < 256; c++)
+	{
+		// Skip colors out of range if desired
+		if (start >= 0 && stop >= start && stop < 256 && (c < start || c > stop))
+			lut[c] = c;
 		else
-			data_[a] = pal->nearestColour(col);
+			lut[c] = -1;
+	}
+	for (int a = 0; a < width_ * height_; a++)
+	{
+		if (lut[data_[a]] < 0)
+			lut[data_[a]] = pal->nearestColour(colourised(pal->colour(data_[a])));
+		data_[a] = lut[data_[a]];
 	}
 
 	return true;
@@ -1695,37 +1749,49 @@ bool SImage::tint(rgba_t colour, float amount, Palette* pal, int start, int stop
 	if (has_palette_ || !pal)
 		pal = &palette_;
 
-	// Go through all pixels
-	uint8_t bpp = getBpp();
-	rgba_t  col;
-	for (int a = 0; a < width_ * height_ * bpp; a += bpp)
+	// Each channel is tinted independently, so build a lookup table per channel
+	float   inv_amt = 1.0f - amount;
+	uint8_t tr[256], tg[256], tb[256];
+	for (int c = 0; c < 256; c++)
 	{
-		// Skip colors out of range if desired
-		if (type_ == PALMASK && start >= 0 && stop >= start && stop < 256)
+		tr[c] = c * inv_amt + colour.r * amount;
+		tg[c] = c * inv_amt + colour.g * amount;
+		tb[c] = c * inv_amt + colour.b * amount;
+	}
+
+	// Truecolour, go through all pixels
+	if (type_ == RGBA)
+	{
+		for (int a = 0; a < width_ * height_ * 4; a += 4)
 		{
-			if (data_[a] < start || data_[a] > stop)
-				continue;
+			data_[a]     = tr[data_[a]];
+			data_[a + 1] = tg[data_[a + 1]];
+			data_[a + 2] = tb[data_[a + 2]];
 		}
 
-		// Get current pixel colour
-		if (type_ == RGBA)
-			col.set(data_[a], data_[a + 1], data_[a + 2], data_[a + 3]);
-		else
-			col.set(pal->colour(data_[a]));
-
-		// Tint it
-		float inv_amt = 1.0f - amount;
-		col.set(
-			col.r * inv_amt + colour.r * amount,
-			col.g * inv_amt + colour.g * amount,
-			col.b * inv_amt + colour.b * amount,
-			col.a);
+		return true;
+	}
 
-		// Set pixel colour
-		if (type_ == RGBA)
-			col.write(data_ + a);
+	// Paletted, each palette index always maps to the same colour so only
+	// look up the nearest colour once per index used
+	short lut[256];
+	for (int c = 0; c < 256; c++)
+	{
+		// Skip colors out of range if desired
+		if (start >= 0 && stop >= start && stop < 256 && (c < start || c > stop))
+			lut[c] = c;
 		else
-			data_[a] = pal->nearestColour(col);
+			lut[c] = -1;
+	}
+	for (int a = 0; a < width_ * height_; a++)
+	{
+		if (lut[data_[a]] < 0)
+		{
+			rgba_t col = pal->colour(data_[a]);
+			col.set(tr[col.r], tg[col.g], tb[col.b], col.a);
+			lut[data_[a]] = pal->nearestColour(col);
+		}
+		data_[a] = lut[data_[a]];
 	}
 
 	return true;
@@ -1900,3 +1966,211 @@ bool SImage::mirrorpad()
 	}
 	return success;
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+#include "App.h"
+#include "General/Console/Console.h"
+#include "Graphics/Palette/PaletteManager.h"
+
+namespace
+{
+// Simple per-pixel versions of the truecolour image kernels, to compare against
+void refMaskFromBrightness(vector<uint8_t>& data)
+{
+	for (unsigned c = 0; c < data.size(); c += 4)
+		data[c + 3] = (double)data[c] * 0.3 + (double)data[c + 1] * 0.59 + (double)data[c + 2] * 0.11;
+}
+void refCutoffMask(vector<uint8_t>& data, uint8_t threshold)
+{
+	for (unsigned a = 3; a < data.size(); a += 4)
+	{
+		if (data[a] > threshold)
+			data[a] = 255;
+		else
+			data[a] = 0;
+	}
+}
+void refColourise(vector<uint8_t>& data, rgba_t colour)
+{
+	rgba_t col;
+	for (unsigned a = 0; a < data.size(); a += 4)
+	{
+		col.set(data[a], data[a + 1], data[a + 2], data[a + 3]);
+		float grey = (col.r * col_greyscale_r + col.g * col_greyscale_g + col.b * col_greyscale_b) / 255.0f;
+		if (grey > 1.0)
+			grey = 1.0;
+		col.r = colour.r * grey;
+		col.g = colour.g * grey;
+		col.b = colour.b * grey;
+		col.write(data.data() + a);
+	}
+}
+void refTint(vector<uint8_t>& data, rgba_t colour, float amount)
+{
+	rgba_t col;
+	for (unsigned a = 0; a < data.size(); a += 4)
+	{
+		col.set(data[a], data[a + 1], data[a + 2], data[a + 3]);
+		float inv_amt = 1.0f - amount;
+		col.set(
+			col.r * inv_amt + colour.r * amount,
+			col.g * inv_amt + colour.g * amount,
+			col.b * inv_amt + colour.b * amount,
+			col.a);
+		col.write(data.data() + a);
+	}
+}
+void refMirror(vector<uint8_t>& data, int width, int height)
+{
+	vector<uint8_t> nd(data.size());
+	int             numpixels = width * height;
+	for (int i = 0; i < numpixels; ++i)
+	{
+		int j = (((height - 1) - (i / width)) * width) + (i % width);
+		for (int k = 0; k < 4; ++k)
+			nd[(j * 4) + k] = data[(i * 4) + k];
+	}
+	data = nd;
+}
+void refRotate90(vector<uint8_t>& data, int width, int height)
+{
+	vector<uint8_t> nd(data.size());
+	int             numpixels = width * height;
+	for (int i = 0; i < numpixels; ++i)
+	{
+		int j = ((i % width) * height) + ((height - 1) - (i / width));
+		for (int k = 0; k < 4; ++k)
+			nd[(j * 4) + k] = data[(i * 4) + k];
+	}
+	data = nd;
+}
+} // namespace
+
+CONSOLE_COMMAND(test_simage_kernels, 0, false)
+{
+	long size       = 512;
+	long iterations = 20;
+	if (!args.empty())
+		args[0].ToLong(&size);
+	if (args.size() > 1)
+		args[1].ToLong(&iterations);
+
+	// Random paletted and truecolour test images
+	Palette pal;
+	pal.copyPalette(App::paletteManager()->globalPalette());
+	srand(1);
+	SImage src_pal(PALMASK);
+	src_pal.create(size, size, PALMASK, &pal);
+	for (int y = 0; y < size; y++)
+		for (int x = 0; x < size; x++)
+			src_pal.setPixel(x, y, rand() % 256, rand() % 2 ? 255 : 0);
+	auto rgba_data = new uint8_t[size * size * 4];
+	for (int a = 0; a < size * size * 4; a++)
+		rgba_data[a] = rand() % 256;
+	SImage src_rgba(RGBA);
+	src_rgba.setImageData(rgba_data, size, size, RGBA);
+	MemChunk src_rgba_mc;
+	src_rgba.getRGBAData(src_rgba_mc);
+
+	rgba_t colour(200, 100, 50, 255);
+	double mpixels = (double)size * size * iterations / 1000000.0;
+	auto   report  = [&](const string& name, long time, long time_ref, bool match) {
+		string line = S_FMT("%s: %1.1f Mpixels/s", CHR(name), mpixels * 1000.0 / std::max(time, 1l));
+		if (time_ref >= 0)
+			line += S_FMT(
+				" (per-pixel loop %1.1f Mpixels/s)%s",
+				mpixels * 1000.0 / std::max(time_ref, 1l),
+				match ? "" : " (RESULTS DIFFER)");
+		Log::console(line);
+	};
+
+	// Runs [op] on a copy of [src] [iterations] times, returning the time taken
+	SImage image;
+	auto   time_op = [&](SImage& src, const std::function<void(SImage&)>& op) {
+		long time = 0;
+		for (long a = 0; a < iterations; a++)
+		{
+			image.copyImage(&src);
+			auto start = App::runTimer();
+			op(image);
+			time += App::runTimer() - start;
+		}
+		return time;
+	};
+
+	// Runs the per-pixel [op] on the truecolour source data, returning the time
+	// taken and setting [match] if the result is the same as [image]
+	auto time_ref = [&](const std::function<void(vector<uint8_t>&)>& op, bool& match) {
+		vector<uint8_t> data;
+		long            time = 0;
+		for (long a = 0; a < iterations; a++)
+		{
+			data.assign(src_rgba_mc.getData(), src_rgba_mc.getData() + src_rgba_mc.getSize());
+			auto start = App::runTimer();
+			op(data);
+			time += App::runTimer() - start;
+		}
+
+		MemChunk result;
+		image.getRGBAData(result);
+		match = result.getSize() == data.size() && memcmp(result.getData(), data.data(), data.size()) == 0;
+		return time;
+	};
+
+	// Paletted kernels
+	MemChunk    mc;
+	Translation trans;
+	trans.parse("0:255=255:0");
+	vector<std::pair<string, std::function<void(SImage&)>>> pal_ops = {
+		{ "getRGBAData", [&](SImage& img) { img.getRGBAData(mc, &pal); } },
+		{ "maskFromBrightness", [&](SImage& img) { img.maskFromBrightness(&pal); } },
+		{ "colourise", [&](SImage& img) { img.colourise(colour, &pal); } },
+		{ "tint", [&](SImage& img) { img.tint(colour, 0.5f, &pal); } },
+		{ "applyTranslation", [&](SImage& img) { img.applyTranslation(&trans, &pal); } },
+		{ "rotate", [&](SImage& img) { img.rotate(90); } },
+		{ "mirror", [&](SImage& img) { img.mirror(true); } },
+	};
+	for (auto& op : pal_ops)
+		report(op.first + " (paletted)", time_op(src_pal, op.second), -1, true);
+
+	// Truecolour kernels, compared with simple per-pixel loops
+	struct RGBAOp
+	{
+		string                                name;
+		std::function<void(SImage&)>          op;
+		std::function<void(vector<uint8_t>&)> ref;
+	};
+	vector<RGBAOp> rgba_ops = {
+		{ "maskFromBrightness",
+		  [&](SImage& img) { img.maskFromBrightness(); },
+		  [&](vector<uint8_t>& data) { refMaskFromBrightness(data); } },
+		{ "cutoffMask",
+		  [&](SImage& img) { img.cutoffMask(128); },
+		  [&](vector<uint8_t>& data) { refCutoffMask(data, 128); } },
+		{ "colourise",
+		  [&](SImage& img) { img.colourise(colour); },
+		  [&](vector<uint8_t>& data) { refColourise(data, colour); } },
+		{ "tint",
+		  [&](SImage& img) { img.tint(colour, 0.5f); },
+		  [&](vector<uint8_t>& data) { refTint(data, colour, 0.5f); } },
+		{ "mirror",
+		  [&](SImage& img) { img.mirror(true); },
+		  [&](vector<uint8_t>& data) { refMirror(data, size, size); } },
+		{ "rotate",
+		  [&](SImage& img) { img.rotate(90); },
+		  [&](vector<uint8_t>& data) { refRotate90(data, size, size); } },
+	};
+	for (auto& op : rgba_ops)
+	{
+		bool match;
+		long time      = time_op(src_rgba, op.op);
+		long time_loop = time_ref(op.ref, match);
+		report(op.name, time, time_loop, match);
+	}
+}
@@ -171,9 +171,9 @@ void Translation::parse(string def)
 	Tokenizer tz;
 	tz.setSpecialCharacters(",");
 	tz.openString(def);
-	parseRange(tz.current().text);
+	parseRange(tz.current().text());
 	while (tz.advIfNext(','))
-		parseRange(tz.next().text);
+		parseRange(tz.next().text());
 }
 
 // -----------------------------------------------------------------------------
@@ -370,7 +370,7 @@ void Translation::parseRange(string range)
 		TransRangeSpecial* tr = new TransRangeSpecial();
 		tr->o_start_          = o_start;
 		tr->o_end_            = o_end;
-		tr->special_          = tz.next().text; // special;
+		tr->special_          = tz.next().text(); // special;
 		translations_.push_back(tr);
 	}
 	else
@@ -38,12 +38,12 @@
 #include "General/ResourceManager.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "MainEditor/MainEditor.h"
+#include "MainEditor/MapResourceIndex.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "MapEditor/SLADEMap/MapLine.h"
 #include "MapEditor/SLADEMap/MapSector.h"
 #include "MapEditor/SLADEMap/MapSide.h"
 #include "MapEditor/SLADEMap/MapThing.h"
-#include "Utility/Tokenizer.h"
 
 
 // -----------------------------------------------------------------------------
@@ -53,7 +53,30 @@
 // -----------------------------------------------------------------------------
 typedef std::map<string, int>                   StrIntMap;
 typedef std::map<string, vector<ArchiveEntry*>> PathMap;
-typedef std::map<int, vector<ArchiveEntry*>>    CRCMap;
+typedef MapResourceIndex::Type                  MapResource;
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the map resource index for [archive]. If it isn't open in the archive
+// manager (so has no shared index), [local] is updated for it and returned
+// -----------------------------------------------------------------------------
+MapResourceIndex& mapResourceIndex(Archive* archive, MapResourceIndex& local)
+{
+	auto index = MapResourceIndex::forArchive(archive);
+	if (index)
+		return *index;
+
+	local.update(archive);
+	return local;
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -262,7 +285,10 @@ void ArchiveOperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 	string                 dups  = "";
 	size_t                 count = 0;
 
-	// Go through list
+	// Go through list, finding counterparts in the IWAD. Only entries with the
+	// same size can be identical
+	vector<std::pair<ArchiveEntry*, ArchiveEntry*>> counterparts;
+	vector<ArchiveEntry*>                           to_hash;
 	for (unsigned a = 0; a < entries.size(); a++)
 	{
 		// Skip directory entries
@@ -278,13 +304,23 @@ void ArchiveOperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 		search.match_name      = entries[a]->getName();
 		other                  = bra->findLast(search);
 
-		// If there is one, and it is identical, remove it
-		if (other != nullptr && (other->getMCData().crc() == entries[a]->getMCData().crc()))
+		if (other != nullptr && other->getSize() == entries[a]->getSize())
+		{
+			counterparts.push_back({ entries[a], other });
+			to_hash.push_back(entries[a]);
+			to_hash.push_back(other);
+		}
+	}
+
+	// If any are identical, remove them
+	ArchiveEntry::computeContentHashes(to_hash);
+	for (auto& pair : counterparts)
+	{
+		if (pair.first->sameData(pair.second))
 		{
 			++count;
-			dups += S_FMT("%s\n", search.match_name);
-			archive->removeEntry(entries[a]);
-			entries[a] = nullptr;
+			dups += S_FMT("%s\n", pair.first->getName());
+			archive->removeEntry(pair.first);
 		}
 	}
 
@@ -314,14 +350,13 @@ void ArchiveOperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 // -----------------------------------------------------------------------------
 bool ArchiveOperations::checkDuplicateEntryContent(Archive* archive)
 {
-	CRCMap map_entries;
-
 	// Get list of all entries in archive
 	vector<ArchiveEntry*> entries;
 	archive->getEntryTreeAsList(entries);
 	string dups = "";
 
 	// Go through list
+	vector<ArchiveEntry*> to_check;
 	for (unsigned a = 0; a < entries.size(); a++)
 	{
 		// Skip directory entries
@@ -332,29 +367,21 @@ bool ArchiveOperations::checkDuplicateEntryContent(Archive* archive)
 		if (entries[a]->getType() == EntryType::mapMarkerType() || entries[a]->getSize() == 0)
 			continue;
 
-		// Enqueue entries
-		map_entries[entries[a]->getMCData().crc()].push_back(entries[a]);
+		to_check.push_back(entries[a]);
 	}
 
 	// Now iterate through the dupes to list the name of the duplicated entries
-	CRCMap::iterator i = map_entries.begin();
-	while (i != map_entries.end())
+	for (auto& group : ArchiveEntry::findDuplicateData(to_check))
 	{
-		if (i->second.size() > 1)
+		string name = group[0]->getPath(true);
+		name.Remove(0, 1);
+		dups += S_FMT("\n%s\t(%016llx) duplicated by", name, (unsigned long long)group[0]->contentHash());
+		for (unsigned a = 1; a < group.size(); a++)
 		{
-			string name = i->second[0]->getPath(true);
+			name = group[a]->getPath(true);
 			name.Remove(0, 1);
-			dups += S_FMT("\n%s\t(%8x) duplicated by", name, i->first);
-			vector<ArchiveEntry*>::iterator j = i->second.begin() + 1;
-			while (j != i->second.end())
-			{
-				name = (*j)->getPath(true);
-				name.Remove(0, 1);
-				dups += S_FMT("\t%s", name);
-				++j;
-			}
+			dups += S_FMT("\t%s", name);
 		}
-		++i;
 	}
 
 	// If no duplicates exist, do nothing
@@ -394,100 +421,20 @@ string flat_anim_end[] = {
 	"NUKAGE3", "FWATER4", "SWATER4", "LAVA4", "BLOOD3", "RROCK08", "SLIME04", "SLIME08", "SLIME12",
 };
 
-struct texused_t
-{
-	bool used;
-	texused_t() { used = false; }
-};
-WX_DECLARE_STRING_HASH_MAP(texused_t, TexUsedMap);
 void ArchiveOperations::removeUnusedTextures(Archive* archive)
 {
 	// Check archive was given
 	if (!archive)
 		return;
 
-	// --- Build list of used textures ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SIDEDEFS entries
-	Archive::SearchOptions opt;
-	opt.match_type                 = EntryType::fromId("map_sidedefs");
-	vector<ArchiveEntry*> sidedefs = archive->findAll(opt);
-	total_maps += sidedefs.size();
-
-	// Go through and add used textures to list
-	MapSide::DoomData sdef;
-	string            tex_lower, tex_middle, tex_upper;
-	for (unsigned a = 0; a < sidedefs.size(); a++)
-	{
-		int nsides = sidedefs[a]->getSize() / 30;
-		sidedefs[a]->seek(0, SEEK_SET);
-		for (int s = 0; s < nsides; s++)
-		{
-			// Read side data
-			sidedefs[a]->read(&sdef, 30);
-
-			// Get textures
-			tex_lower  = wxString::FromAscii(sdef.tex_lower, 8);
-			tex_middle = wxString::FromAscii(sdef.tex_middle, 8);
-			tex_upper  = wxString::FromAscii(sdef.tex_upper, 8);
-
-			// Add to used textures list
-			used_textures[tex_lower].used  = true;
-			used_textures[tex_middle].used = true;
-			used_textures[tex_upper].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name                 = "TEXTMAP";
-	opt.match_type                 = EntryType::fromId("udmf_textmap");
-	vector<ArchiveEntry*> udmfmaps = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used textures to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (unsigned a = 0; a < udmfmaps.size(); a++)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmaps[a]->getMCData(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		string token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sidedef definition
-			if (token == "sidedef")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturetop" || token == "texturemiddle" || token == "texturebottom")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
-
-	// Check if any maps were found
-	if (total_maps == 0)
+	// Get used textures from all maps
+	MapResourceIndex local_index;
+	auto&            index = mapResourceIndex(archive, local_index);
+	if (index.nMaps() == 0)
 		return;
 
 	// Find all TEXTUREx entries
-	opt.match_name                   = "";
+	Archive::SearchOptions opt;
 	opt.match_type                   = EntryType::fromId("texturex");
 	vector<ArchiveEntry*> tx_entries = archive->findAll(opt);
 
@@ -528,7 +475,7 @@ void ArchiveOperations::removeUnusedTextures(Archive* archive)
 			}
 
 			// Mark if unused and not part of an animation
-			if (!used_textures[texname].used && !anim && !thisend)
+			if (!index.used(MapResource::Texture, texname) && !anim && !thisend)
 				unused_tex.Add(txlist.getTexture(t)->getName());
 		}
 	}
@@ -567,7 +514,7 @@ void ArchiveOperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW1", "SW2", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (index.used(MapResource::Texture, swname))
 				swtex = true;
 		}
 		else if (unused_tex[a].StartsWith("SW2"))
@@ -577,7 +524,7 @@ void ArchiveOperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW2", "SW1", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (index.used(MapResource::Texture, swname))
 				swtex = true;
 		}
 
@@ -638,88 +585,15 @@ void ArchiveOperations::removeUnusedFlats(Archive* archive)
 	if (!archive)
 		return;
 
-	// --- Build list of used flats ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SECTORS entries
-	Archive::SearchOptions opt;
-	opt.match_type                = EntryType::fromId("map_sectors");
-	vector<ArchiveEntry*> sectors = archive->findAll(opt);
-	total_maps += sectors.size();
-
-	// Go through and add used flats to list
-	MapSector::DoomData sec;
-	string              tex_floor, tex_ceil;
-	for (unsigned a = 0; a < sectors.size(); a++)
-	{
-		int nsec = sectors[a]->getSize() / 26;
-		sectors[a]->seek(0, SEEK_SET);
-		for (int s = 0; s < nsec; s++)
-		{
-			// Read sector data
-			sectors[a]->read(&sec, 26);
-
-			// Get textures
-			tex_floor = wxString::FromAscii(sec.f_tex, 8);
-			tex_ceil  = wxString::FromAscii(sec.c_tex, 8);
-
-			// Add to used textures list
-			used_textures[tex_floor].used = true;
-			used_textures[tex_ceil].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name                 = "TEXTMAP";
-	opt.match_type                 = EntryType::fromId("udmf_textmap");
-	vector<ArchiveEntry*> udmfmaps = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used flats to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (unsigned a = 0; a < udmfmaps.size(); a++)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmaps[a]->getMCData(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		string token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sector definition
-			if (token == "sector")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturefloor" || token == "textureceiling")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
-
-	// Check if any maps were found
-	if (total_maps == 0)
+	// Get used flats from all maps
+	MapResourceIndex local_index;
+	auto&            index = mapResourceIndex(archive, local_index);
+	if (index.nMaps() == 0)
 		return;
 
 	// Find all flats
-	opt.match_name              = "";
+	Archive::SearchOptions opt;
 	opt.match_namespace         = "flats";
-	opt.match_type              = nullptr;
 	vector<ArchiveEntry*> flats = archive->findAll(opt);
 
 	// Create list of all unused flats
@@ -757,7 +631,7 @@ void ArchiveOperations::removeUnusedFlats(Archive* archive)
 		}
 
 		// Add if not animated
-		if (!used_textures[flatname].used && !anim && !thisend)
+		if (!index.used(MapResource::Flat, flatname) && !anim && !thisend)
 			unused_tex.Add(flatname);
 	}
 
@@ -915,12 +789,16 @@ size_t ArchiveOperations::replaceThings(Archive* archive, int oldtype, int newty
 	// Get all maps
 	vector<Archive::MapDesc> maps   = archive->detectMaps();
 	string                   report = "";
+	auto                     index  = MapResourceIndex::forArchive(archive);
 
 	for (size_t a = 0; a < maps.size(); ++a)
 	{
 		size_t achanged = 0;
+		// Skip maps that don't use the thing type
+		if (index && !index->headUses(maps[a].head, MapResource::ThingType, oldtype))
+			achanged = 0;
 		// Is it an embedded wad?
-		if (maps[a].archive)
+		else if (maps[a].archive)
 		{
 			// Attempt to open entry as wad archive
 			Archive* temp_archive = new WadArchive();
@@ -1193,13 +1071,13 @@ size_t replaceSpecialsHexen(
 		// Perform replacement
 		for (size_t t = 0; t < numthings; ++t)
 		{
-			if (things[t].type == oldtype)
+			if (things[t].special == oldtype)
 			{
 				if ((!arg0 || things[t].args[0] == oldarg0) && (!arg1 || things[t].args[1] == oldarg1)
 					&& (!arg2 || things[t].args[2] == oldarg2) && (!arg3 || things[t].args[3] == oldarg3)
 					&& (!arg4 || things[t].args[4] == oldarg4))
 				{
-					things[t].type = newtype;
+					things[t].special = newtype;
 					if (arg0)
 						things[t].args[0] = newarg0;
 					if (arg1)
@@ -1287,12 +1165,17 @@ size_t ArchiveOperations::replaceSpecials(
 	// Get all maps
 	vector<Archive::MapDesc> maps   = archive->detectMaps();
 	string                   report = "";
+	auto                     index  = MapResourceIndex::forArchive(archive);
 
 	for (size_t a = 0; a < maps.size(); ++a)
 	{
 		size_t achanged = 0;
+		// Skip maps that don't use the special
+		if (index && !(lines && index->headUses(maps[a].head, MapResource::LineSpecial, oldtype))
+			&& !(things && index->headUses(maps[a].head, MapResource::ThingSpecial, oldtype)))
+			achanged = 0;
 		// Is it an embedded wad?
-		if (maps[a].archive)
+		else if (maps[a].archive)
 		{
 			// Attempt to open entry as wad archive
 			Archive* temp_archive = new WadArchive();
@@ -1529,6 +1412,47 @@ bool replaceTextureString(char* str, string oldtex, string newtex)
 	}
 	return go;
 }
+// -----------------------------------------------------------------------------
+// Returns true if any map in [index] with [head] as its head entry might use a
+// texture of [type] that matches [oldtex] (see replaceTextureString)
+// -----------------------------------------------------------------------------
+bool mapUsesTexture(const MapResourceIndex& index, ArchiveEntry* head, MapResource type, string oldtex)
+{
+	// Check for an exact match if possible
+	if (oldtex.Length() == 8 && !oldtex.Contains("?") && !oldtex.Contains("*"))
+		return index.headUses(head, type, oldtex);
+
+	string pattern = oldtex.Upper();
+	bool found = false;
+	for (unsigned a = 0; a < index.nMaps(); a++)
+	{
+		auto& map = index.map(a);
+		if (map.head != head)
+			continue;
+
+		// Doom 64 maps only store name hashes
+		if (map.format == MAP_DOOM64 || !map.usage)
+			return true;
+
+		found = true;
+		for (auto& used : map.usage->names[(unsigned)type])
+		{
+			bool match = true;
+			for (unsigned c = 0; c < pattern.Length() && match; ++c)
+			{
+				if (pattern[c] == '*')
+					break;
+				char used_c = c < used.first.size() ? used.first[c] : 0;
+				if (pattern[c] != '?' && pattern[c] != used_c)
+					match = false;
+			}
+			if (match)
+				return true;
+		}
+	}
+
+	return !found;
+}
 size_t replaceFlatsDoomHexen(ArchiveEntry* entry, string oldtex, string newtex, bool floor, bool ceiling)
 {
 	if (entry == nullptr)
@@ -1720,12 +1644,17 @@ size_t ArchiveOperations::replaceTextures(
 	// Get all maps
 	vector<Archive::MapDesc> maps   = archive->detectMaps();
 	string                   report = "";
+	auto                     index  = MapResourceIndex::forArchive(archive);
 
 	for (size_t a = 0; a < maps.size(); ++a)
 	{
 		size_t achanged = 0;
+		// Skip maps that don't use any matching texture
+		if (index && !((floor || ceiling) && mapUsesTexture(*index, maps[a].head, MapResource::Flat, oldtex))
+			&& !((lower || middle || upper) && mapUsesTexture(*index, maps[a].head, MapResource::Texture, oldtex)))
+			achanged = 0;
 		// Is it an embedded wad?
-		if (maps[a].archive)
+		else if (maps[a].archive)
 		{
 			// Attempt to open entry as wad archive
 			Archive* temp_archive = new WadArchive();
@@ -133,58 +133,12 @@ namespace Conversions
 // -----------------------------------------------------------------------------
 // Converts a 16-bit signed sample to an 8-bit unsigned one.
 // -----------------------------------------------------------------------------
-uint8_t pcm16to8bits(int16_t val)
+inline uint8_t pcm16to8bits(int16_t val)
 {
-	// Value is in the [-32768, 32767] range.
-	// Shift it eight bits to [-128, 127] range,
-	// and add 128 to put it in [0, 255] range.
-	uint8_t ret = 128 + (val >> 8);
-	// Round value up or down depending on value
-	// of shifted-off bits.
-	if ((val & 0x80FF) > 127)
-		ret++;
-	else if ((val & 0x80FF) < -128)
-		ret--;
-	// Send it.
-	return ret;
-}
-
-// -----------------------------------------------------------------------------
-// Converts a 24-bit signed sample to an 8-bit unsigned one.
-// -----------------------------------------------------------------------------
-uint8_t pcm24to8bits(int32_t val)
-{
-	int16_t ret = (val >> 8);
-	if ((val & 0x8000FF) > 127)
-		ret++;
-	else if ((val & 0x8000FF) < -128)
-		ret--;
-	return pcm16to8bits(ret);
-}
-
-// -----------------------------------------------------------------------------
-// Converts a 32-bit signed sample to an 8-bit unsigned one.
-// -----------------------------------------------------------------------------
-uint8_t pcm32to8bits(int32_t val)
-{
-	int32_t ret = (val >> 8);
-	if ((val & 0x800000FF) > 127)
-		ret++;
-	else if ((val & 0x800000FF) < -128)
-		ret--;
-	return pcm24to8bits(ret);
-}
-
-// -----------------------------------------------------------------------------
-// Averages the values of two eight-bit unsigned samples into one.
-// -----------------------------------------------------------------------------
-uint8_t stereoToMono(uint8_t left, uint8_t right)
-{
-	uint16_t val = left + right;
-	val /= 2;
-	if (val > 255)
-		val = 255;
-	return (uint8_t)val;
+	// Value is in the [-32768, 32767] range. Shift it eight bits (rounding to
+	// the nearest value) to the [-128, 127] range, and add 128 to put it in
+	// the [0, 255] range.
+	return (uint8_t)(std::min((val + 0x80) >> 8, 127) + 128);
 }
 
 // The following two functions are adapted from Sun Microsystem's g711.cpp code.
@@ -230,6 +184,209 @@ int16_t mulawToLinear(uint8_t ulaw)
 
 	return ((ulaw & SIGN_BIT) ? (BIAS - t) : (t - BIAS));
 }
+
+// -----------------------------------------------------------------------------
+// Converts [count] [bytes]-byte signed little endian PCM samples in [in] to
+// 8-bit unsigned samples in [out]. Only the top 16 bits of each sample are
+// needed for this
+// -----------------------------------------------------------------------------
+template<unsigned bytes> void pcmTo8bits(const uint8_t* in, uint8_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = pcm16to8bits((int16_t)(in[i * bytes + bytes - 2] | (in[i * bytes + bytes - 1] << 8)));
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] 8-bit A-law (or µ-law if [alaw] is false) samples in [in] to
+// 8-bit unsigned samples in [out]
+// -----------------------------------------------------------------------------
+void lawTo8bits(const uint8_t* in, uint8_t* out, size_t count, bool alaw)
+{
+	// Conversion tables for every possible sample value
+	struct LawTables
+	{
+		uint8_t alaw[256];
+		uint8_t ulaw[256];
+		LawTables()
+		{
+			for (unsigned a = 0; a < 256; ++a)
+			{
+				alaw[a] = pcm16to8bits(alawToLinear(a));
+				ulaw[a] = pcm16to8bits(mulawToLinear(a));
+			}
+		}
+	};
+	static const LawTables tables;
+
+	const uint8_t* table = alaw ? tables.alaw : tables.ulaw;
+	for (size_t i = 0; i < count; ++i)
+		out[i] = table[in[i]];
+}
+
+// -----------------------------------------------------------------------------
+// Averages [count] pairs of eight-bit unsigned stereo samples in [in] into
+// mono samples in [out]
+// -----------------------------------------------------------------------------
+void stereoToMono(const uint8_t* in, uint8_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = (in[i * 2] + in[i * 2 + 1]) >> 1;
+}
+
+// -----------------------------------------------------------------------------
+// Copies [count] [bytes]-byte samples in [in] to [out], reversing the byte
+// order of each
+// -----------------------------------------------------------------------------
+template<unsigned bytes> void swapSamples(const uint8_t* in, uint8_t* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		for (unsigned b = 0; b < bytes; ++b)
+			out[i * bytes + b] = in[i * bytes + bytes - 1 - b];
+}
+
+// -----------------------------------------------------------------------------
+// Returns a PCM wav fmt chunk for the given sample format
+// -----------------------------------------------------------------------------
+WavFmtChunk wavFormat(uint32_t samplerate, uint16_t channels = 1, uint16_t bps = 8)
+{
+	WavFmtChunk fmtchunk;
+	memcpy(&fmtchunk.header.id, "fmt ", 4);
+	fmtchunk.header.size = 16;
+	fmtchunk.tag         = 1;
+	fmtchunk.channels    = channels;
+	fmtchunk.samplerate  = samplerate;
+	fmtchunk.blocksize   = channels * (bps / 8);
+	fmtchunk.datarate    = samplerate * fmtchunk.blocksize;
+	fmtchunk.bps         = bps;
+	return fmtchunk;
+}
+
+// -----------------------------------------------------------------------------
+// Sets [out] to a wav with the format [fmtchunk] and [size] bytes of (for now
+// uninitialised) sample data. Returns a pointer to the sample data in [out] to
+// be filled in.
+//
+// The whole wav is allocated at once, rather than growing [out] for each write
+// -----------------------------------------------------------------------------
+uint8_t* writeWavHeader(MemChunk& out, const WavFmtChunk& fmtchunk, uint32_t size)
+{
+	// Data must end on even byte boundary
+	uint32_t padded = size + (size % 2);
+	uint32_t offset = 12 + sizeof(WavFmtChunk) + 8;
+	out.reSize(offset + padded, false);
+	uint8_t* data = &out[0];
+
+	// Main header
+	WavChunk whdr;
+	memcpy(&whdr.id, "RIFF", 4);
+	whdr.size = 4 + sizeof(WavFmtChunk) + 8 + padded;
+	memcpy(data, &whdr, 8);
+	memcpy(data + 8, "WAVE", 4);
+
+	// Fmt chunk
+	memcpy(data + 12, &fmtchunk, sizeof(WavFmtChunk));
+
+	// Data header
+	WavChunk wdhdr;
+	memcpy(&wdhdr.id, "data", 4);
+	wdhdr.size = size;
+	memcpy(data + 12 + sizeof(WavFmtChunk), &wdhdr, 8);
+
+	if (padded != size)
+		data[offset + size] = 0;
+	out.seek(out.getSize(), SEEK_SET);
+
+	return data + offset;
+}
+
+// -----------------------------------------------------------------------------
+// Writes a wav with the format [fmtchunk] and sample data [samples] of [size]
+// bytes to [out]
+// -----------------------------------------------------------------------------
+void writeWav(MemChunk& out, const WavFmtChunk& fmtchunk, const uint8_t* samples, uint32_t size)
+{
+	memcpy(writeWavHeader(out, fmtchunk, size), samples, size);
+}
+
+// Info about the sample data in a wav
+struct WavInfo
+{
+	WavFmtChunk fmtchunk;
+	uint8_t     format;
+	uint8_t     bps; // Bytes per sample
+	size_t      data_offset;
+	uint32_t    data_size;
+};
+
+// -----------------------------------------------------------------------------
+// Reads the format and location of the sample data of the wav in [in] to
+// [info]. Returns false if [in] isn't a valid wav, or can't be converted to
+// doom sound
+// -----------------------------------------------------------------------------
+bool readWavInfo(MemChunk& in, WavInfo& info)
+{
+	// Check header
+	if (in.getSize() < 12 || memcmp(in.getData(), "RIFF", 4) != 0)
+	{
+		Global::error = "Invalid WAV";
+		return false;
+	}
+
+	// Check format
+	if (memcmp(in.getData() + 8, "WAVE", 4) != 0)
+	{
+		Global::error = "Invalid WAV format";
+		return false;
+	}
+
+	// Find fmt chunk
+	size_t ofs = 12;
+	while (ofs + 8 <= in.getSize() && memcmp(in.getData() + ofs, "fmt ", 4) != 0)
+		ofs += 8 + (uint32_t)READ_L32(in, (ofs + 4));
+
+	// Read fmt chunk
+	if (ofs + sizeof(WavFmtChunk) > in.getSize())
+	{
+		Global::error = "Invalid WAV: no 'fmt ' chunk";
+		return false;
+	}
+	memcpy(&info.fmtchunk, in.getData() + ofs, sizeof(WavFmtChunk));
+
+	// Get format
+	if (info.fmtchunk.tag == 0xFFFE)
+		info.format = ofs + 36 <= in.getSize() ? READ_L32(in, ofs + 32) : 0;
+	else
+		info.format = info.fmtchunk.tag;
+	// Get byte per samples (from bits per sample)
+	info.bps = info.fmtchunk.bps / 8;
+
+	// Check fmt chunk values
+	if (info.fmtchunk.channels == 0 || info.fmtchunk.channels > 2 || info.fmtchunk.bps % 8 || info.bps == 0
+		|| info.bps > 4 || (info.format != WAV_PCM && info.format != WAV_ALAW && info.format != WAV_ULAW)
+		|| (info.format != WAV_PCM && info.bps != 1))
+	{
+		Global::error = "Cannot convert WAV file, only stereo or monophonic sounds in PCM format can be converted";
+		return false;
+	}
+
+	// Find data chunk
+	ofs += 8 + wxUINT32_SWAP_ON_BE(info.fmtchunk.header.size);
+	while (ofs + 8 <= in.getSize() && memcmp(in.getData() + ofs, "data", 4) != 0)
+		ofs += 8 + (uint32_t)READ_L32(in, (ofs + 4));
+
+	if (ofs + 8 > in.getSize())
+	{
+		Global::error = "Invalid WAV: no 'data' chunk";
+		return false;
+	}
+
+	// Get data (ignoring any partial sample frame at the end)
+	info.data_offset = ofs + 8;
+	info.data_size   = std::min<size_t>(READ_L32(in, ofs + 4), in.getSize() - info.data_offset);
+	info.data_size -= info.data_size % (info.bps * info.fmtchunk.channels);
+
+	return true;
+}
 } // namespace Conversions
 
 // -----------------------------------------------------------------------------
@@ -241,8 +398,12 @@ bool Conversions::doomSndToWav(MemChunk& in, MemChunk& out)
 
 	// Read doom sound header
 	DSndHeader header;
-	in.seek(0, SEEK_SET);
-	in.read(&header, 8);
+	if (in.getSize() < 8)
+	{
+		Global::error = "Invalid Doom Sound";
+		return false;
+	}
+	memcpy(&header, in.getData(), 8);
 
 	// Some sounds created on Mac platforms have their identifier and samplerate in BE format.
 	// Curiously, the number of samples is still in LE format.
@@ -264,9 +425,8 @@ bool Conversions::doomSndToWav(MemChunk& in, MemChunk& out)
 		return false;
 	}
 
-	// Read samples
-	uint8_t* samples = new uint8_t[header.samples];
-	in.read(samples, header.samples);
+	// Samples are read directly from the input data
+	const uint8_t* samples = in.getData() + 8;
 
 	// Detect if DMX padding is present
 	// It was discovered ca. 2013 that the original DMX sound format used in Doom
@@ -296,110 +456,39 @@ bool Conversions::doomSndToWav(MemChunk& in, MemChunk& out)
 
 	// --- Write WAV ---
 
-	WavChunk    whdr, wdhdr;
-	WavFmtChunk fmtchunk;
-
-	// Setup data header
-	char did[4] = { 'd', 'a', 't', 'a' };
-	memcpy(&wdhdr.id, &did, 4);
-	wdhdr.size = header.samples;
-
-	// Setup fmt chunk
-	char fid[4] = { 'f', 'm', 't', ' ' };
-	memcpy(&fmtchunk.header.id, &fid, 4);
-	fmtchunk.header.size = 16;
-	fmtchunk.tag         = 1;
-	fmtchunk.channels    = 1;
-	fmtchunk.samplerate  = header.samplerate;
-	fmtchunk.datarate    = header.samplerate;
-	fmtchunk.blocksize   = 1;
-	fmtchunk.bps         = 8;
-
-	// Setup main header
-	char wid[4] = { 'R', 'I', 'F', 'F' };
-	memcpy(&whdr.id, &wid, 4);
-	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
-
-	// Write chunks
-	out.write(&whdr, 8);
-	out.write("WAVE", 4);
-	out.write(&fmtchunk, sizeof(WavFmtChunk));
-	out.write(&wdhdr, 8);
-	out.write(samples + samples_offset, header.samples);
-
-	// Ensure data ends on even byte boundary
-	if (header.samples % 2 != 0)
-		out.write("\0", 1);
-
-	delete[] samples;
+	writeWav(out, wavFormat(header.samplerate), samples + samples_offset, header.samples);
 
 	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Converts wav data [in] to doom sound format, written to [out]
+// Returns true if converting the wav data [in] to doom sound would lose audio
+// quality (ie. it isn't 8-bit mono PCM). Also returns false if [in] can't be
+// converted at all
 // -----------------------------------------------------------------------------
-bool Conversions::wavToDoomSnd(MemChunk& in, MemChunk& out)
+bool Conversions::wavToDoomSndIsLossy(MemChunk& in)
 {
-	// --- Read WAV ---
-	WavChunk chunk;
-
-	// Read header
-	in.seek(0, SEEK_SET);
-	in.read(&chunk, 8);
-
-	// Check header
-	if (chunk.id[0] != 'R' || chunk.id[1] != 'I' || chunk.id[2] != 'F' || chunk.id[3] != 'F')
-	{
-		Global::error = "Invalid WAV";
-		return false;
-	}
-
-	// Read format
-	char format[4];
-	in.read(format, 4);
-
-	// Check format
-	if (format[0] != 'W' || format[1] != 'A' || format[2] != 'V' || format[3] != 'E')
-	{
-		Global::error = "Invalid WAV format";
-		return false;
-	}
-
-	// Find fmt chunk
-	size_t ofs = 12;
-	while (ofs < in.getSize())
-	{
-		if (in[ofs] == 'f' && in[ofs + 1] == 'm' && in[ofs + 2] == 't' && in[ofs + 3] == ' ')
-			break;
-		ofs += 8 + READ_L32(in, (ofs + 4));
-	}
-
-	// Read fmt chunk
-	if (ofs + sizeof(WavFmtChunk) > in.getSize())
-	{
-		Global::error = "Invalid WAV: no 'fmt ' chunk";
+	WavInfo info;
+	if (!readWavInfo(in, info))
 		return false;
-	}
-	in.seek(ofs, SEEK_SET);
-	WavFmtChunk fmtchunk;
-	in.read(&fmtchunk, sizeof(WavFmtChunk));
 
-	// Get format
-	uint8_t wavfmt = fmtchunk.tag == 0xFFFE ? READ_L32(in, ofs + 32) : fmtchunk.tag;
-	// Get byte per samples (from bits per sample)
-	uint8_t wavbps = fmtchunk.bps / 8;
+	return info.bps > 1 || info.format != WAV_PCM || info.fmtchunk.channels == 2;
+}
 
-	// Check fmt chunk values
-	if (fmtchunk.channels > 2 || fmtchunk.bps % 8 || wavbps > 4
-		|| (wavfmt != WAV_PCM && wavfmt != WAV_ALAW && wavfmt != WAV_ULAW))
-	{
-		Global::error = "Cannot convert WAV file, only stereo or monophonic sounds in PCM format can be converted";
+// -----------------------------------------------------------------------------
+// Converts wav data [in] to doom sound format, written to [out]. If
+// [confirm_lossy] is true, the user is asked to confirm the conversion first if
+// it will lose audio quality (see wavToDoomSndIsLossy)
+// -----------------------------------------------------------------------------
+bool Conversions::wavToDoomSnd(MemChunk& in, MemChunk& out, bool confirm_lossy)
+{
+	// --- Read WAV ---
+	WavInfo info;
+	if (!readWavInfo(in, info))
 		return false;
-	}
 
 	// Warn
-	if (wavbps > 1 || wavfmt != WAV_PCM || fmtchunk.channels == 2)
+	if (confirm_lossy && (info.bps > 1 || info.format != WAV_PCM || info.fmtchunk.channels == 2))
 	{
 		if (!(wxMessageBox(
 				  S_FMT(
@@ -413,95 +502,59 @@ bool Conversions::wavToDoomSnd(MemChunk& in, MemChunk& out)
 		}
 	}
 
-	// Find data chunk
-	ofs += 8 + wxUINT32_SWAP_ON_BE(fmtchunk.header.size);
-	while (ofs < in.getSize())
-	{
-		if (in[ofs] == 'd' && in[ofs + 1] == 'a' && in[ofs + 2] == 't' && in[ofs + 3] == 'a')
-			break;
-		ofs += 8 + READ_L32(in, (ofs + 4));
-	}
-
-	// Read data
-	if (ofs + sizeof(WavFmtChunk) > in.getSize())
+	// Nothing to convert
+	size_t n_samples = info.data_size / info.bps;
+	size_t n_frames  = n_samples / info.fmtchunk.channels;
+	if (n_frames == 0)
 	{
-		Global::error = "Invalid WAV: no 'data' chunk";
+		Global::error = "Invalid WAV: no sample data";
 		return false;
 	}
-	in.seek(ofs, SEEK_SET);
-	in.read(&chunk, 8);
-
-	if (wavbps > 1)
-		chunk.size /= wavbps;
-
-	uint8_t* data = new uint8_t[chunk.size];
-	uint8_t  padding[16];
-
-	// Store sample data. A simple read for 8 bits per sample.
-	if (fmtchunk.bps == 8)
-		in.read(data, chunk.size);
-	// For 16, 24, or 32 bits per sample, downsample to 8.
-	else
-	{
-		int32_t val = 0;
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			in.read(&val, wavbps);
-			if (wavbps == 4)
-				data[i] = pcm32to8bits(val);
-			else if (wavbps == 3)
-				data[i] = pcm24to8bits(val);
-			else if (wavbps == 2)
-				data[i] = pcm16to8bits((int16_t)val);
-		}
-	}
-
-	// Convert A-law or µ-law to 8-bit linear
-	if (wavfmt == WAV_ALAW || wavfmt == WAV_ULAW)
-	{
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			int16_t val = (wavfmt == WAV_ALAW) ? alawToLinear(data[i]) : mulawToLinear(data[i]);
-			data[i]     = pcm16to8bits(val);
-		}
-	}
-
-	// Merge stereo channels into a single mono one
-	if (fmtchunk.channels == 2)
-	{
-		chunk.size /= 2;
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			size_t j = 2 * i;
-			data[i]  = stereoToMono(data[j], data[j + 1]);
-		}
-	}
 
 	// --- Write Doom Sound ---
 
+	// Allocate output (header, sample data and padding)
+	size_t padding = dmx_padding ? 16 : 0;
+	out.reSize(8 + n_frames + padding * 2, false);
+	uint8_t* data = &out[0];
+
 	// Write header
 	DSndHeader ds_hdr;
 	ds_hdr.three      = 3;
-	ds_hdr.samplerate = fmtchunk.samplerate;
-	ds_hdr.samples    = chunk.size;
-	if (dmx_padding)
-		ds_hdr.samples += 32;
-	out.write(&ds_hdr, 8);
-
-	// Write data
-	if (dmx_padding)
+	ds_hdr.samplerate = info.fmtchunk.samplerate;
+	ds_hdr.samples    = n_frames + padding * 2;
+	memcpy(data, &ds_hdr, 8);
+
+	// Convert samples to 8-bit unsigned PCM. Stereo sounds are converted to a
+	// temporary buffer first and then merged into a single mono channel
+	const uint8_t*  src = in.getData() + info.data_offset;
+	uint8_t*        dst = data + 8 + padding;
+	vector<uint8_t> stereo;
+	if (info.fmtchunk.channels == 2)
 	{
-		memset(padding, data[0], 16);
-		out.write(padding, 16);
+		stereo.resize(n_samples);
+		dst = stereo.data();
 	}
-	out.write(data, chunk.size);
-	if (dmx_padding)
+	if (info.format == WAV_ALAW || info.format == WAV_ULAW)
+		lawTo8bits(src, dst, n_samples, info.format == WAV_ALAW);
+	else if (info.bps == 1)
+		memcpy(dst, src, n_samples);
+	else if (info.bps == 2)
+		pcmTo8bits<2>(src, dst, n_samples);
+	else if (info.bps == 3)
+		pcmTo8bits<3>(src, dst, n_samples);
+	else
+		pcmTo8bits<4>(src, dst, n_samples);
+	if (info.fmtchunk.channels == 2)
+		stereoToMono(stereo.data(), data + 8 + padding, n_frames);
+
+	// Write padding
+	if (padding)
 	{
-		memset(padding, data[chunk.size - 1], 16);
-		out.write(padding, 16);
+		memset(data + 8, data[8 + padding], padding);
+		memset(data + 8 + padding + n_frames, data[8 + padding + n_frames - 1], padding);
 	}
-
-	delete[] data;
+	out.seek(out.getSize(), SEEK_SET);
 
 	return true;
 }
@@ -511,6 +564,10 @@ bool Conversions::wavToDoomSnd(MemChunk& in, MemChunk& out)
 // -----------------------------------------------------------------------------
 bool Conversions::musToMidi(MemChunk& in, MemChunk& out)
 {
+	// mus2mid keeps its state in static variables, so only one conversion can
+	// run at a time (music can be converted in the background for previews)
+	static std::mutex           mus2mid_mutex;
+	std::lock_guard<std::mutex> lock(mus2mid_mutex);
 	return mus2mid(in, out);
 }
 
@@ -536,7 +593,6 @@ bool Conversions::vocToWav(MemChunk& in, MemChunk& out)
 	}
 
 	// --- Prepare WAV ---
-	WavChunk    whdr, wdhdr;
 	WavFmtChunk fmtchunk;
 
 	// --- Pre-process the file to make sure we can convert it ---
@@ -551,11 +607,17 @@ bool Conversions::vocToWav(MemChunk& in, MemChunk& out)
 		uint8_t blocktype = in[i];
 		size_t  blocksize = (i + 4 < e) ? READ_L24(in, i + 1) : 0x1000000;
 		i += 4;
-		if (i + blocksize > e && i < e && blocktype != 0)
+		if (i + blocksize > e && blocktype != 0)
 		{
 			Global::error = S_FMT("VOC file cut abruptly in block %i", blockcount);
 			return false;
 		}
+		if ((blocktype == 1 && blocksize < 2) || (blocktype == 8 && blocksize < 4)
+			|| (blocktype == 9 && blocksize < 12))
+		{
+			Global::error = S_FMT("Invalid block %i in VOC file", blockcount);
+			return false;
+		}
 		blockcount++;
 		switch (blocktype)
 		{
@@ -624,18 +686,13 @@ bool Conversions::vocToWav(MemChunk& in, MemChunk& out)
 		}
 		i += blocksize;
 	}
-	wdhdr.size = datasize;
 	switch (codec)
 	{
 	case 0: // 8 bits unsigned PCM
-		fmtchunk.bps       = 8;
-		fmtchunk.datarate  = fmtchunk.samplerate;
-		fmtchunk.blocksize = 1;
+		fmtchunk = wavFormat(fmtchunk.samplerate, fmtchunk.channels, 8);
 		break;
 	case 4: // 16 bits signed PCM
-		fmtchunk.bps       = 16;
-		fmtchunk.datarate  = fmtchunk.samplerate << 1;
-		fmtchunk.blocksize = 2;
+		fmtchunk = wavFormat(fmtchunk.samplerate, fmtchunk.channels, 16);
 		break;
 	case 1:     // 4 bits to 8 bits Creative ADPCM
 	case 2:     // 3 bits to 8 bits Creative ADPCM (AKA 2.6 bits)
@@ -650,30 +707,15 @@ bool Conversions::vocToWav(MemChunk& in, MemChunk& out)
 
 	// --- Write WAV ---
 
-	// Setup data header
-	char did[4] = { 'd', 'a', 't', 'a' };
-	memcpy(&wdhdr.id, &did, 4);
-
-	// Setup fmt chunk
-	char fid[4] = { 'f', 'm', 't', ' ' };
-	memcpy(&fmtchunk.header.id, &fid, 4);
-	fmtchunk.header.size = 16;
-
-	// Setup main header
-	char wid[4] = { 'R', 'I', 'F', 'F' };
-	memcpy(&whdr.id, &wid, 4);
-	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
-
-	// Write chunks
-	out.write(&whdr, 8);
-	out.write("WAVE", 4);
-	out.write(&fmtchunk, sizeof(WavFmtChunk));
-	out.write(&wdhdr, 8);
-
 	// Now go and copy sound data
-	const uint8_t* src = in.getData();
-	i                  = 26;
-	while (i < e)
+	uint8_t*       dest   = writeWavHeader(out, fmtchunk, datasize);
+	const uint8_t* src    = in.getData();
+	auto           append = [&](size_t offset, size_t size) {
+		memcpy(dest, src + offset, size);
+		dest += size;
+	};
+	i = 26;
+	while (i + 4 <= e)
 	{
 		// Parses through blocks again
 		uint8_t blocktype = in[i];
@@ -682,18 +724,20 @@ bool Conversions::vocToWav(MemChunk& in, MemChunk& out)
 		switch (blocktype)
 		{
 		case 1: // Sound data
-			out.write(src + i + 2, blocksize - 2);
+			append(i + 2, blocksize - 2);
 			break;
 		case 2: // Sound data continuation
-			out.write(src + i, blocksize);
+			append(i, blocksize);
 			break;
 		case 3: // Silence
 			// Not supported yet
 			break;
 		case 9: // Sound data in new format
-			out.write(src + i + 12, blocksize - 12);
+			append(i + 12, blocksize - 12);
 		default: break;
 		}
+		if (blocktype == 0)
+			break;
 		i += blocksize;
 	}
 
@@ -734,39 +778,9 @@ bool Conversions::bloodToWav(ArchiveEntry* in, MemChunk& out)
 		return false;
 	}
 
-	size_t rawsize = raw->getSize();
-
 	// --- Write WAV ---
-	WavChunk    whdr, wdhdr;
-	WavFmtChunk fmtchunk;
 
-	// Setup data header
-	char did[4] = { 'd', 'a', 't', 'a' };
-	memcpy(&wdhdr.id, &did, 4);
-	wdhdr.size = rawsize;
-
-	// Setup fmt chunk
-	char fid[4] = { 'f', 'm', 't', ' ' };
-	memcpy(&fmtchunk.header.id, &fid, 4);
-	fmtchunk.header.size = 16;
-	fmtchunk.tag         = 1;
-	fmtchunk.channels    = 1;
-	fmtchunk.samplerate  = mc[12] == 5 ? 22050 : 11025;
-	fmtchunk.datarate    = fmtchunk.samplerate;
-	fmtchunk.blocksize   = 1;
-	fmtchunk.bps         = 8;
-
-	// Setup main header
-	char wid[4] = { 'R', 'I', 'F', 'F' };
-	memcpy(&whdr.id, &wid, 4);
-	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
-
-	// Write chunks
-	out.write(&whdr, 8);
-	out.write("WAVE", 4);
-	out.write(&fmtchunk, sizeof(WavFmtChunk));
-	out.write(&wdhdr, 8);
-	out.write(raw->getData(), raw->getSize());
+	writeWav(out, wavFormat(mc[12] == 5 ? 22050 : 11025), raw->getData(), raw->getSize());
 
 	return true;
 }
@@ -784,40 +798,7 @@ bool Conversions::wolfSndToWav(MemChunk& in, MemChunk& out)
 
 	// --- Write WAV ---
 
-	WavChunk    whdr, wdhdr;
-	WavFmtChunk fmtchunk;
-
-	// Setup data header
-	char did[4] = { 'd', 'a', 't', 'a' };
-	memcpy(&wdhdr.id, &did, 4);
-	wdhdr.size = numsamples;
-
-	// Setup fmt chunk
-	char fid[4] = { 'f', 'm', 't', ' ' };
-	memcpy(&fmtchunk.header.id, &fid, 4);
-	fmtchunk.header.size = 16;
-	fmtchunk.tag         = 1;
-	fmtchunk.channels    = 1;
-	fmtchunk.samplerate  = wolfsnd_rate;
-	fmtchunk.datarate    = wolfsnd_rate;
-	fmtchunk.blocksize   = 1;
-	fmtchunk.bps         = 8;
-
-	// Setup main header
-	char wid[4] = { 'R', 'I', 'F', 'F' };
-	memcpy(&whdr.id, &wid, 4);
-	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
-
-	// Write chunks
-	out.write(&whdr, 8);
-	out.write("WAVE", 4);
-	out.write(&fmtchunk, sizeof(WavFmtChunk));
-	out.write(&wdhdr, 8);
-	out.write(samples, numsamples);
-
-	// Ensure data ends on even byte boundary
-	if (numsamples % 2 != 0)
-		out.write("\0", 1);
+	writeWav(out, wavFormat(wolfsnd_rate), samples, numsamples);
 
 	return true;
 }
@@ -831,8 +812,12 @@ bool Conversions::jagSndToWav(MemChunk& in, MemChunk& out)
 
 	// Read Jaguar doom sound header
 	JSndHeader header;
-	in.seek(0, SEEK_SET);
-	in.read(&header, 28);
+	if (in.getSize() < 28)
+	{
+		Global::error = "Invalid Jaguar Doom Sound";
+		return false;
+	}
+	memcpy(&header, in.getData(), 28);
 
 	// Correct endianness for the one value we actually use
 	// (The rest of the header is in big endian format too, but we
@@ -846,47 +831,10 @@ bool Conversions::jagSndToWav(MemChunk& in, MemChunk& out)
 		return false;
 	}
 
-	// Read samples
-	uint8_t* samples = new uint8_t[header.samples];
-	in.read(samples, header.samples);
-
 
 	// --- Write WAV ---
 
-	WavChunk    whdr, wdhdr;
-	WavFmtChunk fmtchunk;
-
-	// Setup data header
-	char did[4] = { 'd', 'a', 't', 'a' };
-	memcpy(&wdhdr.id, &did, 4);
-	wdhdr.size = header.samples;
-
-	// Setup fmt chunk
-	char fid[4] = { 'f', 'm', 't', ' ' };
-	memcpy(&fmtchunk.header.id, &fid, 4);
-	fmtchunk.header.size = 16;
-	fmtchunk.tag         = 1;
-	fmtchunk.channels    = 1;
-	fmtchunk.samplerate  = 11025;
-	fmtchunk.datarate    = 11025;
-	fmtchunk.blocksize   = 1;
-	fmtchunk.bps         = 8;
-
-	// Setup main header
-	char wid[4] = { 'R', 'I', 'F', 'F' };
-	memcpy(&whdr.id, &wid, 4);
-	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
-
-	// Write chunks
-	out.write(&whdr, 8);
-	out.write("WAVE", 4);
-	out.write(&fmtchunk, sizeof(WavFmtChunk));
-	out.write(&wdhdr, 8);
-	out.write(samples, header.samples);
-
-	// Ensure data ends on even byte boundary
-	if (header.samples % 2 != 0)
-		out.write("\0", 1);
+	writeWav(out, wavFormat(11025), in.getData() + 28, header.samples);
 
 	return true;
 }
@@ -1028,7 +976,7 @@ bool Conversions::addImfHeader(MemChunk& in, MemChunk& out)
 bool Conversions::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 {
 	static const double   ORIG_RATE     = 140.0;
-	static const double   FACTOR        = 315; // 315*140 = 44100
+	static const int      FACTOR        = 315; // 315*140 = 44100
 	static const double   FREQ          = 1193181.0;
 	static const double   RATE          = (ORIG_RATE * FACTOR);
 	static const int      PC_VOLUME     = 20;
@@ -1055,16 +1003,16 @@ bool Conversions::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 
 	// Read doom sound header
 	SpkSndHeader header;
-	in.seek(0, SEEK_SET);
-	in.read(&header, 4);
+	memcpy(&header, in.getData(), 4);
 	size_t numsamples;
+	size_t offset = 4;
 
 	// Format checks
 	if (audioT)
 	{
+		// Skip priority
 		numsamples = READ_L32(in, 0);
-		uint16_t priority;
-		in.read(&priority, 2);
+		offset += 2;
 		if (in.getSize() < 6 + numsamples)
 		{
 			Global::error = "Invalid AudioT PC Speaker Sound";
@@ -1085,25 +1033,30 @@ bool Conversions::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 		}
 		numsamples = header.samples;
 	}
+	if (numsamples > 0xFFFFFF) // Would be over 16 million samples when converted
+	{
+		Global::error = "Invalid PC Speaker Sound";
+		return false;
+	}
 
 	// Read samples
-	auto* osamples = new uint8_t[numsamples];
-	auto* nsamples = new uint8_t[(uint8_t) round(numsamples * FACTOR)];
-	in.read(osamples, numsamples);
-
-	int      sign      = -1;
-	uint32_t phase_tic = 0;
-
-	// Convert counter values to sample values
-	for (size_t s = 0; s < numsamples; ++s)
+	const uint8_t* osamples = in.getData() + offset;
+	for (size_t s = 0; s < numsamples && !audioT; ++s)
 	{
-		if (osamples[s] > 127 && !audioT)
+		if (osamples[s] > 127)
 		{
 			Global::error = S_FMT("Invalid PC Speaker counter value: %d > 127", osamples[s]);
-			delete[] osamples;
-			delete[] nsamples;
 			return false;
 		}
+	}
+
+	// Convert counter values to sample values, written directly to the wav
+	uint8_t* nsamples  = writeWavHeader(out, wavFormat(RATE), numsamples * FACTOR);
+	int      sign      = -1;
+	uint32_t phase_tic = 0;
+	for (size_t s = 0; s < numsamples; ++s)
+	{
+		uint8_t* dest = nsamples + s * FACTOR;
 		if (osamples[s] > 0)
 		{
 			// First, convert counter value to frequency in Hz
@@ -1111,66 +1064,32 @@ bool Conversions::spkSndToWav(MemChunk& in, MemChunk& out, bool audioT)
 			uint32_t tone         = audioT ? osamples[s] * 60 : counters[osamples[s]];
 			uint32_t phase_length = (tone * RATE) / (2 * FREQ);
 
-			// Then write a bunch of samples.
-			for (int i = 0; i < FACTOR; ++i)
+			// Then write a bunch of samples, flipping the sign after each
+			// [phase_length] + 1 samples
+			size_t i = 0;
+			while (i < FACTOR)
 			{
-				// Finally, convert frequency into sample value
-				int pos       = (s * FACTOR) + i;
-				nsamples[pos] = 128 + sign * PC_VOLUME;
-				if (phase_tic++ >= phase_length)
+				size_t run = (phase_tic < phase_length ? phase_length - phase_tic : 0) + 1;
+				if (run > FACTOR - i)
 				{
-					sign      = -sign;
-					phase_tic = 0;
+					memset(dest + i, 128 + sign * PC_VOLUME, FACTOR - i);
+					phase_tic += FACTOR - i;
+					break;
 				}
+
+				memset(dest + i, 128 + sign * PC_VOLUME, run);
+				sign      = -sign;
+				phase_tic = 0;
+				i += run;
 			}
 		}
 		else
 		{
-			memset(nsamples + size_t(s * FACTOR), 128, FACTOR);
+			memset(dest, 128, FACTOR);
 			phase_tic = 0;
 		}
 	}
 
-	// --- Write WAV ---
-
-	WavChunk    whdr, wdhdr;
-	WavFmtChunk fmtchunk;
-
-	// Setup data header
-	char did[4] = { 'd', 'a', 't', 'a' };
-	memcpy(&wdhdr.id, &did, 4);
-	wdhdr.size = numsamples * FACTOR;
-
-	// Setup fmt chunk
-	char fid[4] = { 'f', 'm', 't', ' ' };
-	memcpy(&fmtchunk.header.id, &fid, 4);
-	fmtchunk.header.size = 16;
-	fmtchunk.tag         = 1;
-	fmtchunk.channels    = 1;
-	fmtchunk.samplerate  = RATE;
-	fmtchunk.datarate    = RATE;
-	fmtchunk.blocksize   = 1;
-	fmtchunk.bps         = 8;
-
-	// Setup main header
-	char wid[4] = { 'R', 'I', 'F', 'F' };
-	memcpy(&whdr.id, &wid, 4);
-	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
-
-	// Write chunks
-	out.write(&whdr, 8);
-	out.write("WAVE", 4);
-	out.write(&fmtchunk, sizeof(WavFmtChunk));
-	out.write(&wdhdr, 8);
-	out.write(nsamples, numsamples * FACTOR);
-
-	// Ensure data ends on even byte boundary
-	if (header.samples % 2 != 0)
-		out.write("\0", 1);
-
-	delete[] osamples;
-	delete[] nsamples;
-
 	return true;
 }
 
@@ -1183,8 +1102,12 @@ bool Conversions::auSndToWav(MemChunk& in, MemChunk& out)
 
 	// Read doom sound header
 	SunSndHeader header;
-	in.seek(0, SEEK_SET);
-	in.read(&header, 24);
+	if (in.getSize() < 24)
+	{
+		Global::error = "Invalid Sun Sound";
+		return false;
+	}
+	memcpy(&header, in.getData(), 24);
 
 	header.magic    = wxUINT32_SWAP_ON_LE(header.magic);
 	header.offset   = wxUINT32_SWAP_ON_LE(header.offset);
@@ -1211,78 +1134,149 @@ bool Conversions::auSndToWav(MemChunk& in, MemChunk& out)
 	else if (header.format >= 6)
 		--samplesize;
 
-	// Read samples
-	uint8_t* samples = new uint8_t[header.size];
-	in.read(samples, header.size);
-
-	// Swap endianness around if needed
-	if (samplesize > 1)
+	// Get samples (the size can be unknown, ie. to the end of the data)
+	if (header.offset < 24 || header.offset > in.getSize() || header.channels == 0)
 	{
-		uint8_t swapval = 0;
-		for (size_t i = 0; i < header.size / samplesize; ++i)
-		{
-			switch (samplesize)
-			{
-			case 2:
-				swapval            = samples[i * 2];
-				samples[i * 2]     = samples[i * 2 + 1];
-				samples[i * 2 + 1] = swapval;
-				break;
-			case 3:
-				swapval            = samples[i * 3];
-				samples[i * 3]     = samples[i * 3 + 2];
-				samples[i * 3 + 2] = swapval;
-				break;
-			case 4:
-				swapval            = samples[i * 4];
-				samples[i * 4]     = samples[i * 4 + 3];
-				samples[i * 4 + 3] = swapval;
-				swapval            = samples[i * 4 + 2];
-				samples[i * 4 + 2] = samples[i * 4 + 1];
-				samples[i * 4 + 1] = swapval;
-				break;
-			}
-		}
+		Global::error = "Invalid Sun Sound";
+		return false;
 	}
+	uint32_t size = std::min<uint32_t>(header.size, in.getSize() - header.offset);
+	size -= size % (samplesize * header.channels);
+	const uint8_t* samples = in.getData() + header.offset;
 
 	// --- Write WAV ---
 
-	WavChunk    whdr, wdhdr;
-	WavFmtChunk fmtchunk;
+	// 8-bit samples are signed, but unsigned in wav. Others need their byte
+	// order swapped around
+	uint8_t* data = writeWavHeader(out, wavFormat(header.rate, header.channels, 8 * samplesize), size);
+	switch (samplesize)
+	{
+	case 1:
+		for (size_t i = 0; i < size; ++i)
+			data[i] = samples[i] ^ 0x80;
+		break;
+	case 2: swapSamples<2>(samples, data, size / 2); break;
+	case 3: swapSamples<3>(samples, data, size / 3); break;
+	case 4: swapSamples<4>(samples, data, size / 4); break;
+	}
 
-	// Setup data header
-	char did[4] = { 'd', 'a', 't', 'a' };
-	memcpy(&wdhdr.id, &did, 4);
-	wdhdr.size = header.size;
+	return true;
+}
 
-	// Setup fmt chunk
-	char fid[4] = { 'f', 'm', 't', ' ' };
-	memcpy(&fmtchunk.header.id, &fid, 4);
-	fmtchunk.header.size = 16;
-	fmtchunk.tag         = 1;
-	fmtchunk.channels    = header.channels;
-	fmtchunk.samplerate  = header.rate;
-	fmtchunk.datarate    = header.rate * header.channels;
-	fmtchunk.blocksize   = samplesize;
-	fmtchunk.bps         = 8 * samplesize;
-
-	// Setup main header
-	char wid[4] = { 'R', 'I', 'F', 'F' };
-	memcpy(&whdr.id, &wid, 4);
-	whdr.size = wdhdr.size + fmtchunk.header.size + 20;
-
-	// Write chunks
-	out.write(&whdr, 8);
-	out.write("WAVE", 4);
-	out.write(&fmtchunk, sizeof(WavFmtChunk));
-	out.write(&wdhdr, 8);
-	out.write(samples, header.size);
-
-	// Ensure data ends on even byte boundary
-	if (header.size % 2 != 0)
-		out.write("\0", 1);
-
-	delete[] samples;
+// -----------------------------------------------------------------------------
+// Converts sound data [in] of entry data format [format] to wav format,
+// written to [out]. Returns false if the format can't be converted (Blood SFX
+// needs the entry itself, see bloodToWav).
+//
+// This only reads [in] and (thread local) error state, so can be called from
+// multiple threads at once for batch conversions
+// -----------------------------------------------------------------------------
+bool Conversions::soundToWav(MemChunk& in, MemChunk& out, const string& format)
+{
+	if (format == "snd_doom" || format == "snd_doom_mac") // Doom Sound
+		return doomSndToWav(in, out);
+	else if (format == "snd_speaker") // Doom PC Speaker Sound
+		return spkSndToWav(in, out);
+	else if (format == "snd_jaguar") // Jaguar Doom Sound
+		return jagSndToWav(in, out);
+	else if (format == "snd_wolf") // Wolfenstein 3D Sound
+		return wolfSndToWav(in, out);
+	else if (format == "snd_voc") // Creative Voice File
+		return vocToWav(in, out);
+
+	Global::error = S_FMT("Sound format %s can not be converted to WAV", CHR(format));
+	return false;
+}
 
-	return true;
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+#include "App.h"
+#include "General/Console/Console.h"
+#include "General/Misc.h"
+#include "Utility/Parallel.h"
+
+CONSOLE_COMMAND(test_sound_conversion, 0, false)
+{
+	long count   = 1000;
+	long samples = 11025;
+	if (!args.empty())
+		args[0].ToLong(&count);
+	if (args.size() > 1)
+		args[1].ToLong(&samples);
+	count   = std::max(count, 1l);
+	samples = std::max(samples, 8l);
+
+	// Random test sounds: 16-bit stereo wavs, doom sounds (1 second at 11025Hz
+	// by default) and pc speaker sounds with the same number of samples / 100
+	srand(1);
+	vector<MemChunk> wavs(count), dsnds(count), spksnds(count);
+	for (long a = 0; a < count; a++)
+	{
+		uint8_t* data = Conversions::writeWavHeader(wavs[a], Conversions::wavFormat(11025, 2, 16), samples * 4);
+		for (long s = 0; s < samples * 4; s++)
+			data[s] = rand() % 256;
+
+		Conversions::DSndHeader header{ 3, 11025, (uint32_t)samples };
+		dsnds[a].reSize(samples + 8, false);
+		memcpy(&dsnds[a][0], &header, 8);
+		for (long s = 0; s < samples; s++)
+			dsnds[a][s + 8] = rand() % 256;
+
+		long spk_samples = std::max(samples / 100, 4l);
+		spksnds[a].reSize(spk_samples + 4, false);
+		spksnds[a][0] = spksnds[a][1] = 0;
+		spksnds[a][2]                 = spk_samples & 0xFF;
+		spksnds[a][3]                 = spk_samples >> 8;
+		for (long s = 0; s < spk_samples; s++)
+			spksnds[a][s + 4] = rand() % 128;
+	}
+
+	// Runs [convert] on each of [sounds] serially and in parallel, and logs the
+	// throughput of each (in sounds and input MB per second)
+	typedef std::function<bool(MemChunk&, MemChunk&)> ConvertFunc;
+	auto test = [&](const string& name, vector<MemChunk>& sounds, const ConvertFunc& convert) {
+		vector<MemChunk> serial(count), parallel(count);
+		double           mb = 0;
+		for (auto& sound : sounds)
+			mb += sound.getSize() / 1048576.0;
+
+		auto start = App::runTimer();
+		for (long a = 0; a < count; a++)
+			convert(sounds[a], serial[a]);
+		long time_serial = std::max<long>(App::runTimer() - start, 1);
+
+		start = App::runTimer();
+		Parallel::forEach(count, [&](size_t index) { convert(sounds[index], parallel[index]); });
+		long time_parallel = std::max<long>(App::runTimer() - start, 1);
+
+		// Check the results are the same
+		bool match = true;
+		for (long a = 0; a < count && match; a++)
+			match = serial[a].getSize() == parallel[a].getSize()
+					&& Misc::hash64(serial[a].getData(), serial[a].getSize())
+						   == Misc::hash64(parallel[a].getData(), parallel[a].getSize());
+
+		Log::console(S_FMT(
+			"%s: %1.0f sounds/s, %1.1f MB/s (%d threads: %1.0f sounds/s, %1.1f MB/s)%s",
+			CHR(name),
+			count * 1000.0 / time_serial,
+			mb * 1000.0 / time_serial,
+			Parallel::numThreads(),
+			count * 1000.0 / time_parallel,
+			mb * 1000.0 / time_parallel,
+			match ? "" : " (RESULTS DIFFER)"));
+	};
+
+	test("WAV (16-bit stereo) -> Doom Sound", wavs, [](MemChunk& in, MemChunk& out) {
+		return Conversions::wavToDoomSnd(in, out, false);
+	});
+	test("Doom Sound -> WAV", dsnds, [](MemChunk& in, MemChunk& out) { return Conversions::doomSndToWav(in, out); });
+	test("PC Speaker Sound -> WAV", spksnds, [](MemChunk& in, MemChunk& out) {
+		return Conversions::spkSndToWav(in, out);
+	});
 }
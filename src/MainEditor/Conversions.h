@@ -4,7 +4,8 @@ class ArchiveEntry;
 
 namespace Conversions
 {
-bool wavToDoomSnd(MemChunk& in, MemChunk& out);
+bool wavToDoomSnd(MemChunk& in, MemChunk& out, bool confirm_lossy = true);
+bool wavToDoomSndIsLossy(MemChunk& in);
 bool spkSndToWav(MemChunk& in, MemChunk& out, bool audioT = false);
 bool doomSndToWav(MemChunk& in, MemChunk& out);
 bool wolfSndToWav(MemChunk& in, MemChunk& out);
@@ -12,6 +13,7 @@ bool jagSndToWav(MemChunk& in, MemChunk& out);
 bool vocToWav(MemChunk& in, MemChunk& out);
 bool bloodToWav(ArchiveEntry* in, MemChunk& out);
 bool auSndToWav(MemChunk& in, MemChunk& out);
+bool soundToWav(MemChunk& in, MemChunk& out, const string& format);
 bool musToMidi(MemChunk& in, MemChunk& out);
 bool zmusToMidi(MemChunk& in, MemChunk& out, int subsong = 0, int* num_tracks = nullptr);
 bool gmidToMidi(MemChunk& in, MemChunk& out);
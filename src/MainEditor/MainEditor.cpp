@@ -36,6 +36,7 @@
 #include "MapEditor/UI/MapEditorWindow.h"
 #include "UI/ArchiveManagerPanel.h"
 #include "UI/Controls/PaletteChooser.h"
+#include "UI/EntryPanel/TextEntryPanel.h"
 #include "UI/MainWindow.h"
 
 
@@ -139,6 +140,19 @@ void MainEditor::openEntry(ArchiveEntry* entry)
 	main_window->getArchiveManagerPanel()->openEntryTab(entry);
 }
 
+// -----------------------------------------------------------------------------
+// Shows [entry] in the entry panel, and moves to [line] (if given) if it is
+// opened as text
+// -----------------------------------------------------------------------------
+void MainEditor::goToEntry(ArchiveEntry* entry, int line)
+{
+	main_window->getArchiveManagerPanel()->goToEntry(entry);
+
+	auto panel = currentEntryPanel();
+	if (line > 0 && panel && panel->entry() == entry && panel->name() == "text")
+		((TextEntryPanel*)panel)->jumpToLine(line);
+}
+
 // -----------------------------------------------------------------------------
 // Sets the global palette to the main palette in [archive] (eg. PLAYPAL)
 // -----------------------------------------------------------------------------
@@ -24,6 +24,7 @@ void openTextureEditor(Archive* archive, ArchiveEntry* entry = nullptr);
 void openMapEditor(Archive* archive);
 void openArchiveTab(Archive* archive);
 void openEntry(ArchiveEntry* entry);
+void goToEntry(ArchiveEntry* entry, int line = 0);
 
 void setGlobalPaletteFromArchive(Archive* archive);
 
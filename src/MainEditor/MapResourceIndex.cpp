@@ -0,0 +1,673 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapResourceIndex.cpp
+// Description: MapResourceIndex class - keeps track of which textures, flats,
+//              thing types and specials are used by each map in an archive
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapResourceIndex.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/Formats/WadArchive.h"
+#include "General/Misc.h"
+#include "General/ResourceManager.h"
+#include "MapEditor/SLADEMap/MapLine.h"
+#include "MapEditor/SLADEMap/MapSector.h"
+#include "MapEditor/SLADEMap/MapSide.h"
+#include "MapEditor/SLADEMap/MapThing.h"
+#include "Utility/Parallel.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+enum MapLump
+{
+	LUMP_THINGS,
+	LUMP_LINEDEFS,
+	LUMP_SIDEDEFS,
+	LUMP_SECTORS,
+	LUMP_TEXTMAP,
+
+	N_MAP_LUMPS
+};
+const char* map_lump_names[] = { "THINGS", "LINEDEFS", "SIDEDEFS", "SECTORS", "TEXTMAP" };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+typedef MapResourceIndex::Type     Type;
+typedef MapResourceIndex::MapUsage MapUsage;
+
+// A map lump's data to be scanned
+struct LumpData
+{
+	const uint8_t* data = nullptr;
+	uint32_t       size = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Adds [object] as a user of resource [key] of [type] to [usage]
+// -----------------------------------------------------------------------------
+void addUse(MapUsage& usage, Type type, const std::string& key, unsigned object)
+{
+	usage.names[(unsigned)type][key].push_back(object);
+}
+void addUse(MapUsage& usage, Type type, int key, unsigned object)
+{
+	usage.ids[(unsigned)type][key].push_back(object);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (upper case) texture name in the 8-character (not necessarily
+// null-terminated) [name]
+// -----------------------------------------------------------------------------
+std::string textureName(const char* name)
+{
+	std::string str;
+	for (unsigned c = 0; c < 8 && name[c]; c++)
+		str += (char)toupper((uint8_t)name[c]);
+	return str;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func(object, data)] for each [T] struct in [lump]
+// -----------------------------------------------------------------------------
+template<typename T, typename F> void forEachObject(const LumpData& lump, F func)
+{
+	T        data;
+	unsigned count = lump.size / sizeof(T);
+	for (unsigned a = 0; a < count; a++)
+	{
+		memcpy(&data, lump.data + a * sizeof(T), sizeof(T));
+		func(a, data);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds resources used by the Doom/Hexen/Doom 64 format map in [lumps] to
+// [usage]
+// -----------------------------------------------------------------------------
+void scanBinaryMap(const LumpData* lumps, uint8_t format, MapUsage& usage)
+{
+	// Things
+	auto& things = lumps[LUMP_THINGS];
+	if (format == MAP_HEXEN)
+		forEachObject<MapThing::HexenData>(things, [&](unsigned index, const MapThing::HexenData& thing) {
+			addUse(usage, Type::ThingType, thing.type, index);
+			if (thing.special)
+				addUse(usage, Type::ThingSpecial, thing.special, index);
+		});
+	else if (format == MAP_DOOM64)
+		forEachObject<MapThing::Doom64Data>(things, [&](unsigned index, const MapThing::Doom64Data& thing) {
+			addUse(usage, Type::ThingType, thing.type, index);
+		});
+	else
+		forEachObject<MapThing::DoomData>(things, [&](unsigned index, const MapThing::DoomData& thing) {
+			addUse(usage, Type::ThingType, thing.type, index);
+		});
+
+	// Lines
+	auto& lines = lumps[LUMP_LINEDEFS];
+	if (format == MAP_HEXEN)
+		forEachObject<MapLine::HexenData>(lines, [&](unsigned index, const MapLine::HexenData& line) {
+			if (line.type)
+				addUse(usage, Type::LineSpecial, line.type, index);
+		});
+	else if (format == MAP_DOOM64)
+		forEachObject<MapLine::Doom64Data>(lines, [&](unsigned index, const MapLine::Doom64Data& line) {
+			if (line.type)
+				addUse(usage, Type::LineSpecial, line.type, index);
+		});
+	else
+		forEachObject<MapLine::DoomData>(lines, [&](unsigned index, const MapLine::DoomData& line) {
+			if (line.type)
+				addUse(usage, Type::LineSpecial, line.type, index);
+		});
+
+	// Sides and sectors (Doom 64 maps use texture name hashes)
+	auto& sides   = lumps[LUMP_SIDEDEFS];
+	auto& sectors = lumps[LUMP_SECTORS];
+	if (format == MAP_DOOM64)
+	{
+		forEachObject<MapSide::Doom64Data>(sides, [&](unsigned index, const MapSide::Doom64Data& side) {
+			addUse(usage, Type::Texture, side.tex_upper, index);
+			addUse(usage, Type::Texture, side.tex_middle, index);
+			addUse(usage, Type::Texture, side.tex_lower, index);
+		});
+		forEachObject<MapSector::Doom64Data>(sectors, [&](unsigned index, const MapSector::Doom64Data& sector) {
+			addUse(usage, Type::Flat, sector.f_tex, index);
+			addUse(usage, Type::Flat, sector.c_tex, index);
+		});
+	}
+	else
+	{
+		forEachObject<MapSide::DoomData>(sides, [&](unsigned index, const MapSide::DoomData& side) {
+			addUse(usage, Type::Texture, textureName(side.tex_upper), index);
+			addUse(usage, Type::Texture, textureName(side.tex_middle), index);
+			addUse(usage, Type::Texture, textureName(side.tex_lower), index);
+		});
+		forEachObject<MapSector::DoomData>(sectors, [&](unsigned index, const MapSector::DoomData& sector) {
+			addUse(usage, Type::Flat, textureName(sector.f_tex), index);
+			addUse(usage, Type::Flat, textureName(sector.c_tex), index);
+		});
+	}
+}
+
+// -----------------------------------------------------------------------------
+// A minimal reader for UDMF TEXTMAP data, only handles what is needed to find
+// the resources used by a map (block and property names and values)
+// -----------------------------------------------------------------------------
+class TextmapReader
+{
+public:
+	TextmapReader(const LumpData& lump) :
+		current_{ (const char*)lump.data },
+		end_{ (const char*)lump.data + lump.size }
+	{
+	}
+
+	bool atEnd()
+	{
+		skipWhitespace();
+		return current_ >= end_;
+	}
+
+	// Returns true and skips the next character if it is [c]
+	bool check(char c)
+	{
+		skipWhitespace();
+		if (current_ < end_ && *current_ == c)
+		{
+			current_++;
+			return true;
+		}
+		return false;
+	}
+
+	// Skips the next character
+	void skip() { current_++; }
+
+	// Reads an identifier (lower case) into [id], returns false if there isn't
+	// one at the current position
+	bool readIdentifier(std::string& id)
+	{
+		skipWhitespace();
+		id.clear();
+		while (current_ < end_ && (isalnum((uint8_t)*current_) || *current_ == '_'))
+			id += (char)tolower((uint8_t)*current_++);
+		return !id.empty();
+	}
+
+	// Reads a value up to the next ';' into [value], without quotes if it is a
+	// string
+	void readValue(std::string& value)
+	{
+		skipWhitespace();
+		value.clear();
+		if (current_ < end_ && *current_ == '"')
+		{
+			current_++;
+			while (current_ < end_ && *current_ != '"')
+			{
+				if (*current_ == '\\' && current_ + 1 < end_)
+					current_++;
+				value += *current_++;
+			}
+			if (current_ < end_)
+				current_++;
+		}
+		else
+		{
+			while (current_ < end_ && *current_ != ';' && *current_ != '}' && !isspace((uint8_t)*current_))
+				value += *current_++;
+		}
+
+		check(';');
+	}
+
+private:
+	const char* current_;
+	const char* end_;
+
+	void skipWhitespace()
+	{
+		while (current_ < end_)
+		{
+			if (isspace((uint8_t)*current_))
+				current_++;
+			else if (*current_ == '/' && current_ + 1 < end_ && current_[1] == '/')
+			{
+				while (current_ < end_ && *current_ != '\n')
+					current_++;
+			}
+			else if (*current_ == '/' && current_ + 1 < end_ && current_[1] == '*')
+			{
+				current_ += 2;
+				while (current_ + 1 < end_ && !(current_[0] == '*' && current_[1] == '/'))
+					current_++;
+				current_ += 2;
+			}
+			else
+				break;
+		}
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Adds resources used by the UDMF map in [textmap] to [usage]
+// -----------------------------------------------------------------------------
+void scanUDMFMap(const LumpData& textmap, MapUsage& usage)
+{
+	enum Block
+	{
+		BLOCK_THING,
+		BLOCK_LINEDEF,
+		BLOCK_SIDEDEF,
+		BLOCK_SECTOR,
+		BLOCK_OTHER
+	};
+	unsigned count[BLOCK_OTHER] = { 0, 0, 0, 0 };
+
+	TextmapReader reader(textmap);
+	std::string   name, key, value;
+	while (!reader.atEnd())
+	{
+		if (!reader.readIdentifier(name))
+		{
+			// Invalid, skip it
+			reader.skip();
+			continue;
+		}
+
+		// Global property (namespace, etc.)
+		if (reader.check('='))
+		{
+			reader.readValue(value);
+			continue;
+		}
+
+		if (!reader.check('{'))
+			continue;
+
+		// Block, determine type
+		Block block = BLOCK_OTHER;
+		if (name == "thing")
+			block = BLOCK_THING;
+		else if (name == "linedef")
+			block = BLOCK_LINEDEF;
+		else if (name == "sidedef")
+			block = BLOCK_SIDEDEF;
+		else if (name == "sector")
+			block = BLOCK_SECTOR;
+		unsigned index = block == BLOCK_OTHER ? 0 : count[block]++;
+
+		// Read block properties
+		while (!reader.atEnd() && !reader.check('}'))
+		{
+			if (!reader.readIdentifier(key) || !reader.check('='))
+			{
+				reader.skip();
+				continue;
+			}
+			reader.readValue(value);
+
+			switch (block)
+			{
+			case BLOCK_THING:
+				if (key == "type")
+					addUse(usage, Type::ThingType, atoi(value.c_str()), index);
+				else if (key == "special" && atoi(value.c_str()) != 0)
+					addUse(usage, Type::ThingSpecial, atoi(value.c_str()), index);
+				break;
+			case BLOCK_LINEDEF:
+				if (key == "special" && atoi(value.c_str()) != 0)
+					addUse(usage, Type::LineSpecial, atoi(value.c_str()), index);
+				break;
+			case BLOCK_SIDEDEF:
+				if (key == "texturetop" || key == "texturemiddle" || key == "texturebottom")
+				{
+					std::transform(value.begin(), value.end(), value.begin(), ::toupper);
+					addUse(usage, Type::Texture, value, index);
+				}
+				break;
+			case BLOCK_SECTOR:
+				if (key == "texturefloor" || key == "textureceiling")
+				{
+					std::transform(value.begin(), value.end(), value.begin(), ::toupper);
+					addUse(usage, Type::Flat, value, index);
+				}
+				break;
+			default: break;
+			}
+		}
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapResourceIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Updates the index to match the maps currently in [archive]. Maps whose lumps
+// haven't changed since they were last scanned (by content) keep their
+// existing usage info, any others are scanned in parallel
+// -----------------------------------------------------------------------------
+void MapResourceIndex::update(Archive* archive)
+{
+	maps_.clear();
+	n_scanned_ = 0;
+	if (!archive)
+		return;
+
+	// Get the lumps of each map (data needs to be loaded on this thread)
+	struct MapLumps
+	{
+		Archive::MapDesc desc;
+		ArchiveEntry*    lumps[N_MAP_LUMPS] = {};
+	};
+	vector<MapLumps>      map_lumps;
+	vector<ArchiveEntry*> to_hash;
+	for (auto& desc : archive->detectMaps())
+	{
+		MapLumps ml;
+		ml.desc = desc;
+
+		// Maps in embedded wads are keyed by the whole wad
+		if (desc.archive)
+			to_hash.push_back(desc.head);
+		else
+		{
+			auto entry = desc.head;
+			while (entry)
+			{
+				string name = entry->getName().Upper();
+				for (unsigned a = 0; a < N_MAP_LUMPS; a++)
+					if (!ml.lumps[a] && name == map_lump_names[a])
+					{
+						ml.lumps[a] = entry;
+						entry->getMCData();
+						to_hash.push_back(entry);
+					}
+
+				if (entry == desc.end)
+					break;
+				entry = entry->nextEntry();
+			}
+		}
+
+		map_lumps.push_back(ml);
+	}
+	ArchiveEntry::computeContentHashes(to_hash);
+
+	// Find existing usage info for each map, by content
+	struct ScanJob
+	{
+		unsigned                  map;
+		LumpData                  lumps[N_MAP_LUMPS];
+		std::shared_ptr<MapUsage> usage;
+	};
+	vector<ScanJob>                                                 jobs;
+	std::unordered_map<uint64_t, std::shared_ptr<const MapUsage>> usage_cache;
+	std::unordered_map<uint64_t, vector<Map>>                       embedded_cache;
+	for (auto& ml : map_lumps)
+	{
+		auto& desc = ml.desc;
+
+		// Embedded wad, index its maps separately
+		if (desc.archive)
+		{
+			auto key = desc.head->contentHash();
+			auto ec  = embedded_cache_.find(key);
+			if (ec != embedded_cache_.end())
+				embedded_cache[key] = ec->second;
+			else
+			{
+				MapResourceIndex embedded;
+				{
+					WadArchive wad;
+					if (wad.open(desc.head))
+						embedded.update(&wad);
+				}
+				desc.head->unlock();
+
+				embedded_cache[key] = embedded.maps_;
+				n_scanned_ += embedded.n_scanned_;
+			}
+
+			for (auto map : embedded_cache[key])
+			{
+				map.name = desc.name + "/" + map.name;
+				map.head = desc.head;
+				maps_.push_back(map);
+			}
+
+			continue;
+		}
+
+		Map map;
+		map.name   = desc.name;
+		map.head   = desc.head;
+		map.format = desc.format;
+
+		// Key is the map format and content of its lumps
+		uint64_t key_data[N_MAP_LUMPS + 1] = { desc.format };
+		for (unsigned a = 0; a < N_MAP_LUMPS; a++)
+			if (ml.lumps[a])
+				key_data[a + 1] = ml.lumps[a]->contentHash();
+		auto key = Misc::hash64((const uint8_t*)key_data, sizeof(key_data));
+
+		auto uc = usage_cache.find(key);
+		if (uc == usage_cache.end())
+		{
+			uc = usage_cache_.find(key);
+			if (uc != usage_cache_.end())
+				uc = usage_cache.insert(*uc).first;
+		}
+
+		if (uc != usage_cache.end())
+			map.usage = uc->second;
+		else
+		{
+			// Not indexed yet, needs scanning
+			ScanJob job;
+			job.map   = maps_.size();
+			job.usage = std::make_shared<MapUsage>();
+			for (unsigned a = 0; a < N_MAP_LUMPS; a++)
+				if (ml.lumps[a])
+				{
+					job.lumps[a].data = ml.lumps[a]->getData();
+					job.lumps[a].size = ml.lumps[a]->getSize();
+				}
+			jobs.push_back(job);
+
+			map.usage        = job.usage;
+			usage_cache[key] = job.usage;
+		}
+
+		maps_.push_back(map);
+	}
+
+	// Scan new/modified maps
+	Parallel::forEach(jobs.size(), [&](size_t index) {
+		auto& job = jobs[index];
+		if (maps_[job.map].format == MAP_UDMF)
+			scanUDMFMap(job.lumps[LUMP_TEXTMAP], *job.usage);
+		else
+			scanBinaryMap(job.lumps, maps_[job.map].format, *job.usage);
+	});
+	n_scanned_ += jobs.size();
+
+	// Only keep info for maps currently in the archive
+	usage_cache_.swap(usage_cache);
+	embedded_cache_.swap(embedded_cache);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a lookup key for the texture or flat [name]. Includes the name hash,
+// for Doom 64 maps
+// -----------------------------------------------------------------------------
+MapResourceIndex::Key MapResourceIndex::nameKey(const string& name)
+{
+	return { name.Upper().ToStdString(), theResourceManager->getTextureHash(name) };
+}
+
+// -----------------------------------------------------------------------------
+// Returns the indices of objects in [map] using resource [key] of [type], or
+// nullptr if it isn't used
+// -----------------------------------------------------------------------------
+const vector<unsigned>* MapResourceIndex::objects(const Map& map, Type type, const Key& key) const
+{
+	if (!map.usage)
+		return nullptr;
+
+	// Numeric keys (also Doom 64 format textures/flats)
+	bool doom64_tex = map.format == MAP_DOOM64 && (type == Type::Texture || type == Type::Flat);
+	if (key.name.empty() || doom64_tex)
+	{
+		auto& ids = map.usage->ids[(unsigned)type];
+		auto  i   = ids.find(key.id);
+		return i == ids.end() ? nullptr : &i->second;
+	}
+
+	auto& names = map.usage->names[(unsigned)type];
+	auto  i     = names.find(key.name);
+	return i == names.end() ? nullptr : &i->second;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all uses (map and object index) of resource [key] of [type]
+// -----------------------------------------------------------------------------
+vector<MapResourceIndex::Use> MapResourceIndex::uses(Type type, const Key& key) const
+{
+	vector<Use> list;
+	for (unsigned a = 0; a < maps_.size(); a++)
+		if (auto objects = this->objects(maps_[a], type, key))
+			for (auto object : *objects)
+				list.push_back({ a, object });
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of times resource [key] of [type] is used in all maps
+// -----------------------------------------------------------------------------
+unsigned MapResourceIndex::useCount(Type type, const Key& key) const
+{
+	unsigned count = 0;
+	for (auto& map : maps_)
+		if (auto objects = this->objects(map, type, key))
+			count += objects->size();
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of maps (other than any with [exclude_head] as their head
+// entry) using resource [key] of [type]
+// -----------------------------------------------------------------------------
+unsigned MapResourceIndex::mapCount(Type type, const Key& key, ArchiveEntry* exclude_head) const
+{
+	unsigned count = 0;
+	for (auto& map : maps_)
+		if ((!exclude_head || map.head != exclude_head) && objects(map, type, key))
+			count++;
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if any map with [head] as its head entry uses resource [key] of
+// [type]. Also returns true if no indexed map has that head entry, since it
+// isn't known what it uses
+// -----------------------------------------------------------------------------
+bool MapResourceIndex::headUses(ArchiveEntry* head, Type type, const Key& key) const
+{
+	bool found = false;
+	for (auto& map : maps_)
+	{
+		if (map.head != head)
+			continue;
+
+		if (objects(map, type, key))
+			return true;
+		found = true;
+	}
+
+	return !found;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapResourceIndex Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the shared index for [archive], updated to match its current maps.
+// Returns nullptr if [archive] isn't open in the archive manager (eg. a
+// temporary archive), use a local index for those instead
+// -----------------------------------------------------------------------------
+MapResourceIndex* MapResourceIndex::forArchive(Archive* archive)
+{
+	static std::map<Archive*, MapResourceIndex> indices;
+
+	// Remove indices for any archives that have been closed
+	auto& manager = App::archiveManager();
+	for (auto i = indices.begin(); i != indices.end();)
+	{
+		if (manager.archiveIndex(i->first) < 0)
+			i = indices.erase(i);
+		else
+			++i;
+	}
+
+	if (!archive || manager.archiveIndex(archive) < 0)
+		return nullptr;
+
+	auto& index = indices[archive];
+	index.update(archive);
+	return &index;
+}
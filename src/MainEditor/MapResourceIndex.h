@@ -0,0 +1,101 @@
+#pragma once
+
+class Archive;
+class ArchiveEntry;
+
+// An index of the textures, flats, thing types and specials used by each map
+// in an archive, along with the objects using them. Each map is scanned
+// directly from its lumps (in parallel), and the results are kept per map
+// content so only maps that changed since the last update are scanned again
+class MapResourceIndex
+{
+public:
+	enum class Type
+	{
+		Texture,      // Side textures
+		Flat,         // Sector floor/ceiling textures
+		ThingType,    // Thing types
+		LineSpecial,  // Line action specials
+		ThingSpecial, // Thing action specials
+	};
+	static const unsigned N_TYPES = 5;
+
+	// Object indices using each resource in a single map. Textures and flats
+	// are keyed by (upper case) name, other types by number. Doom 64 maps store
+	// texture/flat name hashes instead, in [ids]
+	struct MapUsage
+	{
+		std::unordered_map<std::string, vector<unsigned>> names[N_TYPES];
+		std::unordered_map<int, vector<unsigned>>         ids[N_TYPES];
+	};
+
+	struct Map
+	{
+		string                          name;
+		ArchiveEntry*                   head   = nullptr; // Embedded wad entry for maps in embedded wads
+		uint8_t                         format = MAP_UNKNOWN;
+		std::shared_ptr<const MapUsage> usage;
+	};
+
+	struct Use
+	{
+		unsigned map;
+		unsigned object;
+	};
+
+	MapResourceIndex() {}
+
+	void update(Archive* archive);
+
+	unsigned   nMaps() const { return maps_.size(); }
+	const Map& map(unsigned index) const { return maps_[index]; }
+	unsigned   nScanned() const { return n_scanned_; }
+
+	vector<Use> uses(Type type, const string& name) const { return uses(type, nameKey(name)); }
+	vector<Use> uses(Type type, int id) const { return uses(type, Key{ "", id }); }
+	unsigned    useCount(Type type, const string& name) const { return useCount(type, nameKey(name)); }
+	unsigned    useCount(Type type, int id) const { return useCount(type, Key{ "", id }); }
+	bool        used(Type type, const string& name) const { return mapCount(type, name) > 0; }
+	bool        used(Type type, int id) const { return mapCount(type, id) > 0; }
+
+	// Returns the number of maps using the resource, not counting any with
+	// [exclude_head] as their head entry
+	unsigned mapCount(Type type, const string& name, ArchiveEntry* exclude_head = nullptr) const
+	{
+		return mapCount(type, nameKey(name), exclude_head);
+	}
+	unsigned mapCount(Type type, int id, ArchiveEntry* exclude_head = nullptr) const
+	{
+		return mapCount(type, Key{ "", id }, exclude_head);
+	}
+
+	// Returns true if any map with [head] as its head entry uses the resource,
+	// or if there are no maps with that head in the index
+	bool headUses(ArchiveEntry* head, Type type, const string& name) const
+	{
+		return headUses(head, type, nameKey(name));
+	}
+	bool headUses(ArchiveEntry* head, Type type, int id) const { return headUses(head, type, Key{ "", id }); }
+
+	static MapResourceIndex* forArchive(Archive* archive);
+
+private:
+	// A resource to look up, by name (if not empty) or number
+	struct Key
+	{
+		std::string name;
+		int         id;
+	};
+
+	vector<Map>                                                   maps_;
+	std::unordered_map<uint64_t, std::shared_ptr<const MapUsage>> usage_cache_;
+	std::unordered_map<uint64_t, vector<Map>>                     embedded_cache_;
+	unsigned                                                      n_scanned_ = 0;
+
+	static Key              nameKey(const string& name);
+	const vector<unsigned>* objects(const Map& map, Type type, const Key& key) const;
+	vector<Use>             uses(Type type, const Key& key) const;
+	unsigned                useCount(Type type, const Key& key) const;
+	unsigned                mapCount(Type type, const Key& key, ArchiveEntry* exclude_head) const;
+	bool                    headUses(ArchiveEntry* head, Type type, const Key& key) const;
+};
@@ -0,0 +1,589 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextSearch.cpp
+// Description: TextSearch class - searches the content of all text entries in
+//              an archive (and any archives nested within it) on background
+//              threads, with results available while the search is running.
+//              Also handles replacing text in all entries as one undo level
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextSearch.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "General/UndoRedo.h"
+#include "MainEditor/UI/ArchivePanel.h"
+#include "Utility/Parallel.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+const size_t   NOT_FOUND         = (size_t)-1;
+const unsigned MAX_LINE_TEXT_LEN = 200;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Finds occurrences of a literal string in raw text data, using the
+// Boyer-Moore-Horspool algorithm. Case-insensitive matching only folds ASCII
+// characters
+// -----------------------------------------------------------------------------
+class LiteralMatcher
+{
+public:
+	LiteralMatcher(const TextSearch::Options& options) :
+		match_case_{ options.match_case },
+		whole_word_{ options.whole_word }
+	{
+		auto utf8 = options.find.ToUTF8();
+		find_.assign(utf8.data(), utf8.length());
+		for (auto& c : find_)
+			c = fold(c);
+
+		// Build shift table
+		for (auto& shift : shift_)
+			shift = find_.size();
+		for (size_t a = 0; a + 1 < find_.size(); ++a)
+			shift_[(uint8_t)find_[a]] = find_.size() - 1 - a;
+	}
+
+	size_t length() const { return find_.size(); }
+
+	// Returns the position of the first match in [text] at or after [start],
+	// or NOT_FOUND if there are no more matches
+	size_t find(const char* text, size_t size, size_t start) const
+	{
+		auto len = find_.size();
+		if (len == 0)
+			return NOT_FOUND;
+
+		while (start + len <= size)
+		{
+			auto a = len;
+			while (a > 0 && fold(text[start + a - 1]) == find_[a - 1])
+				--a;
+
+			if (a == 0 && (!whole_word_ || isWholeWord(text, size, start)))
+				return start;
+
+			start += shift_[(uint8_t)fold(text[start + len - 1])];
+		}
+
+		return NOT_FOUND;
+	}
+
+private:
+	std::string find_;
+	size_t      shift_[256];
+	bool        match_case_;
+	bool        whole_word_;
+
+	char fold(char c) const { return match_case_ ? c : (char)tolower((uint8_t)c); }
+
+	static bool isWordChar(char c) { return isalnum((uint8_t)c) || c == '_'; }
+
+	bool isWholeWord(const char* text, size_t size, size_t start) const
+	{
+		auto end = start + find_.size();
+		return (start == 0 || !isWordChar(text[start - 1])) && (end >= size || !isWordChar(text[end]));
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is a text entry that should be searched
+// -----------------------------------------------------------------------------
+bool isTextEntry(ArchiveEntry* entry)
+{
+	return entry->getType()->formatId() == "text";
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is an archive that can be searched within
+// -----------------------------------------------------------------------------
+bool isArchiveEntry(ArchiveEntry* entry)
+{
+	return entry->getType()->formatId().StartsWith("archive_");
+}
+
+// -----------------------------------------------------------------------------
+// Returns [chars] ([length] bytes) as a string. [utf8] is set to false if the
+// data isn't valid UTF-8, in which case it is read as 8-bit data (as in the
+// text editor)
+// -----------------------------------------------------------------------------
+string toString(const char* chars, size_t length, bool& utf8)
+{
+	string text = wxString::FromUTF8(chars, length);
+
+	utf8 = !(text.empty() && length > 0);
+	if (!utf8)
+		text = wxString::From8BitData(chars, length);
+
+	return text;
+}
+string toString(const MemChunk& data, bool& utf8)
+{
+	return toString((const char*)data.getData(), data.getSize(), utf8);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [text] as a line of text for display in the results
+// -----------------------------------------------------------------------------
+string lineText(string text)
+{
+	text.Trim(false).Trim(true);
+	text.Replace("\t", " ");
+	if (text.length() > MAX_LINE_TEXT_LEN)
+		text = text.Left(MAX_LINE_TEXT_LEN) + "...";
+
+	return text;
+}
+
+// -----------------------------------------------------------------------------
+// Compiles the regular expression in [options] to [regex].
+// Returns false if it is invalid
+// -----------------------------------------------------------------------------
+bool compileRegex(wxRegEx& regex, const TextSearch::Options& options)
+{
+	int flags = wxRE_NEWLINE;
+#ifdef wxHAS_REGEX_ADVANCED
+	flags |= wxRE_ADVANCED;
+#else
+	flags |= wxRE_EXTENDED;
+#endif
+	if (!options.match_case)
+		flags |= wxRE_ICASE;
+
+	return regex.Compile(options.find, flags);
+}
+
+// -----------------------------------------------------------------------------
+// Searches [data] for [matcher], adding the number and text of each line with
+// a match to [lines]
+// -----------------------------------------------------------------------------
+void searchLiteral(const MemChunk& data, const LiteralMatcher& matcher, vector<std::pair<unsigned, string>>& lines)
+{
+	auto   text       = (const char*)data.getData();
+	size_t size       = data.getSize();
+	size_t scanned    = 0;
+	size_t line_start = 0;
+	auto   line       = 1u;
+
+	auto pos = matcher.find(text, size, 0);
+	while (pos != NOT_FOUND)
+	{
+		// Count lines up to the match
+		for (; scanned < pos; ++scanned)
+			if (text[scanned] == '\n')
+			{
+				++line;
+				line_start = scanned + 1;
+			}
+
+		auto line_end = line_start;
+		while (line_end < size && text[line_end] != '\n')
+			++line_end;
+
+		bool utf8;
+		lines.emplace_back(line, lineText(toString(text + line_start, line_end - line_start, utf8)));
+
+		// Continue from the next line, only one result per line is needed
+		pos = matcher.find(text, size, line_end);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Searches [data] for [regex], adding the number and text of each line with a
+// match to [lines]
+// -----------------------------------------------------------------------------
+void searchRegex(const MemChunk& data, const wxRegEx& regex, vector<std::pair<unsigned, string>>& lines)
+{
+	bool   utf8;
+	auto   text       = toString(data, utf8);
+	auto   chars      = text.wc_str();
+	size_t size       = text.length();
+	size_t offset     = 0;
+	size_t scanned    = 0;
+	size_t line_start = 0;
+	auto   line       = 1u;
+
+	while (offset < size)
+	{
+		int flags = (offset > 0 && chars[offset - 1] != '\n') ? wxRE_NOTBOL : 0;
+		if (!regex.Matches(chars + offset, flags, size - offset))
+			break;
+
+		size_t start, length;
+		regex.GetMatch(&start, &length);
+		start += offset;
+
+		// Count lines up to the match
+		for (; scanned < start; ++scanned)
+			if (chars[scanned] == '\n')
+			{
+				++line;
+				line_start = scanned + 1;
+			}
+
+		auto line_end = line_start;
+		while (line_end < size && chars[line_end] != '\n')
+			++line_end;
+
+		lines.emplace_back(line, lineText(text.Mid(line_start, line_end - line_start)));
+
+		// Continue from the next line
+		offset = std::max(line_end, start + length) + 1;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Replaces all matches of the search in [options] within [data] with
+// [replacement], writing the modified data to [out].
+// Returns the number of replacements made
+// -----------------------------------------------------------------------------
+unsigned replaceText(
+	const MemChunk&            data,
+	const TextSearch::Options& options,
+	const LiteralMatcher&      matcher,
+	const string&              replacement,
+	MemChunk&                  out)
+{
+	auto   text = (const char*)data.getData();
+	size_t size = data.getSize();
+	bool   utf8;
+
+	// Regex
+	if (options.regex)
+	{
+		wxRegEx regex;
+		if (!compileRegex(regex, options))
+			return 0;
+
+		auto str   = toString(data, utf8);
+		int  count = regex.Replace(&str, replacement);
+		if (count <= 0)
+			return 0;
+
+		auto buf = utf8 ? str.ToUTF8() : str.To8BitData();
+		out.importMem((const uint8_t*)buf.data(), buf.length());
+		return count;
+	}
+
+	// Literal
+	auto pos = matcher.find(text, size, 0);
+	if (pos == NOT_FOUND)
+		return 0;
+
+	// Write replacement in the same encoding as the data
+	toString(data, utf8);
+	auto        rep_buf = utf8 ? replacement.ToUTF8() : replacement.To8BitData();
+	std::string rep(rep_buf.data(), rep_buf.length());
+
+	std::string result;
+	result.reserve(size);
+	size_t   last  = 0;
+	unsigned count = 0;
+	while (pos != NOT_FOUND)
+	{
+		result.append(text + last, pos - last);
+		result += rep;
+		last = pos + matcher.length();
+		pos  = matcher.find(text, size, last);
+		++count;
+	}
+	result.append(text + last, size - last);
+
+	out.importMem((const uint8_t*)result.data(), result.size());
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Opens the nested archive in [entry]. [managed] is set to true if it is
+// already open in the archive manager (so shouldn't be deleted)
+// -----------------------------------------------------------------------------
+Archive* openNested(ArchiveEntry* entry, bool& managed)
+{
+	auto archive = App::archiveManager().openArchive(entry, false, true);
+	managed      = archive && App::archiveManager().archiveIndex(archive) >= 0;
+	return archive;
+}
+
+// -----------------------------------------------------------------------------
+// Replaces text in all text entries in [archive] and any nested archives
+// within it, recording undo steps to [undo_manager] if given.
+// Returns the number of replacements made
+// -----------------------------------------------------------------------------
+size_t replaceInArchive(
+	Archive*                   archive,
+	const TextSearch::Options& options,
+	const string&              replacement,
+	UndoManager*               undo_manager)
+{
+	vector<ArchiveEntry::SPtr> entries;
+	archive->getEntryTreeAsList(entries);
+
+	size_t                count = 0;
+	vector<ArchiveEntry*> text_entries;
+	for (auto& entry : entries)
+	{
+		if (isTextEntry(entry.get()))
+		{
+			// Entry data can only be loaded from the archive on this thread
+			entry->getMCData();
+			text_entries.push_back(entry.get());
+		}
+		else if (options.nested && isArchiveEntry(entry.get()))
+		{
+			bool managed;
+			auto nested = openNested(entry.get(), managed);
+			if (!nested)
+				continue;
+
+			// Changes to an open archive would be overwritten when it is saved
+			if (managed)
+			{
+				Log::info(S_FMT("Not replacing text in %s, it is currently open", entry->getPath(true)));
+				continue;
+			}
+
+			auto nested_count = replaceInArchive(nested, options, replacement, nullptr);
+			if (nested_count > 0)
+			{
+				MemChunk mc;
+				nested->write(mc);
+				delete nested; // Unlocks the entry
+				if (undo_manager)
+					undo_manager->recordUndoStep(new EntryDataUS(entry.get()));
+				entry->importMemChunk(mc);
+				count += nested_count;
+			}
+			else
+				delete nested;
+		}
+	}
+
+	// Do the replacements in parallel
+	LiteralMatcher   matcher(options);
+	vector<MemChunk> results(text_entries.size());
+	vector<unsigned> counts(text_entries.size());
+	Parallel::forEach(text_entries.size(), [&](size_t index) {
+		counts[index] = replaceText(text_entries[index]->getMCData(), options, matcher, replacement, results[index]);
+	});
+
+	// Apply them
+	for (unsigned a = 0; a < text_entries.size(); ++a)
+	{
+		if (counts[a] == 0)
+			continue;
+
+		if (undo_manager)
+			undo_manager->recordUndoStep(new EntryDataUS(text_entries[a]));
+		text_entries[a]->importMemChunk(results[a]);
+		count += counts[a];
+	}
+
+	return count;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// TextSearch Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts searching all text entries in [archive] using [options]. The search
+// runs on background threads, use takeResults to get results as they come in.
+// Returns false if the search couldn't be started
+// -----------------------------------------------------------------------------
+bool TextSearch::start(Archive* archive, const Options& options)
+{
+	cancel();
+
+	if (!archive || options.find.empty())
+		return false;
+
+	// Check the regex is valid here, so any error is only shown once
+	if (options.regex && !regexValid(options))
+	{
+		Global::error = "Invalid regular expression";
+		return false;
+	}
+
+	options_ = options;
+	jobs_.clear();
+	results_.clear();
+	searched_  = 0;
+	cancelled_ = false;
+
+	// Get entries to search (copying their data, since the archive can only be
+	// accessed from this thread)
+	addJobs(archive, nullptr, wxEmptyString);
+
+	running_ = true;
+	thread_  = std::thread([this]() {
+		LiteralMatcher matcher(options_);
+		Parallel::forEach(jobs_.size(), [&](size_t index) {
+			if (cancelled_)
+				return;
+
+			vector<std::pair<unsigned, string>> lines;
+			if (options_.regex)
+			{
+				wxRegEx regex;
+				compileRegex(regex, options_);
+				searchRegex(jobs_[index]->data, regex, lines);
+			}
+			else
+				searchLiteral(jobs_[index]->data, matcher, lines);
+
+			if (!lines.empty())
+			{
+				auto&                       job = *jobs_[index];
+				std::lock_guard<std::mutex> lock(mutex_);
+				for (auto& line : lines)
+					results_.push_back({ job.entry, job.path, job.nested, line.first, line.second });
+			}
+
+			++searched_;
+		});
+
+		running_ = false;
+	});
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the regular expression in [options] is valid, compiled the
+// same way as when searching. wx doesn't log the error, it's up to the caller
+// to report it
+// -----------------------------------------------------------------------------
+bool TextSearch::regexValid(const Options& options)
+{
+	wxLogNull no_log;
+	wxRegEx   regex;
+	return compileRegex(regex, options);
+}
+
+// -----------------------------------------------------------------------------
+// Cancels the current search (if any) and waits for it to stop
+// -----------------------------------------------------------------------------
+void TextSearch::cancel()
+{
+	cancelled_ = true;
+	if (thread_.joinable())
+		thread_.join();
+	running_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all results found since the last call
+// -----------------------------------------------------------------------------
+vector<TextSearch::Match> TextSearch::takeResults()
+{
+	vector<Match> results;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	results.swap(results_);
+	return results;
+}
+
+// -----------------------------------------------------------------------------
+// Replaces all matches of [options] in all text entries in [archive] with
+// [replacement], as a single undo level in [undo_manager] (if given). Nested
+// archives that are currently open are skipped.
+// Returns the number of replacements made
+// -----------------------------------------------------------------------------
+size_t TextSearch::replaceAll(
+	Archive*       archive,
+	const Options& options,
+	const string&  replacement,
+	UndoManager*   undo_manager)
+{
+	if (!archive || options.find.empty())
+		return 0;
+
+	if (undo_manager)
+		undo_manager->beginRecord("Replace in Text Entries");
+
+	auto count = replaceInArchive(archive, options, replacement, undo_manager);
+
+	if (undo_manager)
+		undo_manager->endRecord(count > 0);
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Adds search jobs for all text entries in [archive], recursing into nested
+// archives if enabled. [container] is the nested archive entry in the
+// searched archive, if [archive] is nested
+// -----------------------------------------------------------------------------
+void TextSearch::addJobs(Archive* archive, ArchiveEntry* container, const string& path_prefix)
+{
+	vector<ArchiveEntry::SPtr> entries;
+	archive->getEntryTreeAsList(entries);
+
+	for (auto& entry : entries)
+	{
+		if (isTextEntry(entry.get()))
+		{
+			auto job    = std::make_unique<Job>();
+			job->entry  = container ? container : entry.get();
+			job->path   = path_prefix + entry->getPath(true);
+			job->nested = container != nullptr;
+			job->data.importMem(entry->getData(), entry->getSize());
+			jobs_.push_back(std::move(job));
+		}
+		else if (options_.nested && isArchiveEntry(entry.get()))
+		{
+			bool managed;
+			auto nested = openNested(entry.get(), managed);
+			if (!nested)
+				continue;
+
+			addJobs(nested, container ? container : entry.get(), path_prefix + entry->getPath(true));
+			if (!managed)
+				delete nested;
+		}
+	}
+}
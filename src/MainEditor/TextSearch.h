@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+class Archive;
+class ArchiveEntry;
+class UndoManager;
+
+class TextSearch
+{
+public:
+	struct Options
+	{
+		string find;
+		bool   match_case = false;
+		bool   regex      = false; // Use regular expressions (wxRegEx syntax)
+		bool   whole_word = false; // Literal mode only
+		bool   nested     = true;  // Search inside nested archives
+	};
+
+	struct Match
+	{
+		ArchiveEntry* entry;  // Entry in the searched archive (the nested archive entry if nested)
+		string        path;   // Full path to the matched entry, including any nested archives
+		bool          nested; // Match is inside a nested archive
+		unsigned      line;   // Line number (starting from 1)
+		string        text;   // Text of the matched line
+	};
+
+	TextSearch() {}
+	~TextSearch() { cancel(); }
+
+	bool          start(Archive* archive, const Options& options);
+	void          cancel();
+	bool          running() const { return running_; }
+	vector<Match> takeResults();
+	unsigned      numEntries() const { return jobs_.size(); }
+	unsigned      numSearched() const { return searched_; }
+
+	static size_t replaceAll(
+		Archive*       archive,
+		const Options& options,
+		const string&  replacement,
+		UndoManager*   undo_manager = nullptr);
+	static bool   regexValid(const Options& options);
+
+private:
+	struct Job
+	{
+		ArchiveEntry* entry;
+		string        path;
+		bool          nested;
+		MemChunk      data;
+	};
+
+	Options                      options_;
+	vector<std::unique_ptr<Job>> jobs_;
+	vector<Match>                results_;
+	std::mutex                   mutex_;
+	std::thread                  thread_;
+	std::atomic<bool>            running_{ false };
+	std::atomic<bool>            cancelled_{ false };
+	std::atomic<unsigned>        searched_{ 0 };
+
+	void addJobs(Archive* archive, ArchiveEntry* container, const string& path_prefix);
+};
@@ -2021,8 +2021,21 @@ void ArchiveManagerPanel::goToBookmark(long index) const
 	if (!bookmark)
 		return;
 
+	goToEntry(bookmark);
+}
+
+// -----------------------------------------------------------------------------
+// Shows [entry] in the entry panel, either in its own tab if it is already
+// open in one, or in its parent archive's tab
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::goToEntry(ArchiveEntry* entry) const
+{
+	// Check if the entry is open in its own tab
+	if (redirectToTab(entry))
+		return;
+
 	// Open its parent archive in a tab
-	openTab(bookmark->getParent());
+	openTab(entry->getParent());
 
 	// Get the opened tab (should be an ArchivePanel unless something went wrong)
 	wxWindow* tab = stc_archives_->GetPage(stc_archives_->GetSelection());
@@ -2031,10 +2044,12 @@ void ArchiveManagerPanel::goToBookmark(long index) const
 	if (!tab || !(S_CMP(tab->GetName(), "archive")))
 		return;
 
-	// Finally, open the entry
-	((ArchivePanel*)tab)->openEntry(bookmark, true);
-	if (bookmark->getType() != EntryType::folderType())
-		((ArchivePanel*)tab)->focusOnEntry(bookmark);
+	// Finally, open the entry (if it isn't already, so any changes are kept)
+	auto panel = (ArchivePanel*)tab;
+	if (!panel->currentArea() || panel->currentArea()->entry() != entry)
+		panel->openEntry(entry, true);
+	if (entry->getType() != EntryType::folderType())
+		panel->focusOnEntry(entry);
 }
 
 
@@ -135,6 +135,7 @@ public:
 	// Bookmark functions
 	void deleteSelectedBookmarks() const;
 	void goToBookmark(long index = -1) const;
+	void goToEntry(ArchiveEntry* entry) const;
 
 	// SAction handler
 	bool handleAction(string id) override;
@@ -40,6 +40,7 @@
 #include "Dialogs/GfxConvDialog.h"
 #include "Dialogs/MapEditorConfigDialog.h"
 #include "Dialogs/MapReplaceDialog.h"
+#include "Dialogs/TextSearchDialog.h"
 #include "Dialogs/ModifyOffsetsDialog.h"
 #include "Dialogs/Preferences/PreferencesDialog.h"
 #include "Dialogs/RunDialog.h"
@@ -71,6 +72,7 @@
 #include "Scripting/ScriptManager.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "UI/Controls/SIconButton.h"
+#include "Utility/Parallel.h"
 #include "Utility/SFileDialog.h"
 
 
@@ -314,6 +316,62 @@ size_t getNamespaceNumber(ArchiveEntry* entry, size_t index, vector<string>& ns,
 	return ns.size();
 }
 
+// -----------------------------------------------------------------------------
+// Converts each of [entries] with [convert] on worker threads, and writes the
+// results back to the entries (with undo steps in [undo_manager]) in order on
+// this thread. The entries' data must already be loaded. Returns false if any
+// entries couldn't be converted (with errors written to the log)
+// -----------------------------------------------------------------------------
+bool convertEntries(
+	vector<ArchiveEntry*>&                        entries,
+	UndoManager*                                  undo_manager,
+	const std::function<bool(size_t, MemChunk&)>& convert)
+{
+	// Show splash window
+	UI::showSplash("Converting entries... (Esc to cancel)", true);
+
+	vector<MemChunk> converted(entries.size());
+	vector<uint8_t>  converted_ok(entries.size(), 0);
+	vector<string>   errors(entries.size());
+	bool             success = true;
+	Parallel::forEachOrdered(
+		entries.size(),
+		[&](size_t index) {
+			converted_ok[index] = convert(index, converted[index]);
+			if (!converted_ok[index])
+				errors[index] = Global::error;
+		},
+		[&](size_t index) {
+			// Cancel event
+			if (wxGetKeyState(WXK_ESCAPE))
+				return false;
+
+			// Update splash window
+			UI::setSplashProgressMessage(entries[index]->getName());
+			UI::setSplashProgress((float)index / (float)entries.size());
+
+			if (!converted_ok[index])
+			{
+				LOG_MESSAGE(1, "Error: Unable to convert entry %s: %s", entries[index]->getName(), errors[index]);
+				success = false;
+				return true;
+			}
+
+			undo_manager->recordUndoStep(new EntryDataUS(entries[index])); // Create undo step
+			entries[index]->importMemChunk(converted[index]);              // Load converted data
+			EntryType::detectEntryType(entries[index]);                    // Update entry type
+			entries[index]->setExtensionByType();                          // Update extension if necessary
+			converted[index].clear();
+
+			return true;
+		});
+
+	// Hide splash window
+	UI::hideSplash();
+
+	return success;
+}
+
 } // namespace
 
 
@@ -500,6 +558,7 @@ void ArchivePanel::addMenus()
 		SAction::fromId("arch_check_duplicates")->addToMenu(menu_clean);
 		SAction::fromId("arch_check_duplicates2")->addToMenu(menu_clean);
 		SAction::fromId("arch_replace_maps")->addToMenu(menu_clean);
+		SAction::fromId("arch_text_search")->addToMenu(menu_clean);
 		menu_archive->AppendSubMenu(menu_clean, "&Maintenance");
 		auto menu_scripts = new wxMenu();
 		ScriptManager::populateEditorScriptMenu(menu_scripts, ScriptManager::ScriptType::Archive, "arch_script");
@@ -1893,37 +1952,55 @@ bool ArchivePanel::gfxConvert()
 	gcd.ShowModal();
 
 	// Show splash window
-	UI::showSplash("Writing converted image data...", true);
+	UI::showSplash("Writing converted image data... (Esc to cancel)", true);
 
 	// Begin recording undo level
 	undo_manager_->beginRecord("Gfx Format Conversion");
 
-	// Write any changes
+	// Encode converted images in parallel, writing them back to entries in
+	// order on this thread as they become available
+	vector<MemChunk> encoded(selection.size());
+	vector<uint8_t>  encoded_ok(selection.size(), 0);
 	entry_list_->setEntriesAutoUpdate(false);
-	for (unsigned a = 0; a < selection.size(); a++)
-	{
-		if (a == selection.size() - 1)
-			entry_list_->setEntriesAutoUpdate(true);
+	Parallel::forEachOrdered(
+		selection.size(),
+		[&](size_t index) {
+			// Skip if the image wasn't converted
+			if (!gcd.itemModified(index))
+				return;
 
-		// Update splash window
-		UI::setSplashProgressMessage(selection[a]->getName());
-		UI::setSplashProgress((float)a / (float)selection.size());
+			// Use a copy of the palette, colour matching isn't thread safe
+			Palette  pal;
+			Palette* item_pal = gcd.getItemPalette(index);
+			if (item_pal)
+				pal.copyPalette(item_pal);
 
-		// Skip if the image wasn't converted
-		if (!gcd.itemModified(a))
-			continue;
+			encoded_ok[index] =
+				gcd.getItemFormat(index)->saveImage(*gcd.getItemImage(index), encoded[index], item_pal ? &pal : nullptr);
+		},
+		[&](size_t index) {
+			// Cancel event
+			if (wxGetKeyState(WXK_ESCAPE))
+				return false;
 
-		// Get image and conversion info
-		SImage*   image  = gcd.getItemImage(a);
-		SIFormat* format = gcd.getItemFormat(a);
+			if (index == selection.size() - 1)
+				entry_list_->setEntriesAutoUpdate(true);
 
-		// Write converted image back to entry
-		MemChunk mc;
-		format->saveImage(*image, mc, gcd.getItemPalette(a));
-		selection[a]->importMemChunk(mc);
-		EntryType::detectEntryType(selection[a]);
-		selection[a]->setExtensionByType();
-	}
+			// Update splash window
+			UI::setSplashProgressMessage(selection[index]->getName());
+			UI::setSplashProgress((float)index / (float)selection.size());
+
+			// Write converted image back to entry
+			if (encoded_ok[index])
+			{
+				selection[index]->importMemChunk(encoded[index]);
+				EntryType::detectEntryType(selection[index]);
+				selection[index]->setExtensionByType();
+				encoded[index].clear();
+			}
+
+			return true;
+		});
 	entry_list_->setEntriesAutoUpdate(true);
 
 	// Finish recording undo level
@@ -2412,37 +2489,37 @@ bool ArchivePanel::palConvert()
 // -----------------------------------------------------------------------------
 bool ArchivePanel::wavDSndConvert()
 {
-	// Get selected entries
-	vector<ArchiveEntry*> selection = entry_list_->getSelectedEntries();
+	// Get selected wav entries, loading their data here since the conversion
+	// happens on other threads
+	vector<ArchiveEntry*> selection;
+	bool                  lossy = false;
+	for (auto entry : entry_list_->getSelectedEntries())
+	{
+		if (entry->getType()->formatId() == "snd_wav")
+		{
+			selection.push_back(entry);
+			if (Conversions::wavToDoomSndIsLossy(entry->getMCData()))
+				lossy = true;
+		}
+	}
+
+	// Warn (once for all entries)
+	if (lossy
+		&& wxMessageBox(
+			   "Warning: conversion will result in loss of metadata and audio quality. Do you wish to proceed?",
+			   "Conversion warning",
+			   wxOK | wxCANCEL)
+			   != wxOK)
+		return true;
 
 	// Begin recording undo level
 	undo_manager_->beginRecord("Convert Wav -> Doom Sound");
 
-	// Go through selection
-	bool errors = false;
+	// Convert WAV -> Doom Sound
 	entry_list_->setEntriesAutoUpdate(false);
-	for (unsigned a = 0; a < selection.size(); a++)
-	{
-		if (a == selection.size() - 1)
-			entry_list_->setEntriesAutoUpdate(true);
-
-		// Convert WAV -> Doom Sound if the entry is WAV format
-		if (selection[a]->getType()->formatId() == "snd_wav")
-		{
-			MemChunk dsnd;
-			// Attempt conversion
-			if (!Conversions::wavToDoomSnd(selection[a]->getMCData(), dsnd))
-			{
-				LOG_MESSAGE(1, "Error: Unable to convert entry %s: %s", selection[a]->getName(), Global::error);
-				errors = true;
-				continue;
-			}
-			undo_manager_->recordUndoStep(new EntryDataUS(selection[a])); // Create undo step
-			selection[a]->importMemChunk(dsnd);                           // Load doom sound data
-			EntryType::detectEntryType(selection[a]);                     // Update entry type
-			selection[a]->setExtensionByType();                           // Update extension if necessary
-		}
-	}
+	bool errors = !convertEntries(selection, undo_manager_.get(), [&](size_t index, MemChunk& dsnd) {
+		return Conversions::wavToDoomSnd(selection[index]->getMCData(false), dsnd, false);
+	});
 	entry_list_->setEntriesAutoUpdate(true);
 
 	// Finish recording undo level
@@ -2460,55 +2537,39 @@ bool ArchivePanel::wavDSndConvert()
 // -----------------------------------------------------------------------------
 bool ArchivePanel::dSndWavConvert()
 {
-	// Get selected entries
+	// Get selected entries, loading their data here since the conversion
+	// happens on other threads
 	vector<ArchiveEntry*> selection = entry_list_->getSelectedEntries();
-
-	// Begin recording undo level
-	undo_manager_->beginRecord("Convert Doom Sound -> Wav");
-
-	// Go through selection
-	bool errors = false;
-	entry_list_->setEntriesAutoUpdate(false);
+	vector<string>        formats;
+	vector<MemChunk>      blood_wavs(selection.size());
+	vector<string>        blood_errors(selection.size());
 	for (unsigned a = 0; a < selection.size(); a++)
 	{
-		if (a == selection.size() - 1)
-			entry_list_->setEntriesAutoUpdate(true);
+		formats.push_back(selection[a]->getType()->formatId());
 
-		bool     worked = false;
-		MemChunk wav;
-		// Convert Doom Sound -> WAV if the entry is Doom Sound format
-		if (selection[a]->getType()->formatId() == "snd_doom" || selection[a]->getType()->formatId() == "snd_doom_mac")
-			worked = Conversions::doomSndToWav(selection[a]->getMCData(), wav);
-		// Or Doom Speaker sound format
-		else if (selection[a]->getType()->formatId() == "snd_speaker")
-			worked = Conversions::spkSndToWav(selection[a]->getMCData(), wav);
-		// Or Jaguar Doom sound format
-		else if (selection[a]->getType()->formatId() == "snd_jaguar")
-			worked = Conversions::jagSndToWav(selection[a]->getMCData(), wav);
-		// Or Wolfenstein 3D sound format
-		else if (selection[a]->getType()->formatId() == "snd_wolf")
-			worked = Conversions::wolfSndToWav(selection[a]->getMCData(), wav);
-		// Or Creative Voice File format
-		else if (selection[a]->getType()->formatId() == "snd_voc")
-			worked = Conversions::vocToWav(selection[a]->getMCData(), wav);
-		// Or Blood SFX format (this one needs to be given the entry, not just the mem chunk)
-		else if (selection[a]->getType()->formatId() == "snd_bloodsfx")
-			worked = Conversions::bloodToWav(selection[a], wav);
-		// If successfully converted, update the entry
-		if (worked)
+		// Blood SFX format needs to be given the entry (to find its raw data),
+		// so is converted here
+		if (formats[a] == "snd_bloodsfx")
 		{
-			undo_manager_->recordUndoStep(new EntryDataUS(selection[a])); // Create undo step
-			selection[a]->importMemChunk(wav);                            // Load wav data
-			EntryType::detectEntryType(selection[a]);                     // Update entry type
-			selection[a]->setExtensionByType();                           // Update extension if necessary
+			if (!Conversions::bloodToWav(selection[a], blood_wavs[a]))
+				blood_errors[a] = Global::error;
 		}
 		else
-		{
-			LOG_MESSAGE(1, "Error: Unable to convert entry %s: %s", selection[a]->getName(), Global::error);
-			errors = true;
-			continue;
-		}
+			selection[a]->getMCData();
 	}
+
+	// Begin recording undo level
+	undo_manager_->beginRecord("Convert Doom Sound -> Wav");
+
+	// Convert Doom Sound (or other supported formats) -> WAV
+	entry_list_->setEntriesAutoUpdate(false);
+	bool errors = !convertEntries(selection, undo_manager_.get(), [&](size_t index, MemChunk& wav) {
+		if (formats[index] != "snd_bloodsfx")
+			return Conversions::soundToWav(selection[index]->getMCData(false), wav, formats[index]);
+
+		Global::error = blood_errors[index];
+		return blood_errors[index].empty() && wav.importMem(blood_wavs[index].getData(), blood_wavs[index].getSize());
+	});
 	entry_list_->setEntriesAutoUpdate(true);
 
 	// Finish recording undo level
@@ -3063,6 +3124,24 @@ bool ArchivePanel::handleAction(string id)
 		dlg.ShowModal();
 	}
 
+	// Archive->Maintenance->Find/Replace in Text Entries
+	else if (id == "arch_text_search")
+	{
+		// Make sure any changes in the current entry are searched
+		saveEntryChanges();
+
+		TextSearchDialog dlg(this, archive_, undo_manager_.get());
+		int              result = dlg.ShowModal();
+
+		// Refresh the current entry if its text was replaced
+		if (dlg.replaced() && currentEntry())
+			openEntry(currentEntry(), true);
+
+		// Go to the selected result
+		if (result == wxID_OK && dlg.selectedEntry())
+			MainEditor::goToEntry(dlg.selectedEntry(), dlg.selectedLine());
+	}
+
 	// Archive->Scripts->...
 	else if (id == "arch_script")
 		ScriptManager::runArchiveScript(archive_, wx_id_offset_);
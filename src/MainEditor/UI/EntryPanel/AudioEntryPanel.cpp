@@ -72,8 +72,13 @@ AudioEntryPanel::AudioEntryPanel(wxWindow* parent) :
 	timer_seek_{ new wxTimer(this) },
 	sound_{ new sf::Sound() },
 	music_{ new sf::Music() },
-	mod_{ new ModMusic() }
+	mod_{ new ModMusic() },
+	midi_converter_{ new MIDIConverter(this) }
 {
+	// Entries can't be modified here, and copying the data would load the
+	// whole entry just to view its info
+	keep_entry_data_ = false;
+
 #ifdef __WXMSW__
 	wxRegKey key(
 		wxRegKey::HKLM,
@@ -179,6 +184,7 @@ AudioEntryPanel::AudioEntryPanel(wxWindow* parent) :
 	slider_seek_->Bind(wxEVT_SLIDER, &AudioEntryPanel::onSliderSeekChanged, this);
 	slider_volume_->Bind(wxEVT_SLIDER, &AudioEntryPanel::onSliderVolumeChanged, this);
 	Bind(wxEVT_TIMER, &AudioEntryPanel::onTimer, this);
+	Bind(wxEVT_THREAD_MIDI_CONVERTED, &AudioEntryPanel::onMidiConverted, this);
 
 	Layout();
 }
@@ -226,9 +232,22 @@ bool AudioEntryPanel::loadEntry(ArchiveEntry* entry)
 	if (wxFileExists(prevfile_))
 		wxRemoveFile(prevfile_);
 
-	// Open new data
+	// Set up for the new entry
 	this->entry_ = entry;
-	open();
+	audio_type_  = Invalid;
+	subsong_     = 0;
+	num_tracks_  = 1;
+	setAudioDuration(0);
+	txt_title_->SetLabel(entry->getPath(true));
+	updateTrackControls();
+
+	// The entry is only opened (and its data loaded) once playback starts, so
+	// just looking at a large music entry only reads the parts of it needed
+	// for the info text. MIDI is opened straight away to show the track info
+	if (MIDIConverter::canConvert(entry))
+		open();
+	else
+		updateInfo();
 
 	// Autoplay if option is on
 	if (snd_autoplay)
@@ -300,8 +319,10 @@ bool AudioEntryPanel::open()
 	// Stop if sound currently playing
 	resetStream();
 
-	subsong_    = 0;
-	num_tracks_ = 1;
+	subsong_      = 0;
+	num_tracks_   = 1;
+	midi_         = nullptr;
+	midi_request_ = 0;
 
 	// Get entry data
 	MemChunk& mcdata = entry_->getMCData();
@@ -329,31 +350,14 @@ bool AudioEntryPanel::open()
 		Conversions::jagSndToWav(mcdata, convdata);
 	else if (entry_->getType()->formatId() == "snd_bloodsfx") // Blood Sound -> WAV
 		Conversions::bloodToWav(entry_, convdata);
-	else if (entry_->getType()->formatId() == "midi_mus") // MUS -> MIDI
-	{
-		Conversions::musToMidi(mcdata, convdata);
-		path.SetExt("mid");
-	}
-	else if (
-		entry_->getType()->formatId() == "midi_xmi" || // HMI/HMP/XMI -> MIDI
-		entry_->getType()->formatId() == "midi_hmi" || entry_->getType()->formatId() == "midi_hmp")
-	{
-		Conversions::zmusToMidi(mcdata, convdata, 0, &num_tracks_);
-		path.SetExt("mid");
-	}
-	else if (entry_->getType()->formatId() == "midi_gmid") // GMID -> MIDI
-	{
-		Conversions::gmidToMidi(mcdata, convdata);
-		path.SetExt("mid");
-	}
-	else
+	else if (!MIDIConverter::canConvert(entry_))
 		convdata.importMem(mcdata.getData(), mcdata.getSize());
 
-	// MIDI format
-	if (entry_->getType()->formatId().StartsWith("midi_"))
+	// MIDI format (converted to MIDI in the background if needed)
+	if (MIDIConverter::canConvert(entry_))
 	{
 		audio_type_ = MIDI;
-		openMidi(convdata, path.GetFullPath());
+		loadMidi(subsong_);
 	}
 
 	// MOD format
@@ -368,16 +372,9 @@ bool AudioEntryPanel::open()
 	prevfile_ = path.GetFullPath();
 
 	txt_title_->SetLabel(entry_->getPath(true));
-	txt_track_->SetLabel(S_FMT("%d/%d", subsong_ + 1, num_tracks_));
+	updateTrackControls();
 	updateInfo();
 
-	// Disable prev/next track buttons if only one track is available
-	if (num_tracks_ < 2)
-	{
-		btn_prev_->Disable();
-		btn_next_->Disable();
-	}
-
 	opened_ = true;
 	return true;
 }
@@ -452,17 +449,41 @@ bool AudioEntryPanel::openAudio(MemChunk& audio, string filename)
 }
 
 // -----------------------------------------------------------------------------
-// Opens a MIDI file for playback
+// Opens [subsong] of the current MIDI entry for playback if it has already
+// been converted, otherwise begins converting it in the background (it will be
+// opened when the conversion finishes, see onMidiConverted)
+// -----------------------------------------------------------------------------
+bool AudioEntryPanel::loadMidi(int subsong)
+{
+	auto midi = MIDIConverter::cached(entry_, subsong);
+	if (midi)
+	{
+		midi_request_ = 0;
+		return openMidi(midi);
+	}
+
+	midi_         = nullptr;
+	midi_request_ = midi_converter_->convert(entry_, subsong);
+	setAudioDuration(0);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Opens converted [midi] for playback
 // -----------------------------------------------------------------------------
-bool AudioEntryPanel::openMidi(MemChunk& data, string filename)
+bool AudioEntryPanel::openMidi(const MIDIConverter::ResultPtr& midi)
 {
+	midi_       = midi;
+	num_tracks_ = midi->num_tracks;
+
 	// Enable volume control
 	slider_volume_->Enable(true);
 
 	// Attempt to open midi
-	if (theMIDIPlayer->isReady())
+	if (midi->success && theMIDIPlayer->isReady())
 	{
-		if (theMIDIPlayer->openData(data))
+		if (theMIDIPlayer->openData(midi->data, &midi->info))
 		{
 			// Enable play controls
 			btn_play_->Enable();
@@ -470,7 +491,7 @@ bool AudioEntryPanel::openMidi(MemChunk& data, string filename)
 			btn_stop_->Enable();
 
 			// Setup seekbar
-			setAudioDuration(theMIDIPlayer->getLength());
+			setAudioDuration(midi->info.length);
 
 			return true;
 		}
@@ -548,7 +569,13 @@ void AudioEntryPanel::startStream()
 	case Sound: sound_->play(); break;
 	case Music: music_->play(); break;
 	case Mod: mod_->play(); break;
-	case MIDI: theMIDIPlayer->play(); break;
+	case MIDI:
+		// Still converting, play once ready
+		if (midi_)
+			theMIDIPlayer->play();
+		else
+			play_pending_ = true;
+		break;
 	case Media:
 		if (media_ctrl_)
 			media_ctrl_->Play();
@@ -567,7 +594,10 @@ void AudioEntryPanel::stopStream()
 	case Sound: sound_->pause(); break;
 	case Music: music_->pause(); break;
 	case Mod: mod_->pause(); break;
-	case MIDI: theMIDIPlayer->pause(); break;
+	case MIDI:
+		play_pending_ = false;
+		theMIDIPlayer->pause();
+		break;
 	case Media:
 		if (media_ctrl_)
 			media_ctrl_->Pause();
@@ -586,7 +616,10 @@ void AudioEntryPanel::resetStream()
 	case Sound: sound_->stop(); break;
 	case Music: music_->stop(); break;
 	case Mod: mod_->stop(); break;
-	case MIDI: theMIDIPlayer->stop(); break;
+	case MIDI:
+		play_pending_ = false;
+		theMIDIPlayer->stop();
+		break;
 	case Media:
 		if (media_ctrl_)
 			media_ctrl_->Stop();
@@ -601,58 +634,20 @@ void AudioEntryPanel::resetStream()
 bool AudioEntryPanel::updateInfo()
 {
 	txt_info_->Clear();
-	string    info = entry_->getTypeString() + "\n";
-	MemChunk& mc   = entry_->getMCData();
+	string info = entry_->getTypeString() + "\n";
 	switch (audio_type_)
 	{
+	case Invalid:
 	case Sound:
 	case Music:
 	case Media:
-		if (entry_->getType() == EntryType::fromId("snd_doom"))
-		{
-			size_t samplerate = READ_L16(mc, 2);
-			size_t samples    = READ_L16(mc, 4);
-			info += S_FMT("%lu samples at %lu Hz", (unsigned long)samples, (unsigned long)samplerate);
-		}
-		else if (entry_->getType() == EntryType::fromId("snd_speaker"))
-		{
-			size_t samples = READ_L16(mc, 2);
-			info += S_FMT("%lu samples", (unsigned long)samples);
-		}
-		else if (entry_->getType() == EntryType::fromId("snd_audiot"))
-		{
-			size_t samples = READ_L16(mc, 0);
-			info += S_FMT("%lu samples", (unsigned long)samples);
-		}
-		else if (entry_->getType() == EntryType::fromId("snd_sun"))
-			info += Audio::getSunInfo(mc);
-		else if (entry_->getType() == EntryType::fromId("snd_voc"))
-			info += Audio::getVocInfo(mc);
-		else if (entry_->getType() == EntryType::fromId("snd_wav"))
-			info += Audio::getWavInfo(mc);
-		else if (entry_->getType() == EntryType::fromId("snd_mp3"))
-			info += Audio::getID3Tag(mc);
-		else if (entry_->getType() == EntryType::fromId("snd_ogg"))
-			info += Audio::getOggComments(mc);
-		else if (entry_->getType() == EntryType::fromId("snd_flac"))
-			info += Audio::getFlacComments(mc);
-		else if (entry_->getType() == EntryType::fromId("snd_aiff"))
-			info += Audio::getAiffInfo(mc);
-		break;
-	case Mod:
-		if (entry_->getType() == EntryType::fromId("mod_it"))
-			info += Audio::getITComments(mc);
-		else if (entry_->getType() == EntryType::fromId("mod_mod"))
-			info += Audio::getModComments(mc);
-		else if (entry_->getType() == EntryType::fromId("mod_s3m"))
-			info += Audio::getS3MComments(mc);
-		else if (entry_->getType() == EntryType::fromId("mod_xm"))
-			info += Audio::getXMComments(mc);
-		break;
+	case Mod: info += Audio::getEntryInfo(entry_); break;
 	case MIDI:
-		info += theMIDIPlayer->getInfo();
-		if (entry_->getType() == EntryType::fromId("midi_rmid"))
-			info += Audio::getRmidInfo(mc);
+		if (midi_)
+			info += midi_->info.text;
+		else if (midi_request_)
+			info += "Converting...\n";
+		info += Audio::getEntryInfo(entry_);
 		break;
 	/*case AUTYPE_EMU:
 		info += theGMEPlayer->getInfo(subsong);
@@ -673,6 +668,17 @@ bool AudioEntryPanel::updateInfo()
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Updates the track number and enables the prev/next track buttons if more
+// than one track is available
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::updateTrackControls()
+{
+	txt_track_->SetLabel(S_FMT("%d/%d", subsong_ + 1, num_tracks_));
+	btn_prev_->Enable(num_tracks_ > 1);
+	btn_next_->Enable(num_tracks_ > 1);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -724,16 +730,11 @@ void AudioEntryPanel::onBtnPrev(wxCommandEvent& e)
 	else
 		subsong_ = num_tracks_ - 1;
 
-	if (entry_->getType()->formatId() == "xmi")
-	{
-		MemChunk& mcdata = entry_->getMCData();
-		MemChunk  convdata;
-		if (Conversions::zmusToMidi(mcdata, convdata, subsong_))
-			openMidi(convdata, prevfile_);
-	}
+	if (audio_type_ == MIDI)
+		loadMidi(subsong_);
 	// else if (entry->getType()->getFormat().StartsWith("gme"))
 	//	theGMEPlayer->play(subsong);
-	txt_track_->SetLabel(S_FMT("%d/%d", subsong_ + 1, num_tracks_));
+	updateTrackControls();
 	updateInfo();
 }
 
@@ -743,19 +744,14 @@ void AudioEntryPanel::onBtnPrev(wxCommandEvent& e)
 void AudioEntryPanel::onBtnNext(wxCommandEvent& e)
 {
 	int newsong = (subsong_ + 1) % num_tracks_;
-	if (entry_->getType()->formatId() == "xmi")
-	{
-		MemChunk& mcdata = entry_->getMCData();
-		MemChunk  convdata;
-		if (Conversions::zmusToMidi(mcdata, convdata, newsong) && openMidi(convdata, prevfile_))
-			subsong_ = newsong;
-	}
+	if (audio_type_ == MIDI && loadMidi(newsong))
+		subsong_ = newsong;
 	/*else if (entry->getType()->getFormat().StartsWith("gme"))
 	{
 		if (theGMEPlayer->play(newsong))
 			subsong = newsong;
 	}*/
-	txt_track_->SetLabel(S_FMT("%d/%d", subsong_ + 1, num_tracks_));
+	updateTrackControls();
 	updateInfo();
 }
 
@@ -834,3 +830,30 @@ void AudioEntryPanel::onSliderVolumeChanged(wxCommandEvent& e)
 	default: break;
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Called when a background MIDI conversion finishes
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::onMidiConverted(wxThreadEvent& e)
+{
+	// Ignore if the conversion isn't for the current entry/subsong
+	if ((unsigned)e.GetInt() != midi_request_)
+		return;
+
+	auto midi = midi_converter_->result(midi_request_);
+	if (!midi)
+		return;
+
+	midi_request_ = 0;
+	openMidi(midi);
+	updateTrackControls();
+	updateInfo();
+
+	// Start playback if it was requested while converting
+	if (play_pending_)
+	{
+		play_pending_ = false;
+		startStream();
+		timer_seek_->Start(10);
+	}
+}
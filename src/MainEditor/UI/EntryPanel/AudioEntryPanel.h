@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Audio/MIDIConverter.h"
 #include "EntryPanel.h"
 
 class ModMusic;
@@ -36,11 +37,13 @@ private:
 	};
 
 	string    prevfile_;
-	AudioType audio_type_  = Invalid;
-	int       num_tracks_  = 1;
-	int       subsong_     = 0;
-	int       song_length_ = 0;
-	bool      opened_      = false;
+	AudioType audio_type_   = Invalid;
+	int       num_tracks_   = 1;
+	int       subsong_      = 0;
+	int       song_length_  = 0;
+	bool      opened_       = false;
+	unsigned  midi_request_ = 0;     // Id of the current background MIDI conversion (0 if none)
+	bool      play_pending_ = false; // Start playback once the current MIDI conversion finishes
 
 	wxBitmapButton* btn_play_      = nullptr;
 	wxBitmapButton* btn_pause_     = nullptr;
@@ -59,10 +62,14 @@ private:
 	std::unique_ptr<sf::Sound>       sound_;
 	std::unique_ptr<sf::Music>       music_;
 	std::unique_ptr<ModMusic>        mod_;
+	std::unique_ptr<MIDIConverter>   midi_converter_;
+	MIDIConverter::ResultPtr         midi_;
 
 	bool open();
 	bool openAudio(MemChunk& audio, string filename);
-	bool openMidi(MemChunk& data, string filename);
+	bool loadMidi(int subsong);
+	bool openMidi(const MIDIConverter::ResultPtr& midi);
+	void updateTrackControls();
 	bool openMod(MemChunk& data);
 	bool openMedia(string filename);
 	bool updateInfo();
@@ -79,4 +86,5 @@ private:
 	void onTimer(wxTimerEvent& e);
 	void onSliderSeekChanged(wxCommandEvent& e);
 	void onSliderVolumeChanged(wxCommandEvent& e);
+	void onMidiConverted(wxThreadEvent& e);
 };
@@ -143,7 +143,8 @@ bool EntryPanel::openEntry(ArchiveEntry* entry)
 
 	// Copy current entry content
 	entry_data_.clear();
-	entry_data_.importMem(entry->getData(true), entry->getSize());
+	if (keep_entry_data_)
+		entry_data_.importMem(entry->getData(true), entry->getSize());
 
 	// Load the entry
 	if (loadEntry(entry))
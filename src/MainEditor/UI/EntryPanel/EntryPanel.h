@@ -41,8 +41,9 @@ public:
 
 protected:
 	MemChunk      entry_data_;
-	ArchiveEntry* entry_        = nullptr;
-	UndoManager*  undo_manager_ = nullptr;
+	ArchiveEntry* entry_           = nullptr;
+	UndoManager*  undo_manager_    = nullptr;
+	bool          keep_entry_data_ = true; // Copy the entry data on open, to revert changes to
 
 	wxSizer*        sizer_main_   = nullptr;
 	wxSizer*        sizer_bottom_ = nullptr;
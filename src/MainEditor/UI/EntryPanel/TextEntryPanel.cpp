@@ -287,6 +287,14 @@ bool TextEntryPanel::redo()
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Moves the text editor cursor to [line]
+// -----------------------------------------------------------------------------
+void TextEntryPanel::jumpToLine(int line)
+{
+	text_area_->jumpToLine(line);
+}
+
 // -----------------------------------------------------------------------------
 // Handles the action [id].
 // Returns true if the action was handled, false otherwise
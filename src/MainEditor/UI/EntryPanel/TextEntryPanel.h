@@ -20,6 +20,8 @@ public:
 	bool   undo() override;
 	bool   redo() override;
 
+	void jumpToLine(int line);
+
 	// SAction Handler
 	bool handleAction(string id) override;
 
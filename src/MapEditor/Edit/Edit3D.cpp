@@ -39,6 +39,7 @@
 #include "Utility/MathStuff.h"
 
 using MapEditor::ItemType;
+using LineFlag = Game::Configuration::LineBasicFlag;
 
 
 // -----------------------------------------------------------------------------
@@ -700,12 +701,12 @@ void Edit3D::toggleUnpegged(bool lower) const
 		context_.recordPropertyChangeUndoStep(line);
 		if (lower)
 		{
-			bool unpegged = Game::configuration().lineBasicFlagSet("dontpegbottom", line, context_.mapDesc().format);
+			bool unpegged = Game::configuration().lineBasicFlagSet(LineFlag::DontPegBottom, line, context_.mapDesc().format);
 			Game::configuration().setLineBasicFlag("dontpegbottom", line, context_.map().currentFormat(), !unpegged);
 		}
 		else
 		{
-			bool unpegged = Game::configuration().lineBasicFlagSet("dontpegtop", line, context_.mapDesc().format);
+			bool unpegged = Game::configuration().lineBasicFlagSet(LineFlag::DontPegTop, line, context_.mapDesc().format);
 			Game::configuration().setLineBasicFlag("dontpegtop", line, context_.map().currentFormat(), !unpegged);
 		}
 	}
@@ -42,6 +42,8 @@
 #include "UI/Dialogs/ThingTypeBrowser.h"
 #include "Utility/MathStuff.h"
 
+using LineFlag = Game::Configuration::LineBasicFlag;
+
 
 // -----------------------------------------------------------------------------
 //
@@ -757,12 +759,46 @@ public:
 	void doCheck() override
 	{
 		double r1, r2;
+		auto&  config = Game::configuration();
+
+		int  map_format    = map_->currentFormat();
+		bool udmf_zdoom    = (map_format == MAP_UDMF && S_CMPNOCASE(config.udmfNamespace(), "zdoom"));
+		bool udmf_eternity = (map_format == MAP_UDMF && S_CMPNOCASE(config.udmfNamespace(), "eternity"));
+		int  min_skill     = udmf_zdoom || udmf_eternity ? 1 : 2;
+		int  max_skill     = udmf_zdoom ? 17 : 5;
+		int  max_class     = udmf_zdoom ? 17 : 4;
+
+		// Resolve the flags to compare once
+		vector<Game::Configuration::FlagHandle> flags;
+		uint64_t                                skill_bits = 0;
+		uint64_t                                class_bits = 0;
+		for (int s = min_skill; s < max_skill; ++s)
+		{
+			skill_bits |= 1ull << flags.size();
+			flags.push_back(config.thingBasicFlagHandle(S_FMT("skill%d", s), map_format));
+		}
+		uint64_t single_bit = 1ull << flags.size();
+		flags.push_back(config.thingBasicFlagHandle("single", map_format));
+		uint64_t coop_bit = 1ull << flags.size();
+		flags.push_back(config.thingBasicFlagHandle("coop", map_format));
+		uint64_t dm_bit = 1ull << flags.size();
+		flags.push_back(config.thingBasicFlagHandle("dm", map_format));
+		for (int c = 1; c < max_class; ++c)
+		{
+			class_bits |= 1ull << flags.size();
+			flags.push_back(config.thingBasicFlagHandle(S_FMT("class%d", c), map_format));
+		}
+
+		// Get the set flags for each thing
+		vector<uint64_t> thing_flags(map_->nThings());
+		for (unsigned a = 0; a < map_->nThings(); a++)
+			thing_flags[a] = config.thingFlagBits(flags, map_->getThing(a));
 
 		// Go through things
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
 			MapThing* thing1 = map_->getThing(a);
-			auto&     tt1    = Game::configuration().thingType(thing1->getType());
+			auto&     tt1    = config.thingType(thing1->getType());
 			r1               = tt1.radius() - 1;
 
 			// Ignore if no radius
@@ -770,18 +806,10 @@ public:
 				continue;
 
 			// Go through uncompared things
-			int  map_format = map_->currentFormat();
-			bool udmf_zdoom = (map_format == MAP_UDMF && S_CMPNOCASE(Game::configuration().udmfNamespace(), "zdoom"));
-			bool udmf_eternity =
-				(map_format == MAP_UDMF && S_CMPNOCASE(Game::configuration().udmfNamespace(), "eternity"));
-			int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
-			int max_skill = udmf_zdoom ? 17 : 5;
-			int max_class = udmf_zdoom ? 17 : 4;
-
 			for (unsigned b = a + 1; b < map_->nThings(); b++)
 			{
 				MapThing* thing2 = map_->getThing(b);
-				auto&     tt2    = Game::configuration().thingType(thing2->getType());
+				auto&     tt2    = config.thingType(thing2->getType());
 				r2               = tt2.radius() - 1;
 
 				// Ignore if no radius
@@ -790,28 +818,18 @@ public:
 
 				// Check flags
 				// Case #1: different skill levels
-				bool shareflag = false;
-				for (int s = min_skill; s < max_skill; ++s)
-				{
-					string skill = S_FMT("skill%d", s);
-					if (Game::configuration().thingBasicFlagSet(skill, thing1, map_format)
-						&& Game::configuration().thingBasicFlagSet(skill, thing2, map_format))
-					{
-						shareflag = true;
-						s         = max_skill;
-					}
-				}
-				if (!shareflag)
+				uint64_t shared = thing_flags[a] & thing_flags[b];
+				if (!(shared & skill_bits))
 					continue;
 
 				// Booleans for single, coop, deathmatch, and teamgame status for each thing
-				bool s1, s2, c1, c2, d1, d2, t1, t2;
-				s1 = Game::configuration().thingBasicFlagSet("single", thing1, map_format);
-				s2 = Game::configuration().thingBasicFlagSet("single", thing2, map_format);
-				c1 = Game::configuration().thingBasicFlagSet("coop", thing1, map_format);
-				c2 = Game::configuration().thingBasicFlagSet("coop", thing2, map_format);
-				d1 = Game::configuration().thingBasicFlagSet("dm", thing1, map_format);
-				d2 = Game::configuration().thingBasicFlagSet("dm", thing2, map_format);
+				bool s1, s2, c1, c2, d1, d2, t1 = false, t2 = false;
+				s1 = !!(thing_flags[a] & single_bit);
+				s2 = !!(thing_flags[b] & single_bit);
+				c1 = !!(thing_flags[a] & coop_bit);
+				c2 = !!(thing_flags[b] & coop_bit);
+				d1 = !!(thing_flags[a] & dm_bit);
+				d2 = !!(thing_flags[b] & dm_bit);
 
 				// Player starts
 				// P1 are automatically S and C; P2+ are automatically C;
@@ -856,7 +874,7 @@ public:
 				}
 
 				// Case #2: different game modes (single, coop, dm)
-				shareflag = false;
+				bool shareflag = false;
 				if ((c1 && c2) || (d1 && d2) || (t1 && t2))
 				{
 					shareflag = true;
@@ -864,16 +882,8 @@ public:
 				if (!shareflag && s1 && s2)
 				{
 					// Case #3: things flagged for single player with different class filters
-					for (int c = 1; c < max_class; ++c)
-					{
-						string pclass = S_FMT("class%d", c);
-						if (Game::configuration().thingBasicFlagSet(pclass, thing1, map_format)
-							&& Game::configuration().thingBasicFlagSet(pclass, thing2, map_format))
-						{
-							shareflag = true;
-							c         = max_class;
-						}
-					}
+					if (shared & class_bits)
+						shareflag = true;
 				}
 				if (!shareflag)
 					continue;
@@ -1371,7 +1381,7 @@ public:
 			line = map_->getLine(a);
 
 			// Skip if line is 2-sided and not blocking
-			if (line->s2() && !Game::configuration().lineBasicFlagSet("blocking", line, map_->currentFormat()))
+			if (line->s2() && !Game::configuration().lineBasicFlagSet(LineFlag::Blocking, line, map_->currentFormat()))
 				continue;
 
 			check_lines.push_back(line);
@@ -2053,6 +2053,27 @@ CONSOLE_COMMAND(m_test_sector, 0, false)
 	LOG_MESSAGE(1, "Took %ldms", ms);
 }
 
+CONSOLE_COMMAND(m_test_slopes, 0, false)
+{
+	SLADEMap& map      = MapEditor::editContext().map();
+	auto      specials = map.mapSpecials();
+
+	// Incremental update
+	sf::Clock clock;
+	map.recomputeSpecials();
+	LOG_MESSAGE(
+		1, "Update: %dms, %d sectors", clock.getElapsedTime().asMilliseconds(), specials->nSlopeSectorsUpdated());
+
+	// Full update, should give the same slopes
+	clock.restart();
+	unsigned differ = specials->checkSlopes(&map);
+	LOG_MESSAGE(
+		1, "Full update: %dms, %d sectors", clock.getElapsedTime().asMilliseconds(), specials->nSlopeSectorsUpdated());
+
+	if (differ > 0)
+		Log::warning(S_FMT("%d sectors differ from a full slope update", differ));
+}
+
 CONSOLE_COMMAND(m_test_mobj_backup, 0, false)
 {
 	sf::Clock clock;
@@ -2092,6 +2113,71 @@ CONSOLE_COMMAND(m_test_mobj_backup, 0, false)
 	LOG_MESSAGE(1, "Total: %dms", totalClock.getElapsedTime().asMilliseconds());
 }
 
+CONSOLE_COMMAND(m_test_flags, 0, false)
+{
+	long iterations = 100;
+	if (!args.empty())
+		args[0].ToLong(&iterations);
+
+	auto&    map        = MapEditor::editContext().map();
+	auto&    config     = Game::configuration();
+	int      map_format = map.currentFormat();
+	unsigned count      = 0;
+
+	// Things, by name
+	sf::Clock clock;
+	for (long i = 0; i < iterations; i++)
+		for (unsigned a = 0; a < map.nThings(); a++)
+		{
+			auto thing = map.getThing(a);
+			if (config.thingBasicFlagSet("skill3", thing, map_format)
+				&& config.thingBasicFlagSet("single", thing, map_format))
+				count++;
+		}
+	LOG_MESSAGE(1, "Things (by name): %dms", clock.getElapsedTime().asMilliseconds());
+
+	// Things, by handle
+	clock.restart();
+	auto skill3 = config.thingBasicFlagHandle("skill3", map_format);
+	auto single = config.thingBasicFlagHandle("single", map_format);
+	for (long i = 0; i < iterations; i++)
+		for (unsigned a = 0; a < map.nThings(); a++)
+		{
+			auto thing = map.getThing(a);
+			if (config.thingFlagSet(skill3, thing) && config.thingFlagSet(single, thing))
+				count--;
+		}
+	LOG_MESSAGE(1, "Things (by handle): %dms", clock.getElapsedTime().asMilliseconds());
+
+	// Lines, by name
+	clock.restart();
+	for (long i = 0; i < iterations; i++)
+		for (unsigned a = 0; a < map.nLines(); a++)
+		{
+			auto line = map.getLine(a);
+			if (config.lineBasicFlagSet("dontpegtop", line, map_format)
+				|| config.lineBasicFlagSet("dontpegbottom", line, map_format))
+				count++;
+		}
+	LOG_MESSAGE(1, "Lines (by name): %dms", clock.getElapsedTime().asMilliseconds());
+
+	// Lines, by handle
+	clock.restart();
+	for (long i = 0; i < iterations; i++)
+		for (unsigned a = 0; a < map.nLines(); a++)
+		{
+			auto line = map.getLine(a);
+			if (config.lineBasicFlagSet(Game::Configuration::LineBasicFlag::DontPegTop, line, map_format)
+				|| config.lineBasicFlagSet(Game::Configuration::LineBasicFlag::DontPegBottom, line, map_format))
+				count--;
+		}
+	LOG_MESSAGE(1, "Lines (by handle): %dms", clock.getElapsedTime().asMilliseconds());
+
+	// Both methods should find the same flags set
+	if (count != 0)
+		Log::warning("Flag checks by name and by handle gave different results");
+}
+
 CONSOLE_COMMAND(m_vertex_attached, 1, false)
 {
 	MapVertex* vertex = MapEditor::editContext().map().getVertex(atoi(CHR(args[0])));
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapSpecials.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
@@ -65,6 +66,12 @@ void MapSpecials::reset()
 {
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
+
+	// Slopes
+	slope_ops_.clear();
+	slopes_time_             = -1;
+	slopes_geometry_updated_ = -1;
+	slope_thing_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -284,7 +291,7 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 						int  b   = -1;
 						for (unsigned a = 0; a < parameters.size(); a++)
 						{
-							if (parameters[a].text.ToLong(&val))
+							if (parameters[a].text().ToLong(&val))
 							{
 								if (tag < 0)
 									tag = val;
@@ -325,7 +332,7 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 						int  b   = -1;
 						for (unsigned a = 0; a < parameters.size(); a++)
 						{
-							if (parameters[a].text.ToLong(&val))
+							if (parameters[a].text().ToLong(&val))
 							{
 								if (tag < 0)
 									tag = val;
@@ -375,48 +382,13 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 	//  - overwrite vertex heights with vertex height things
 	//  - vertex triangle slopes, in sector order
 	//  - Plane_Copy, in line order
-
-	// First things first: reset every sector to flat planes
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		MapSector* target = map->getSector(a);
-		target->setPlane<SurfaceType::Floor>(plane_t::flat(target->getPlaneHeight<SurfaceType::Floor>()));
-		target->setPlane<SurfaceType::Ceiling>(plane_t::flat(target->getPlaneHeight<SurfaceType::Ceiling>()));
-	}
+	// These are gathered into a list of operations first, which is then
+	// applied only to the sectors affected by any changes since the last update
+	bool            full = beginSlopeUpdate(map);
+	vector<SlopeOp> ops;
 
 	// Plane_Align (line special 181)
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		MapLine* line = map->getLine(a);
-		if (line->getSpecial() != 181)
-			continue;
-
-		MapSector* sector1 = line->frontSector();
-		MapSector* sector2 = line->backSector();
-		if (!sector1 || !sector2)
-		{
-			LOG_MESSAGE(1, "Ignoring Plane_Align on one-sided line %d", line->getIndex());
-			continue;
-		}
-		if (sector1 == sector2)
-		{
-			LOG_MESSAGE(
-				1, "Ignoring Plane_Align on line %d, which has the same sector on both sides", line->getIndex());
-			continue;
-		}
-
-		int floor_arg = line->intProperty("arg0");
-		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
-		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
-
-		int ceiling_arg = line->intProperty("arg1");
-		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
-		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
-	}
+	addPlaneAlignOps(map, ops);
 
 	// Line slope things (9500/9501), sector tilt things (9502/9503), and
 	// vavoom things (1500/1501), all in the same pass
@@ -426,19 +398,27 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 
 		// Line slope things
 		if (thing->getType() == 9500)
-			applyLineSlopeThing<SurfaceType::Floor>(map, thing);
+			addLineSlopeOps<SurfaceType::Floor>(map, thing, ops);
 		else if (thing->getType() == 9501)
-			applyLineSlopeThing<SurfaceType::Ceiling>(map, thing);
+			addLineSlopeOps<SurfaceType::Ceiling>(map, thing, ops);
 		// Sector tilt things
-		else if (thing->getType() == 9502)
-			applySectorTiltThing<SurfaceType::Floor>(map, thing);
-		else if (thing->getType() == 9503)
-			applySectorTiltThing<SurfaceType::Ceiling>(map, thing);
+		else if (thing->getType() == 9502 || thing->getType() == 9503)
+		{
+			// TODO should this apply to /all/ sectors at this point, in the
+			// case of an intersection?
+			int target_idx = slopeThingCache(map, thing);
+			if (target_idx < 0)
+				continue;
+
+			SurfaceType surface = thing->getType() == 9502 ? SurfaceType::Floor : SurfaceType::Ceiling;
+			ops.emplace_back(SlopeOp::SectorTilt, surface, map->getSector(target_idx));
+			ops.back().thing = thing;
+		}
 		// Vavoom things
 		else if (thing->getType() == 1500)
-			applyVavoomSlopeThing<SurfaceType::Floor>(map, thing);
+			addVavoomOp<SurfaceType::Floor>(map, thing, ops);
 		else if (thing->getType() == 1501)
-			applyVavoomSlopeThing<SurfaceType::Ceiling>(map, thing);
+			addVavoomOp<SurfaceType::Ceiling>(map, thing, ops);
 	}
 
 	// Slope copy things (9510/9511)
@@ -448,10 +428,9 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 
 		if (thing->getType() == 9510 || thing->getType() == 9511)
 		{
-			int target_idx = map->sectorAt(thing->point());
+			int target_idx = slopeThingCache(map, thing);
 			if (target_idx < 0)
 				continue;
-			MapSector* target = map->getSector(target_idx);
 
 			// First argument is the tag of a sector whose slope should be copied
 			int tag = thing->intProperty("arg0");
@@ -461,19 +440,18 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 				continue;
 			}
 
-			vector<MapSector*> tagged_sectors;
-			map->getSectorsByTag(tag, tagged_sectors);
-			if (tagged_sectors.empty())
+			MapSector* tagged = taggedSector(tag);
+			if (!tagged)
 			{
 				LOG_MESSAGE(
 					1, "Ignoring slope copy thing in sector %d; no sectors have target tag %d", target_idx, tag);
 				continue;
 			}
 
-			if (thing->getType() == 9510)
-				target->setFloorPlane(tagged_sectors[0]->floor().plane);
-			else
-				target->setCeilingPlane(tagged_sectors[0]->ceiling().plane);
+			SurfaceType surface = thing->getType() == 9510 ? SurfaceType::Floor : SurfaceType::Ceiling;
+			ops.emplace_back(SlopeOp::CopyPlane, surface, map->getSector(target_idx));
+			ops.back().source = tagged;
+			ops.back().thing  = thing;
 		}
 	}
 
@@ -489,9 +467,10 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 		if (thing->getType() == 1504 || thing->getType() == 1505)
 		{
 			// TODO there could be more than one vertex at this point
-			MapVertex* vertex = map->vertexAt(thing->xPos(), thing->yPos());
-			if (vertex)
+			int vertex_idx = slopeThingCache(map, thing);
+			if (vertex_idx >= 0)
 			{
+				MapVertex* vertex = map->getVertex(vertex_idx);
 				if (thing->getType() == 1504)
 					vertex_floor_heights[vertex] = thing->floatProperty("height");
 				else if (thing->getType() == 1505)
@@ -504,97 +483,290 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map)
 	// Heights may be set by UDMF properties, or by a vertex height thing
 	// placed exactly on the vertex (which takes priority over the prop).
 	vector<MapVertex*> vertices;
-	for (unsigned a = 0; a < map->nSectors(); a++)
+	for (auto target : slope_triangles_)
 	{
-		MapSector* target = map->getSector(a);
 		vertices.clear();
 		target->getVertices(vertices);
-		if (vertices.size() != 3)
-			continue;
 
-		applyVertexHeightSlope<SurfaceType::Floor>(target, vertices, vertex_floor_heights);
-		applyVertexHeightSlope<SurfaceType::Ceiling>(target, vertices, vertex_ceiling_heights);
+		addVertexHeightOp<SurfaceType::Floor>(target, vertices, vertex_floor_heights, ops);
+		addVertexHeightOp<SurfaceType::Ceiling>(target, vertices, vertex_ceiling_heights, ops);
 	}
 
 	// Plane_Copy
-	vector<MapSector*> sectors;
-	for (unsigned a = 0; a < map->nLines(); a++)
+	addPlaneCopyOps(map, ops);
+
+	updateSlopes(map, ops, full);
+}
+
+// -----------------------------------------------------------------------------
+// Process Eternity slope specials
+// -----------------------------------------------------------------------------
+void MapSpecials::processEternitySlopes(SLADEMap* map)
+{
+	// Eternity plans on having a few slope mechanisms,
+	// which must be evaluated in a specific order.
+	//  - Plane_Align, in line order
+	//  - vertex triangle slopes, in sector order (wip)
+	//  - Plane_Copy, in line order
+	bool            full = beginSlopeUpdate(map);
+	vector<SlopeOp> ops;
+	addPlaneAlignOps(map, ops);
+	addPlaneCopyOps(map, ops);
+	updateSlopes(map, ops, full);
+}
+
+// -----------------------------------------------------------------------------
+// Recomputes all slopes in [map] from scratch, and compares the result with
+// the (incrementally updated) slopes before. Returns the number of sectors
+// that had different slopes, which should always be 0
+// -----------------------------------------------------------------------------
+unsigned MapSpecials::checkSlopes(SLADEMap* map)
+{
+	vector<plane_t> floors, ceilings;
+	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
-		MapLine* line = map->getLine(a);
-		if (line->getSpecial() != 118)
-			continue;
+		floors.push_back(map->getSector(a)->floor().plane);
+		ceilings.push_back(map->getSector(a)->ceiling().plane);
+	}
 
-		int        tag;
-		MapSector* front = line->frontSector();
-		MapSector* back  = line->backSector();
-		if ((tag = line->intProperty("arg0")) && front)
+	// Force a full update
+	slopes_geometry_updated_ = -1;
+	processMapSpecials(map);
+
+	unsigned differ = 0;
+	for (unsigned a = 0; a < map->nSectors(); a++)
+	{
+		MapSector* sector = map->getSector(a);
+		if (sector->floor().plane != floors[a] || sector->ceiling().plane != ceilings[a])
+		{
+			LOG_MESSAGE(1, "Sector %d slope differs from full recompute", a);
+			differ++;
+		}
+	}
+
+	return differ;
+}
+
+// -----------------------------------------------------------------------------
+// Prepares for a slope update on [map], refreshing cached lookups.
+// Returns true if the map structure has changed since the last update, in
+// which case all slopes must be recomputed
+// -----------------------------------------------------------------------------
+bool MapSpecials::beginSlopeUpdate(SLADEMap* map)
+{
+	bool full = slopes_geometry_updated_ != map->geometryUpdated() || slopes_n_lines_ != map->nLines()
+				|| slopes_n_sectors_ != map->nSectors() || slope_vertex_pos_.size() != map->nVertices()
+				|| slope_side_sectors_.size() != map->nSides();
+
+	// Moving vertices or changing side sectors doesn't update the map
+	// geometry time, so check for those too
+	for (unsigned a = 0; !full && a < map->nVertices(); a++)
+		if (map->getVertex(a)->point() != slope_vertex_pos_[a])
+			full = true;
+	for (unsigned a = 0; !full && a < map->nSides(); a++)
+		if (map->getSide(a)->getSector() != slope_side_sectors_[a])
+			full = true;
+
+	if (full)
+	{
+		slopes_geometry_updated_ = map->geometryUpdated();
+		slopes_n_lines_          = map->nLines();
+		slopes_n_sectors_        = map->nSectors();
+
+		slope_vertex_pos_.clear();
+		for (unsigned a = 0; a < map->nVertices(); a++)
+			slope_vertex_pos_.push_back(map->getVertex(a)->point());
+
+		slope_side_sectors_.clear();
+		for (unsigned a = 0; a < map->nSides(); a++)
+			slope_side_sectors_.push_back(map->getSide(a)->getSector());
+
+		// Triangular sectors, for vertex height slopes
+		slope_triangles_.clear();
+		vector<MapVertex*> vertices;
+		for (unsigned a = 0; a < map->nSectors(); a++)
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				front->setFloorPlane(sectors[0]->floor().plane);
+			vertices.clear();
+			map->getSector(a)->getVertices(vertices);
+			if (vertices.size() == 3)
+				slope_triangles_.push_back(map->getSector(a));
 		}
-		if ((tag = line->intProperty("arg1")) && front)
+
+		slope_thing_cache_.clear();
+	}
+
+	// Clear cached sector/vertex for any things that have changed
+	slope_thing_cache_.resize(map->nThings());
+	for (unsigned a = 0; a < map->nThings(); a++)
+	{
+		MapThing* thing = map->getThing(a);
+		if (slope_thing_cache_[a].thing != thing || thing->modifiedTime() >= slopes_time_)
+			slope_thing_cache_[a] = { thing, -2 };
+	}
+
+	// Tag and line id lookups
+	slope_tagged_.clear();
+	for (unsigned a = 0; a < map->nSectors(); a++)
+		if (map->getSector(a)->getTag())
+			slope_tagged_.emplace(map->getSector(a)->getTag(), map->getSector(a));
+
+	slope_line_ids_.clear();
+	for (unsigned a = 0; a < map->nLines(); a++)
+	{
+		int id = map->getLine(a)->intProperty("id");
+		if (id)
+			slope_line_ids_[id].push_back(map->getLine(a));
+	}
+
+	return full;
+}
+
+// -----------------------------------------------------------------------------
+// Applies slope operations [ops] to [map]. Unless [full] is true, only sectors
+// affected by changes since the last update are reset and recomputed
+// -----------------------------------------------------------------------------
+void MapSpecials::updateSlopes(SLADEMap* map, vector<SlopeOp>& ops, bool full)
+{
+	unsigned     n_sectors = map->nSectors();
+	vector<bool> recompute(n_sectors, full);
+	vector<int>  todo;
+	auto         mark = [&](MapSector* sector) {
+		if (sector && !recompute[sector->getIndex()])
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				front->setCeilingPlane(sectors[0]->ceiling().plane);
+			recompute[sector->getIndex()] = true;
+			todo.push_back(sector->getIndex());
 		}
-		if ((tag = line->intProperty("arg2")) && back)
+	};
+
+	if (!full)
+	{
+		// Sectors that have been modified themselves
+		for (unsigned a = 0; a < n_sectors; a++)
+			if (map->getSector(a)->modifiedTime() >= slopes_time_)
+				mark(map->getSector(a));
+
+		// Sectors with operations from modified lines or things
+		for (auto& op : ops)
+			if ((op.line && op.line->modifiedTime() >= slopes_time_)
+				|| (op.thing && op.thing->modifiedTime() >= slopes_time_))
+				mark(op.target);
+
+		// Sectors whose list of operations has changed
+		vector<vector<unsigned>> old_ops(n_sectors), new_ops(n_sectors);
+		for (unsigned a = 0; a < slope_ops_.size(); a++)
+			old_ops[slope_ops_[a].target->getIndex()].push_back(a);
+		for (unsigned a = 0; a < ops.size(); a++)
+			new_ops[ops[a].target->getIndex()].push_back(a);
+		for (unsigned a = 0; a < n_sectors; a++)
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				back->setFloorPlane(sectors[0]->floor().plane);
+			bool changed = old_ops[a].size() != new_ops[a].size();
+			for (unsigned b = 0; !changed && b < old_ops[a].size(); b++)
+				changed = slope_ops_[old_ops[a][b]] != ops[new_ops[a][b]];
+			if (changed)
+				mark(map->getSector(a));
 		}
-		if ((tag = line->intProperty("arg3")) && back)
+
+		// Anything reading from a changed sector has changed too
+		vector<vector<MapSector*>> readers(n_sectors);
+		for (auto& op : ops)
+			if (op.source && op.source != op.target)
+				readers[op.source->getIndex()].push_back(op.target);
+		while (!todo.empty())
 		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				back->setCeilingPlane(sectors[0]->ceiling().plane);
+			int index = todo.back();
+			todo.pop_back();
+			for (auto reader : readers[index])
+				mark(reader);
 		}
 
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
+		// Recomputing a sector must replay the operations it reads from other
+		// sectors as well, so they are at the same state they would be in a
+		// full update
+		for (unsigned a = 0; a < n_sectors; a++)
+			if (recompute[a])
+				todo.push_back(a);
+		while (!todo.empty())
 		{
-			int share = line->intProperty("arg4");
+			int index = todo.back();
+			todo.pop_back();
+			for (auto op : new_ops[index])
+				mark(ops[op].source);
+		}
+	}
 
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
+	// Reset sectors to flat planes
+	slope_sectors_updated_ = 0;
+	for (unsigned a = 0; a < n_sectors; a++)
+	{
+		if (!recompute[a])
+			continue;
 
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
+		MapSector* target = map->getSector(a);
+		target->setPlane<SurfaceType::Floor>(plane_t::flat(target->getPlaneHeight<SurfaceType::Floor>()));
+		target->setPlane<SurfaceType::Ceiling>(plane_t::flat(target->getPlaneHeight<SurfaceType::Ceiling>()));
+		slope_sectors_updated_++;
+	}
+
+	// Apply operations in order
+	MapThing* last_thing = nullptr;
+	double    thingz     = 0;
+	for (auto& op : ops)
+	{
+		if (!recompute[op.target->getIndex()])
+			continue;
+
+		if (op.surface == SurfaceType::Floor)
+			applySlopeOp<SurfaceType::Floor>(op, last_thing, thingz);
+		else
+			applySlopeOp<SurfaceType::Ceiling>(op, last_thing, thingz);
 	}
+
+	slope_ops_   = std::move(ops);
+	slopes_time_ = App::runTimer();
 }
 
 // -----------------------------------------------------------------------------
-// Process Eternity slope specials
+// Returns the cached sector index containing [thing] (or vertex index for
+// vertex height things), looking it up in [map] if needed. Returns -1 if the
+// thing isn't in a sector (or on a vertex)
 // -----------------------------------------------------------------------------
-void MapSpecials::processEternitySlopes(SLADEMap* map)
+int MapSpecials::slopeThingCache(SLADEMap* map, MapThing* thing)
 {
-	// Eternity plans on having a few slope mechanisms,
-	// which must be evaluated in a specific order.
-	//  - Plane_Align, in line order
-	//  - vertex triangle slopes, in sector order (wip)
-	//  - Plane_Copy, in line order
-
-	// First things first: reset every sector to flat planes
-	for (unsigned a = 0; a < map->nSectors(); a++)
+	auto& cache = slope_thing_cache_[thing->getIndex()];
+	if (cache.index == -2)
 	{
-		MapSector* target = map->getSector(a);
-		target->setPlane<SurfaceType::Floor>(plane_t::flat(target->getPlaneHeight<SurfaceType::Floor>()));
-		target->setPlane<SurfaceType::Ceiling>(plane_t::flat(target->getPlaneHeight<SurfaceType::Ceiling>()));
+		if (thing->getType() == 1504 || thing->getType() == 1505)
+		{
+			MapVertex* vertex = map->vertexAt(thing->xPos(), thing->yPos());
+			cache.index       = vertex ? vertex->getIndex() : -1;
+		}
+		else
+			cache.index = map->sectorAt(thing->point());
 	}
 
-	// Plane_Align (line special 181)
+	return cache.index;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the first sector with [tag], or null if none
+// -----------------------------------------------------------------------------
+MapSector* MapSpecials::taggedSector(int tag)
+{
+	auto i = slope_tagged_.find(tag);
+	return i != slope_tagged_.end() ? i->second : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds operations for all Plane_Align (181) lines in [map] to [ops]
+// -----------------------------------------------------------------------------
+void MapSpecials::addPlaneAlignOps(SLADEMap* map, vector<SlopeOp>& ops)
+{
+	auto add = [&](MapLine* line, SurfaceType surface, MapSector* target, MapSector* model) {
+		ops.emplace_back(SlopeOp::PlaneAlign, surface, target);
+		ops.back().source = model;
+		ops.back().line   = line;
+	};
+
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		MapLine* line = map->getLine(a);
@@ -617,56 +789,43 @@ void MapSpecials::processEternitySlopes(SLADEMap* map)
 
 		int floor_arg = line->intProperty("arg0");
 		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
+			add(line, SurfaceType::Floor, sector1, sector2);
 		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
+			add(line, SurfaceType::Floor, sector2, sector1);
 
 		int ceiling_arg = line->intProperty("arg1");
 		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
+			add(line, SurfaceType::Ceiling, sector1, sector2);
 		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
+			add(line, SurfaceType::Ceiling, sector2, sector1);
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds operations for all Plane_Copy (118) lines in [map] to [ops]
+// -----------------------------------------------------------------------------
+void MapSpecials::addPlaneCopyOps(SLADEMap* map, vector<SlopeOp>& ops)
+{
+	auto add = [&](MapLine* line, SurfaceType surface, MapSector* target, MapSector* source) {
+		if (!target || !source)
+			return;
+		ops.emplace_back(SlopeOp::CopyPlane, surface, target);
+		ops.back().source = source;
+		ops.back().line   = line;
+	};
 
-	// Plane_Copy
-	vector<MapSector*> sectors;
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		MapLine* line = map->getLine(a);
 		if (line->getSpecial() != 118)
 			continue;
 
-		int        tag;
 		MapSector* front = line->frontSector();
 		MapSector* back  = line->backSector();
-		if ((tag = line->intProperty("arg0")))
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				front->setFloorPlane(sectors[0]->floor().plane);
-		}
-		if ((tag = line->intProperty("arg1")))
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				front->setCeilingPlane(sectors[0]->ceiling().plane);
-		}
-		if ((tag = line->intProperty("arg2")))
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				back->setFloorPlane(sectors[0]->floor().plane);
-		}
-		if ((tag = line->intProperty("arg3")))
-		{
-			sectors.clear();
-			map->getSectorsByTag(tag, sectors);
-			if (sectors.size())
-				back->setCeilingPlane(sectors[0]->ceiling().plane);
-		}
+		add(line, SurfaceType::Floor, front, taggedSector(line->intProperty("arg0")));
+		add(line, SurfaceType::Ceiling, front, taggedSector(line->intProperty("arg1")));
+		add(line, SurfaceType::Floor, back, taggedSector(line->intProperty("arg2")));
+		add(line, SurfaceType::Ceiling, back, taggedSector(line->intProperty("arg3")));
 
 		// The fifth "share" argument copies from one side of the line to the
 		// other
@@ -675,18 +834,132 @@ void MapSpecials::processEternitySlopes(SLADEMap* map)
 			int share = line->intProperty("arg4");
 
 			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
+				add(line, SurfaceType::Floor, back, front);
 			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
+				add(line, SurfaceType::Floor, front, back);
 
 			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
+				add(line, SurfaceType::Ceiling, back, front);
 			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
+				add(line, SurfaceType::Ceiling, front, back);
 		}
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Adds operations for line slope special [thing] to [ops], one for each
+// sector facing the thing on a line with its lineid
+// -----------------------------------------------------------------------------
+template<SurfaceType p> void MapSpecials::addLineSlopeOps(SLADEMap* map, MapThing* thing, vector<SlopeOp>& ops)
+{
+	int lineid = thing->intProperty("arg0");
+	if (!lineid)
+	{
+		LOG_MESSAGE(1, "Ignoring line slope thing %d with no lineid argument", thing->getIndex());
+		return;
+	}
+
+	auto lines = slope_line_ids_.find(lineid);
+	if (lines == slope_line_ids_.end())
+		return;
+
+	// The containing sector is looked up on first use, to avoid extra work if
+	// no lines match
+	int containing_sector_idx = -2;
+	for (auto line : lines->second)
+	{
+		// Line slope things only affect the sector on the side of the line
+		// that faces the thing
+		double     side   = MathStuff::lineSide(thing->point(), line->seg());
+		MapSector* target = nullptr;
+		if (side < 0)
+			target = line->backSector();
+		else if (side > 0)
+			target = line->frontSector();
+		if (!target)
+			continue;
+
+		// Need to know the containing sector's height to find the thing's true height
+		if (containing_sector_idx == -2)
+			containing_sector_idx = slopeThingCache(map, thing);
+		if (containing_sector_idx < 0)
+			return;
+
+		ops.emplace_back(SlopeOp::LineSlope, p, target);
+		ops.back().source = map->getSector(containing_sector_idx);
+		ops.back().line   = line;
+		ops.back().thing  = thing;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds an operation for vavoom slope [thing] to [ops], if it is in a sector
+// with a line matching its id
+// -----------------------------------------------------------------------------
+template<SurfaceType p> void MapSpecials::addVavoomOp(SLADEMap* map, MapThing* thing, vector<SlopeOp>& ops)
+{
+	int target_idx = slopeThingCache(map, thing);
+	if (target_idx < 0)
+		return;
+	MapSector* target = map->getSector(target_idx);
+
+	int              tid = thing->intProperty("id");
+	vector<MapLine*> lines;
+	target->getLines(lines);
+
+	// TODO unclear if this is the same order that ZDoom would go through the
+	// lines, which matters if two lines have the same first arg
+	for (unsigned a = 0; a < lines.size(); a++)
+	{
+		if (tid != lines[a]->intProperty("arg0"))
+			continue;
+
+		if (MathStuff::distanceToLineFast(thing->point(), lines[a]->seg()) == 0)
+		{
+			LOG_MESSAGE(1, "Vavoom thing %d lies directly on its target line %d", thing->getIndex(), a);
+			return;
+		}
+
+		ops.emplace_back(SlopeOp::Vavoom, p, target);
+		ops.back().line  = lines[a];
+		ops.back().thing = thing;
+		return;
+	}
+
+	LOG_MESSAGE(1, "Vavoom thing %d has no matching line with first arg %d", thing->getIndex(), tid);
+}
+
+// -----------------------------------------------------------------------------
+// Applies slope operation [op] to its target sector.
+// [last_thing] and [thingz] keep the height of the last line slope thing, which
+// is calculated once before any of the sectors it affects are changed
+// -----------------------------------------------------------------------------
+template<SurfaceType p> void MapSpecials::applySlopeOp(const SlopeOp& op, MapThing*& last_thing, double& thingz)
+{
+	switch (op.type)
+	{
+	case SlopeOp::PlaneAlign: applyPlaneAlign<p>(op.line, op.target, op.source); break;
+	case SlopeOp::LineSlope:
+		if (op.thing != last_thing)
+		{
+			last_thing = op.thing;
+			thingz = op.source->getPlane<p>().height_at(op.thing->point()) + op.thing->floatProperty("height");
+		}
+		applyLineSlope<p>(op.line, op.target, fpoint3_t(op.thing->xPos(), op.thing->yPos(), thingz));
+		break;
+	case SlopeOp::SectorTilt: applySectorTiltThing<p>(op.thing, op.target); break;
+	case SlopeOp::Vavoom: applyVavoomSlopeThing<p>(op.thing, op.line, op.target); break;
+	case SlopeOp::CopyPlane: op.target->setPlane<p>(op.source->getPlane<p>()); break;
+	case SlopeOp::VertexHeights:
+	{
+		fpoint3_t p1(op.vertices[0]->xPos(), op.vertices[0]->yPos(), op.heights[0]);
+		fpoint3_t p2(op.vertices[1]->xPos(), op.vertices[1]->yPos(), op.heights[1]);
+		fpoint3_t p3(op.vertices[2]->xPos(), op.vertices[2]->yPos(), op.heights[2]);
+		op.target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, p3));
+		break;
+	}
+	}
+}
 
 // -----------------------------------------------------------------------------
 // Applies a Plane_Align special on [line], to [target] from [model]
@@ -734,69 +1007,23 @@ template<SurfaceType p> void MapSpecials::applyPlaneAlign(MapLine* line, MapSect
 }
 
 // -----------------------------------------------------------------------------
-// Applies a line slope special on [thing], to its containing sector in [map]
+// Applies a line slope special on [line] to [target], sloping it up (or down)
+// to the line slope thing at [thing_pos]
 // -----------------------------------------------------------------------------
-template<SurfaceType p> void MapSpecials::applyLineSlopeThing(SLADEMap* map, MapThing* thing)
+template<SurfaceType p> void MapSpecials::applyLineSlope(MapLine* line, MapSector* target, fpoint3_t thing_pos)
 {
-	int lineid = thing->intProperty("arg0");
-	if (!lineid)
-	{
-		LOG_MESSAGE(1, "Ignoring line slope thing %d with no lineid argument", thing->getIndex());
-		return;
-	}
-
-	// These are computed on first use, to avoid extra work if no lines match
-	MapSector* containing_sector = nullptr;
-	double     thingz;
-
-	vector<MapLine*> lines;
-	map->getLinesById(lineid, lines);
-	for (unsigned b = 0; b < lines.size(); b++)
-	{
-		MapLine* line = lines[b];
-
-		// Line slope things only affect the sector on the side of the line
-		// that faces the thing
-		double     side   = MathStuff::lineSide(thing->point(), line->seg());
-		MapSector* target = nullptr;
-		if (side < 0)
-			target = line->backSector();
-		else if (side > 0)
-			target = line->frontSector();
-		if (!target)
-			continue;
-
-		// Need to know the containing sector's height to find the thing's true height
-		if (!containing_sector)
-		{
-			int containing_sector_idx = map->sectorAt(thing->point());
-			if (containing_sector_idx < 0)
-				return;
-			containing_sector = map->getSector(containing_sector_idx);
-			thingz = (containing_sector->getPlane<p>().height_at(thing->point()) + thing->floatProperty("height"));
-		}
-
-		// Three points: endpoints of the line, and the thing itself
-		plane_t   target_plane = target->getPlane<p>();
-		fpoint3_t p1(lines[b]->x1(), lines[b]->y1(), target_plane.height_at(lines[b]->point1()));
-		fpoint3_t p2(lines[b]->x2(), lines[b]->y2(), target_plane.height_at(lines[b]->point2()));
-		fpoint3_t p3(thing->xPos(), thing->yPos(), thingz);
-		target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, p3));
-	}
+	// Three points: endpoints of the line, and the thing itself
+	plane_t   target_plane = target->getPlane<p>();
+	fpoint3_t p1(line->x1(), line->y1(), target_plane.height_at(line->point1()));
+	fpoint3_t p2(line->x2(), line->y2(), target_plane.height_at(line->point2()));
+	target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, thing_pos));
 }
 
 // -----------------------------------------------------------------------------
-// Applies a tilt slope special on [thing], to its containing sector in [map]
+// Applies a tilt slope special on [thing], to its containing sector [target]
 // -----------------------------------------------------------------------------
-template<SurfaceType p> void MapSpecials::applySectorTiltThing(SLADEMap* map, MapThing* thing)
+template<SurfaceType p> void MapSpecials::applySectorTiltThing(MapThing* thing, MapSector* target)
 {
-	// TODO should this apply to /all/ sectors at this point, in the case of an
-	// intersection?
-	int target_idx = map->sectorAt(thing->point());
-	if (target_idx < 0)
-		return;
-	MapSector* target = map->getSector(target_idx);
-
 	// First argument is the tilt angle, but starting with 0 as straight down;
 	// subtracting 90 fixes that.
 	int raw_angle = thing->intProperty("arg0");
@@ -832,45 +1059,20 @@ template<SurfaceType p> void MapSpecials::applySectorTiltThing(SLADEMap* map, Ma
 }
 
 // -----------------------------------------------------------------------------
-// Applies a vavoom slope special on [thing], to its containing sector in [map]
+// Applies a vavoom slope special on [thing] and its matching [line], to its
+// containing sector [target]
 // -----------------------------------------------------------------------------
-template<SurfaceType p> void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, MapThing* thing)
+template<SurfaceType p> void MapSpecials::applyVavoomSlopeThing(MapThing* thing, MapLine* line, MapSector* target)
 {
-	int target_idx = map->sectorAt(thing->point());
-	if (target_idx < 0)
-		return;
-	MapSector* target = map->getSector(target_idx);
+	// Vavoom things use the plane defined by the thing and its two
+	// endpoints, based on the sector's original (flat) plane and treating
+	// the thing's height as absolute
+	short     height = target->getPlaneHeight<p>();
+	fpoint3_t p1(thing->xPos(), thing->yPos(), thing->floatProperty("height"));
+	fpoint3_t p2(line->x1(), line->y1(), height);
+	fpoint3_t p3(line->x2(), line->y2(), height);
 
-	int              tid = thing->intProperty("id");
-	vector<MapLine*> lines;
-	target->getLines(lines);
-
-	// TODO unclear if this is the same order that ZDoom would go through the
-	// lines, which matters if two lines have the same first arg
-	for (unsigned a = 0; a < lines.size(); a++)
-	{
-		if (tid != lines[a]->intProperty("arg0"))
-			continue;
-
-		// Vavoom things use the plane defined by the thing and its two
-		// endpoints, based on the sector's original (flat) plane and treating
-		// the thing's height as absolute
-		if (MathStuff::distanceToLineFast(thing->point(), lines[a]->seg()) == 0)
-		{
-			LOG_MESSAGE(1, "Vavoom thing %d lies directly on its target line %d", thing->getIndex(), a);
-			return;
-		}
-
-		short     height = target->getPlaneHeight<p>();
-		fpoint3_t p1(thing->xPos(), thing->yPos(), thing->floatProperty("height"));
-		fpoint3_t p2(lines[a]->x1(), lines[a]->y1(), height);
-		fpoint3_t p3(lines[a]->x2(), lines[a]->y2(), height);
-
-		target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, p3));
-		return;
-	}
-
-	LOG_MESSAGE(1, "Vavoom thing %d has no matching line with first arg %d", thing->getIndex(), tid);
+	target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, p3));
 }
 
 // -----------------------------------------------------------------------------
@@ -888,18 +1090,45 @@ template<SurfaceType p> double MapSpecials::vertexHeight(MapVertex* vertex, MapS
 }
 
 // -----------------------------------------------------------------------------
-// Applies a slope to sector [target] based on the heights of its vertices
-// (triangular sectors only)
+// Adds an operation to [ops] sloping sector [target] based on the heights of
+// its vertices (triangular sectors only)
 // -----------------------------------------------------------------------------
 template<SurfaceType p>
-void MapSpecials::applyVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights)
+void MapSpecials::addVertexHeightOp(
+	MapSector*          target,
+	vector<MapVertex*>& vertices,
+	VertexHeightMap&    heights,
+	vector<SlopeOp>&    ops)
 {
-	double z1 = heights.count(vertices[0]) ? heights[vertices[0]] : vertexHeight<p>(vertices[0], target);
-	double z2 = heights.count(vertices[1]) ? heights[vertices[1]] : vertexHeight<p>(vertices[1], target);
-	double z3 = heights.count(vertices[2]) ? heights[vertices[2]] : vertexHeight<p>(vertices[2], target);
+	ops.emplace_back(SlopeOp::VertexHeights, p, target);
+	for (unsigned a = 0; a < 3; a++)
+	{
+		MapVertex* vertex      = vertices[a];
+		ops.back().vertices[a] = vertex;
+		ops.back().heights[a]  = heights.count(vertex) ? heights[vertex] : vertexHeight<p>(vertex, target);
+	}
+}
 
-	fpoint3_t p1(vertices[0]->xPos(), vertices[0]->yPos(), z1);
-	fpoint3_t p2(vertices[1]->xPos(), vertices[1]->yPos(), z2);
-	fpoint3_t p3(vertices[2]->xPos(), vertices[2]->yPos(), z3);
-	target->setPlane<p>(MathStuff::planeFromTriangle(p1, p2, p3));
+
+// -----------------------------------------------------------------------------
+//
+// MapSpecials::SlopeOp Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if the operation is the same as [other]
+// -----------------------------------------------------------------------------
+bool MapSpecials::SlopeOp::operator==(const SlopeOp& other) const
+{
+	if (type != other.type || surface != other.surface || target != other.target || source != other.source
+		|| line != other.line || thing != other.thing)
+		return false;
+
+	for (unsigned a = 0; a < 3; a++)
+		if (vertices[a] != other.vertices[a] || heights[a] != other.heights[a])
+			return false;
+
+	return true;
 }
@@ -30,6 +30,10 @@ public:
 	void processACSScripts(ArchiveEntry* entry);
 	void setModified(SLADEMap* map, int tag);
 
+	// Slopes
+	unsigned nSlopeSectorsUpdated() const { return slope_sectors_updated_; }
+	unsigned checkSlopes(SLADEMap* map);
+
 private:
 	struct SectorColour
 	{
@@ -37,16 +41,85 @@ private:
 		rgba_t colour;
 	};
 
+	// A single operation setting a sector plane. The list of these (in the
+	// order they are applied) is the dependency graph from lines, things,
+	// vertices and other sectors to each sloped sector plane
+	struct SlopeOp
+	{
+		enum Type
+		{
+			PlaneAlign,
+			LineSlope,
+			SectorTilt,
+			Vavoom,
+			CopyPlane,
+			VertexHeights
+		};
+
+		Type                   type;
+		MapSector::SurfaceType surface;
+		MapSector*             target      = nullptr;
+		MapSector*             source      = nullptr; // Other sector read by the operation
+		MapLine*               line        = nullptr;
+		MapThing*              thing       = nullptr;
+		MapVertex*             vertices[3] = { nullptr, nullptr, nullptr };
+		double                 heights[3]  = { 0, 0, 0 };
+
+		SlopeOp(Type type, MapSector::SurfaceType surface, MapSector* target) :
+			type{ type },
+			surface{ surface },
+			target{ target }
+		{
+		}
+
+		bool operator==(const SlopeOp& other) const;
+		bool operator!=(const SlopeOp& other) const { return !(*this == other); }
+	};
+
 	vector<SectorColour> sector_colours_;
 	vector<SectorColour> sector_fadecolours_;
 
-	void                                    processZDoomSlopes(SLADEMap* map);
-	void                                    processEternitySlopes(SLADEMap* map);
+	// Slopes
+	struct SlopeThingCache
+	{
+		MapThing* thing = nullptr;
+		int       index = -2; // Containing sector (or vertex for vertex height things), -2 if not cached
+	};
+
+	vector<SlopeOp>                           slope_ops_;
+	long                                      slopes_time_             = -1;
+	long                                      slopes_geometry_updated_ = -1;
+	unsigned                                  slopes_n_lines_          = 0;
+	unsigned                                  slopes_n_sectors_        = 0;
+	vector<fpoint2_t>                         slope_vertex_pos_;
+	vector<MapSector*>                        slope_side_sectors_;
+	vector<MapSector*>                        slope_triangles_;
+	vector<SlopeThingCache>                   slope_thing_cache_;
+	std::unordered_map<int, MapSector*>       slope_tagged_;
+	std::unordered_map<int, vector<MapLine*>> slope_line_ids_;
+	unsigned                                  slope_sectors_updated_   = 0;
+
+	void       processZDoomSlopes(SLADEMap* map);
+	void       processEternitySlopes(SLADEMap* map);
+	bool       beginSlopeUpdate(SLADEMap* map);
+	void       updateSlopes(SLADEMap* map, vector<SlopeOp>& ops, bool full);
+	int        slopeThingCache(SLADEMap* map, MapThing* thing);
+	MapSector* taggedSector(int tag);
+	void       addPlaneAlignOps(SLADEMap* map, vector<SlopeOp>& ops);
+	void       addPlaneCopyOps(SLADEMap* map, vector<SlopeOp>& ops);
+
+	template<MapSector::SurfaceType> void   addLineSlopeOps(SLADEMap* map, MapThing* thing, vector<SlopeOp>& ops);
+	template<MapSector::SurfaceType> void   addVavoomOp(SLADEMap* map, MapThing* thing, vector<SlopeOp>& ops);
+	template<MapSector::SurfaceType> void   applySlopeOp(const SlopeOp& op, MapThing*& last_thing, double& thingz);
 	template<MapSector::SurfaceType> void   applyPlaneAlign(MapLine* line, MapSector* sector, MapSector* model_sector);
-	template<MapSector::SurfaceType> void   applyLineSlopeThing(SLADEMap* map, MapThing* thing);
-	template<MapSector::SurfaceType> void   applySectorTiltThing(SLADEMap* map, MapThing* thing);
-	template<MapSector::SurfaceType> void   applyVavoomSlopeThing(SLADEMap* map, MapThing* thing);
+	template<MapSector::SurfaceType> void   applyLineSlope(MapLine* line, MapSector* target, fpoint3_t thing_pos);
+	template<MapSector::SurfaceType> void   applySectorTiltThing(MapThing* thing, MapSector* target);
+	template<MapSector::SurfaceType> void   applyVavoomSlopeThing(MapThing* thing, MapLine* line, MapSector* target);
 	template<MapSector::SurfaceType> double vertexHeight(MapVertex* vertex, MapSector* sector);
 	template<MapSector::SurfaceType>
-	void applyVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights);
+	void addVertexHeightOp(
+		MapSector*          target,
+		vector<MapVertex*>& vertices,
+		VertexHeightMap&    heights,
+		vector<SlopeOp>&    ops);
 };
@@ -66,6 +66,8 @@ public:
 	void refreshResources();
 	void buildTexInfoList();
 
+	Archive* getArchive() const { return archive_; }
+
 	Palette*   getResourcePalette();
 	GLTexture* getTexture(string name, bool mixed);
 	GLTexture* getFlat(string name, bool mixed);
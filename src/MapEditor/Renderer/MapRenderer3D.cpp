@@ -45,6 +45,8 @@
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/MathStuff.h"
 
+using LineFlag = Game::Configuration::LineBasicFlag;
+
 
 // -----------------------------------------------------------------------------
 //
@@ -68,6 +70,7 @@ CVAR(Bool, render_shade_orthogonal_lines, true, CVAR_SAVE)
 CVAR(Bool, mlook_invert_y, false, CVAR_SAVE)
 CVAR(Float, camera_3d_sensitivity_x, 1.0f, CVAR_SAVE)
 CVAR(Float, camera_3d_sensitivity_y, 1.0f, CVAR_SAVE)
+CVAR(Bool, render_3d_portal_culling, true, CVAR_SAVE)
 
 
 // -----------------------------------------------------------------------------
@@ -79,6 +82,26 @@ EXTERN_CVAR(Bool, flats_use_vbo)
 EXTERN_CVAR(Bool, use_zeth_icons)
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the angle (in radians) of [point] relative to the view direction
+// [dir] from [cam]
+// -----------------------------------------------------------------------------
+double viewAngle(fpoint2_t cam, fpoint2_t dir, fpoint2_t point)
+{
+	double dx = point.x - cam.x;
+	double dy = point.y - cam.y;
+	return atan2(dir.x * dy - dir.y * dx, dir.x * dx + dir.y * dy);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapRenderer3D Class Functions
@@ -108,6 +131,8 @@ MapRenderer3D::MapRenderer3D(SLADEMap* map)
 	this->flat_last_        = 0;
 	this->render_hilight_   = true;
 	this->render_selection_ = true;
+	this->cam_sector_       = -1;
+	this->view_aspect_      = 1.6f;
 
 	// Build skybox circle
 	buildSkyCircle();
@@ -183,6 +208,7 @@ void MapRenderer3D::refresh()
 
 	floors_.clear();
 	ceilings_.clear();
+	clearPickProxies(PICK_SECTOR);
 
 	// Set sky texture
 	auto minf     = Game::configuration().mapInfo(map_->mapName());
@@ -202,6 +228,9 @@ void MapRenderer3D::clearData()
 	things_.clear();
 	floors_.clear();
 	ceilings_.clear();
+	pick_tree_.clear();
+	for (auto& proxies : pick_proxies_)
+		proxies.clear();
 
 	// Clear everything else
 	refresh();
@@ -458,6 +487,7 @@ void MapRenderer3D::setupView(int width, int height)
 	// Calculate aspect ratio
 	float aspect = (1.6f / 1.333333f) * ((float)width / (float)height);
 	float fovy   = 2 * MathStuff::radToDeg(atan(tan(MathStuff::degToRad(90) / 2) / aspect));
+	view_aspect_ = aspect;
 
 	// Setup projection
 	glMatrixMode(GL_PROJECTION);
@@ -589,15 +619,22 @@ void MapRenderer3D::renderMap()
 	{
 		floors_.resize(map_->nSectors());
 		ceilings_.resize(map_->nSectors());
+		resizePickProxies(PICK_SECTOR, map_->nSectors());
 	}
 
 	// Create lines array if empty
 	if (lines_.size() != map_->nLines())
+	{
 		lines_.resize(map_->nLines());
+		resizePickProxies(PICK_LINE, map_->nLines());
+	}
 
 	// Create things array if empty
 	if (things_.size() != map_->nThings())
+	{
 		things_.resize(map_->nThings());
+		resizePickProxies(PICK_THING, map_->nThings());
+	}
 
 	// Quick distance vis check
 	sf::Clock clock;
@@ -606,6 +643,9 @@ void MapRenderer3D::renderMap()
 	// Build lists of quads and flats to render
 	checkVisibleFlats();
 	checkVisibleQuads();
+	stats_.quads    = n_quads_;
+	stats_.flats    = n_flats_;
+	stats_.vis_time = clock.getElapsedTime().asMicroseconds() / 1000.0f;
 
 	// Render sky
 	if (render_3d_sky)
@@ -980,6 +1020,7 @@ void MapRenderer3D::updateSector(unsigned index)
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		sector->getPolygon()->setZ(0);
 	}
+	updatePickBounds(PICK_SECTOR, index);
 }
 
 // -----------------------------------------------------------------------------
@@ -1290,15 +1331,18 @@ void MapRenderer3D::updateLine(unsigned index)
 	// Skip invalid line
 	MapLine* line = map_->getLine(index);
 	if (!line->s1())
+	{
+		updatePickBounds(PICK_LINE, index);
 		return;
+	}
 
 	// Process line special
 	map_->mapSpecials()->processLineSpecial(line);
 
 	// Get relevant line info
 	int    map_format = MapEditor::editContext().mapDesc().format;
-	bool   upeg       = Game::configuration().lineBasicFlagSet("dontpegtop", line, map_format);
-	bool   lpeg       = Game::configuration().lineBasicFlagSet("dontpegbottom", line, map_format);
+	bool   upeg       = Game::configuration().lineBasicFlagSet(LineFlag::DontPegTop, line, map_format);
+	bool   lpeg       = Game::configuration().lineBasicFlagSet(LineFlag::DontPegBottom, line, map_format);
 	double xoff, yoff, sx, sy, lsx, lsy;
 	bool   mixed       = Game::configuration().featureSupported(Feature::MixTexFlats);
 	lines_[index].line = line;
@@ -1850,6 +1894,7 @@ void MapRenderer3D::updateLine(unsigned index)
 
 	// Finished
 	lines_[index].updated_time = App::runTimer();
+	updatePickBounds(PICK_LINE, index);
 }
 
 // -----------------------------------------------------------------------------
@@ -2145,6 +2190,7 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 	things_[index].z += MapEditor::textureManager().getVerticalOffset(things_[index].type->sprite());
 
 	things_[index].updated_time = App::runTimer();
+	updatePickBounds(PICK_THING, index);
 }
 
 // -----------------------------------------------------------------------------
@@ -2196,6 +2242,10 @@ void MapRenderer3D::renderThings()
 				break;
 		}
 
+		// Skip if the thing's sector can't be seen
+		if (stats_.portals && things_[a].sector && dist_sectors_[things_[a].sector->getIndex()] < 0)
+			continue;
+
 		// Skip if not shown
 		if (!things_[a].type->decoration() && render_3d_things == 2)
 			continue;
@@ -2555,7 +2605,8 @@ void MapRenderer3D::updateWallsVBO() {}
 
 // -----------------------------------------------------------------------------
 // Runs a quick check of all sector bounding boxes against the current view to
-// hide any that are outside it
+// hide any that are outside it. If portal culling is enabled, sectors that
+// can't be seen from the camera's sector are also hidden
 // -----------------------------------------------------------------------------
 void MapRenderer3D::quickVisDiscard()
 {
@@ -2563,12 +2614,22 @@ void MapRenderer3D::quickVisDiscard()
 	if (dist_sectors_.size() != map_->nSectors())
 		dist_sectors_.resize(map_->nSectors());
 
+	// Determine sectors visible from the camera
+	stats_.portals = render_3d_portal_culling && checkPortalVisibility();
+
 	// Go through all sectors
 	fpoint2_t cam = cam_position_.get2d();
 	double    min_dist, dist;
 	fseg2_t   strafe(cam, cam + cam_strafe_.get2d());
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
+		// Hide if not visible from the camera sector
+		if (stats_.portals && !vis_sectors_[a])
+		{
+			dist_sectors_[a] = -1.0f;
+			continue;
+		}
+
 		// Get sector bbox
 		bbox_t bbox = map_->getSector(a)->boundingBox();
 
@@ -2614,17 +2675,165 @@ void MapRenderer3D::quickVisDiscard()
 		}
 	}
 
-	// Set all lines that are part of invisible sectors to invisible
+	// Set all lines that aren't part of any visible sector to invisible
+	for (unsigned a = 0; a < map_->nLines(); a++)
+		lines_[a].visible = false;
 	for (unsigned a = 0; a < map_->nSides(); a++)
 	{
 		dist = dist_sectors_[map_->getSide(a)->getSector()->getIndex()];
-		if (dist < 0 || (render_max_dist > 0 && dist > render_max_dist))
-			lines_[map_->getSide(a)->getParentLine()->getIndex()].visible = false;
-		else
+		if (dist >= 0 && (render_max_dist <= 0 || dist <= render_max_dist))
 			lines_[map_->getSide(a)->getParentLine()->getIndex()].visible = true;
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Determines which sectors can be seen from the camera, by flooding out from
+// the sector the camera is in through any open two-sided lines within view.
+// The range of view angles is narrowed by each line passed through, so
+// sectors hidden behind walls (or closed doors) are never reached.
+//
+// Sets [vis_sectors_] for each visible sector, returns false if the camera
+// isn't within a sector or the map is too complex to check (in which case all
+// sectors should be considered visible)
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::checkPortalVisibility()
+{
+	// Find the sector the camera is in (check the previous one first)
+	fpoint2_t cam = cam_position_.get2d();
+	if (cam_sector_ < 0 || cam_sector_ >= (int)map_->nSectors() || !map_->getSector(cam_sector_)->isWithin(cam))
+		cam_sector_ = map_->sectorAt(cam);
+	if (cam_sector_ < 0)
+		return false;
+
+	// Init
+	unsigned n_sectors = map_->nSectors();
+	vis_sectors_.assign(n_sectors, 0);
+	if (vis_ranges_.size() != n_sectors)
+		vis_ranges_.resize(n_sectors);
+	for (auto& ranges : vis_ranges_)
+		ranges.clear();
+
+	// Determine the horizontal range of the view. The horizontal fov is always
+	// 90 degrees (see setupView), but it widens when looking up or down
+	VisRange  view{ -PI, PI };
+	double    forward = cos(cam_pitch_) - fabs(sin(cam_pitch_)) / view_aspect_;
+	fpoint2_t dir     = cam_direction_.normalized();
+	if (forward > 0.01)
+	{
+		double half = atan2(1.0, forward) + 0.05;
+		if (half < PI)
+			view = { -half, half };
+	}
+
+	// Flood through sectors from the camera sector
+	struct Portal
+	{
+		unsigned sector;
+		VisRange range;
+	};
+	vector<Portal> portals{ { (unsigned)cam_sector_, view } };
+	while (!portals.empty())
+	{
+		auto current = portals.back();
+		portals.pop_back();
+
+		// Skip if this part of the view has already been checked for the sector
+		auto& ranges = vis_ranges_[current.sector];
+		bool  done   = false;
+		for (auto& range : ranges)
+			if (range.min <= current.range.min && range.max >= current.range.max)
+			{
+				done = true;
+				break;
+			}
+		if (done)
+			continue;
+
+		// Give up if the sector keeps being reached through different ranges
+		if (ranges.size() >= 32)
+			return false;
+
+		ranges.push_back(current.range);
+		vis_sectors_[current.sector] = 1;
+
+		// Check lines to other sectors
+		auto sector = map_->getSector(current.sector);
+		for (auto side : sector->connectedSides())
+		{
+			auto line  = side->getParentLine();
+			bool front = (side == line->s1());
+			auto other = front ? line->backSector() : line->frontSector();
+			if (!other || other == sector)
+				continue;
+
+			// Check the camera is on this sector's side of the line
+			double cam_side = MathStuff::lineSide(cam, line->seg());
+			if ((front && cam_side < 0) || (!front && cam_side > 0))
+				continue;
+
+			// Check the opening between the sectors isn't closed. Ignore sloped or
+			// sky flats since they can be seen over
+			auto& f1 = sector->floor();
+			auto& c1 = sector->ceiling();
+			auto& f2 = other->floor();
+			auto& c2 = other->ceiling();
+			if (f1.plane.a == 0 && f1.plane.b == 0 && c1.plane.a == 0 && c1.plane.b == 0 && f2.plane.a == 0
+				&& f2.plane.b == 0 && c2.plane.a == 0 && c2.plane.b == 0
+				&& std::min(c1.height, c2.height) <= std::max(f1.height, f2.height)
+				&& !S_CMPNOCASE(c1.texture, Game::configuration().skyFlat())
+				&& !S_CMPNOCASE(c2.texture, Game::configuration().skyFlat()))
+				continue;
+
+			// Check distance
+			double dist = MathStuff::distanceToLine(cam, line->seg());
+			if (render_max_dist > 0 && dist > render_max_dist)
+				continue;
+
+			// If the camera is (almost) on the line, the whole current range is
+			// visible through it
+			if (dist < 1.0)
+			{
+				portals.push_back({ other->getIndex(), current.range });
+				continue;
+			}
+
+			// Get the range of view angles covered by the line
+			double a1  = viewAngle(cam, dir, line->point1());
+			double a2  = viewAngle(cam, dir, line->point2());
+			double d   = a2 - a1;
+			if (d > PI)
+				d -= PI * 2;
+			else if (d < -PI)
+				d += PI * 2;
+			double min = std::min(a1, a1 + d);
+			double max = std::max(a1, a1 + d);
+
+			// Narrow the current range to it (the line's range may wrap around
+			// behind the camera, in which case it is split in two)
+			auto add = [&](double from, double to) {
+				from = std::max(from, current.range.min);
+				to   = std::min(to, current.range.max);
+				if (from < to)
+					portals.push_back({ other->getIndex(), { from, to } });
+			};
+			if (max > PI)
+			{
+				add(min, PI);
+				add(-PI, max - PI * 2);
+			}
+			else if (min < -PI)
+			{
+				add(min + PI * 2, PI);
+				add(-PI, max);
+			}
+			else
+				add(min, max);
+		}
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Calculates and returns the faded alpha value for [distance] from the camera
 // -----------------------------------------------------------------------------
@@ -2777,6 +2986,7 @@ void MapRenderer3D::checkVisibleFlats()
 		// Add floor flat
 		flats_[n_flats_++] = &(floors_[a]);
 	}
+	stats_.sectors = n_flats_;
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
 		// Skip if invisible
@@ -2794,7 +3004,9 @@ void MapRenderer3D::checkVisibleFlats()
 MapEditor::Item MapRenderer3D::determineHilight()
 {
 	// Init
-	double          min_dist = 9999999;
+	double          min_dist  = 9999999;
+	int             min_type  = PICK_TYPES;
+	unsigned        min_index = 0;
 	MapEditor::Item current;
 	fseg2_t         strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
 
@@ -2803,14 +3015,28 @@ MapEditor::Item MapRenderer3D::determineHilight()
 		|| things_.size() != map_->nThings())
 		return current;
 
-	// Check lines
+	// Returns true if a hit at [dist] is closer than the current closest hit.
+	// If they are the same distance, lines take priority over sectors, then
+	// things, then lower indices (same as checking each in order)
+	auto closer = [&](double dist, int type, unsigned index) {
+		if (dist != min_dist)
+			return dist < min_dist;
+		return type < min_type || (type == min_type && index < min_index);
+	};
+	auto setCurrent = [&](double dist, int type, unsigned index, MapEditor::ItemType item_type, int item_index) {
+		current.index = item_index;
+		current.type  = item_type;
+		min_dist      = dist;
+		min_type      = type;
+		min_index     = index;
+	};
+
+	// Checks the line at [a] for a hit
 	double height, dist;
-	Quad*  quad;
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
+	auto   checkLine = [&](unsigned a) {
 		// Ignore if not visible
 		if (!lines_[a].visible)
-			continue;
+			return;
 
 		MapLine* line = map_->getLine(a);
 
@@ -2819,120 +3045,93 @@ MapEditor::Item MapRenderer3D::determineHilight()
 			cam_position_.get2d(), (cam_position_ + cam_dir3d_).get2d(), line->point1(), line->point2());
 
 		// Ignore if no intersection or something was closer
-		if (dist < 0 || dist >= min_dist)
-			continue;
+		if (dist < 0 || !closer(dist, PICK_LINE, a))
+			return;
 
 		// Find quad intersect if any
 		fpoint3_t intersection = cam_position_ + cam_dir3d_ * dist;
-		for (unsigned q = 0; q < lines_[a].quads.size(); q++)
+		for (auto& quad : lines_[a].quads)
 		{
-			quad = &lines_[a].quads[q];
-
 			// Check side of camera
 			if (MathStuff::lineSide(
 					cam_position_.get2d(),
-					fseg2_t(quad->points[0].x, quad->points[0].y, quad->points[2].x, quad->points[2].y))
+					fseg2_t(quad.points[0].x, quad.points[0].y, quad.points[2].x, quad.points[2].y))
 				< 0)
 				continue;
 
 			// Check intersection height
 			// Need to handle slopes by finding the floor and ceiling height of
 			// the quad at the intersection point
-			fpoint2_t seg_left  = fpoint2_t(quad->points[1].x, quad->points[1].y);
-			fpoint2_t seg_right = fpoint2_t(quad->points[2].x, quad->points[2].y);
+			fpoint2_t seg_left  = fpoint2_t(quad.points[1].x, quad.points[1].y);
+			fpoint2_t seg_right = fpoint2_t(quad.points[2].x, quad.points[2].y);
 			double    dist_along_segment =
 				(intersection.get2d() - seg_left).magnitude() / (seg_right - seg_left).magnitude();
-			double top    = quad->points[0].z + (quad->points[3].z - quad->points[0].z) * dist_along_segment;
-			double bottom = quad->points[1].z + (quad->points[2].z - quad->points[1].z) * dist_along_segment;
+			double top    = quad.points[0].z + (quad.points[3].z - quad.points[0].z) * dist_along_segment;
+			double bottom = quad.points[1].z + (quad.points[2].z - quad.points[1].z) * dist_along_segment;
 			if (bottom <= intersection.z && intersection.z <= top)
 			{
 				// Determine selected item from quad flags
-
-				// Side index
-				if (quad->flags & BACK)
-					current.index = line->s2Index();
+				MapEditor::ItemType type;
+				if (quad.flags & UPPER)
+					type = MapEditor::ItemType::WallTop;
+				else if (quad.flags & LOWER)
+					type = MapEditor::ItemType::WallBottom;
 				else
-					current.index = line->s1Index();
+					type = MapEditor::ItemType::WallMiddle;
 
-				// Side part
-				if (quad->flags & UPPER)
-					current.type = MapEditor::ItemType::WallTop;
-				else if (quad->flags & LOWER)
-					current.type = MapEditor::ItemType::WallBottom;
-				else
-					current.type = MapEditor::ItemType::WallMiddle;
-
-				min_dist = dist;
+				setCurrent(dist, PICK_LINE, a, type, (quad.flags & BACK) ? line->s2Index() : line->s1Index());
 			}
 		}
-	}
+	};
 
-	// Check sectors
-	for (unsigned a = 0; a < map_->nSectors(); a++)
-	{
+	// Checks the floor and ceiling of the sector at [a] for a hit
+	auto checkSector = [&](unsigned a) {
 		// Ignore if not visible
 		if (dist_sectors_[a] < 0)
-			continue;
+			return;
 
 		// Check distance to floor plane
 		dist = MathStuff::distanceRayPlane(cam_position_, cam_dir3d_, floors_[a].plane);
-		if (dist >= 0 && dist < min_dist)
+		if (dist >= 0 && closer(dist, PICK_SECTOR, a))
 		{
 			// Check if on the correct side of the plane
 			if (cam_position_.z > floors_[a].plane.height_at(cam_position_.x, cam_position_.y))
 			{
 				// Check if intersection is within sector
 				if (map_->getSector(a)->isWithin((cam_position_ + cam_dir3d_ * dist).get2d()))
-				{
-					current.index = a;
-					current.type  = MapEditor::ItemType::Floor;
-					min_dist      = dist;
-				}
+					setCurrent(dist, PICK_SECTOR, a, MapEditor::ItemType::Floor, a);
 			}
 		}
 
 		// Check distance to ceiling plane
 		dist = MathStuff::distanceRayPlane(cam_position_, cam_dir3d_, ceilings_[a].plane);
-		if (dist >= 0 && dist < min_dist)
+		if (dist >= 0 && closer(dist, PICK_SECTOR, a))
 		{
 			// Check if on the correct side of the plane
 			if (cam_position_.z < ceilings_[a].plane.height_at(cam_position_.x, cam_position_.y))
 			{
 				// Check if intersection is within sector
 				if (map_->getSector(a)->isWithin((cam_position_ + cam_dir3d_ * dist).get2d()))
-				{
-					current.index = a;
-					current.type  = MapEditor::ItemType::Ceiling;
-					min_dist      = dist;
-				}
+					setCurrent(dist, PICK_SECTOR, a, MapEditor::ItemType::Ceiling, a);
 			}
 		}
-	}
-
-	// Update item distance
-	if (min_dist >= 9999999 || min_dist < 0)
-		item_dist_ = -1;
-	else
-		item_dist_ = MathStuff::round(min_dist);
+	};
 
-	// Check things (if visible)
-	if (render_3d_things == 0)
-		return current;
+	// Checks the thing at [a] for a hit
 	double halfwidth, theight;
-	for (unsigned a = 0; a < map_->nThings(); a++)
-	{
+	auto   checkThing = [&](unsigned a) {
 		// Ignore if no sprite
 		if (!things_[a].sprite)
-			continue;
+			return;
 
 		// Ignore if not visible
 		MapThing* thing = map_->getThing(a);
 		if (MathStuff::lineSide(thing->point(), strafe) > 0)
-			continue;
+			return;
 
 		// Ignore if not shown
 		if (!things_[a].type->decoration() && render_3d_things == 2)
-			continue;
+			return;
 
 		// Find distance to thing sprite
 		halfwidth = things_[a].sprite->getWidth() * 0.5;
@@ -2945,8 +3144,8 @@ MapEditor::Item MapRenderer3D::determineHilight()
 			thing->point() + cam_strafe_.get2d() * halfwidth);
 
 		// Ignore if no intersection or something was closer
-		if (dist < 0 || dist >= min_dist)
-			continue;
+		if (dist < 0 || !closer(dist, PICK_THING, a))
+			return;
 
 		// Check intersection height
 		theight = things_[a].sprite->getHeight();
@@ -2954,12 +3153,30 @@ MapEditor::Item MapRenderer3D::determineHilight()
 		if (things_[a].flags & ICON)
 			theight = render_thing_icon_size;
 		if (height >= things_[a].z && height <= things_[a].z + theight)
-		{
-			current.index = a;
-			current.type  = MapEditor::ItemType::Thing;
-			min_dist      = dist;
-		}
-	}
+			setCurrent(dist, PICK_THING, a, MapEditor::ItemType::Thing, a);
+	};
+
+	// Check objects with bounding boxes hit by the view ray, closest first
+	pick_tree_.raycast(cam_position_, cam_dir3d_, min_dist, [&](int item, double max_dist) {
+		unsigned index = item / PICK_TYPES;
+		switch (item % PICK_TYPES)
+		{
+		case PICK_LINE:
+			if (index < map_->nLines())
+				checkLine(index);
+			break;
+		case PICK_SECTOR:
+			if (index < map_->nSectors())
+				checkSector(index);
+			break;
+		default:
+			if (render_3d_things > 0 && index < map_->nThings())
+				checkThing(index);
+			break;
+		}
+
+		return std::min(max_dist, min_dist);
+	});
 
 	// Update item distance
 	if (min_dist >= 9999999 || min_dist < 0)
@@ -2970,6 +3187,99 @@ MapEditor::Item MapRenderer3D::determineHilight()
 	return current;
 }
 
+// -----------------------------------------------------------------------------
+// Updates the bounding box used for hilight picking of the line, sector or
+// thing at [index] (depending on [type]) from its cached rendering data
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updatePickBounds(unsigned type, unsigned index)
+{
+	if (pick_proxies_[type].size() <= index)
+		pick_proxies_[type].resize(index + 1, -1);
+
+	// Determine bounding box
+	AABBTree::Box box;
+	bool          valid = false;
+	auto          add   = [&](double x, double y, double z) {
+		fpoint3_t point(x, y, z);
+		if (valid)
+			box.extend(point);
+		else
+			box = { point, point };
+		valid = true;
+	};
+	if (type == PICK_LINE)
+	{
+		// All line quads
+		for (auto& quad : lines_[index].quads)
+			for (auto& point : quad.points)
+				add(point.x, point.y, point.z);
+	}
+	else if (type == PICK_SECTOR)
+	{
+		// Sector bbox between the lowest and highest floor/ceiling points
+		auto bbox = map_->getSector(index)->boundingBox();
+		for (auto& plane : { floors_[index].plane, ceilings_[index].plane })
+		{
+			add(bbox.min.x, bbox.min.y, plane.height_at(bbox.min.x, bbox.min.y));
+			add(bbox.max.x, bbox.min.y, plane.height_at(bbox.max.x, bbox.min.y));
+			add(bbox.min.x, bbox.max.y, plane.height_at(bbox.min.x, bbox.max.y));
+			add(bbox.max.x, bbox.max.y, plane.height_at(bbox.max.x, bbox.max.y));
+		}
+	}
+	else if (things_[index].sprite)
+	{
+		// Thing sprite (which always faces the camera)
+		double halfwidth = things_[index].sprite->getWidth() * 0.5;
+		double height    = things_[index].sprite->getHeight();
+		if (things_[index].flags & ICON)
+		{
+			halfwidth = render_thing_icon_size * 0.5;
+			height    = render_thing_icon_size;
+		}
+		auto point = map_->getThing(index)->point();
+		add(point.x - halfwidth, point.y - halfwidth, things_[index].z);
+		add(point.x + halfwidth, point.y + halfwidth, things_[index].z + height);
+	}
+
+	// Remove from the tree if nothing to pick
+	int& proxy = pick_proxies_[type][index];
+	if (!valid)
+	{
+		if (proxy >= 0)
+			pick_tree_.remove(proxy);
+		proxy = -1;
+		return;
+	}
+
+	// Add or update in the tree (with a bit of leeway for rounding errors)
+	box.expand(1.0);
+	if (proxy < 0)
+		proxy = pick_tree_.insert(box, index * PICK_TYPES + type);
+	else
+		pick_tree_.update(proxy, box);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the picking bounding boxes of any objects of [type] past [count]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::resizePickProxies(unsigned type, unsigned count)
+{
+	auto& proxies = pick_proxies_[type];
+	for (unsigned a = count; a < proxies.size(); a++)
+		if (proxies[a] >= 0)
+			pick_tree_.remove(proxies[a]);
+
+	proxies.resize(count, -1);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the picking bounding boxes of all objects of [type]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::clearPickProxies(unsigned type)
+{
+	resizePickProxies(type, 0);
+}
+
 // -----------------------------------------------------------------------------
 // Renders the hilight overlay for the currently hilighted object
 // -----------------------------------------------------------------------------
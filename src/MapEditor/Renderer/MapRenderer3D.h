@@ -3,6 +3,7 @@
 #include "General/ListenerAnnouncer.h"
 #include "MapEditor/Edit/Edit3D.h"
 #include "MapEditor/SLADEMap/SLADEMap.h"
+#include "Utility/AABBTree.h"
 
 class ItemSelection;
 class GLTexture;
@@ -116,6 +117,14 @@ public:
 			sector       = nullptr;
 		}
 	};
+	struct RenderStats
+	{
+		unsigned sectors  = 0; // Visible sectors
+		unsigned quads    = 0; // Visible (opaque) wall quads
+		unsigned flats    = 0; // Visible flats
+		float    vis_time = 0; // Time taken for visibility checks (ms)
+		bool     portals  = false; // Portal culling was used
+	};
 
 	MapRenderer3D(SLADEMap* map = nullptr);
 	~MapRenderer3D();
@@ -128,6 +137,8 @@ public:
 	void enableHilight(bool render) { render_hilight_ = render; }
 	void enableSelection(bool render) { render_selection_ = render; }
 
+	const RenderStats& renderStats() const { return stats_; }
+
 	bool init();
 	void refresh();
 	void clearData();
@@ -204,6 +215,7 @@ public:
 
 	// Visibility checking
 	void  quickVisDiscard();
+	bool  checkPortalVisibility();
 	float calcDistFade(double distance, double max = -1);
 	void  checkVisibleQuads();
 	void  checkVisibleFlats();
@@ -229,7 +241,16 @@ private:
 	float      fog_depth_last_;
 
 	// Visibility
-	vector<float> dist_sectors_;
+	struct VisRange
+	{
+		double min, max; // View angles relative to the camera direction
+	};
+	vector<float>            dist_sectors_;
+	vector<uint8_t>          vis_sectors_;
+	vector<vector<VisRange>> vis_ranges_;
+	int                      cam_sector_;
+	float                    view_aspect_;
+	RenderStats              stats_;
 
 	// Camera
 	fpoint3_t cam_position_;
@@ -241,6 +262,20 @@ private:
 	double    gravity_;
 	int       item_dist_;
 
+	// Picking (bounding boxes of all lines, sectors and things, for hilight)
+	enum PickType
+	{
+		PICK_LINE,
+		PICK_SECTOR,
+		PICK_THING,
+		PICK_TYPES
+	};
+	AABBTree    pick_tree_;
+	vector<int> pick_proxies_[PICK_TYPES]; // Tree proxy ids by object index
+	void        updatePickBounds(unsigned type, unsigned index);
+	void        resizePickProxies(unsigned type, unsigned count);
+	void        clearPickProxies(unsigned type);
+
 	// Map Structures
 	vector<Line>  lines_;
 	Quad**        quads_;
@@ -44,6 +44,8 @@
 #include "OpenGL/Drawing.h"
 #include "OpenGL/OpenGL.h"
 
+using LineFlag = Game::Configuration::LineBasicFlag;
+
 
 // -----------------------------------------------------------------------------
 //
@@ -118,11 +120,11 @@ void InfoOverlay3D::update(int item_index, MapEditor::ItemType item_type, SLADEM
 
 		// Relevant flags
 		string flags = "";
-		if (Game::configuration().lineBasicFlagSet("dontpegtop", line, map_format))
+		if (Game::configuration().lineBasicFlagSet(LineFlag::DontPegTop, line, map_format))
 			flags += "Upper Unpegged, ";
-		if (Game::configuration().lineBasicFlagSet("dontpegbottom", line, map_format))
+		if (Game::configuration().lineBasicFlagSet(LineFlag::DontPegBottom, line, map_format))
 			flags += "Lower Unpegged, ";
-		if (Game::configuration().lineBasicFlagSet("blocking", line, map_format))
+		if (Game::configuration().lineBasicFlagSet(LineFlag::Blocking, line, map_format))
 			flags += "Blocking, ";
 		if (!flags.IsEmpty())
 			flags.RemoveLast(2);
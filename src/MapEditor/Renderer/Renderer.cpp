@@ -105,7 +105,8 @@ Renderer::Renderer(MapEditContext& context) :
 	anim_info_fade_{ 0 },
 	anim_overlay_fade_{ 0 },
 	anim_help_fade_{ 0 },
-	cursor_zoom_disabled_{ false }
+	cursor_zoom_disabled_{ false },
+	frame_time_last_{ 0 }
 {
 }
 
@@ -973,6 +974,45 @@ void Renderer::drawAnimations() const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Draws the (average) frames per second, and visibility stats if in 3d mode
+// -----------------------------------------------------------------------------
+void Renderer::drawFPS()
+{
+	// Update average fps
+	long time = App::runTimer();
+	if (frame_time_last_ > 0 && time > frame_time_last_)
+	{
+		fps_avg_.push_back(MathStuff::round(1000.0 / (time - frame_time_last_)));
+		if (fps_avg_.size() > 20)
+			fps_avg_.erase(fps_avg_.begin());
+	}
+	frame_time_last_ = time;
+
+	int afps = 0;
+	for (auto fps : fps_avg_)
+		afps += fps;
+	if (!fps_avg_.empty())
+		afps /= fps_avg_.size();
+
+	string text = S_FMT("FPS: %d", afps);
+	if (context_.editMode() == Mode::Visual)
+	{
+		auto& stats = renderer_3d_.renderStats();
+		text += S_FMT(
+			"  Sectors: %d/%d%s  Quads: %d  Flats: %d  Vis: %1.2fms",
+			stats.sectors,
+			context_.map().nSectors(),
+			stats.portals ? " (portals)" : "",
+			stats.quads,
+			stats.flats,
+			stats.vis_time);
+	}
+
+	glEnable(GL_TEXTURE_2D);
+	Drawing::drawText(text, 0, 0, rgba_t(255, 255, 255, 255), Drawing::Font::Small);
+}
+
 // -----------------------------------------------------------------------------
 // Draws the 2d map
 // -----------------------------------------------------------------------------
@@ -1324,21 +1364,8 @@ void Renderer::draw()
 	}
 
 	// FPS counter
-	/*if (map_showfps)
-	{
-		glEnable(GL_TEXTURE_2D);
-		if (frametime_last > 0)
-		{
-			int fps = MathStuff::round(1.0 / (frametime_last / 1000.0));
-			fps_avg.push_back(fps);
-			if (fps_avg.size() > 20) fps_avg.erase(fps_avg.begin());
-		}
-		int afps = 0;
-		for (unsigned a = 0; a < fps_avg.size(); a++)
-			afps += fps_avg[a];
-		if (fps_avg.size() > 0) afps /= fps_avg.size();
-		Drawing::drawText(S_FMT("FPS: %d", afps));
-	}*/
+	if (map_showfps)
+		drawFPS();
 
 	// test
 	// Drawing::drawText(S_FMT("Render distance: %1.2f", (double)render_max_dist), 0, 100);
@@ -71,6 +71,9 @@ private:
 	float  anim_help_fade_;
 	bool   cursor_zoom_disabled_;
 
+	// FPS counter
+	long        frame_time_last_;
+	vector<int> fps_avg_;
 
 	// Drawing
 	void drawGrid() const;
@@ -83,6 +86,7 @@ private:
 	void drawPasteLines() const;
 	void drawObjectEdit();
 	void drawAnimations() const;
+	void drawFPS();
 	void drawMap2d();
 	void drawMap3d();
 
@@ -33,7 +33,10 @@
 #include "Main.h"
 #include "MapTextureBrowser.h"
 #include "Game/Configuration.h"
+#include "General/Misc.h"
 #include "General/ResourceManager.h"
+#include "MainEditor/MapResourceIndex.h"
+#include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
 #include "MapEditor/MapTextureManager.h"
 #include "MapEditor/SLADEMap/SLADEMap.h"
@@ -69,7 +72,8 @@ MapTexBrowserItem::MapTexBrowserItem(string name, int type, unsigned index) : Br
 	if (name == "-" && type == 0)
 		blank_ = true;
 
-	usage_count_ = 0;
+	usage_count_     = 0;
+	other_map_usage_ = 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -99,6 +103,124 @@ bool MapTexBrowserItem::loadImage()
 		return false;
 }
 
+// -----------------------------------------------------------------------------
+// Finds the resource the texture/flat image would be loaded from, in the same
+// order as MapTextureManager::getTexture/getFlat. If it is a composite
+// texture, [ctex] is set to it and nullptr is returned
+// -----------------------------------------------------------------------------
+ArchiveEntry* MapTexBrowserItem::sourceEntry(CTexture*& ctex)
+{
+	auto archive = MapEditor::textureManager().getArchive();
+	ctex         = nullptr;
+
+	if (type_ == "texture")
+	{
+		// Composite textures take precedence over the textures directory
+		ctex = theResourceManager->getTexture(name_, archive);
+		if (ctex)
+			return nullptr;
+
+		auto entry = theResourceManager->getTextureEntry(name_, "hires", archive);
+		if (!entry)
+			entry = theResourceManager->getTextureEntry(name_, "textures", archive);
+		return entry;
+	}
+	else if (type_ == "flat")
+	{
+		auto entry = theResourceManager->getTextureEntry(name_, "hires", archive);
+		if (!entry)
+			entry = theResourceManager->getTextureEntry(name_, "flats", archive);
+		if (!entry)
+			entry = theResourceManager->getFlatEntry(name_, archive);
+		return entry;
+	}
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Sets up [request] to load the texture/flat thumbnail. Single-entry images
+// are passed on as data to be decoded by the loader, composite textures are
+// built on demand by thumbnailImage if they aren't in the thumbnail cache
+// -----------------------------------------------------------------------------
+bool MapTexBrowserItem::thumbnailSource(ThumbnailLoader::Request& request)
+{
+	CTexture* ctex  = nullptr;
+	auto      entry = sourceEntry(ctex);
+	if (!entry && !ctex)
+		return false;
+
+	auto palette = MapEditor::textureManager().getResourcePalette();
+	if (palette)
+		request.palette.copyPalette(palette);
+
+	if (ctex)
+	{
+		// Key on the texture definition and the content of each patch. Patch
+		// entries cache their content hash until they are modified, so this
+		// doesn't rehash all the patch data every time the thumbnail is
+		// requested (eg. when resizing)
+		auto archive = MapEditor::textureManager().getArchive();
+		auto text    = ctex->asText().ToUTF8();
+		request.key  = Misc::hash64((const uint8_t*)text.data(), text.length());
+		for (unsigned a = 0; a < ctex->nPatches(); a++)
+		{
+			auto patch  = ctex->getPatch(a);
+			auto pentry = patch->getPatchEntry(archive);
+			if (pentry)
+			{
+				auto hash   = pentry->contentHash();
+				request.key = Misc::hash64((const uint8_t*)&hash, sizeof(hash), request.key);
+			}
+			else
+			{
+				auto name   = patch->getName().ToUTF8();
+				request.key = Misc::hash64((const uint8_t*)name.data(), name.length(), request.key);
+			}
+		}
+
+		return true;
+	}
+
+	// Check the entry is an image
+	if (entry->getType() == EntryType::unknownType())
+		EntryType::detectEntryType(entry);
+	if (!entry->getType()->extraProps().propertyExists("image"))
+		return false;
+
+	request.key = entry->contentHash();
+
+	// Fonts, jaguar and raw formats need extra resources or detection to load,
+	// leave those to thumbnailImage
+	string format = entry->getType()->formatId();
+	if (format.StartsWith("font_") || format.StartsWith("img_jaguar") || format == "img_raw")
+		return true;
+
+	request.data.importMem(entry->getData(), entry->getSize());
+	if (entry->getType()->extraProps().propertyExists("image_format"))
+		request.format_hint = entry->getType()->extraProps()["image_format"].getStringValue();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the full texture/flat image into [image], with its [palette]
+// -----------------------------------------------------------------------------
+bool MapTexBrowserItem::thumbnailImage(SImage& image, Palette& palette)
+{
+	CTexture* ctex  = nullptr;
+	auto      entry = sourceEntry(ctex);
+
+	auto res_palette = MapEditor::textureManager().getResourcePalette();
+	if (res_palette)
+		palette.copyPalette(res_palette);
+
+	if (ctex)
+		return ctex->toImage(image, MapEditor::textureManager().getArchive(), &palette, true);
+
+	return Misc::loadImageFromEntry(&image, entry);
+}
+
 // -----------------------------------------------------------------------------
 // Returns a string with extra information about the texture/flat
 // -----------------------------------------------------------------------------
@@ -128,6 +250,8 @@ string MapTexBrowserItem::itemInfo()
 
 	// Add usage count
 	info += S_FMT(", Used %d times", usage_count_);
+	if (other_map_usage_ > 0)
+		info += S_FMT(" (also in %d other maps)", other_map_usage_);
 
 	return info;
 }
@@ -354,6 +478,11 @@ void MapTextureBrowser::updateUsage()
 	if (!map_)
 		return;
 
+	// Get other maps in the archive
+	auto index = MapResourceIndex::forArchive(MapEditor::textureManager().getArchive());
+	auto head  = MapEditor::editContext().mapDesc().head;
+	auto type  = type_ == 0 ? MapResourceIndex::Type::Texture : MapResourceIndex::Type::Flat;
+
 	vector<BrowserItem*>& items = canvas_->itemList();
 	for (unsigned i = 0; i < items.size(); i++)
 	{
@@ -362,5 +491,7 @@ void MapTextureBrowser::updateUsage()
 			item->setUsage(map_->texUsageCount(item->name()));
 		else
 			item->setUsage(map_->flatUsageCount(item->name()));
+
+		item->setOtherMapUsage(index ? index->mapCount(type, item->name(), head) : 0);
 	}
 }
@@ -5,6 +5,8 @@
 
 class SLADEMap;
 class Archive;
+class ArchiveEntry;
+class CTexture;
 
 class MapTexBrowserItem : public BrowserItem
 {
@@ -16,9 +18,15 @@ public:
 	string itemInfo();
 	int    usageCount() { return usage_count_; }
 	void   setUsage(int count) { usage_count_ = count; }
+	void   setOtherMapUsage(int count) { other_map_usage_ = count; }
+	bool   thumbnailSource(ThumbnailLoader::Request& request) override;
+	bool   thumbnailImage(SImage& image, Palette& palette) override;
 
 private:
 	int usage_count_;
+	int other_map_usage_;
+
+	ArchiveEntry* sourceEntry(CTexture*& ctex);
 };
 
 class MapTextureBrowser : public BrowserWindow
@@ -133,6 +133,7 @@ void registerAppNamespace(sol::state& lua)
 	app.set_function("showArchive", &showArchive);
 	app.set_function("showEntry", &MainEditor::openEntry);
 	app.set_function("mapEditor", &MapEditor::editContext);
+	app.set_function("runTimer", &App::runTimer);
 }
 
 void registerSplashWindowNamespace(sol::state& lua)
@@ -35,6 +35,276 @@ void objectSetStringProperty(MapObject& self, const string& key, const string& v
 			1, S_FMT("%s string property \"%s\" can not be modified via script", CHR(self.getTypeName()), key));
 }
 
+// Bulk map object access ----------------------------------------------------
+
+bool mapObjectType(const string& name, MapObject::Type& type)
+{
+	if (name == "vertices")
+		type = MapObject::Type::Vertex;
+	else if (name == "linedefs")
+		type = MapObject::Type::Line;
+	else if (name == "sidedefs")
+		type = MapObject::Type::Side;
+	else if (name == "sectors")
+		type = MapObject::Type::Sector;
+	else if (name == "things")
+		type = MapObject::Type::Thing;
+	else
+	{
+		Log::warning(1, S_FMT("Unknown map object type \"%s\"", CHR(name)));
+		return false;
+	}
+
+	return true;
+}
+
+unsigned mapObjectCount(SLADEMap& map, MapObject::Type type)
+{
+	switch (type)
+	{
+	case MapObject::Type::Vertex: return map.nVertices();
+	case MapObject::Type::Line: return map.nLines();
+	case MapObject::Type::Side: return map.nSides();
+	case MapObject::Type::Sector: return map.nSectors();
+	case MapObject::Type::Thing: return map.nThings();
+	default: return 0;
+	}
+}
+
+// Calls [func] with [object] cast to its actual type, so its type-specific
+// properties are available when passed to a script
+template<typename F> auto visitMapObject(MapObject* object, F func)
+{
+	switch (object->getObjType())
+	{
+	case MapObject::Type::Vertex: return func((MapVertex*)object);
+	case MapObject::Type::Line: return func((MapLine*)object);
+	case MapObject::Type::Side: return func((MapSide*)object);
+	case MapObject::Type::Sector: return func((MapSector*)object);
+	case MapObject::Type::Thing: return func((MapThing*)object);
+	default: return func(object);
+	}
+}
+
+// Returns the objects given by [objects], which is either an object type name
+// (all objects of that type in [map]) or a table of objects
+vector<MapObject*> mapObjectList(SLADEMap& map, const sol::object& objects)
+{
+	vector<MapObject*> list;
+	if (objects.is<string>())
+	{
+		MapObject::Type type;
+		if (!mapObjectType(objects.as<string>(), type))
+			return list;
+
+		auto count = mapObjectCount(map, type);
+		list.reserve(count);
+		for (unsigned a = 0; a < count; a++)
+			list.push_back(map.getObject(type, a));
+	}
+	else if (objects.is<sol::table>())
+	{
+		auto table = objects.as<sol::table>();
+		auto count = table.size();
+		list.reserve(count);
+		for (unsigned a = 1; a <= count; a++)
+		{
+			auto object = table.get<sol::optional<MapObject*>>(a);
+			if (object && *object)
+				list.push_back(*object);
+		}
+	}
+
+	return list;
+}
+
+sol::table mapObjectTable(const vector<MapObject*>& objects, sol::this_state state)
+{
+	auto table = sol::state_view(state).create_table(objects.size(), 0);
+	for (unsigned a = 0; a < objects.size(); a++)
+		visitMapObject(objects[a], [&](auto object) { table[a + 1] = object; });
+	return table;
+}
+
+template<typename T> std::function<T*()> mapObjectIterator(SLADEMap& map, MapObject::Type type)
+{
+	unsigned index = 0;
+	return [&map, type, index]() mutable { return (T*)map.getObject(type, index++); };
+}
+
+// Returns an iterator function over all objects of type [type_name] in the map,
+// for use in a generic for loop (eg. 'for line in map:each("linedefs") do')
+sol::object mapEachObject(SLADEMap& self, const string& type_name, sol::this_state state)
+{
+	MapObject::Type type;
+	if (!mapObjectType(type_name, type))
+		return sol::make_object(state, mapObjectIterator<MapObject>(self, MapObject::Type::Object));
+
+	switch (type)
+	{
+	case MapObject::Type::Vertex: return sol::make_object(state, mapObjectIterator<MapVertex>(self, type));
+	case MapObject::Type::Line: return sol::make_object(state, mapObjectIterator<MapLine>(self, type));
+	case MapObject::Type::Side: return sol::make_object(state, mapObjectIterator<MapSide>(self, type));
+	case MapObject::Type::Sector: return sol::make_object(state, mapObjectIterator<MapSector>(self, type));
+	default: return sol::make_object(state, mapObjectIterator<MapThing>(self, type));
+	}
+}
+
+sol::table mapFilterObjects(
+	SLADEMap&                      self,
+	const sol::object&             objects,
+	const sol::protected_function& predicate,
+	sol::this_state                state)
+{
+	vector<MapObject*> matches;
+	for (auto object : mapObjectList(self, objects))
+	{
+		auto result = visitMapObject(object, [&](auto typed_object) { return predicate(typed_object); });
+		if (!result.valid())
+		{
+			sol::error error = result;
+			throw error;
+		}
+		if (result.get<bool>())
+			matches.push_back(object);
+	}
+
+	return mapObjectTable(matches, state);
+}
+
+sol::table mapFindObjects(
+	SLADEMap&          self,
+	const sol::object& objects,
+	const string&      key,
+	const sol::object& value,
+	sol::this_state    state)
+{
+	vector<MapObject*> matches;
+	auto               list = mapObjectList(self, objects);
+	switch (value.get_type())
+	{
+	case sol::type::boolean:
+	{
+		auto match = value.as<bool>();
+		for (auto object : list)
+			if (object->boolProperty(key) == match)
+				matches.push_back(object);
+		break;
+	}
+	case sol::type::number:
+	{
+		// Some int properties aren't available as floats (eg. line specials),
+		// so whole numbers are also compared as integers. That's only done if
+		// the property has no fractional part, since intProperty truncates
+		// float values (eg. a height of 0.5 would otherwise match 0)
+		auto match = value.as<double>();
+		auto whole = std::floor(match) == match;
+		for (auto object : list)
+		{
+			auto fval = object->floatProperty(key);
+			if (fval == match || (whole && std::floor(fval) == fval && object->intProperty(key) == match))
+				matches.push_back(object);
+		}
+		break;
+	}
+	case sol::type::string:
+	{
+		auto match = value.as<string>();
+		for (auto object : list)
+			if (object->stringProperty(key) == match)
+				matches.push_back(object);
+		break;
+	}
+	default: break;
+	}
+
+	return mapObjectTable(matches, state);
+}
+
+template<typename T>
+sol::table mapObjectProperties(
+	SLADEMap&          self,
+	const sol::object& objects,
+	const string&      key,
+	sol::this_state    state,
+	T (MapObject::*get_property)(const string&))
+{
+	auto list   = mapObjectList(self, objects);
+	auto values = sol::state_view(state).create_table(list.size(), 0);
+	for (unsigned a = 0; a < list.size(); a++)
+		values[a + 1] = (list[a]->*get_property)(key);
+	return values;
+}
+
+// Sets property [key] of all [objects] to [values], either a single value for
+// all objects or a table with a value for each object (nil to skip)
+template<typename T, typename V>
+void mapSetObjectProperties(
+	SLADEMap&          self,
+	const sol::object& objects,
+	const string&      key,
+	const sol::object& values,
+	void (MapObject::*set_property)(const string&, V))
+{
+	bool per_object = values.is<sol::table>();
+	if (!per_object && !values.is<T>())
+	{
+		Log::warning(1, S_FMT("Invalid value given for property \"%s\"", CHR(key)));
+		return;
+	}
+
+	auto list   = mapObjectList(self, objects);
+	auto table  = per_object ? values.as<sol::table>() : sol::table();
+	T    value  = per_object ? T() : values.as<T>();
+	auto warned = MapObject::Type::Object;
+	for (unsigned a = 0; a < list.size(); a++)
+	{
+		auto object = list[a];
+		if (!object->scriptCanModifyProp(key))
+		{
+			// Only warn once per object type
+			if (object->getObjType() != warned)
+				Log::warning(
+					1,
+					S_FMT("%s property \"%s\" can not be modified via script", CHR(object->getTypeName()), CHR(key)));
+			warned = object->getObjType();
+			continue;
+		}
+
+		if (per_object)
+		{
+			auto object_value = table.get<sol::optional<T>>(a + 1);
+			if (object_value)
+				(object->*set_property)(key, *object_value);
+		}
+		else
+			(object->*set_property)(key, value);
+	}
+}
+
+// Runs [func] with all changes it makes to the map recorded as a single undo
+// level (if the map is open in the map editor)
+void mapBatchEdit(SLADEMap& self, const string& name, const sol::protected_function& func)
+{
+	auto& context = MapEditor::editContext();
+	auto  manager = context.undoManager();
+	if (context.editMode() == MapEditor::Mode::Visual)
+		manager = context.edit3D().undoManager();
+	bool record = &context.map() == &self && !manager->currentlyRecording();
+
+	if (record)
+		context.beginUndoRecord(name);
+	auto result = func(&self);
+	if (record)
+		context.endUndoRecord(true);
+
+	if (!result.valid())
+	{
+		sol::error error = result;
+		throw error;
+	}
+}
+
 void registerSLADEMap(sol::state& lua)
 {
 	lua.new_usertype<SLADEMap>(
@@ -58,7 +328,56 @@ void registerSLADEMap(sol::state& lua)
 		"sectors",
 		sol::property(&SLADEMap::sectors),
 		"things",
-		sol::property(&SLADEMap::things));
+		sol::property(&SLADEMap::things),
+
+		// Functions
+		"count",
+		[](SLADEMap& self, const string& type_name) {
+			MapObject::Type type;
+			return mapObjectType(type_name, type) ? mapObjectCount(self, type) : 0;
+		},
+		"each",
+		&mapEachObject,
+		"filter",
+		&mapFilterObjects,
+		"find",
+		&mapFindObjects,
+		"boolProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, sol::this_state state) {
+			return mapObjectProperties(self, objects, key, state, &MapObject::boolProperty);
+		},
+		"intProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, sol::this_state state) {
+			return mapObjectProperties(self, objects, key, state, &MapObject::intProperty);
+		},
+		"floatProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, sol::this_state state) {
+			return mapObjectProperties(self, objects, key, state, &MapObject::floatProperty);
+		},
+		"stringProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, sol::this_state state) {
+			return mapObjectProperties(self, objects, key, state, &MapObject::stringProperty);
+		},
+		"setBoolProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, const sol::object& values) {
+			mapSetObjectProperties<bool>(self, objects, key, values, &MapObject::setBoolProperty);
+		},
+		"setIntProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, const sol::object& values) {
+			mapSetObjectProperties<int>(self, objects, key, values, &MapObject::setIntProperty);
+		},
+		"setFloatProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, const sol::object& values) {
+			mapSetObjectProperties<double>(self, objects, key, values, &MapObject::setFloatProperty);
+		},
+		"setStringProperties",
+		[](SLADEMap& self, const sol::object& objects, const string& key, const sol::object& values) {
+			mapSetObjectProperties<string>(self, objects, key, values, &MapObject::setStringProperty);
+		},
+		"batchEdit",
+		sol::overload(&mapBatchEdit, [](SLADEMap& self, const sol::protected_function& func) {
+			mapBatchEdit(self, "Script", func);
+		}));
 }
 
 void selectMapObject(MapEditContext& self, MapObject* object, bool select)
@@ -44,6 +44,7 @@
 #include "MainEditor/MainEditor.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/SLADEMap/SLADEMap.h"
+#include "Utility/Parallel.h"
 #include "Utility/SFileDialog.h"
 
 
@@ -121,9 +122,9 @@ void resetError()
 }
 
 // -----------------------------------------------------------------------------
-// Processes error information from [result]
+// Processes error information from [result] into [script_error]
 // -----------------------------------------------------------------------------
-void processError(sol::protected_function_result& result)
+void processError(sol::protected_function_result& result, Error& script_error = Lua::script_error)
 {
 	// Error Type
 	script_error.type = sol::to_string(result.status());
@@ -148,6 +149,60 @@ void processError(sol::protected_function_result& result)
 		script_error.message.Right(script_error.message.size() - script_error.message.Find(": ") - 2);
 }
 
+// -----------------------------------------------------------------------------
+// Registers all SLADE namespaces and types to [lua]
+// -----------------------------------------------------------------------------
+void registerAll(sol::state& lua)
+{
+	lua.open_libraries(sol::lib::base, sol::lib::string);
+
+	// Register namespaces
+	registerAppNamespace(lua);
+	registerSplashWindowNamespace(lua);
+	registerGameNamespace(lua);
+	registerArchivesNamespace(lua);
+
+	// Register types
+	registerMiscTypes(lua);
+	registerArchiveTypes(lua);
+	registerMapEditorTypes(lua);
+	registerGameTypes(lua);
+}
+
+// -----------------------------------------------------------------------------
+// Replaces UI and editor related functions in [lua] for running without a UI
+// on [archive] (in batch mode). Messages are written to the log and standard
+// output (prefixed with [name]) and prompts return their default values
+// -----------------------------------------------------------------------------
+void registerBatchOverrides(sol::state& lua, Archive* archive, const string& name)
+{
+	auto print = [name](const string& message) {
+		Log::message(Log::MessageType::Script, S_FMT("%s: %s", CHR(name), CHR(message)));
+		printf("%s: %s\n", CHR(name), CHR(message));
+	};
+
+	sol::table app = lua["App"];
+	app.set_function("logMessage", [print](const string& message) { print(message); });
+	app.set_function("messageBox", [print](const string& title, const string& message) { print(message); });
+	app.set_function("messageBoxExt", [print](const string& title, const string& message, const string& extra) {
+		print(message + "\n" + extra);
+	});
+	app.set_function("promptString", [](const string&, const string&, const string& value) { return value; });
+	app.set_function("promptNumber", [](const string&, const string&, int value, int, int) { return value; });
+	app.set_function("promptYesNo", [](const string&, const string&) { return false; });
+	app.set_function("browseFile", [](const string&, const string&, const string&) { return string(); });
+	app.set_function("browseFiles", [](const string&, const string&) { return vector<string>(); });
+	app.set_function("currentArchive", [archive]() { return archive; });
+	app.set_function("currentEntry", []() { return (ArchiveEntry*)nullptr; });
+	app.set_function("currentEntrySelection", []() { return vector<ArchiveEntry*>(); });
+	app.set_function("showArchive", [](Archive*) { return false; });
+	app.set_function("showEntry", [](ArchiveEntry*) {});
+	app["mapEditor"] = sol::nil;
+
+	// Archives are opened independently of the archive manager in batch mode
+	lua["Archives"] = sol::nil;
+}
+
 // -----------------------------------------------------------------------------
 // Template function for Lua::run*Script functions.
 // Loads [script] and runs the 'execute' function in the script, passing
@@ -196,19 +251,7 @@ template<class T> bool runEditorScript(const string& script, T param)
 // -----------------------------------------------------------------------------
 bool Lua::init()
 {
-	lua.open_libraries(sol::lib::base, sol::lib::string);
-
-	// Register namespaces
-	registerAppNamespace(lua);
-	registerSplashWindowNamespace(lua);
-	registerGameNamespace(lua);
-	registerArchivesNamespace(lua);
-
-	// Register types
-	registerMiscTypes(lua);
-	registerArchiveTypes(lua);
-	registerMapEditorTypes(lua);
-	registerGameTypes(lua);
+	registerAll(lua);
 
 	return true;
 }
@@ -235,8 +278,8 @@ void Lua::showErrorDialog(wxWindow* parent, const string& title, const string& m
 	// Get script log messages since the last script was started
 	auto   log = Log::since(script_start_time, Log::MessageType::Script);
 	string output;
-	for (auto msg : log)
-		output += msg->formattedMessageLine() + "\n";
+	for (auto& msg : log)
+		output += msg.formattedMessageLine() + "\n";
 
 	ExtMessageDialog dlg(parent ? parent : current_window, title);
 	dlg.setMessage(message);
@@ -329,6 +372,117 @@ bool Lua::runMapScript(const string& script, SLADEMap* map)
 	return runEditorScript<SLADEMap*>(script, map);
 }
 
+// -----------------------------------------------------------------------------
+// Runs the 'execute(archive)' function in the script file [script_file] on
+// each archive in [archive_files], without any UI. Each archive is opened, run
+// through the script and saved (if modified) in its own lua state, spread
+// across worker threads. Progress and timing for each archive is written to
+// the log and standard output in order. Returns the number of archives that
+// failed to open, run or save
+// -----------------------------------------------------------------------------
+unsigned Lua::runBatch(const string& script_file, const vector<string>& archive_files)
+{
+	// Load script
+	MemChunk mc;
+	if (!mc.importFile(script_file))
+	{
+		Log::error(S_FMT("Unable to read script file \"%s\"", CHR(script_file)));
+		return archive_files.size();
+	}
+	std::string script((const char*)mc.getData(), mc.getSize());
+
+	struct Result
+	{
+		string message;
+		bool   ok          = false;
+		long   time_open   = 0;
+		long   time_script = 0;
+		long   time_save   = 0;
+	};
+	vector<Result> results(archive_files.size());
+
+	wxStopWatch sw;
+	unsigned    n_failed = 0;
+	Parallel::forEachOrdered(
+		archive_files.size(),
+		[&](size_t index) {
+			auto&       result = results[index];
+			wxStopWatch sw_archive;
+			string      name = wxFileName(archive_files[index]).GetFullName();
+
+			// Open archive
+			std::unique_ptr<Archive> archive(App::archiveManager().openArchive(archive_files[index], false, true));
+			result.time_open = sw_archive.Time();
+			if (!archive)
+			{
+				result.message = "Unable to open archive";
+				return;
+			}
+
+			// Run script
+			sol::state lua;
+			registerAll(lua);
+			registerBatchOverrides(lua, archive.get(), name);
+			Error            error;
+			bool             script_ok = false;
+			sol::environment sandbox(lua, sol::create, lua.globals());
+			auto             load_result = lua.script(script, sandbox, sol::simple_on_error);
+			if (!load_result.valid())
+				processError(load_result, error);
+			else
+			{
+				sol::protected_function func        = sandbox["execute"];
+				auto                    exec_result = func(archive.get());
+				if (!exec_result.valid())
+					processError(exec_result, error);
+				else
+					script_ok = true;
+			}
+			result.time_script = sw_archive.Time() - result.time_open;
+			if (!script_ok)
+			{
+				result.message = S_FMT("%s Error: %d: %s", CHR(error.type), error.line_no, CHR(error.message));
+				return;
+			}
+
+			// Save if modified
+			if (archive->isModified() && !archive->save())
+			{
+				result.message = "Unable to save archive";
+				return;
+			}
+			result.time_save = sw_archive.Time() - result.time_open - result.time_script;
+			result.ok        = true;
+		},
+		[&](size_t index) {
+			auto&  result = results[index];
+			string line   = S_FMT(
+				"%s: %s (open %ldms, script %ldms, save %ldms)",
+				CHR(archive_files[index]),
+				result.ok ? "OK" : CHR(result.message),
+				result.time_open,
+				result.time_script,
+				result.time_save);
+
+			if (result.ok)
+				Log::info(line);
+			else
+			{
+				Log::error(line);
+				n_failed++;
+			}
+			printf("%s\n", CHR(line));
+
+			return true;
+		});
+
+	string summary = S_FMT("Processed %d archives in %ldms, %d failed", (int)archive_files.size(), sw.Time(), n_failed);
+	Log::info(summary);
+	printf("%s\n", CHR(summary));
+
+	return n_failed;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the active lua state
 // -----------------------------------------------------------------------------
@@ -30,6 +30,8 @@ bool runArchiveScript(const string& script, Archive* archive);
 bool runEntryScript(const string& script, vector<ArchiveEntry*> entries);
 bool runMapScript(const string& script, SLADEMap* map);
 
+unsigned runBatch(const string& script_file, const vector<string>& archive_files);
+
 sol::state& state();
 
 wxWindow* currentWindow();
@@ -43,6 +43,222 @@
 CVAR(Bool, debug_lexer, false, CVAR_SECRET)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [str] as a UTF-8 std::string
+// -----------------------------------------------------------------------------
+std::string toStdString(const string& str)
+{
+	auto utf8 = str.ToUTF8();
+	return std::string(utf8.data(), utf8.length());
+}
+
+// -----------------------------------------------------------------------------
+// Returns [c] in lower case if it is an ASCII letter
+// -----------------------------------------------------------------------------
+inline uint8_t lowerChar(uint8_t c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+}
+
+inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+inline bool isHexDigit(char c)
+{
+	return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [word] is a number: an integer, a hex integer (0x...) or a
+// float, optionally with an exponent
+// -----------------------------------------------------------------------------
+bool isNumber(const char* word, unsigned length)
+{
+	unsigned a = 0;
+
+	// Hex
+	if (length > 2 && word[0] == '0' && word[1] == 'x')
+	{
+		for (a = 2; a < length; a++)
+			if (!isHexDigit(word[a]))
+				return false;
+		return true;
+	}
+
+	// Sign
+	if (a < length && (word[a] == '+' || word[a] == '-'))
+		a++;
+
+	// Integer part
+	unsigned digits = 0;
+	while (a < length && isDigit(word[a]))
+	{
+		a++;
+		digits++;
+	}
+
+	// Fractional part
+	if (a < length && word[a] == '.')
+	{
+		a++;
+		digits = 0;
+		while (a < length && isDigit(word[a]))
+		{
+			a++;
+			digits++;
+		}
+	}
+	if (digits == 0)
+		return false;
+
+	// Exponent
+	if (a < length && (word[a] == 'e' || word[a] == 'E'))
+	{
+		a++;
+		if (a < length && (word[a] == '+' || word[a] == '-'))
+			a++;
+		if (a == length)
+			return false;
+		while (a < length && isDigit(word[a]))
+			a++;
+	}
+
+	return a == length;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Lexer::WordTable Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Removes all words from the table
+// -----------------------------------------------------------------------------
+void Lexer::WordTable::clear()
+{
+	entries_.clear();
+	chars_.clear();
+	count_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [word] to the table with [value], replacing the value if [word] was
+// already added
+// -----------------------------------------------------------------------------
+void Lexer::WordTable::add(const string& word, int value)
+{
+	auto utf8   = word.ToUTF8();
+	auto length = (unsigned)utf8.length();
+	if (length == 0)
+		return;
+
+	// Update existing
+	auto     h    = hash(utf8.data(), length);
+	unsigned mask = entries_.size() - 1;
+	for (unsigned a = h & mask; !entries_.empty() && entries_[a].length > 0; a = (a + 1) & mask)
+		if (entries_[a].hash == h && equals(entries_[a], utf8.data(), length))
+		{
+			entries_[a].value = value;
+			return;
+		}
+
+	// Grow table if it would be more than half full
+	if ((count_ + 1) * 2 > entries_.size())
+	{
+		auto old = std::move(entries_);
+		entries_.assign(std::max<size_t>(64, old.size() * 2), Entry());
+		for (auto& entry : old)
+			if (entry.length > 0)
+				insert(entry);
+	}
+
+	// Add word, the stored copy is lower case if the table isn't case sensitive
+	Entry entry;
+	entry.offset = chars_.size();
+	entry.length = length;
+	entry.hash   = h;
+	entry.value  = value;
+	for (unsigned a = 0; a < length; a++)
+		chars_ += case_sensitive_ ? utf8.data()[a] : (char)lowerChar(utf8.data()[a]);
+	insert(entry);
+	count_++;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value for [word] ([length] characters), or 0 if it isn't in the
+// table
+// -----------------------------------------------------------------------------
+int Lexer::WordTable::find(const char* word, unsigned length) const
+{
+	if (count_ == 0 || length == 0)
+		return 0;
+
+	auto     h    = hash(word, length);
+	unsigned mask = entries_.size() - 1;
+	for (unsigned a = h & mask; entries_[a].length > 0; a = (a + 1) & mask)
+		if (entries_[a].hash == h && equals(entries_[a], word, length))
+			return entries_[a].value;
+
+	return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (FNV-1a) hash of [word], ignoring case if the table isn't case
+// sensitive
+// -----------------------------------------------------------------------------
+uint32_t Lexer::WordTable::hash(const char* word, unsigned length) const
+{
+	uint32_t h = 2166136261u;
+	for (unsigned a = 0; a < length; a++)
+		h = (h ^ (case_sensitive_ ? (uint8_t)word[a] : lowerChar(word[a]))) * 16777619u;
+	return h;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is [word]
+// -----------------------------------------------------------------------------
+bool Lexer::WordTable::equals(const Entry& entry, const char* word, unsigned length) const
+{
+	if (entry.length != length)
+		return false;
+
+	auto chars = chars_.data() + entry.offset;
+	if (case_sensitive_)
+		return memcmp(chars, word, length) == 0;
+
+	for (unsigned a = 0; a < length; a++)
+		if ((uint8_t)chars[a] != lowerChar(word[a]))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Inserts [entry] into the first free slot for its hash
+// -----------------------------------------------------------------------------
+void Lexer::WordTable::insert(const Entry& entry)
+{
+	unsigned mask = entries_.size() - 1;
+	unsigned a    = entry.hash & mask;
+	while (entries_[a].length > 0)
+		a = (a + 1) & mask;
+	entries_[a] = entry;
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // Lexer Class Functions
@@ -54,16 +270,19 @@ CVAR(Bool, debug_lexer, false, CVAR_SECRET)
 // Lexer class constructor
 // -----------------------------------------------------------------------------
 Lexer::Lexer() :
-	whitespace_chars_{ { ' ', '\n', '\r', '\t' } },
 	language_{ nullptr },
-	re_int1_{ "^[+-]?[0-9]+[0-9]*$", wxRE_DEFAULT | wxRE_NOSUB },
-	re_int2_{ "^0[0-9]+$", wxRE_DEFAULT | wxRE_NOSUB },
-	re_int3_{ "^0x[0-9A-Fa-f]+$", wxRE_DEFAULT | wxRE_NOSUB },
-	re_float_{ "^[-+]?[0-9]*.?[0-9]+([eE][-+]?[0-9]+)?$", wxRE_DEFAULT | wxRE_NOSUB },
 	fold_comments_{ false },
 	fold_preprocessor_{ false },
-	curr_comment_idx_{ -1 }
+	preprocessor_char_{ 0 },
+	curr_comment_idx_{ -1 },
+	fold_words_{ false },
+	pp_fold_words_{ false }
 {
+	// Whitespace characters
+	memset(char_class_, 0, 256);
+	for (auto c : { ' ', '\n', '\r', '\t' })
+		char_class_[(uint8_t)c] |= WhitespaceChar;
+
 	// Default word characters
 	setWordChars("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_");
 
@@ -77,7 +296,18 @@ Lexer::Lexer() :
 void Lexer::loadLanguage(TextLanguage* language)
 {
 	this->language_ = language;
+	word_list_.setCaseSensitive(language && language->caseSensitive());
 	clearWords();
+	fold_words_.clear();
+	pp_fold_words_.clear();
+	comment_begin_l_.clear();
+	comment_end_l_.clear();
+	comment_line_l_.clear();
+	comment_doc_.clear();
+	block_begin_.clear();
+	block_end_.clear();
+	preprocessor_.clear();
+	preprocessor_char_ = 0;
 
 	if (!language)
 		return;
@@ -94,8 +324,29 @@ void Lexer::loadLanguage(TextLanguage* language)
 	for (auto word : language->wordListSorted(TextLanguage::WordType::Keyword))
 		addWord(word, Lexer::Style::Keyword);
 
+	// Load folding words (matched case-insensitively), block begin words take
+	// precedence if a word is in both lists
+	for (auto& word : language->wordBlockEnd())
+		fold_words_.add(word, -1);
+	for (auto& word : language->wordBlockBegin())
+		fold_words_.add(word, 1);
+	for (auto& word : language->ppBlockEnd())
+		pp_fold_words_.add(word, -1);
+	for (auto& word : language->ppBlockBegin())
+		pp_fold_words_.add(word, 1);
+
 	// Load language info
-	preprocessor_char_ = language->preprocessor().empty() ? (char)0 : (char)language->preprocessor()[0];
+	preprocessor_      = toStdString(language->preprocessor());
+	preprocessor_char_ = preprocessor_.empty() ? (char)0 : preprocessor_[0];
+	comment_doc_       = toStdString(language->docComment());
+	block_begin_       = toStdString(language->blockBegin());
+	block_end_         = toStdString(language->blockEnd());
+	for (auto& token : language->commentBeginL())
+		comment_begin_l_.push_back(toStdString(token));
+	for (auto& token : language->commentEndL())
+		comment_end_l_.push_back(toStdString(token));
+	for (auto& token : language->lineCommentL())
+		comment_line_l_.push_back(toStdString(token));
 }
 
 // -----------------------------------------------------------------------------
@@ -162,30 +413,32 @@ bool Lexer::doStyling(TextEditorCtrl* editor, int start, int end)
 // -----------------------------------------------------------------------------
 void Lexer::addWord(string word, int style)
 {
-	word_list_[language_->caseSensitive() ? word : word.Lower()].style = (char)style;
+	word_list_.add(word, style);
 }
 
 // -----------------------------------------------------------------------------
-// Applies a style to [word] in [editor], depending on if it is in the word
-// list, a number or begins with the preprocessor character
+// Returns the style for [word] ([length] characters), depending on if it is
+// in the word list, a number or begins with the preprocessor token
 // -----------------------------------------------------------------------------
-void Lexer::styleWord(LexerState& state, string word)
+int Lexer::wordStyle(const char* word, unsigned length) const
 {
-	if (!language_->caseSensitive())
-		word = word.Lower();
-
-	if (word_list_[word].style > 0)
-		state.editor->SetStyling(word.length(), word_list_[word].style);
-	else if (word.StartsWith(language_->preprocessor()))
-		state.editor->SetStyling(word.length(), Style::Preprocessor);
+	auto style = word_list_.find(word, length);
+	if (style > 0)
+		return style;
+	else if (length >= preprocessor_.size() && memcmp(word, preprocessor_.data(), preprocessor_.size()) == 0)
+		return Style::Preprocessor;
+	else if (isNumber(word, length))
+		return Style::Number;
 	else
-	{
-		// Check for number
-		if (re_int2_.Matches(word) || re_int1_.Matches(word) || re_float_.Matches(word) || re_int3_.Matches(word))
-			state.editor->SetStyling(word.length(), Style::Number);
-		else
-			state.editor->SetStyling(word.length(), Style::Default);
-	}
+		return Style::Default;
+}
+
+// -----------------------------------------------------------------------------
+// Applies a style to [word] ([length] characters) in [editor], see wordStyle
+// -----------------------------------------------------------------------------
+void Lexer::styleWord(LexerState& state, const char* word, unsigned length)
+{
+	state.editor->SetStyling(length, wordStyle(word, length));
 }
 
 // -----------------------------------------------------------------------------
@@ -193,9 +446,10 @@ void Lexer::styleWord(LexerState& state, string word)
 // -----------------------------------------------------------------------------
 void Lexer::setWordChars(string chars)
 {
-	word_chars_.clear();
+	for (auto& c : char_class_)
+		c &= ~WordChar;
 	for (unsigned a = 0; a < chars.length(); a++)
-		word_chars_.push_back((unsigned char)chars[a]);
+		char_class_[(unsigned char)chars[a]] |= WordChar;
 }
 
 // -----------------------------------------------------------------------------
@@ -203,9 +457,10 @@ void Lexer::setWordChars(string chars)
 // -----------------------------------------------------------------------------
 void Lexer::setOperatorChars(string chars)
 {
-	operator_chars_.clear();
+	for (auto& c : char_class_)
+		c &= ~OperatorChar;
 	for (unsigned a = 0; a < chars.length(); a++)
-		operator_chars_.push_back((unsigned char)chars[a]);
+		char_class_[(unsigned char)chars[a]] |= OperatorChar;
 }
 
 // -----------------------------------------------------------------------------
@@ -214,23 +469,9 @@ void Lexer::setOperatorChars(string chars)
 // -----------------------------------------------------------------------------
 bool Lexer::processUnknown(LexerState& state)
 {
-	int            u_length = 0;
-	bool           end      = false;
-	bool           pp       = false;
-	vector<string> comment_begin_l;
-	string         comment_doc;
-	vector<string> comment_line_l;
-	string         block_begin;
-	string         block_end;
-
-	if (language_)
-	{
-		comment_begin_l = language_->commentBeginL();
-		comment_doc     = language_->docComment();
-		comment_line_l  = language_->lineCommentL();
-		block_begin     = language_->blockBegin();
-		block_end       = language_->blockEnd();
-	}
+	int  u_length = 0;
+	bool end      = false;
+	bool pp       = false;
 
 	while (true)
 	{
@@ -273,11 +514,11 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Start of block comment
-		else if (checkToken(state, state.position, comment_begin_l, &(curr_comment_idx_)))
+		else if (checkToken(state, state.position, comment_begin_l_, &(curr_comment_idx_)))
 		{
 			state.state  = State::Comment;
-			state.length = comment_begin_l[curr_comment_idx_].size();
-			state.position += comment_begin_l[curr_comment_idx_].size();
+			state.length = comment_begin_l_[curr_comment_idx_].size();
+			state.position += comment_begin_l_[curr_comment_idx_].size();
 			if (fold_comments_)
 			{
 				state.fold_increment++;
@@ -287,7 +528,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Start of doc line comment
-		else if (checkToken(state, state.position, comment_doc))
+		else if (checkToken(state, state.position, comment_doc_))
 		{
 			// Format as comment to end of line
 			state.editor->SetStyling(u_length, Style::Default);
@@ -298,7 +539,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Start of line comment
-		else if (checkToken(state, state.position, comment_line_l))
+		else if (checkToken(state, state.position, comment_line_l_))
 		{
 			// Format as comment to end of line
 			state.editor->SetStyling(u_length, Style::Default);
@@ -309,7 +550,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Whitespace
-		else if (VECTOR_EXISTS(whitespace_chars_, c))
+		else if (isWhitespace(c))
 		{
 			state.state = State::Whitespace;
 			state.position++;
@@ -318,7 +559,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Preprocessor
-		else if (c == (unsigned char)language_->preprocessor()[0])
+		else if (preprocessor_char_ && c == (unsigned char)preprocessor_char_)
 		{
 			pp = true;
 			u_length++;
@@ -327,7 +568,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Operator
-		else if (VECTOR_EXISTS(operator_chars_, c))
+		else if (isOperatorChar(c))
 		{
 			state.position++;
 			state.state    = State::Operator;
@@ -337,7 +578,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Word
-		else if (VECTOR_EXISTS(word_chars_, c))
+		else if (isWordChar(c))
 		{
 			// Include preprocessor character if it was the previous character
 			if (pp)
@@ -353,11 +594,11 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Block begin
-		else if (checkToken(state, state.position, block_begin))
+		else if (checkToken(state, state.position, block_begin_))
 			state.fold_increment++;
 
 		// Block end
-		else if (checkToken(state, state.position, block_end))
+		else if (checkToken(state, state.position, block_end_))
 			state.fold_increment--;
 
 		// if (debug_lexer)
@@ -380,10 +621,12 @@ bool Lexer::processUnknown(LexerState& state)
 // -----------------------------------------------------------------------------
 bool Lexer::processComment(LexerState& state)
 {
-	bool   end         = false;
-	string comment_end = "";
-	if (curr_comment_idx_ >= 0)
-		comment_end = language_->commentEndL()[curr_comment_idx_];
+	static const std::string no_comment_end;
+
+	bool  end         = false;
+	auto& comment_end = (curr_comment_idx_ >= 0 && curr_comment_idx_ < (int)comment_end_l_.size()) ?
+							comment_end_l_[curr_comment_idx_] :
+							no_comment_end;
 
 	while (true)
 	{
@@ -424,11 +667,11 @@ bool Lexer::processComment(LexerState& state)
 // -----------------------------------------------------------------------------
 bool Lexer::processWord(LexerState& state)
 {
-	vector<char> word;
-	bool         end = false;
+	bool end = false;
 
 	// Add first letter
-	word.push_back((char)state.editor->GetCharAt(state.position++));
+	word_.clear();
+	word_ += (char)state.editor->GetCharAt(state.position++);
 
 	while (true)
 	{
@@ -441,9 +684,9 @@ bool Lexer::processWord(LexerState& state)
 		}
 
 		char c = (char)state.editor->GetCharAt(state.position);
-		if (VECTOR_EXISTS(word_chars_, c))
+		if (isWordChar(c))
 		{
-			word.push_back(c);
+			word_ += c;
 			state.position++;
 		}
 		else
@@ -453,31 +696,18 @@ bool Lexer::processWord(LexerState& state)
 		}
 	}
 
-	// Get word as string
-	string word_string = wxString::FromAscii(&word[0], word.size());
-
 	// Check for preprocessor folding word
-	if (fold_preprocessor_ && word_string.StartsWith(preprocessor_char_))
-	{
-		string word_lower = word_string.Lower().After(preprocessor_char_);
-		if (VECTOR_EXISTS(language_->ppBlockBegin(), word_lower))
-			state.fold_increment++;
-		else if (VECTOR_EXISTS(language_->ppBlockEnd(), word_lower))
-			state.fold_increment--;
-	}
+	auto     word   = word_.data();
+	unsigned length = word_.size();
+	if (fold_preprocessor_ && preprocessor_char_ && word[0] == preprocessor_char_)
+		state.fold_increment += pp_fold_words_.find(word + 1, length - 1);
 	else
-	{
-		string word_lower = word_string.Lower();
-		if (VECTOR_EXISTS(language_->wordBlockBegin(), word_lower))
-			state.fold_increment++;
-		else if (VECTOR_EXISTS(language_->wordBlockEnd(), word_lower))
-			state.fold_increment--;
-	}
+		state.fold_increment += fold_words_.find(word, length);
 
 	if (debug_lexer)
-		Log::debug(S_FMT("word: %s", word_string));
+		Log::debug(S_FMT("word: %s", wxString::FromUTF8(word, length)));
 
-	styleWord(state, word_string);
+	styleWord(state, word, length);
 
 	return end;
 }
@@ -581,7 +811,7 @@ bool Lexer::processOperator(LexerState& state)
 		}
 
 		char c = (char)state.editor->GetCharAt(state.position);
-		if (VECTOR_EXISTS(operator_chars_, c))
+		if (isOperatorChar(c))
 		{
 			state.length++;
 			state.position++;
@@ -620,7 +850,7 @@ bool Lexer::processWhitespace(LexerState& state)
 		}
 
 		char c = (char)state.editor->GetCharAt(state.position);
-		if (VECTOR_EXISTS(whitespace_chars_, c))
+		if (isWhitespace(c))
 		{
 			state.length++;
 			state.position++;
@@ -643,14 +873,14 @@ bool Lexer::processWhitespace(LexerState& state)
 // -----------------------------------------------------------------------------
 // Checks if the text in [editor] starting from [pos] matches [token]
 // -----------------------------------------------------------------------------
-bool Lexer::checkToken(LexerState& state, int pos, string& token)
+bool Lexer::checkToken(LexerState& state, int pos, const std::string& token)
 {
 	if (!token.empty())
 	{
 		unsigned long token_size = token.size();
 		for (unsigned i = 0; i < token_size; i++)
 		{
-			if (state.editor->GetCharAt(pos + i) != (int)token[i])
+			if (state.editor->GetCharAt(pos + i) != (int)(unsigned char)token[i])
 				return false;
 		}
 		return true;
@@ -663,16 +893,14 @@ bool Lexer::checkToken(LexerState& state, int pos, string& token)
 // Writes the fitst index that matched to [found_index] if a valid pointer
 // is passed. Returns true if there's a match, false if not.
 // -----------------------------------------------------------------------------
-bool Lexer::checkToken(LexerState& state, int pos, vector<string>& tokens, int* found_idx)
+bool Lexer::checkToken(LexerState& state, int pos, const vector<std::string>& tokens, int* found_idx)
 {
 	if (!tokens.size() == 0)
 	{
-		int    idx = 0;
-		string token;
+		int idx = 0;
 		while (idx < tokens.size())
 		{
-			token = tokens[idx];
-			if (checkToken(state, pos, token))
+			if (checkToken(state, pos, tokens[idx]))
 			{
 				if (found_idx)
 					*found_idx = idx;
@@ -686,19 +914,32 @@ bool Lexer::checkToken(LexerState& state, int pos, vector<string>& tokens, int*
 }
 
 // -----------------------------------------------------------------------------
-// Updates code folding levels in [editor], starting from line [line_start]
+// Updates code folding levels in [editor], starting from line [line_start].
+// If [line_end] is given, lines after it are only updated until one is found
+// with an unchanged fold level, since the levels of any lines after that
+// won't change either
 // -----------------------------------------------------------------------------
-void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
+void Lexer::updateFolding(TextEditorCtrl* editor, int line_start, int line_end)
 {
 	int fold_level = editor->GetFoldLevel(line_start) & wxSTC_FOLDLEVELNUMBERMASK;
+	int num_lines  = editor->GetLineCount();
 
-	for (int l = line_start; l < editor->GetLineCount(); l++)
+	for (int l = line_start; l < num_lines; l++)
 	{
 		// Determine next line's fold level
 		int next_level = fold_level + lines_[l].fold_increment;
 		if (next_level < wxSTC_FOLDLEVELBASE)
 			next_level = wxSTC_FOLDLEVELBASE;
 
+		// Stop if past the updated lines and the level hasn't changed
+		if (line_end >= 0 && l > line_end)
+		{
+			bool header_up = next_level > fold_level && !lines_[l].has_word;
+			int  level     = next_level > fold_level ? (fold_level | wxSTC_FOLDLEVELHEADERFLAG) : fold_level;
+			if (!header_up && editor->GetFoldLevel(l) == level)
+				break;
+		}
+
 		// Check if we are going up a fold level
 		if (next_level > fold_level)
 		{
@@ -725,8 +966,8 @@ void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
 // -----------------------------------------------------------------------------
 bool Lexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos)
 {
-	string word = editor->GetTextRange(start_pos, end_pos);
-	return word_list_[language_->caseSensitive() ? word : word.MakeLower()].style == (int)Style::Function;
+	auto word = editor->GetTextRangeRaw(start_pos, end_pos);
+	return word_list_.find(word.data(), word.length()) == (int)Style::Function;
 }
 
 
@@ -744,7 +985,7 @@ bool Lexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos)
 void ZScriptLexer::addWord(string word, int style)
 {
 	if (style == Style::Function)
-		functions_.push_back(language_->caseSensitive() ? word : word.Lower());
+		functions_.add(word, 1);
 	else
 		Lexer::addWord(word, style);
 }
@@ -752,31 +993,25 @@ void ZScriptLexer::addWord(string word, int style)
 // -----------------------------------------------------------------------------
 // ZScript version of Lexer::styleWord - functions require a following '('
 // -----------------------------------------------------------------------------
-void ZScriptLexer::styleWord(LexerState& state, string word)
+void ZScriptLexer::styleWord(LexerState& state, const char* word, unsigned length)
 {
 	// Skip whitespace after word
 	auto index = state.position;
 	while (index < state.end)
 	{
-		if (!(VECTOR_EXISTS(whitespace_chars_, state.editor->GetCharAt(index))))
+		if (!isWhitespace(state.editor->GetCharAt(index)))
 			break;
 		++index;
 	}
 
 	// Check for '(' (possible function)
-	if (state.editor->GetCharAt(index) == '(')
+	if (state.editor->GetCharAt(index) == '(' && functions_.find(word, length))
 	{
-		if (!language_->caseSensitive())
-			word = word.Lower();
-
-		if (VECTOR_EXISTS(functions_, word))
-		{
-			state.editor->SetStyling(word.length(), Style::Function);
-			return;
-		}
+		state.editor->SetStyling(length, Style::Function);
+		return;
 	}
 
-	Lexer::styleWord(state, word);
+	Lexer::styleWord(state, word, length);
 }
 
 // -----------------------------------------------------------------------------
@@ -785,6 +1020,7 @@ void ZScriptLexer::styleWord(LexerState& state, string word)
 void ZScriptLexer::clearWords()
 {
 	functions_.clear();
+	functions_.setCaseSensitive(language_ && language_->caseSensitive());
 	Lexer::clearWords();
 }
 
@@ -801,7 +1037,7 @@ bool ZScriptLexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos
 	auto end   = editor->GetTextLength();
 	while (index < end)
 	{
-		if (!(VECTOR_EXISTS(whitespace_chars_, editor->GetCharAt(index))))
+		if (!isWhitespace(editor->GetCharAt(index)))
 			break;
 		++index;
 	}
@@ -809,6 +1045,161 @@ bool ZScriptLexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos
 		return false;
 
 	// Check if word is a function name
-	string word = editor->GetTextRange(start_pos, end_pos);
-	return VECTOR_EXISTS(functions_, language_->caseSensitive() ? word : word.Lower());
+	auto word = editor->GetTextRangeRaw(start_pos, end_pos);
+	return functions_.find(word.data(), word.length()) != 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+#include "App.h"
+#include "General/Console/Console.h"
+
+namespace
+{
+// -----------------------------------------------------------------------------
+// Word styling as done by the original lexer (lower case copy, map lookup and
+// regex number checks), to compare against
+// -----------------------------------------------------------------------------
+class RefWordStyler
+{
+public:
+	RefWordStyler(TextLanguage* language) :
+		language_{ language },
+		re_int1_{ "^[+-]?[0-9]+[0-9]*$", wxRE_DEFAULT | wxRE_NOSUB },
+		re_int2_{ "^0[0-9]+$", wxRE_DEFAULT | wxRE_NOSUB },
+		re_int3_{ "^0x[0-9A-Fa-f]+$", wxRE_DEFAULT | wxRE_NOSUB },
+		re_float_{ "^[-+]?[0-9]*.?[0-9]+([eE][-+]?[0-9]+)?$", wxRE_DEFAULT | wxRE_NOSUB }
+	{
+	}
+
+	void addWord(string word, int style)
+	{
+		word_list_[language_->caseSensitive() ? word : word.Lower()] = (char)style;
+	}
+
+	int style(string word)
+	{
+		if (!language_->caseSensitive())
+			word = word.Lower();
+
+		if (word_list_[word] > 0)
+			return word_list_[word];
+		else if (word.StartsWith(language_->preprocessor()))
+			return Lexer::Style::Preprocessor;
+		else if (re_int2_.Matches(word) || re_int1_.Matches(word) || re_float_.Matches(word) || re_int3_.Matches(word))
+			return Lexer::Style::Number;
+		else
+			return Lexer::Style::Default;
+	}
+
+private:
+	TextLanguage*          language_;
+	wxRegEx                re_int1_;
+	wxRegEx                re_int2_;
+	wxRegEx                re_int3_;
+	wxRegEx                re_float_;
+	std::map<string, char> word_list_;
+};
+} // namespace
+
+CONSOLE_COMMAND(test_lexer, 0, false)
+{
+	string lang_id = args.empty() ? string("zscript") : args[0];
+	long   size_kb = 2048;
+	if (args.size() > 1)
+		args[1].ToLong(&size_kb);
+
+	auto language = TextLanguage::fromId(lang_id);
+	if (!language)
+	{
+		Log::console(S_FMT("Unknown language \"%s\"", CHR(lang_id)));
+		return;
+	}
+
+	// Get words to build test text from
+	vector<string> words;
+	for (auto type : { TextLanguage::Keyword, TextLanguage::Constant, TextLanguage::Type, TextLanguage::Property })
+		for (auto& word : language->wordListSorted(type))
+			words.push_back(word);
+	for (auto& word : language->functionsSorted())
+		words.push_back(word);
+	for (auto word : { "my_variable", "Counter", "spawn_health", "12345", "0x7F", "1e10", "0777" })
+		words.push_back(word);
+
+	// Build test text
+	srand(1);
+	std::string         text;
+	vector<std::string> tokens;
+	while (text.size() < (size_t)size_kb * 1024)
+	{
+		for (unsigned a = 0; a < 8; a++)
+		{
+			auto token = toStdString(words[rand() % words.size()]);
+			tokens.push_back(token);
+			text += token;
+			text += (a == 3) ? " = " : " ";
+		}
+		switch (rand() % 10)
+		{
+		case 0: text += "// Line comment\n"; break;
+		case 1: text += "\"A string\";\n"; break;
+		case 2: text += "/* Block\n comment */\n"; break;
+		default: text += ";\n"; break;
+		}
+	}
+
+	// Word classification, compared with the original method
+	Lexer         lexer;
+	RefWordStyler ref(language);
+	lexer.loadLanguage(language);
+	for (auto type : { TextLanguage::Constant, TextLanguage::Property })
+		for (auto& word : language->wordListSorted(type))
+			ref.addWord(word, type == TextLanguage::Constant ? Lexer::Style::Constant : Lexer::Style::Property);
+	for (auto& word : language->functionsSorted())
+		ref.addWord(word, Lexer::Style::Function);
+	for (auto type : { TextLanguage::Type, TextLanguage::Keyword })
+		for (auto& word : language->wordListSorted(type))
+			ref.addWord(word, type == TextLanguage::Type ? Lexer::Style::Type : Lexer::Style::Keyword);
+
+	vector<int> styles(tokens.size());
+	auto        start = App::runTimer();
+	for (unsigned a = 0; a < tokens.size(); a++)
+		styles[a] = lexer.wordStyle(tokens[a].data(), tokens[a].size());
+	long time_table = App::runTimer() - start;
+
+	unsigned differ = 0;
+	start           = App::runTimer();
+	for (unsigned a = 0; a < tokens.size(); a++)
+		if (ref.style(wxString::FromUTF8(tokens[a].data(), tokens[a].size())) != styles[a])
+			differ++;
+	long time_ref = App::runTimer() - start;
+
+	Log::console(S_FMT(
+		"Word styling: %lu words in %ldms (original method %ldms)",
+		tokens.size(),
+		time_table,
+		time_ref));
+	if (differ > 0)
+		Log::console(S_FMT("%d words styled differently", differ));
+
+	// Full styling in a (hidden) text editor
+	auto frame  = new wxFrame(nullptr, -1, "");
+	auto editor = new TextEditorCtrl(frame, -1);
+	editor->setLanguage(language);
+	editor->SetText(wxString::FromUTF8(text.data(), text.size()));
+	start = App::runTimer();
+	editor->Colourise(0, editor->GetTextLength());
+	long time_style = App::runTimer() - start;
+	frame->Destroy();
+
+	Log::console(S_FMT(
+		"Styled %1.2fMB in %ldms (%1.2fMB/s)",
+		text.size() / 1048576.0,
+		time_style,
+		text.size() / 1048576.0 * 1000.0 / std::max(time_style, 1l)));
 }
@@ -33,11 +33,12 @@ public:
 	virtual bool doStyling(TextEditorCtrl* editor, int start, int end);
 	virtual void addWord(string word, int style);
 	virtual void clearWords() { word_list_.clear(); }
+	int          wordStyle(const char* word, unsigned length) const;
 
 	void setWordChars(string chars);
 	void setOperatorChars(string chars);
 
-	void updateFolding(TextEditorCtrl* editor, int line_start);
+	void updateFolding(TextEditorCtrl* editor, int line_start, int line_end = -1);
 	void foldComments(bool fold) { fold_comments_ = fold; }
 	void foldPreprocessor(bool fold) { fold_preprocessor_ = fold; }
 
@@ -56,25 +57,66 @@ protected:
 		Whitespace,
 	};
 
-	vector<unsigned char> word_chars_;
-	vector<unsigned char> operator_chars_;
-	vector<unsigned char> whitespace_chars_;
-	TextLanguage*         language_;
-	wxRegEx               re_int1_;
-	wxRegEx               re_int2_;
-	wxRegEx               re_int3_;
-	wxRegEx               re_float_;
-	bool                  fold_comments_;
-	bool                  fold_preprocessor_;
-	char                  preprocessor_char_;
-	int                   curr_comment_idx_;
-
-	struct WLIndex
+	// Hash table of words (eg. keywords) to a value (eg. style), looked up
+	// directly from character data without creating a string
+	class WordTable
 	{
-		char style;
-		WLIndex() : style(0) {}
+	public:
+		WordTable(bool case_sensitive = true) : case_sensitive_{ case_sensitive } {}
+
+		void setCaseSensitive(bool case_sensitive) { case_sensitive_ = case_sensitive; }
+		void clear();
+		void add(const string& word, int value);
+		int  find(const char* word, unsigned length) const;
+		bool empty() const { return count_ == 0; }
+
+	private:
+		struct Entry
+		{
+			unsigned offset = 0;
+			unsigned length = 0;
+			uint32_t hash   = 0;
+			int      value  = 0;
+		};
+
+		vector<Entry> entries_;
+		std::string   chars_;
+		unsigned      count_          = 0;
+		bool          case_sensitive_ = true;
+
+		uint32_t hash(const char* word, unsigned length) const;
+		bool     equals(const Entry& entry, const char* word, unsigned length) const;
+		void     insert(const Entry& entry);
 	};
-	std::map<string, WLIndex> word_list_;
+
+	enum CharClass
+	{
+		WordChar       = 1,
+		OperatorChar   = 2,
+		WhitespaceChar = 4,
+	};
+
+	uint8_t             char_class_[256];
+	TextLanguage*       language_;
+	bool                fold_comments_;
+	bool                fold_preprocessor_;
+	char                preprocessor_char_;
+	int                 curr_comment_idx_;
+	WordTable           word_list_;
+	WordTable           fold_words_;
+	WordTable           pp_fold_words_;
+	std::string         word_;
+	std::string         preprocessor_;
+	vector<std::string> comment_begin_l_;
+	vector<std::string> comment_end_l_;
+	vector<std::string> comment_line_l_;
+	std::string         comment_doc_;
+	std::string         block_begin_;
+	std::string         block_end_;
+
+	bool isWordChar(int c) const { return (char_class_[(uint8_t)c] & WordChar) != 0; }
+	bool isOperatorChar(int c) const { return (char_class_[(uint8_t)c] & OperatorChar) != 0; }
+	bool isWhitespace(int c) const { return (char_class_[(uint8_t)c] & WhitespaceChar) != 0; }
 
 	struct LineInfo
 	{
@@ -104,9 +146,9 @@ protected:
 	bool processOperator(LexerState& state);
 	bool processWhitespace(LexerState& state);
 
-	virtual void styleWord(LexerState& state, string word);
-	bool         checkToken(LexerState& state, int pos, string& token);
-	bool         checkToken(LexerState& state, int pos, vector<string>& tokens, int* found_idx = nullptr);
+	virtual void styleWord(LexerState& state, const char* word, unsigned length);
+	bool         checkToken(LexerState& state, int pos, const std::string& token);
+	bool checkToken(LexerState& state, int pos, const vector<std::string>& tokens, int* found_idx = nullptr);
 };
 
 class ZScriptLexer : public Lexer
@@ -117,10 +159,10 @@ public:
 
 protected:
 	void addWord(string word, int style) override;
-	void styleWord(LexerState& state, string word) override;
+	void styleWord(LexerState& state, const char* word, unsigned length) override;
 	void clearWords() override;
 	bool isFunction(TextEditorCtrl* editor, int start_pos, int end_pos) override;
 
 private:
-	vector<string> functions_;
+	WordTable functions_;
 };
@@ -0,0 +1,433 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    OutlineIndex.cpp
+// Description: OutlineIndex class - keeps track of the named top-level blocks
+//              (eg. actors, classes, scripts) in a text editor, for the
+//              'Jump To' list and calltip context. The text is scanned line by
+//              line, and edits only rescan from the first modified line until
+//              the scanner state matches the previous scan again
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "OutlineIndex.h"
+#include "App.h"
+#include "TextLanguage.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+const char* SPECIAL_CHARS = ";,:|={}/()";
+
+// -----------------------------------------------------------------------------
+// Returns [str] as a UTF-8 std::string
+// -----------------------------------------------------------------------------
+std::string toStdString(const string& str)
+{
+	auto utf8 = str.ToUTF8();
+	return std::string(utf8.data(), utf8.length());
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [token] ([length] characters) matches [lower] (which must
+// be lower case), ignoring case
+// -----------------------------------------------------------------------------
+bool equalsNoCase(const char* token, unsigned length, const std::string& lower)
+{
+	if (length != lower.size())
+		return false;
+
+	for (unsigned a = 0; a < length; a++)
+		if (tolower((uint8_t)token[a]) != (uint8_t)lower[a])
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [token] ([length] characters) is an integer
+// -----------------------------------------------------------------------------
+bool isNumber(const char* token, unsigned length)
+{
+	unsigned a = (length > 1 && token[0] == '-') ? 1 : 0;
+	for (; a < length; a++)
+		if (token[a] < '0' || token[a] > '9')
+			return false;
+
+	return length > 0;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// OutlineIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Sets the block keywords to index from [language], and resets the index for
+// a text of [num_lines] lines
+// -----------------------------------------------------------------------------
+void OutlineIndex::setLanguage(TextLanguage* language, int num_lines)
+{
+	blocks_.clear();
+	ignore_.clear();
+
+	if (language)
+	{
+		// Block keywords can have a number of tokens to skip before the name
+		// (eg. 'function:1' for 'function int name')
+		for (auto& block : language->jumpBlocks())
+		{
+			Block b;
+			b.label = toStdString(block.BeforeFirst(':'));
+			b.name  = toStdString(block.BeforeFirst(':').Lower());
+			b.skip  = 0;
+
+			long skip;
+			if (block.Contains(":") && block.AfterFirst(':').ToLong(&skip))
+				b.skip = skip;
+
+			blocks_.push_back(b);
+		}
+
+		for (auto& word : language->jumpBlocksIgnored())
+			ignore_.push_back(toStdString(word.Lower()));
+	}
+
+	reset(num_lines);
+}
+
+// -----------------------------------------------------------------------------
+// Clears the index, the whole text ([num_lines] lines) will be scanned on the
+// next update
+// -----------------------------------------------------------------------------
+void OutlineIndex::reset(int num_lines)
+{
+	lines_.clear();
+	lines_.resize(std::max(num_lines, 1));
+	lines_[0].valid = true;
+	dirty_from_     = 0;
+	dirty_to_       = lines_.size() - 1;
+	shifted_        = true;
+}
+
+// -----------------------------------------------------------------------------
+// Marks [line] as modified, with [lines_added] lines inserted (or removed if
+// negative) after it
+// -----------------------------------------------------------------------------
+void OutlineIndex::linesChanged(int line, int lines_added)
+{
+	if (line < 0 || line >= (int)lines_.size() || line - lines_added >= (int)lines_.size())
+	{
+		// Index is out of sync with the text, scan everything again
+		reset(lines_.size() + lines_added);
+		return;
+	}
+
+	// Add/remove lines after [line]
+	if (lines_added > 0)
+		lines_.insert(lines_.begin() + line + 1, lines_added, Line());
+	else if (lines_added < 0)
+		lines_.erase(lines_.begin() + line + 1, lines_.begin() + line + 1 - lines_added);
+
+	// Update modified range
+	if (dirty_to_ >= dirty_from_)
+	{
+		if (dirty_to_ > line)
+			dirty_to_ = std::max(line, dirty_to_ + lines_added);
+		dirty_from_ = std::min(dirty_from_, line);
+		dirty_to_   = std::max(dirty_to_, line + std::max(lines_added, 0));
+	}
+	else
+	{
+		dirty_from_ = line;
+		dirty_to_   = line + std::max(lines_added, 0);
+	}
+
+	// Line numbers of following entries have changed
+	if (lines_added != 0)
+		shifted_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Rescans modified lines in [editor]. Scanning continues past the modified
+// lines until the scanner state at the start of a line is the same as it was
+// previously, after which nothing can have changed.
+// If [time_limit] (ms) is given, scanning stops once it has taken that long
+// and continues from the same line on the next update (see pending), so the
+// first scan of a large text can be spread over several updates.
+// Returns true if the list of entries changed (the revision number is also
+// incremented)
+// -----------------------------------------------------------------------------
+bool OutlineIndex::update(wxStyledTextCtrl* editor, long time_limit)
+{
+	int num_lines = editor->GetLineCount();
+	if ((int)lines_.size() != num_lines)
+		reset(num_lines);
+
+	if (dirty_to_ < dirty_from_)
+		return false;
+
+	bool          changed = shifted_;
+	bool          paused  = false;
+	auto          start   = App::runTimer();
+	State         state   = lines_[dirty_from_].state;
+	vector<Entry> old_entries;
+	int           line = dirty_from_;
+	for (; line < num_lines; line++)
+	{
+		// Stop if we're past the modified lines and back in sync
+		if (line > dirty_to_ && lines_[line].valid && lines_[line].state == state)
+			break;
+
+		// Stop if out of time (only checking every so often)
+		if (time_limit > 0 && line > dirty_from_ && (line - dirty_from_) % 64 == 0
+			&& App::runTimer() - start >= time_limit)
+		{
+			paused = true;
+			break;
+		}
+
+		lines_[line].state = state;
+		lines_[line].valid = true;
+		old_entries.swap(lines_[line].entries);
+		lines_[line].entries.clear();
+
+		auto text = editor->GetLineRaw(line);
+		scanLine(line, text.data(), text.length(), state);
+
+		// Check if the line's entries changed
+		auto& entries = lines_[line].entries;
+		if (entries.size() != old_entries.size())
+			changed = true;
+		else
+			for (unsigned a = 0; a < entries.size(); a++)
+				if (entries[a].name != old_entries[a].name)
+					changed = true;
+	}
+
+	if (paused)
+	{
+		// Continue from [line] next time, it always needs scanning since its
+		// previous state was overwritten
+		lines_[line].state = state;
+		dirty_from_        = line;
+		dirty_to_          = std::max(dirty_to_, line);
+	}
+	else
+	{
+		dirty_from_ = 0;
+		dirty_to_   = -1;
+	}
+
+	shifted_ = false;
+	if (changed)
+	{
+		rebuild_ = true;
+		revision_++;
+	}
+
+	return changed;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all entries in the index, in order
+// -----------------------------------------------------------------------------
+const vector<OutlineIndex::Entry>& OutlineIndex::entries()
+{
+	if (rebuild_)
+	{
+		entries_.clear();
+		for (unsigned a = 0; a < lines_.size(); a++)
+			for (auto& entry : lines_[a].entries)
+			{
+				entries_.push_back(entry);
+				entries_.back().line = a;
+			}
+
+		rebuild_ = false;
+	}
+
+	return entries_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the entry for the top-level block containing [line], or nullptr if
+// [line] isn't within a block
+// -----------------------------------------------------------------------------
+const OutlineIndex::Entry* OutlineIndex::blockAt(int line)
+{
+	if (line < 0 || line >= (int)lines_.size() || lines_[line].state.depth == 0)
+		return nullptr;
+
+	// Go back to the line the block opened on
+	while (line > 0 && lines_[line].state.depth > 0)
+		line--;
+
+	// Find the nearest entry at or before it
+	for (; line >= 0; line--)
+		if (!lines_[line].entries.empty())
+			return &lines_[line].entries.back();
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Scans [line] ([text], [length] characters) for tokens, updating [state]
+// -----------------------------------------------------------------------------
+void OutlineIndex::scanLine(int line, const char* text, unsigned length, State& state)
+{
+	unsigned pos = 0;
+	while (pos < length)
+	{
+		// Block comment
+		if (state.comment)
+		{
+			while (pos + 1 < length && !(text[pos] == '*' && text[pos + 1] == '/'))
+				pos++;
+			if (pos + 1 >= length)
+				return;
+			pos += 2;
+			state.comment = false;
+			continue;
+		}
+
+		char c = text[pos];
+
+		// Whitespace
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+		{
+			pos++;
+			continue;
+		}
+
+		// Comments
+		if (c == '/' && pos + 1 < length)
+		{
+			if (text[pos + 1] == '/')
+				return;
+			if (text[pos + 1] == '*')
+			{
+				state.comment = true;
+				pos += 2;
+				continue;
+			}
+		}
+
+		// Quoted string
+		if (c == '"')
+		{
+			unsigned start = ++pos;
+			while (pos < length && text[pos] != '"')
+				pos += (text[pos] == '\\') ? 2 : 1;
+			processToken(line, text + start, std::min(pos, length) - start, state);
+			pos++;
+			continue;
+		}
+
+		// Special character
+		if (strchr(SPECIAL_CHARS, c))
+		{
+			processToken(line, text + pos, 1, state);
+			pos++;
+			continue;
+		}
+
+		// Regular token
+		unsigned start = pos;
+		while (pos < length && text[pos] != '"' && !strchr(SPECIAL_CHARS, text[pos]) && text[pos] != ' '
+			   && text[pos] != '\t' && text[pos] != '\r' && text[pos] != '\n')
+			pos++;
+		processToken(line, text + start, pos - start, state);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Processes [token] ([length] characters) on [line], updating [state] and
+// adding an entry if it names a block
+// -----------------------------------------------------------------------------
+void OutlineIndex::processToken(int line, const char* token, unsigned length, State& state)
+{
+	bool open  = length == 1 && token[0] == '{';
+	bool close = length == 1 && token[0] == '}';
+
+	// Waiting for a block name
+	if (state.block >= 0)
+	{
+		auto& block = blocks_[state.block];
+		bool  end   = open || close || (length == 1 && token[0] == ';');
+		if (state.skip > 0 && !end)
+		{
+			state.skip--;
+			return;
+		}
+
+		// Skip ignored words
+		if (!end)
+			for (auto& word : ignore_)
+				if (equalsNoCase(token, length, word))
+					return;
+
+		Entry entry;
+		entry.line  = line;
+		entry.block = block.label;
+		if (end)
+			entry.name = block.label; // Unnamed block, use block name
+		else if (isNumber(token, length))
+			entry.name = block.label + " " + std::string(token, length); // Numbered block
+		else
+			entry.name = std::string(token, length);
+		lines_[line].entries.push_back(entry);
+		state.block = -1;
+
+		if (!open && !close)
+			return;
+	}
+
+	// Blocks
+	if (open)
+		state.depth++;
+	else if (close)
+		state.depth = std::max(0, state.depth - 1);
+
+	// Check for block keyword (top level only)
+	else if (state.depth == 0 && state.block < 0)
+		for (unsigned a = 0; a < blocks_.size(); a++)
+			if (equalsNoCase(token, length, blocks_[a].name))
+			{
+				state.block = a;
+				state.skip  = blocks_[a].skip;
+				break;
+			}
+}
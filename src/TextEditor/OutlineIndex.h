@@ -0,0 +1,68 @@
+#pragma once
+
+class TextLanguage;
+
+class OutlineIndex
+{
+public:
+	struct Entry
+	{
+		int         line;
+		std::string name;
+		std::string block;
+	};
+
+	OutlineIndex() {}
+	~OutlineIndex() {}
+
+	void                 setLanguage(TextLanguage* language, int num_lines);
+	void                 reset(int num_lines);
+	void                 linesChanged(int line, int lines_added);
+	bool                 update(wxStyledTextCtrl* editor, long time_limit = 0);
+	bool                 pending() const { return dirty_to_ >= dirty_from_; }
+	const vector<Entry>& entries();
+	const Entry*         blockAt(int line);
+	unsigned             revision() const { return revision_; }
+
+private:
+	struct Block
+	{
+		std::string name; // Lower case
+		std::string label;
+		int         skip;
+	};
+
+	// Scanner state at the start of a line
+	struct State
+	{
+		int  depth   = 0;     // Brace depth
+		bool comment = false; // In block comment
+		int  block   = -1;    // Block keyword waiting for a name
+		int  skip    = 0;     // Tokens to skip before the name
+
+		bool operator==(const State& rhs) const
+		{
+			return depth == rhs.depth && comment == rhs.comment && block == rhs.block && skip == rhs.skip;
+		}
+	};
+
+	struct Line
+	{
+		State         state;
+		bool          valid = false; // State is from a previous scan of unchanged text
+		vector<Entry> entries;
+	};
+
+	vector<Block>       blocks_;
+	vector<std::string> ignore_;
+	vector<Line>        lines_;
+	vector<Entry>       entries_;
+	int                 dirty_from_ = 0;
+	int                 dirty_to_   = -1;
+	bool                shifted_    = true;
+	bool                rebuild_    = true;
+	unsigned            revision_   = 0;
+
+	void scanLine(int line, const char* text, unsigned length, State& state);
+	void processToken(int line, const char* token, unsigned length, State& state);
+};
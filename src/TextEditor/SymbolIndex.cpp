@@ -0,0 +1,727 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    SymbolIndex.cpp
+// Description: SymbolIndex class - keeps an index of the symbols (actors,
+//              classes, functions, scripts, maps etc.) defined in script
+//              entries of all open archives, and where each word is used.
+//              Entries are parsed on a background thread as archives are
+//              opened and entries are added or modified
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "SymbolIndex.h"
+#include "Archive/Archive.h"
+#include "Game/ZScript.h"
+#include "Utility/Tokenizer.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, txed_symbol_index, true, CVAR_SAVE)
+SymbolIndex* SymbolIndex::instance_ = nullptr;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [word] in lower case, as used for index keys
+// -----------------------------------------------------------------------------
+std::string indexKey(const string& word)
+{
+	auto key = word.ToStdString();
+	for (auto& c : key)
+		c = tolower((uint8_t)c);
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [word] could be a symbol name (identifier)
+// -----------------------------------------------------------------------------
+bool isIdentifier(const string& word)
+{
+	if (word.empty() || !(wxIsalpha(word[0]) || word[0] == '_'))
+		return false;
+
+	for (auto c : word)
+		if (!(wxIsalnum(c) || c == '_'))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [token] could be a symbol name (identifier), checking the
+// token characters directly to avoid creating a string for every token
+// -----------------------------------------------------------------------------
+bool isIdentifier(const Tokenizer::Token& token)
+{
+	auto c   = token.chars();
+	auto len = token.size();
+	if (len == 0 || !(isalpha((uint8_t)c[0]) || c[0] == '_'))
+		return false;
+
+	for (unsigned a = 1; a < len; a++)
+		if (!(isalnum((uint8_t)c[a]) || c[a] == '_'))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [token] in lower case, as used for index keys
+// -----------------------------------------------------------------------------
+std::string indexKey(const Tokenizer::Token& token)
+{
+	auto key = token.stdString();
+	for (auto& c : key)
+		c = tolower((uint8_t)c);
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the name of the ZScript function declared in [statement]
+// -----------------------------------------------------------------------------
+string functionName(const ZScript::ParsedStatement& statement)
+{
+	bool special = false;
+	for (unsigned a = 1; a < statement.tokens.size(); a++)
+	{
+		auto& token = statement.tokens[a];
+
+		// Skip deprecated(...) and version(...)
+		if (S_CMPNOCASE(token, "deprecated") || S_CMPNOCASE(token, "version"))
+			special = true;
+		else if (special && token == ")")
+			special = false;
+		else if (!special && token == "(")
+			return statement.tokens[a - 1];
+	}
+
+	return wxEmptyString;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the ZScript symbol(s) defined by [statement] to [symbols]. [parent] is
+// the name of the containing class/struct, if any
+// -----------------------------------------------------------------------------
+void addZScriptSymbol(
+	const ZScript::ParsedStatement& statement,
+	const string&                   parent,
+	ArchiveEntry*                   entry,
+	vector<SymbolIndex::Symbol>&    symbols)
+{
+	typedef SymbolIndex::Kind Kind;
+
+	auto& tokens = statement.tokens;
+	if (tokens.empty())
+		return;
+
+	string name;
+	Kind   kind = Kind::Function;
+	if (S_CMPNOCASE(tokens[0], "struct"))
+	{
+		name = tokens.size() > 1 ? tokens[1] : "";
+		kind = Kind::Struct;
+		for (auto& member : statement.block)
+			addZScriptSymbol(member, name, entry, symbols);
+	}
+	else if (S_CMPNOCASE(tokens[0], "enum"))
+	{
+		name = tokens.size() > 1 ? tokens[1] : "";
+		kind = Kind::Enum;
+
+		// Values are all in one statement, separated by commas
+		for (auto& values : statement.block)
+			for (unsigned a = 0; a < values.tokens.size(); a++)
+				if ((a == 0 || values.tokens[a - 1] == ",") && isIdentifier(values.tokens[a]))
+					symbols.push_back({ values.tokens[a], Kind::Constant, parent, { entry, values.line } });
+	}
+	else if (S_CMPNOCASE(tokens[0], "const"))
+	{
+		name = tokens.size() > 1 ? tokens[1] : "";
+		kind = Kind::Constant;
+	}
+	else if (ZScript::Function::isFunction(const_cast<ZScript::ParsedStatement&>(statement)))
+		name = functionName(statement);
+
+	if (isIdentifier(name))
+		symbols.push_back({ name, kind, parent, { entry, statement.line } });
+}
+
+// -----------------------------------------------------------------------------
+// Adds the symbols defined in ZScript [data] to [symbols]
+// -----------------------------------------------------------------------------
+void parseZScript(MemChunk& data, ArchiveEntry* entry, vector<SymbolIndex::Symbol>& symbols)
+{
+	typedef SymbolIndex::Kind Kind;
+
+	vector<ZScript::ParsedStatement> statements;
+	ZScript::parseStatements(data, statements);
+
+	for (auto& statement : statements)
+	{
+		auto&    tokens = statement.tokens;
+		unsigned index  = 0;
+
+		// Skip modifiers that can come before class
+		while (index < tokens.size()
+			   && (S_CMPNOCASE(tokens[index], "extend") || S_CMPNOCASE(tokens[index], "mixin")))
+			index++;
+
+		if (index + 1 < tokens.size() && S_CMPNOCASE(tokens[index], "class"))
+		{
+			// Extensions aren't definitions, but their members are
+			string name = tokens[index + 1];
+			if (!S_CMPNOCASE(tokens[0], "extend"))
+				symbols.push_back({ name, Kind::Class, wxEmptyString, { entry, statement.line } });
+
+			for (auto& member : statement.block)
+				addZScriptSymbol(member, name, entry, symbols);
+		}
+		else if (index == 0)
+			addZScriptSymbol(statement, wxEmptyString, entry, symbols);
+		else if (index + 1 < tokens.size())
+		{
+			// extend struct
+			for (auto& member : statement.block)
+				addZScriptSymbol(member, tokens[index + 1], entry, symbols);
+		}
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SymbolIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// SymbolIndex class destructor
+// -----------------------------------------------------------------------------
+SymbolIndex::~SymbolIndex()
+{
+	stop();
+}
+
+// -----------------------------------------------------------------------------
+// Adds all script entries in [archive] to the index
+// -----------------------------------------------------------------------------
+void SymbolIndex::addArchive(Archive* archive)
+{
+	if (!archive || !txed_symbol_index)
+		return;
+
+	vector<ArchiveEntry::SPtr> entries;
+	archive->getEntryTreeAsList(entries);
+	for (auto& entry : entries)
+		if (language(entry.get()) != Language::None)
+			updateEntry(entry.get());
+
+	listenTo(archive);
+}
+
+// -----------------------------------------------------------------------------
+// Removes all entries in [archive] from the index
+// -----------------------------------------------------------------------------
+void SymbolIndex::removeArchive(Archive* archive)
+{
+	if (!archive)
+		return;
+
+	stopListening(archive);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (auto i = records_.begin(); i != records_.end();)
+	{
+		if (i->second.archive == archive)
+		{
+			if (i->second.symbols)
+				removeDefinitions(i->first, *i->second.symbols);
+			i = records_.erase(i);
+		}
+		else
+			++i;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Queues [entry] to be (re)parsed on the background thread. Removes it from
+// the index instead if it isn't a script entry (any more)
+// -----------------------------------------------------------------------------
+void SymbolIndex::updateEntry(ArchiveEntry* entry)
+{
+	auto lang = language(entry);
+	if (lang == Language::None)
+	{
+		removeEntry(entry);
+		return;
+	}
+
+	// Entry data can only be loaded from the archive on this thread, so the
+	// job gets a copy of it
+	auto job      = std::make_unique<Job>();
+	job->entry    = entry;
+	job->language = lang;
+	job->data.importMem(entry->getData(), entry->getSize());
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (stop_)
+			return;
+
+		auto& record    = records_[entry];
+		record.entry    = entry->getShared();
+		record.archive  = entry->getParent();
+		record.revision = ++revision_;
+		job->revision   = revision_;
+		queue_.push_back(std::move(job));
+
+		// Start worker thread if needed
+		if (!thread_.joinable())
+			thread_ = std::thread(&SymbolIndex::workerThread, this);
+	}
+	cv_.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from the index
+// -----------------------------------------------------------------------------
+void SymbolIndex::removeEntry(ArchiveEntry* entry)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto record = records_.find(entry);
+	if (record == records_.end())
+		return;
+
+	if (record->second.symbols)
+		removeDefinitions(entry, *record->second.symbols);
+	records_.erase(record);
+}
+
+// -----------------------------------------------------------------------------
+// Stops the background thread and discards anything still queued
+// -----------------------------------------------------------------------------
+void SymbolIndex::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+		queue_.clear();
+	}
+	cv_.notify_all();
+
+	if (thread_.joinable())
+		thread_.join();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if there are any entries still waiting to be parsed
+// -----------------------------------------------------------------------------
+bool SymbolIndex::busy()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return !queue_.empty() || in_progress_ > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all definitions of symbol [name] (case-insensitive), with any in
+// the [priority] archive first
+// -----------------------------------------------------------------------------
+vector<SymbolIndex::Symbol> SymbolIndex::definitions(const string& name, Archive* priority)
+{
+	vector<Symbol> list;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pruneRecords();
+		auto defs = definitions_.find(indexKey(name));
+		if (defs != definitions_.end())
+			list = defs->second;
+	}
+
+	std::stable_sort(list.begin(), list.end(), [priority](const Symbol& left, const Symbol& right) {
+		return (left.location.entry->getParent() == priority) > (right.location.entry->getParent() == priority);
+	});
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the locations of all lines [name] (case-insensitive) is used on,
+// grouped by entry, with entries in the [priority] archive first
+// -----------------------------------------------------------------------------
+vector<SymbolIndex::Location> SymbolIndex::usages(const string& name, Archive* priority)
+{
+	auto key = indexKey(name);
+
+	// Get lines from all entries using the word
+	vector<std::pair<ArchiveEntry*, vector<unsigned>>> found;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pruneRecords();
+		for (auto& record : records_)
+		{
+			if (!record.second.symbols)
+				continue;
+
+			auto lines = record.second.symbols->usages.find(key);
+			if (lines != record.second.symbols->usages.end())
+				found.emplace_back(record.first, lines->second);
+		}
+	}
+
+	// Sort entries by archive then path
+	vector<std::pair<string, unsigned>> order;
+	for (unsigned a = 0; a < found.size(); a++)
+	{
+		auto entry = found[a].first;
+		order.emplace_back(
+			S_FMT(
+				"%d%s/%s",
+				entry->getParent() == priority ? 0 : 1,
+				entry->getParent()->filename(false),
+				entry->getPath(true)),
+			a);
+	}
+	std::sort(order.begin(), order.end());
+
+	vector<Location> list;
+	for (auto& o : order)
+		for (auto line : found[o.second].second)
+			list.push_back({ found[o.second].first, line });
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Called when an announcement is recieved from one of the archives being
+// indexed
+// -----------------------------------------------------------------------------
+void SymbolIndex::onAnnouncement(Announcer* announcer, string event_name, MemChunk& event_data)
+{
+	event_data.seek(0, SEEK_SET);
+
+	// An entry is added or modified
+	if (event_name == "entry_added" || event_name == "entry_state_changed")
+	{
+		wxUIntPtr ptr;
+		event_data.read(&ptr, sizeof(wxUIntPtr), 4);
+		updateEntry((ArchiveEntry*)wxUIntToPtr(ptr));
+	}
+
+	// An entry is removed
+	if (event_name == "entry_removing")
+	{
+		wxUIntPtr ptr;
+		event_data.read(&ptr, sizeof(wxUIntPtr), sizeof(int));
+		removeEntry((ArchiveEntry*)wxUIntToPtr(ptr));
+	}
+
+	// Entries can be deleted without being announced (eg. along with their
+	// directory), so drop any records for them
+	if (event_name == "modified")
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pruneRecords();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns a display name for symbol [kind]
+// -----------------------------------------------------------------------------
+string SymbolIndex::kindName(Kind kind)
+{
+	switch (kind)
+	{
+	case Kind::Actor: return "Actor";
+	case Kind::Class: return "Class";
+	case Kind::Struct: return "Struct";
+	case Kind::Enum: return "Enum";
+	case Kind::Constant: return "Constant";
+	case Kind::Function: return "Function";
+	case Kind::Script: return "Script";
+	case Kind::Map: return "Map";
+	default: return "Unknown";
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Removes the definitions in [symbols] (parsed from [entry]) from the
+// definitions map. The mutex must be locked when calling this
+// -----------------------------------------------------------------------------
+void SymbolIndex::removeDefinitions(ArchiveEntry* entry, EntrySymbols& symbols)
+{
+	for (auto& symbol : symbols.definitions)
+	{
+		auto defs = definitions_.find(indexKey(symbol.name));
+		if (defs == definitions_.end())
+			continue;
+
+		auto& list = defs->second;
+		list.erase(
+			std::remove_if(list.begin(), list.end(), [entry](const Symbol& s) { return s.location.entry == entry; }),
+			list.end());
+		if (list.empty())
+			definitions_.erase(defs);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Removes records (and their definitions) for any entries that have since
+// been deleted. The mutex must be locked when calling this
+// -----------------------------------------------------------------------------
+void SymbolIndex::pruneRecords()
+{
+	for (auto i = records_.begin(); i != records_.end();)
+	{
+		if (i->second.entry.expired())
+		{
+			if (i->second.symbols)
+				removeDefinitions(i->first, *i->second.symbols);
+			i = records_.erase(i);
+		}
+		else
+			++i;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Background thread loop, parses queued entries until stopped
+// -----------------------------------------------------------------------------
+void SymbolIndex::workerThread()
+{
+	while (true)
+	{
+		std::unique_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+			if (stop_)
+				return;
+
+			job = std::move(queue_.back());
+			queue_.pop_back();
+
+			// Skip if the entry was removed or modified again since queued
+			auto record = records_.find(job->entry);
+			if (record == records_.end() || record->second.revision != job->revision)
+				continue;
+
+			in_progress_++;
+		}
+
+		auto symbols = std::make_unique<EntrySymbols>();
+		parse(*job, *symbols);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		in_progress_--;
+		auto record = records_.find(job->entry);
+		if (record == records_.end() || record->second.revision != job->revision)
+			continue;
+
+		// Replace previous definitions
+		if (record->second.symbols)
+			removeDefinitions(job->entry, *record->second.symbols);
+		for (auto& symbol : symbols->definitions)
+			definitions_[indexKey(symbol.name)].push_back(symbol);
+		record->second.symbols = std::move(symbols);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the script language to index [entry] as, based on its type
+// -----------------------------------------------------------------------------
+SymbolIndex::Language SymbolIndex::language(ArchiveEntry* entry)
+{
+	if (!entry || !entry->getType())
+		return Language::None;
+
+	auto& id = entry->getType()->id();
+	if (id == "decorate" || id == "decorate_ns")
+		return Language::Decorate;
+	if (id == "zscript" || id == "zscript_ns")
+		return Language::ZScript;
+	if (id == "acs")
+		return Language::ACS;
+	if (id == "mapinfo" || id == "zmapinfo")
+		return Language::MapInfo;
+
+	return Language::None;
+}
+
+// -----------------------------------------------------------------------------
+// Parses the entry data in [job], adding all symbol definitions and the lines
+// each word is used on to [symbols]
+// -----------------------------------------------------------------------------
+void SymbolIndex::parse(Job& job, EntrySymbols& symbols)
+{
+	if (job.language == Language::ZScript)
+		parseZScript(job.data, job.entry, symbols.definitions);
+
+	Tokenizer tz(Tokenizer::CommentTypes::CPPStyle | Tokenizer::CommentTypes::CStyle);
+	tz.setSpecialCharacters(CHR(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-*[]&!?.<>"));
+	tz.openMem(job.data, "SymbolIndex");
+
+	int  depth      = 0;
+	bool name_next  = false; // Next token is the name of a definition
+	int  skip       = 0;     // Number of tokens to skip before the name
+	Kind kind       = Kind::Actor;
+	bool enum_block = false; // In a DECORATE enum block
+	bool enum_value = false; // Next token is a DECORATE enum value
+	while (!tz.atEnd())
+	{
+		auto& token = tz.current();
+
+		// Record usage
+		if (isIdentifier(token))
+		{
+			auto& lines = symbols.usages[indexKey(token)];
+			if (lines.empty() || lines.back() != token.line_no)
+				lines.push_back(token.line_no);
+		}
+
+		// Definition name
+		if (name_next && skip > 0)
+			skip--;
+		else if (name_next)
+		{
+			if (!token.empty() && !tz.isSpecialCharacter(token[0]))
+				symbols.definitions.push_back({ token.text(), kind, wxEmptyString, { job.entry, token.line_no } });
+			name_next = false;
+		}
+
+		// DECORATE enum values
+		else if (enum_block && depth == 1 && token != '}')
+		{
+			if (enum_value && isIdentifier(token))
+				symbols.definitions.push_back(
+					{ token.text(), Kind::Constant, wxEmptyString, { job.entry, token.line_no } });
+			enum_value = token == ',';
+		}
+
+		// Blocks
+		else if (token == '{')
+		{
+			depth++;
+			enum_value = enum_block;
+		}
+		else if (token == '}')
+		{
+			depth = std::max(0, depth - 1);
+			if (depth == 0)
+				enum_block = false;
+		}
+
+		// Definition keywords (ZScript definitions come from the parsed statements)
+		else if (depth == 0 && !token.quoted_string && job.language != Language::ZScript)
+		{
+			name_next = true;
+			skip      = 0;
+			if (job.language == Language::Decorate && tz.checkNC("actor"))
+				kind = Kind::Actor;
+			else if (job.language == Language::Decorate && tz.checkNC("const"))
+			{
+				kind = Kind::Constant;
+				skip = 1; // Type
+			}
+			else if (job.language == Language::Decorate && tz.checkNC("enum"))
+			{
+				enum_block = true;
+				name_next  = false;
+			}
+			else if (job.language == Language::ACS && tz.checkNC("script"))
+				kind = Kind::Script;
+			else if (job.language == Language::ACS && tz.checkNC("function"))
+			{
+				kind = Kind::Function;
+				skip = 1; // Return type
+			}
+			else if (job.language == Language::ACS && (tz.checkNC("#define") || tz.checkNC("#libdefine")))
+				kind = Kind::Constant;
+			else if (job.language == Language::MapInfo && tz.checkNC("map"))
+				kind = Kind::Map;
+			else
+				name_next = false;
+		}
+
+		tz.adv();
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+#include "App.h"
+#include "General/Console/Console.h"
+
+CONSOLE_COMMAND(find_definition, 1, false)
+{
+	auto start = App::runTimer();
+	auto defs  = theSymbolIndex->definitions(args[0]);
+	auto time  = App::runTimer() - start;
+
+	for (auto& def : defs)
+		Log::console(S_FMT(
+			"%s %s: %s/%s:%u",
+			SymbolIndex::kindName(def.kind),
+			def.parent.empty() ? def.name : def.parent + "." + def.name,
+			def.location.entry->getParent()->filename(false),
+			def.location.entry->getPath(true),
+			def.location.line));
+	Log::console(S_FMT("%d definitions found in %dms", (int)defs.size(), (int)time));
+}
+
+CONSOLE_COMMAND(find_usages, 1, false)
+{
+	auto start  = App::runTimer();
+	auto usages = theSymbolIndex->usages(args[0]);
+	auto time   = App::runTimer() - start;
+
+	for (auto& usage : usages)
+		Log::console(S_FMT(
+			"%s/%s:%u",
+			usage.entry->getParent()->filename(false),
+			usage.entry->getPath(true),
+			usage.line));
+	Log::console(S_FMT("%d usages found in %dms", (int)usages.size(), (int)time));
+}
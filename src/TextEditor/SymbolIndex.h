@@ -0,0 +1,118 @@
+#pragma once
+
+#include "General/ListenerAnnouncer.h"
+#include <condition_variable>
+#include <thread>
+
+class Archive;
+class ArchiveEntry;
+
+class SymbolIndex : public Listener, public Announcer
+{
+public:
+	enum class Kind
+	{
+		Actor,
+		Class,
+		Struct,
+		Enum,
+		Constant,
+		Function,
+		Script,
+		Map,
+	};
+
+	struct Location
+	{
+		ArchiveEntry* entry = nullptr;
+		unsigned      line  = 0; // 1-based
+	};
+
+	struct Symbol
+	{
+		string   name;
+		Kind     kind;
+		string   parent; // Containing class/struct for members
+		Location location;
+	};
+
+	SymbolIndex() {}
+	~SymbolIndex();
+
+	static SymbolIndex* getInstance()
+	{
+		if (!instance_)
+			instance_ = new SymbolIndex();
+
+		return instance_;
+	}
+
+	void addArchive(Archive* archive);
+	void removeArchive(Archive* archive);
+	void updateEntry(ArchiveEntry* entry);
+	void removeEntry(ArchiveEntry* entry);
+	void stop();
+
+	bool             busy();
+	vector<Symbol>   definitions(const string& name, Archive* priority = nullptr);
+	vector<Location> usages(const string& name, Archive* priority = nullptr);
+
+	void onAnnouncement(Announcer* announcer, string event_name, MemChunk& event_data) override;
+
+	static string kindName(Kind kind);
+
+private:
+	enum class Language
+	{
+		None,
+		Decorate,
+		ZScript,
+		ACS,
+		MapInfo,
+	};
+
+	// Symbols parsed from a single entry
+	struct EntrySymbols
+	{
+		vector<Symbol>                                    definitions;
+		std::unordered_map<std::string, vector<unsigned>> usages; // Lower case word -> lines
+	};
+
+	struct Record
+	{
+		std::weak_ptr<ArchiveEntry>   entry; // Expires if the entry is deleted without being announced
+		Archive*                      archive  = nullptr;
+		unsigned                      revision = 0;
+		std::unique_ptr<EntrySymbols> symbols;
+	};
+
+	struct Job
+	{
+		ArchiveEntry* entry    = nullptr;
+		unsigned      revision = 0;
+		Language      language = Language::None;
+		MemChunk      data;
+	};
+
+	std::mutex                                      mutex_;
+	std::condition_variable                         cv_;
+	std::thread                                     thread_;
+	vector<std::unique_ptr<Job>>                    queue_;
+	std::unordered_map<ArchiveEntry*, Record>       records_;
+	std::unordered_map<std::string, vector<Symbol>> definitions_; // Lower case name -> definitions
+	unsigned                                        revision_    = 0;
+	unsigned                                        in_progress_ = 0;
+	bool                                            stop_        = false;
+
+	void removeDefinitions(ArchiveEntry* entry, EntrySymbols& symbols);
+	void pruneRecords();
+	void workerThread();
+
+	static Language language(ArchiveEntry* entry);
+	static void     parse(Job& job, EntrySymbols& symbols);
+
+	static SymbolIndex* instance_;
+};
+
+// Define for less cumbersome SymbolIndex::getInstance()
+#define theSymbolIndex SymbolIndex::getInstance()
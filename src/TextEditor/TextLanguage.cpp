@@ -128,7 +128,7 @@ void TLFunction::addContext(
 	{
 		while (!tz.check(","))
 		{
-			arg_tokens.push_back(tz.current().text);
+			arg_tokens.push_back(tz.current().text());
 			if (tz.atEnd())
 				break;
 			tz.adv();
@@ -155,9 +155,9 @@ void TLFunction::addContext(
 				tz.adv();
 
 			bool is_replacement = true;
-			for (unsigned c = 0; c < tz.current().text.size(); c++)
+			for (unsigned c = 0; c < tz.current().text().size(); c++)
 			{
-				char chr = tz.current().text[c];
+				char chr = tz.current().text()[c];
 				if (isdigit(chr) || chr == '.')
 				{
 					is_replacement = false;
@@ -166,9 +166,9 @@ void TLFunction::addContext(
 			}
 
 			if (is_replacement)
-				ctx.deprecated_f = tz.current().text;
+				ctx.deprecated_f = tz.current().text();
 			else
-				ctx.deprecated_v = tz.current().text;
+				ctx.deprecated_v = tz.current().text();
 
 			if (tz.atEnd())
 				break;
@@ -121,17 +121,25 @@ void SCallTip::loadContext(unsigned long index)
 }
 
 // -----------------------------------------------------------------------------
-// Opens [function] in the call tip, with [arg] highlighted
+// Opens [function] in the call tip, with [arg] highlighted. If [context] is
+// given, the first of the function's contexts matching it is shown
 // -----------------------------------------------------------------------------
-void SCallTip::openFunction(TLFunction* function, int arg)
+void SCallTip::openFunction(TLFunction* function, int arg, const string& context)
 {
 	// Set current function
 	function_ = function;
 	if (!function)
 		return;
 
-	// Init with first arg set
+	// Init with first arg set, or the first one for [context] if there is one
 	context_current_ = 0;
+	if (!context.empty())
+		for (unsigned a = 0; a < function->contexts().size(); a++)
+			if (S_CMPNOCASE(function->contexts()[a].context, context))
+			{
+				context_current_ = a;
+				break;
+			}
 	arg_current_     = arg;
 	loadContext(context_current_);
 }
@@ -22,7 +22,7 @@ public:
 	void enableArgSwitch(bool enable) { switch_contexts_ = enable; }
 	void setFont(string face, int size);
 
-	void openFunction(TLFunction* function, int arg = -1);
+	void openFunction(TLFunction* function, int arg = -1, const string& context = "");
 	void nextArgSet();
 	void prevArgSet();
 
@@ -37,8 +37,9 @@
 #include "FindReplacePanel.h"
 #include "General/KeyBind.h"
 #include "Graphics/Icons.h"
+#include "MainEditor/MainEditor.h"
 #include "SCallTip.h"
-#include "Utility/Tokenizer.h"
+#include "TextEditor/SymbolIndex.h"
 
 
 // -----------------------------------------------------------------------------
@@ -70,86 +71,14 @@ CVAR(Int, txed_line_extra_height, 0, CVAR_SAVE)
 CVAR(Bool, txed_tab_spaces, false, CVAR_SAVE)
 CVAR(Int, txed_show_whitespace, 0, CVAR_SAVE)
 
-wxDEFINE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDEFINE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
-
-// -----------------------------------------------------------------------------
-//
-// JumpToCalculator Class Functions
-//
-// -----------------------------------------------------------------------------
-
-
-// -----------------------------------------------------------------------------
-// JumpToCalculator thread entry function
-// -----------------------------------------------------------------------------
-wxThread::ExitCode JumpToCalculator::Entry()
+namespace
 {
-	string jump_points;
-
-	Tokenizer tz;
-	tz.setSpecialCharacters(";,:|={}/()");
-	tz.openString(text_);
-
-	string token = tz.getToken();
-	while (!tz.atEnd())
-	{
-		if (token == "{")
-		{
-			// Skip block
-			while (!tz.atEnd() && token != "}")
-				token = tz.getToken();
-		}
-
-		for (unsigned a = 0; a < block_names_.size(); a++)
-		{
-			// Get jump block keyword
-			string block = block_names_[a];
-			long   skip  = 0;
-			if (block.Contains(":"))
-			{
-				wxArrayString sp = wxSplit(block, ':');
-				sp.back().ToLong(&skip);
-				block = sp[0];
-			}
-
-			if (S_CMPNOCASE(token, block))
-			{
-				string name = tz.getToken();
-				for (int s = 0; s < skip; s++)
-					name = tz.getToken();
-
-				for (unsigned i = 0; i < ignore_.size(); ++i)
-					if (S_CMPNOCASE(name, ignore_[i]))
-						name = tz.getToken();
-
-				// Numbered block, add block name
-				if (name.IsNumber())
-					name = S_FMT("%s %s", block, name);
-				// Unnamed block, use block name
-				if (name == "{" || name == ";")
-					name = block;
-
-				// Add jump point
-				jump_points += S_FMT("%d,%s,", tz.lineNo() - 1, CHR(name));
-			}
-		}
-
-		token = tz.getToken();
-	}
-
-	// Remove ending comma
-	if (!jump_points.empty())
-		jump_points.RemoveLast(1);
-
-	// Send event
-	wxThreadEvent* event = new wxThreadEvent(wxEVT_COMMAND_JTCALCULATOR_COMPLETED);
-	event->SetString(jump_points);
-	wxQueueEvent(handler_, event);
-
-	return nullptr;
-}
+// Maximum time (ms) to spend scanning the outline at once, the rest of a
+// large text is scanned on following update timer events
+const long OUTLINE_SCAN_TIME = 20;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -178,7 +107,7 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 	panel_fr_           = nullptr;
 	call_tip_           = new SCallTip(this);
 	choice_jump_to_     = nullptr;
-	jump_to_calculator_ = nullptr;
+	jump_to_revision_   = 0;
 	update_jump_to_     = false;
 	update_word_match_  = false;
 	last_modified_      = App::runTimer();
@@ -219,8 +148,8 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 	Bind(wxEVT_KILL_FOCUS, &TextEditorCtrl::onFocusLoss, this);
 	Bind(wxEVT_ACTIVATE, &TextEditorCtrl::onActivate, this);
 	Bind(wxEVT_STC_MARGINCLICK, &TextEditorCtrl::onMarginClick, this);
-	Bind(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, &TextEditorCtrl::onJumpToCalculateComplete, this);
 	Bind(wxEVT_STC_CHANGE, &TextEditorCtrl::onModified, this);
+	Bind(wxEVT_STC_MODIFIED, &TextEditorCtrl::onTextModified, this);
 	Bind(wxEVT_TIMER, &TextEditorCtrl::onUpdateTimer, this);
 	Bind(wxEVT_STC_STYLENEEDED, &TextEditorCtrl::onStyleNeeded, this);
 }
@@ -392,7 +321,8 @@ bool TextEditorCtrl::setLanguage(TextLanguage* lang)
 	// Re-colour text
 	Colourise(0, GetTextLength());
 
-	// Update Jump To list
+	// Update outline and Jump To list
+	outline_.setLanguage(lang, GetLineCount());
 	updateJumpToList();
 
 	return true;
@@ -864,8 +794,16 @@ bool TextEditorCtrl::openCalltip(int pos, int arg, bool dwell)
 	// Show calltip if it's a function
 	if (func && func->contexts().size() > 0)
 	{
+		// Use the block the function is in (eg. a ZScript class) as context
+		// (none if the outline is still being scanned)
+		string context;
+		outline_.update(this, OUTLINE_SCAN_TIME);
+		auto block = outline_.pending() ? nullptr : outline_.blockAt(LineFromPosition(pos));
+		if (block)
+			context = wxString::FromUTF8(block->name.data(), block->name.size());
+
 		call_tip_->enableArgSwitch(!dwell && func->contexts().size() > 1);
-		call_tip_->openFunction(func, arg);
+		call_tip_->openFunction(func, arg, context);
 		showCalltip(dwell ? pos : end + 1);
 
 		ct_function_ = func;
@@ -1000,20 +938,40 @@ void TextEditorCtrl::setJumpToControl(wxChoice* jump_to)
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::updateJumpToList()
 {
-	if (!choice_jump_to_)
+	if (!language_ || GetTextLength() == 0)
+	{
+		if (choice_jump_to_)
+			choice_jump_to_->Clear();
+		jump_to_lines_.clear();
+		jump_to_revision_ = outline_.revision() - 1;
 		return;
+	}
 
-	if (!language_ || jump_to_calculator_ || GetText().length() == 0)
+	// Update outline. Only a limited amount is scanned at once, so opening a
+	// large text doesn't block the editor, continue shortly if not finished
+	outline_.update(this, OUTLINE_SCAN_TIME);
+	if (outline_.pending())
 	{
-		choice_jump_to_->Clear();
+		update_jump_to_ = true;
+		timer_update_.Start(10, true);
 		return;
 	}
 
-	// Begin jump to calculation thread
-	choice_jump_to_->Enable(false);
-	jump_to_calculator_ =
-		new JumpToCalculator(this, GetText(), language_->jumpBlocks(), language_->jumpBlocksIgnored());
-	jump_to_calculator_->Run();
+	// Nothing to do if it hasn't changed since the list was last built
+	if (!choice_jump_to_ || jump_to_revision_ == outline_.revision())
+		return;
+
+	wxArrayString items;
+	jump_to_lines_.clear();
+	for (auto& entry : outline_.entries())
+	{
+		items.push_back(wxString::FromUTF8(entry.name.data(), entry.name.size()));
+		jump_to_lines_.push_back(entry.line);
+	}
+
+	choice_jump_to_->Clear();
+	choice_jump_to_->Append(items);
+	jump_to_revision_ = outline_.revision();
 }
 
 // -----------------------------------------------------------------------------
@@ -1035,14 +993,95 @@ void TextEditorCtrl::jumpToLine()
 		this);
 
 	if (line >= 1)
+		jumpToLine(line);
+}
+
+// -----------------------------------------------------------------------------
+// Moves the cursor to the end of [line] (starting from 1)
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::jumpToLine(int line)
+{
+	int pos = GetLineEndPosition(line - 1);
+	SetCurrentPos(pos);
+	SetSelection(pos, pos);
+	EnsureCaretVisible();
+	SetFocus();
+}
+
+// -----------------------------------------------------------------------------
+// Goes to the definition of the symbol at the cursor, from the symbol index.
+// If there is more than one definition, the user is prompted to select one
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::goToDefinition()
+{
+	int    pos  = GetCurrentPos();
+	string word = GetTextRange(WordStartPosition(pos, true), WordEndPosition(pos, true));
+	if (word.empty())
+		return;
+
+	auto defs = theSymbolIndex->definitions(word, MainEditor::currentArchive());
+	if (defs.empty())
 	{
-		// Move to line
-		int pos = GetLineEndPosition(line - 1);
-		SetCurrentPos(pos);
-		SetSelection(pos, pos);
-		EnsureCaretVisible();
-		SetFocus();
+		wxMessageBox(
+			theSymbolIndex->busy() ? S_FMT("No definition of \"%s\" found (still indexing)", word) :
+									 S_FMT("No definition of \"%s\" found", word),
+			"Go to Definition");
+		return;
+	}
+
+	// Select definition if there are multiple
+	unsigned index = 0;
+	if (defs.size() > 1)
+	{
+		wxArrayString choices;
+		for (auto& def : defs)
+			choices.Add(S_FMT(
+				"%s %s - %s/%s (line %u)",
+				SymbolIndex::kindName(def.kind),
+				def.parent.empty() ? def.name : def.parent + "." + def.name,
+				def.location.entry->getParent()->filename(false),
+				def.location.entry->getPath(true),
+				def.location.line));
+
+		int choice = wxGetSingleChoiceIndex("Select definition", "Go to Definition", choices, 0, this);
+		if (choice < 0)
+			return;
+		index = choice;
 	}
+
+	MainEditor::goToEntry(defs[index].location.entry, defs[index].location.line);
+}
+
+// -----------------------------------------------------------------------------
+// Lists all lines in indexed scripts that use the word at the cursor, and
+// goes to the one the user selects
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::findUsages()
+{
+	int    pos  = GetCurrentPos();
+	string word = GetTextRange(WordStartPosition(pos, true), WordEndPosition(pos, true));
+	if (word.empty())
+		return;
+
+	auto usages = theSymbolIndex->usages(word, MainEditor::currentArchive());
+	if (usages.empty())
+	{
+		wxMessageBox(S_FMT("No usages of \"%s\" found", word), "Find Usages");
+		return;
+	}
+
+	wxArrayString choices;
+	for (auto& usage : usages)
+		choices.Add(S_FMT(
+			"%s/%s (line %u)",
+			usage.entry->getParent()->filename(false),
+			usage.entry->getPath(true),
+			usage.line));
+
+	int choice = wxGetSingleChoiceIndex(
+		S_FMT("%d usages of \"%s\"", (int)usages.size(), word), "Find Usages", choices, 0, this);
+	if (choice >= 0)
+		MainEditor::goToEntry(usages[choice].entry, usages[choice].line);
 }
 
 // -----------------------------------------------------------------------------
@@ -1333,6 +1372,20 @@ void TextEditorCtrl::onKeyDown(wxKeyEvent& e)
 			handled = true;
 		}
 
+		// Go to definition
+		else if (name == "ted_goto_definition")
+		{
+			goToDefinition();
+			handled = true;
+		}
+
+		// Find usages
+		else if (name == "ted_find_usages")
+		{
+			findUsages();
+			handled = true;
+		}
+
 		// Comments
 		else if (name == "ted_line_comment")
 		{
@@ -1719,44 +1772,6 @@ void TextEditorCtrl::onMarginClick(wxStyledTextEvent& e)
 	}
 }
 
-// -----------------------------------------------------------------------------
-// Called when the 'Jump To' calculation thread completes
-// -----------------------------------------------------------------------------
-void TextEditorCtrl::onJumpToCalculateComplete(wxThreadEvent& e)
-{
-	if (!choice_jump_to_)
-	{
-		jump_to_calculator_ = nullptr;
-		return;
-	}
-
-	choice_jump_to_->Clear();
-	jump_to_lines_.clear();
-
-	string        jump_points = e.GetString();
-	wxArrayString split       = wxSplit(jump_points, ',');
-
-	wxArrayString items;
-	for (unsigned a = 0; a < split.size(); a += 2)
-	{
-		if (a == split.size() - 1)
-			break;
-
-		long line;
-		if (!split[a].ToLong(&line))
-			line = 0;
-		string name = split[a + 1];
-
-		items.push_back(name);
-		jump_to_lines_.push_back(line);
-	}
-
-	choice_jump_to_->Append(items);
-	choice_jump_to_->Enable(true);
-
-	jump_to_calculator_ = nullptr;
-}
-
 // -----------------------------------------------------------------------------
 // Called when the 'Jump To' dropdown is changed
 // -----------------------------------------------------------------------------
@@ -1782,7 +1797,7 @@ void TextEditorCtrl::onModified(wxStyledTextEvent& e)
 	{
 		last_modified_  = App::runTimer();
 		update_jump_to_ = true;
-		timer_update_.Start(1000, true);
+		timer_update_.Start(250, true);
 
 		// Send change event
 		wxCommandEvent event(wxEVT_TEXT_CHANGED);
@@ -1792,18 +1807,34 @@ void TextEditorCtrl::onModified(wxStyledTextEvent& e)
 	e.Skip();
 }
 
+// -----------------------------------------------------------------------------
+// Called when text is inserted or deleted (or anything else is modified)
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::onTextModified(wxStyledTextEvent& e)
+{
+	// Mark modified lines in the outline
+	if (e.GetModificationType() & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))
+		outline_.linesChanged(LineFromPosition(e.GetPosition()), e.GetLinesAdded());
+
+	e.Skip();
+}
+
 // -----------------------------------------------------------------------------
 // Called when the update timer finishes
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::onUpdateTimer(wxTimerEvent& e)
 {
+	// (Flags are cleared first, updating the jump to list can set it again)
 	if (update_jump_to_)
+	{
+		update_jump_to_ = false;
 		updateJumpToList();
+	}
 	if (update_word_match_)
+	{
+		update_word_match_ = false;
 		matchWord();
-
-	update_jump_to_    = false;
-	update_word_match_ = false;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -1833,7 +1864,7 @@ void TextEditorCtrl::onStyleNeeded(wxStyledTextEvent& e)
 	if (txed_fold_enable)
 	{
 		auto modified = last_modified_;
-		lexer_->updateFolding(this, line_start);
+		lexer_->updateFolding(this, line_start, l - 1);
 		last_modified_ = modified;
 	}
 }
@@ -2,6 +2,7 @@
 
 #include "Archive/ArchiveEntry.h"
 #include "TextEditor/Lexer.h"
+#include "TextEditor/OutlineIndex.h"
 #include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
 
@@ -12,30 +13,8 @@ class FindReplacePanel;
 class SCallTip;
 class wxChoice;
 
-wxDECLARE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDECLARE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
-class JumpToCalculator : public wxThread
-{
-public:
-	JumpToCalculator(wxEvtHandler* handler, string text, vector<string> block_names, vector<string> ignore) :
-		handler_(handler),
-		text_(text),
-		block_names_(block_names),
-		ignore_(ignore)
-	{
-	}
-	virtual ~JumpToCalculator() {}
-
-	ExitCode Entry();
-
-private:
-	wxEvtHandler*  handler_;
-	string         text_;
-	vector<string> block_names_;
-	vector<string> ignore_;
-};
-
 class TextEditorCtrl : public wxStyledTextCtrl
 {
 public:
@@ -79,6 +58,11 @@ public:
 	void setJumpToControl(wxChoice* jump_to);
 	void updateJumpToList();
 	void jumpToLine();
+	void jumpToLine(int line);
+
+	// Symbols
+	void goToDefinition();
+	void findUsages();
 
 	// Folding
 	void foldAll(bool fold = true);
@@ -94,7 +78,8 @@ private:
 	FindReplacePanel*      panel_fr_;
 	SCallTip*              call_tip_;
 	wxChoice*              choice_jump_to_;
-	JumpToCalculator*      jump_to_calculator_;
+	OutlineIndex           outline_;
+	unsigned               jump_to_revision_;
 	std::unique_ptr<Lexer> lexer_;
 	string                 prev_word_match_;
 	string                 autocomp_list_;
@@ -134,9 +119,9 @@ private:
 	void onFocusLoss(wxFocusEvent& e);
 	void onActivate(wxActivateEvent& e);
 	void onMarginClick(wxStyledTextEvent& e);
-	void onJumpToCalculateComplete(wxThreadEvent& e);
 	void onJumpToChoiceSelected(wxCommandEvent& e);
 	void onModified(wxStyledTextEvent& e);
+	void onTextModified(wxStyledTextEvent& e);
 	void onUpdateTimer(wxTimerEvent& e);
 	void onStyleNeeded(wxStyledTextEvent& e);
 };
@@ -32,6 +32,7 @@
 //
 // ----------------------------------------------------------------------------
 #include "Main.h"
+#include "App.h"
 #include "BrowserCanvas.h"
 #include "OpenGL/Drawing.h"
 #include "General/UI.h"
@@ -44,6 +45,7 @@
 // ----------------------------------------------------------------------------
 CVAR(Int, browser_bg_type, false, CVAR_SAVE)
 CVAR(Int, browser_item_size, 96, CVAR_SAVE)
+CVAR(Int, browser_thumbnail_budget, 10, CVAR_SAVE)
 DEFINE_EVENT_TYPE(wxEVT_BROWSERCANVAS_SELECTION_CHANGED)
 
 
@@ -76,6 +78,9 @@ BrowserCanvas::BrowserCanvas(wxWindow* parent) :
 	Bind(wxEVT_MOUSEWHEEL, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_LEFT_DOWN, &BrowserCanvas::onMouseEvent, this);
 	Bind(wxEVT_KEY_DOWN, &BrowserCanvas::onKeyDown, this);
+
+	// Redraw periodically while thumbnails are loading
+	timer_thumbnails_.Bind(wxEVT_TIMER, [&](wxTimerEvent&) { Refresh(); });
 }
 
 // ----------------------------------------------------------------------------
@@ -119,6 +124,11 @@ void BrowserCanvas::addItem(BrowserItem* item)
 // ----------------------------------------------------------------------------
 void BrowserCanvas::clearItems()
 {
+	// Discard any pending thumbnails (the items may already have been deleted),
+	// they will be requested again if the items are shown
+	thumbnails_.clear();
+	thumb_pending_.clear();
+
 	items_.clear();
 }
 
@@ -216,6 +226,9 @@ void BrowserCanvas::draw()
 	if (browser_bg_type == 0)
 		drawCheckeredBackground();
 
+	// Load thumbnails for visible items
+	updateThumbnails();
+
 	// Init for texture drawing
 	glEnable(GL_TEXTURE_2D);
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
@@ -593,6 +606,114 @@ bool BrowserCanvas::searchItemFrom(int from)
 	return false;
 }
 
+// ----------------------------------------------------------------------------
+// BrowserCanvas::updateThumbnails
+//
+// Applies any thumbnails finished by the thumbnail loader and queues
+// thumbnail requests for visible items that don't have one yet. Work done on
+// the main thread (resolving item sources) is limited to
+// [browser_thumbnail_budget] ms per frame, anything left over is done in
+// later frames
+// ----------------------------------------------------------------------------
+void BrowserCanvas::updateThumbnails()
+{
+	if (num_cols_ <= 0)
+		return;
+
+	int  size  = item_size_ > 0 ? item_size_ : (int)browser_item_size;
+	long start = App::runTimer();
+	bool more  = false;
+
+	// Apply finished thumbnails
+	while (App::runTimer() - start < browser_thumbnail_budget)
+	{
+		auto result = thumbnails_.nextResult();
+		if (!result)
+			break;
+
+		// Ignore if the item's thumbnail has been requested again since
+		auto item    = result->item;
+		auto pending = thumb_pending_.find(item);
+		if (pending == thumb_pending_.end() || pending->second != result->item_request)
+			continue;
+		if (item->thumbnailRequest() != result->item_request)
+		{
+			thumb_pending_.erase(pending);
+			continue;
+		}
+
+		if (!result->missing)
+		{
+			thumb_pending_.erase(pending);
+			item->setThumbnail(result->thumbnail, result->width, result->height);
+			continue;
+		}
+
+		// Not cached and the item has no data the loader can decode, so get
+		// the image from the item and send it back to be scaled down
+		auto request          = std::make_unique<ThumbnailLoader::Request>();
+		request->item         = item;
+		request->item_request = result->item_request;
+		request->key          = result->key;
+		request->size         = size;
+		if (item->thumbnailImage(request->image, request->palette))
+			thumbnails_.request(std::move(request));
+		else
+		{
+			thumb_pending_.erase(pending);
+			item->setThumbnailState(BrowserItem::ThumbnailState::Failed);
+		}
+	}
+
+	// Request thumbnails for visible items (and a row either side), the loader
+	// processes the most recent requests first so go from the bottom up
+	int row_height = fullItemSizeY();
+	int first      = max(0, yoff_ / row_height - 1) * num_cols_;
+	int last       = min((int)items_filter_.size(), ((yoff_ + GetSize().y) / row_height + 2) * num_cols_);
+	for (int a = last - 1; a >= first; --a)
+	{
+		// Check if the item needs a (new) thumbnail
+		auto item = items_[items_filter_[a]];
+		switch (item->thumbnailState())
+		{
+		case BrowserItem::ThumbnailState::None: break;
+		case BrowserItem::ThumbnailState::Ready:
+			if (item->thumbnailSize() >= size)
+				continue;
+			break;
+		case BrowserItem::ThumbnailState::Queued:
+		{
+			// Request discarded by clearItems
+			auto pending = thumb_pending_.find(item);
+			if (pending != thumb_pending_.end() && pending->second == item->thumbnailRequest())
+				continue;
+			break;
+		}
+		default: continue;
+		}
+
+		if (App::runTimer() - start >= browser_thumbnail_budget)
+		{
+			more = true;
+			break;
+		}
+
+		auto request  = std::make_unique<ThumbnailLoader::Request>();
+		request->size = size;
+		if (!item->prepareThumbnail(*request))
+			continue;
+
+		if (request->key)
+			request->key = ThumbnailLoader::cacheKey(request->key, request->palette, size);
+		thumb_pending_[item] = request->item_request;
+		thumbnails_.request(std::move(request));
+	}
+
+	// Keep redrawing until everything is loaded
+	if (more || !thumb_pending_.empty())
+		timer_thumbnails_.StartOnce(30);
+}
+
 int BrowserCanvas::longestItemTextWidth()
 {
 	return 144;
@@ -45,6 +45,7 @@ public:
 	void                  setItemSize(int size) { this->item_size_ = size; }
 	void                  setItemViewType(int type) { this->item_type_ = type; }
 	int                   longestItemTextWidth();
+	void                  updateThumbnails();
 
 	// Events
 	void onSize(wxSizeEvent& e);
@@ -64,6 +65,11 @@ private:
 	string               search_;
 	BrowserItem*         item_selected_ = nullptr;
 
+	// Thumbnails
+	ThumbnailLoader                   thumbnails_;
+	std::map<BrowserItem*, unsigned>  thumb_pending_;
+	wxTimer                           timer_thumbnails_;
+
 	// Display
 	int           yoff_        = 0;
 	int           item_border_ = 0;
@@ -67,6 +67,8 @@ BrowserItem::~BrowserItem()
 {
 	if (text_box_)
 		delete text_box_;
+	if (thumbnail_)
+		delete thumbnail_;
 }
 
 // ----------------------------------------------------------------------------
@@ -127,12 +129,38 @@ void BrowserItem::draw(int size, int x, int y, Drawing::Font font, int nametype,
 	if (blank_)
 		return;
 
-	// Try to load image if it isn't already
-	if (!image_ || (image_ && !image_->isLoaded()))
-		loadImage();
+	// Get image to draw and its full size
+	GLTexture* texture = nullptr;
+	double     width   = 0;
+	double     height  = 0;
+	if (thumbnail_ && (thumb_state_ == ThumbnailState::Ready || thumb_state_ == ThumbnailState::Queued))
+	{
+		// Use thumbnail (keep showing the current one while a larger one loads)
+		texture = thumbnail_;
+		width   = image_width_;
+		height  = image_height_;
+	}
+	else if (thumb_state_ == ThumbnailState::None || thumb_state_ == ThumbnailState::Queued)
+	{
+		// Thumbnail is still loading
+		return;
+	}
+	else
+	{
+		// Try to load image if it isn't already
+		if (!image_ || (image_ && !image_->isLoaded()))
+			loadImage();
+
+		if (image_ && image_->isLoaded())
+		{
+			texture = image_;
+			width   = image_->getWidth();
+			height  = image_->getHeight();
+		}
+	}
 
 	// If it still isn't just draw a red box with an X
-	if (!image_ || (image_ && !image_->isLoaded()))
+	if (!texture)
 	{
 		glPushAttrib(GL_ENABLE_BIT|GL_CURRENT_BIT);
 
@@ -160,10 +188,6 @@ void BrowserItem::draw(int size, int x, int y, Drawing::Font font, int nametype,
 		return;
 	}
 
-	// Determine texture dimensions
-	double width = image_->getWidth();
-	double height = image_->getHeight();
-
 	// Scale up if size > 128
 	if (size > 128)
 	{
@@ -198,7 +222,7 @@ void BrowserItem::draw(int size, int x, int y, Drawing::Font font, int nametype,
 	double left = x + ((double)size * 0.5) - (width * 0.5);
 
 	// Draw
-	image_->bind();
+	texture->bind();
 	OpenGL::setColour(COL_WHITE, false);
 
 	glBegin(GL_QUADS);
@@ -217,4 +241,56 @@ void BrowserItem::draw(int size, int x, int y, Drawing::Font font, int nametype,
 void BrowserItem::clearImage()
 {
 	if (image_) image_->clear();
+
+	// Clear thumbnail, any pending request for it will be ignored
+	if (thumbnail_)
+	{
+		delete thumbnail_;
+		thumbnail_ = nullptr;
+	}
+	thumb_state_ = ThumbnailState::None;
+	thumb_request_++;
+}
+
+// ----------------------------------------------------------------------------
+// BrowserItem::prepareThumbnail
+//
+// Sets up [request] to load the item's thumbnail, [request]'s size should
+// already be set. Returns false if the item doesn't support thumbnails
+// ----------------------------------------------------------------------------
+bool BrowserItem::prepareThumbnail(ThumbnailLoader::Request& request)
+{
+	request.item         = this;
+	request.item_request = ++thumb_request_;
+	thumb_size_          = request.size;
+
+	if (!thumbnailSource(request))
+	{
+		thumb_state_ = ThumbnailState::Unsupported;
+		return false;
+	}
+
+	thumb_state_ = ThumbnailState::Queued;
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// BrowserItem::setThumbnail
+//
+// Sets the item's thumbnail to [thumbnail], for an image of [width]x[height]
+// ----------------------------------------------------------------------------
+void BrowserItem::setThumbnail(SImage& thumbnail, int width, int height)
+{
+	if (!thumbnail_)
+		thumbnail_ = new GLTexture(false);
+
+	if (!thumbnail_->loadImage(&thumbnail))
+	{
+		thumb_state_ = ThumbnailState::Failed;
+		return;
+	}
+
+	image_width_  = width;
+	image_height_ = height;
+	thumb_state_  = ThumbnailState::Ready;
 }
@@ -2,6 +2,7 @@
 
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
+#include "ThumbnailLoader.h"
 
 class BrowserWindow;
 class TextBox;
@@ -10,6 +11,15 @@ class BrowserItem
 	friend class BrowserWindow;
 
 public:
+	enum class ThumbnailState
+	{
+		None,        // Not requested yet
+		Queued,      // Waiting for the thumbnail loader
+		Ready,       // Thumbnail loaded
+		Unsupported, // Item doesn't support thumbnails, its image is loaded directly
+		Failed,      // Couldn't create a thumbnail, its image is loaded directly
+	};
+
 	BrowserItem(string name, unsigned index = 0, string type = "item");
 	virtual ~BrowserItem();
 
@@ -29,6 +39,16 @@ public:
 	void           clearImage();
 	virtual string itemInfo() { return ""; }
 
+	// Thumbnails
+	ThumbnailState thumbnailState() const { return thumb_state_; }
+	void           setThumbnailState(ThumbnailState state) { thumb_state_ = state; }
+	bool           prepareThumbnail(ThumbnailLoader::Request& request);
+	void           setThumbnail(SImage& thumbnail, int width, int height);
+	unsigned       thumbnailRequest() const { return thumb_request_; }
+	int            thumbnailSize() const { return thumb_size_; }
+	virtual bool   thumbnailSource(ThumbnailLoader::Request& request) { return false; }
+	virtual bool   thumbnailImage(SImage& image, Palette& palette) { return false; }
+
 protected:
 	string         type_;
 	string         name_;
@@ -37,4 +57,12 @@ protected:
 	BrowserWindow* parent_   = nullptr;
 	bool           blank_    = false;
 	TextBox*       text_box_ = nullptr;
+
+	// Thumbnail
+	GLTexture*     thumbnail_     = nullptr;
+	ThumbnailState thumb_state_   = ThumbnailState::None;
+	unsigned       thumb_request_ = 0;
+	int            thumb_size_    = 0;
+	int            image_width_   = 0;
+	int            image_height_  = 0;
 };
@@ -0,0 +1,406 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ThumbnailLoader.cpp
+// Description: ThumbnailLoader class - decodes and scales down browser item
+//              images on worker threads, and keeps the resulting thumbnails
+//              in an on-disk cache keyed by a hash of the source content
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ThumbnailLoader.h"
+#include "General/Misc.h"
+#include "Utility/Parallel.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, browser_thumbnail_cache, true, CVAR_SAVE)
+CVAR(Int, browser_thumbnail_cache_size, 64, CVAR_SAVE) // In MB
+namespace
+{
+const uint32_t THUMBNAIL_CACHE_MAGIC   = 0x54484D42; // THMB
+const uint32_t THUMBNAIL_CACHE_VERSION = 1;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the path to the cache file for thumbnail [key]
+// -----------------------------------------------------------------------------
+string cacheFile(uint64_t key)
+{
+	return Misc::cachePath(S_FMT("thumbnails/%08x%08x.dat", (unsigned)(key >> 32), (unsigned)key));
+}
+
+// -----------------------------------------------------------------------------
+// Scales [image] down to fit within [size]x[size] pixels, writing the result
+// to [thumbnail] as RGBA. Each thumbnail pixel is the alpha-weighted average of
+// the source pixels it covers
+// -----------------------------------------------------------------------------
+void makeThumbnail(SImage& image, Palette* pal, int size, SImage& thumbnail)
+{
+	MemChunk rgba;
+	image.getRGBAData(rgba, pal);
+
+	int    width  = image.getWidth();
+	int    height = image.getHeight();
+	double scale  = std::min(1.0, (double)size / std::max(width, height));
+	int    tw     = std::max(1, (int)(width * scale + 0.5));
+	int    th     = std::max(1, (int)(height * scale + 0.5));
+
+	auto src  = rgba.getData();
+	auto data = new uint8_t[tw * th * 4];
+	for (int ty = 0; ty < th; ++ty)
+	{
+		int y1 = ty * height / th;
+		int y2 = std::max(y1 + 1, (ty + 1) * height / th);
+		for (int tx = 0; tx < tw; ++tx)
+		{
+			int x1 = tx * width / tw;
+			int x2 = std::max(x1 + 1, (tx + 1) * width / tw);
+
+			uint64_t r = 0, g = 0, b = 0, a = 0;
+			for (int y = y1; y < y2; ++y)
+			{
+				auto p = src + (y * width + x1) * 4;
+				for (int x = x1; x < x2; ++x, p += 4)
+				{
+					r += p[0] * p[3];
+					g += p[1] * p[3];
+					b += p[2] * p[3];
+					a += p[3];
+				}
+			}
+
+			auto out = data + (ty * tw + tx) * 4;
+			if (a > 0)
+			{
+				out[0] = r / a;
+				out[1] = g / a;
+				out[2] = b / a;
+			}
+			else
+				out[0] = out[1] = out[2] = 0;
+			out[3] = a / ((x2 - x1) * (y2 - y1));
+		}
+	}
+
+	thumbnail.setImageData(data, tw, th, RGBA);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ThumbnailLoader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ThumbnailLoader class constructor
+// -----------------------------------------------------------------------------
+ThumbnailLoader::ThumbnailLoader()
+{
+	// Create cache directory
+	auto dir = Misc::cachePath("thumbnails");
+	if (!wxDirExists(dir))
+		wxMkdir(dir);
+
+	// Start worker threads, leaving one core for the UI
+	auto num_threads = std::max<unsigned>(1, Parallel::numThreads() - 1);
+	for (unsigned a = 0; a < num_threads; ++a)
+		threads_.emplace_back(&ThumbnailLoader::workerThread, this);
+}
+
+// -----------------------------------------------------------------------------
+// ThumbnailLoader class destructor
+// -----------------------------------------------------------------------------
+ThumbnailLoader::~ThumbnailLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+
+	for (auto& thread : threads_)
+		thread.join();
+}
+
+// -----------------------------------------------------------------------------
+// Queues [request] to be processed by a worker thread. The most recently
+// queued requests are processed first, so items currently in view are loaded
+// before any that have been scrolled past
+// -----------------------------------------------------------------------------
+void ThumbnailLoader::request(std::unique_ptr<Request> request)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		queue_.push_back(std::move(request));
+	}
+	cv_.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the next finished result, or nullptr if there are none waiting
+// -----------------------------------------------------------------------------
+std::unique_ptr<ThumbnailLoader::Result> ThumbnailLoader::nextResult()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (results_.empty())
+		return nullptr;
+
+	auto result = std::move(results_.front());
+	results_.erase(results_.begin());
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Discards all queued requests and waiting results. Requests currently being
+// processed will finish but their results are discarded
+// -----------------------------------------------------------------------------
+void ThumbnailLoader::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	queue_.clear();
+	results_.clear();
+	generation_++;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if there are any requests queued or being processed
+// -----------------------------------------------------------------------------
+bool ThumbnailLoader::busy()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return !queue_.empty() || in_progress_ > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the disk cache key for a thumbnail of [size] from a source image
+// with content hash [source_key], drawn with [palette]
+// -----------------------------------------------------------------------------
+uint64_t ThumbnailLoader::cacheKey(uint64_t source_key, Palette& palette, int size)
+{
+	uint8_t colours[256 * 4 + 12];
+	for (unsigned a = 0; a < 256; a++)
+		palette.colour(a).write(colours + a * 4);
+	memcpy(colours + 1024, &source_key, 8);
+	memcpy(colours + 1032, &size, 4);
+
+	return Misc::hash64(colours, sizeof(colours));
+}
+
+// -----------------------------------------------------------------------------
+// Deletes the least recently used thumbnails from the disk cache until it is
+// no larger than browser_thumbnail_cache_size MB
+// -----------------------------------------------------------------------------
+void ThumbnailLoader::pruneCache()
+{
+	auto dir = Misc::cachePath("thumbnails");
+	if (!wxDirExists(dir))
+		return;
+
+	struct CacheFile
+	{
+		string   path;
+		time_t   time;
+		uint64_t size;
+	};
+
+	// Get all cache files, oldest first
+	wxArrayString     paths;
+	vector<CacheFile> files;
+	uint64_t          total = 0;
+	wxDir::GetAllFiles(dir, &paths, "*.dat", wxDIR_FILES);
+	for (auto& path : paths)
+	{
+		auto size = wxFileName::GetSize(path);
+		if (size == wxInvalidSize)
+			continue;
+
+		files.push_back({ path, wxFileModificationTime(path), size.GetValue() });
+		total += files.back().size;
+	}
+	std::sort(files.begin(), files.end(), [](const CacheFile& left, const CacheFile& right) {
+		return left.time < right.time;
+	});
+
+	uint64_t limit   = (uint64_t)std::max(0, (int)browser_thumbnail_cache_size) * 1024 * 1024;
+	unsigned removed = 0;
+	for (auto& file : files)
+	{
+		if (total <= limit)
+			break;
+
+		if (wxRemoveFile(file.path))
+		{
+			total -= file.size;
+			removed++;
+		}
+	}
+
+	if (removed > 0)
+		Log::info(2, S_FMT("Removed %u old thumbnails from the cache", removed));
+}
+
+// -----------------------------------------------------------------------------
+// Worker thread loop, processes queued requests until the loader is destroyed
+// -----------------------------------------------------------------------------
+void ThumbnailLoader::workerThread()
+{
+	while (true)
+	{
+		std::unique_ptr<Request> request;
+		unsigned                 generation;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+			if (stop_)
+				return;
+
+			request = std::move(queue_.back());
+			queue_.pop_back();
+			generation = generation_;
+			in_progress_++;
+		}
+
+		auto result = std::make_unique<Result>();
+		process(*request, *result);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		in_progress_--;
+		if (generation == generation_)
+			results_.push_back(std::move(result));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Loads the thumbnail for [request] into [result], from the disk cache if
+// possible, otherwise by decoding and scaling down the source image
+// -----------------------------------------------------------------------------
+void ThumbnailLoader::process(Request& request, Result& result)
+{
+	result.item         = request.item;
+	result.item_request = request.item_request;
+	result.key          = request.key;
+
+	// Check the disk cache first
+	if (request.key && browser_thumbnail_cache && readCached(request.key, result))
+		return;
+
+	// Decode source image if needed
+	if (!request.image.isValid() && request.data.hasData())
+		request.image.open(request.data, 0, request.format_hint);
+
+	// If there's no image the item will have to load it
+	if (!request.image.isValid())
+	{
+		result.missing = true;
+		return;
+	}
+
+	// Create thumbnail
+	result.width  = request.image.getWidth();
+	result.height = request.image.getHeight();
+	makeThumbnail(request.image, &request.palette, request.size, result.thumbnail);
+
+	// Add to disk cache
+	if (request.key && browser_thumbnail_cache)
+		writeCached(request.key, result);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the cached thumbnail for [key] into [result].
+// Returns false if it isn't cached
+// -----------------------------------------------------------------------------
+bool ThumbnailLoader::readCached(uint64_t key, Result& result)
+{
+	auto     path = cacheFile(key);
+	MemChunk mc;
+	if (!Misc::readCacheFile(path, THUMBNAIL_CACHE_MAGIC, THUMBNAIL_CACHE_VERSION, mc))
+		return false;
+
+	wxMemoryInputStream stream(mc.getData(), mc.getSize());
+	wxDataInputStream   in(stream);
+
+	int width  = in.Read32();
+	int height = in.Read32();
+	int tw     = in.Read32();
+	int th     = in.Read32();
+	if (!in.IsOk() || tw <= 0 || th <= 0 || mc.getSize() != 16 + (unsigned)(tw * th * 4))
+		return false;
+
+	auto data = new uint8_t[tw * th * 4];
+	memcpy(data, mc.getData() + 16, tw * th * 4);
+	result.thumbnail.setImageData(data, tw, th, RGBA);
+	result.width  = width;
+	result.height = height;
+
+	// Mark as recently used, so it's kept when the cache is pruned
+	wxFileName(path).Touch();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the thumbnail in [result] to the disk cache as [key]
+// -----------------------------------------------------------------------------
+void ThumbnailLoader::writeCached(uint64_t key, Result& result)
+{
+	// Don't write the same file from two threads at once
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!writing_.insert(key).second)
+			return;
+	}
+
+	MemChunk             rgba;
+	wxMemoryOutputStream stream;
+	wxDataOutputStream   out(stream);
+	result.thumbnail.getRGBAData(rgba);
+	out.Write32(result.width);
+	out.Write32(result.height);
+	out.Write32(result.thumbnail.getWidth());
+	out.Write32(result.thumbnail.getHeight());
+	stream.Write(rgba.getData(), rgba.getSize());
+
+	Misc::writeCacheFile(cacheFile(key), THUMBNAIL_CACHE_MAGIC, THUMBNAIL_CACHE_VERSION, stream);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	writing_.erase(key);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Graphics/SImage/SImage.h"
+#include <condition_variable>
+#include <thread>
+
+class BrowserItem;
+
+class ThumbnailLoader
+{
+public:
+	struct Request
+	{
+		BrowserItem* item         = nullptr;
+		unsigned     item_request = 0;
+		uint64_t     key          = 0; // Hash of the source image content (0 = don't cache)
+		int          size         = 0;
+		MemChunk     data;             // Encoded source image, decoded on a worker thread
+		string       format_hint;
+		SImage       image; // Already decoded source image, used if [data] is empty
+		Palette      palette;
+	};
+
+	struct Result
+	{
+		BrowserItem* item         = nullptr;
+		unsigned     item_request = 0;
+		uint64_t     key          = 0;
+		SImage       thumbnail;
+		int          width   = 0; // Size of the source image
+		int          height  = 0;
+		bool         missing = false; // Not cached and no source data, the item must supply a decoded image
+	};
+
+	ThumbnailLoader();
+	~ThumbnailLoader();
+
+	void                    request(std::unique_ptr<Request> request);
+	std::unique_ptr<Result> nextResult();
+	void                    clear();
+	bool                    busy();
+
+	static uint64_t cacheKey(uint64_t source_key, Palette& palette, int size);
+	static void     pruneCache();
+
+private:
+	std::mutex                       mutex_;
+	std::condition_variable          cv_;
+	vector<std::unique_ptr<Request>> queue_;
+	vector<std::unique_ptr<Result>>  results_;
+	vector<std::thread>              threads_;
+	std::set<uint64_t>               writing_;
+	unsigned                         generation_  = 0;
+	unsigned                         in_progress_ = 0;
+	bool                             stop_        = false;
+
+	void workerThread();
+	void process(Request& request, Result& result);
+	bool readCached(uint64_t key, Result& result);
+	void writeCached(uint64_t key, Result& result);
+};
@@ -145,8 +145,8 @@ void ConsolePanel::update()
 	setupTextArea();
 
 	// Check if any new log messages were added since the last update
-	auto& log = Log::history();
-	if (log.size() <= next_message_index_)
+	auto log = Log::history(next_message_index_);
+	if (log.empty())
 	{
 		// None added, check again in 500ms
 		timer_update_.Start(500);
@@ -155,19 +155,20 @@ void ConsolePanel::update()
 
 	// Add new log messages to log text area
 	text_log_->SetEditable(true);
-	for (auto a = next_message_index_; a < log.size(); ++a)
+	for (auto& msg : log)
 	{
+		auto a = next_message_index_++;
 		if (a > 0)
 			text_log_->AppendText("\n");
 
 		// Add message line + timestamp margin
-		text_log_->AppendText(log[a].message);
-		text_log_->MarginSetText(a, wxDateTime(log[a].timestamp).FormatISOTime());
+		text_log_->AppendText(msg.message);
+		text_log_->MarginSetText(a, wxDateTime(msg.timestamp).FormatISOTime());
 		text_log_->MarginSetStyle(a, wxSTC_STYLE_LINENUMBER);
 
 		// Set line colour depending on message type
 		text_log_->StartStyling(text_log_->GetLineEndPosition(a) - text_log_->GetLineLength(a), 0);
-		switch (log[a].type)
+		switch (msg.type)
 		{
 		case Log::MessageType::Error:
 			text_log_->SetStyling(text_log_->GetLineLength(a), 200); break;
@@ -182,7 +183,6 @@ void ConsolePanel::update()
 	}
 	text_log_->SetEditable(false);
 
-	next_message_index_ = Log::history().size();
 	text_log_->ScrollToEnd();
 
 	// Check again in 100ms
@@ -0,0 +1,340 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    AABBTree.cpp
+// Description: AABBTree class - a dynamic bounding volume hierarchy of
+//              axis-aligned boxes, used to quickly find the objects hit by a
+//              ray (eg. for picking in the 3d map view)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "AABBTree.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// AABBTree::Box Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Extends the box to include [point]
+// -----------------------------------------------------------------------------
+void AABBTree::Box::extend(fpoint3_t point)
+{
+	min.x = std::min(min.x, point.x);
+	min.y = std::min(min.y, point.y);
+	min.z = std::min(min.z, point.z);
+	max.x = std::max(max.x, point.x);
+	max.y = std::max(max.y, point.y);
+	max.z = std::max(max.z, point.z);
+}
+
+// -----------------------------------------------------------------------------
+// Extends the box to include [box]
+// -----------------------------------------------------------------------------
+void AABBTree::Box::extend(const Box& box)
+{
+	extend(box.min);
+	extend(box.max);
+}
+
+// -----------------------------------------------------------------------------
+// Grows the box by [amount] in all directions
+// -----------------------------------------------------------------------------
+void AABBTree::Box::expand(double amount)
+{
+	min.x -= amount;
+	min.y -= amount;
+	min.z -= amount;
+	max.x += amount;
+	max.y += amount;
+	max.z += amount;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the surface area of the box
+// -----------------------------------------------------------------------------
+double AABBTree::Box::surfaceArea() const
+{
+	double dx = max.x - min.x;
+	double dy = max.y - min.y;
+	double dz = max.z - min.z;
+	return 2.0 * (dx * dy + dy * dz + dz * dx);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the box is the same as [other]
+// -----------------------------------------------------------------------------
+bool AABBTree::Box::operator==(const Box& other) const
+{
+	return min.x == other.min.x && min.y == other.min.y && min.z == other.min.z && max.x == other.max.x
+		   && max.y == other.max.y && max.z == other.max.z;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the ray from [origin] (with [inv_dir] being the reciprocal
+// of each component of the ray direction) hits the box within [max_dist].
+// If it does, [dist] is set to the distance along the ray where it enters the
+// box (0 if the origin is inside the box)
+// -----------------------------------------------------------------------------
+bool AABBTree::Box::rayIntersect(fpoint3_t origin, fpoint3_t inv_dir, double max_dist, double& dist) const
+{
+	const double o[]  = { origin.x, origin.y, origin.z };
+	const double id[] = { inv_dir.x, inv_dir.y, inv_dir.z };
+	const double lo[] = { min.x, min.y, min.z };
+	const double hi[] = { max.x, max.y, max.z };
+
+	double t_min = 0;
+	double t_max = max_dist;
+	for (unsigned a = 0; a < 3; a++)
+	{
+		// Ray parallel to this axis, just check the origin is within the slab
+		if (std::isinf(id[a]))
+		{
+			if (o[a] < lo[a] || o[a] > hi[a])
+				return false;
+			continue;
+		}
+
+		double t1 = (lo[a] - o[a]) * id[a];
+		double t2 = (hi[a] - o[a]) * id[a];
+		if (t1 > t2)
+			std::swap(t1, t2);
+
+		t_min = std::max(t_min, t1);
+		t_max = std::min(t_max, t2);
+		if (t_min > t_max)
+			return false;
+	}
+
+	dist = t_min;
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// AABBTree Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Adds [box] for [item] to the tree. Returns the proxy id of the new box, used
+// to update or remove it later
+// -----------------------------------------------------------------------------
+int AABBTree::insert(const Box& box, int item)
+{
+	int leaf          = allocateNode();
+	nodes_[leaf].box  = box;
+	nodes_[leaf].item = item;
+	insertLeaf(leaf);
+	n_leaves_++;
+
+	return leaf;
+}
+
+// -----------------------------------------------------------------------------
+// Removes the box with id [proxy] from the tree
+// -----------------------------------------------------------------------------
+void AABBTree::remove(int proxy)
+{
+	removeLeaf(proxy);
+	freeNode(proxy);
+	n_leaves_--;
+}
+
+// -----------------------------------------------------------------------------
+// Changes the box with id [proxy] to [box]
+// -----------------------------------------------------------------------------
+void AABBTree::update(int proxy, const Box& box)
+{
+	if (nodes_[proxy].box == box)
+		return;
+
+	removeLeaf(proxy);
+	nodes_[proxy].box = box;
+	insertLeaf(proxy);
+}
+
+// -----------------------------------------------------------------------------
+// Removes all boxes from the tree
+// -----------------------------------------------------------------------------
+void AABBTree::clear()
+{
+	nodes_.clear();
+	root_     = -1;
+	free_     = -1;
+	n_leaves_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of a new (unused) node
+// -----------------------------------------------------------------------------
+int AABBTree::allocateNode()
+{
+	if (free_ < 0)
+	{
+		nodes_.emplace_back();
+		return nodes_.size() - 1;
+	}
+
+	int node     = free_;
+	free_        = nodes_[node].parent;
+	nodes_[node] = Node();
+	return node;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [node] to the list of free nodes
+// -----------------------------------------------------------------------------
+void AABBTree::freeNode(int node)
+{
+	nodes_[node].parent = free_;
+	nodes_[node].child1 = -1;
+	nodes_[node].child2 = -1;
+	nodes_[node].item   = -1;
+	free_               = node;
+}
+
+// -----------------------------------------------------------------------------
+// Inserts [leaf] into the tree. The sibling for the new leaf is found by
+// descending towards the child that would grow the least (by surface area)
+// -----------------------------------------------------------------------------
+void AABBTree::insertLeaf(int leaf)
+{
+	if (root_ < 0)
+	{
+		root_               = leaf;
+		nodes_[leaf].parent = -1;
+		return;
+	}
+
+	// Find the best sibling for the leaf
+	Box leaf_box = nodes_[leaf].box;
+	int index    = root_;
+	while (!nodes_[index].isLeaf())
+	{
+		Box combined = nodes_[index].box;
+		combined.extend(leaf_box);
+		double area          = nodes_[index].box.surfaceArea();
+		double combined_area = combined.surfaceArea();
+
+		// Cost of creating a new parent for this node and the leaf
+		double cost = 2.0 * combined_area;
+
+		// Minimum cost of pushing the leaf further down the tree
+		double inheritance = 2.0 * (combined_area - area);
+
+		// Cost of descending into each child
+		auto child_cost = [&](int child) {
+			Box box = nodes_[child].box;
+			box.extend(leaf_box);
+			double cost = box.surfaceArea();
+			if (!nodes_[child].isLeaf())
+				cost -= nodes_[child].box.surfaceArea();
+			return cost + inheritance;
+		};
+		double cost1 = child_cost(nodes_[index].child1);
+		double cost2 = child_cost(nodes_[index].child2);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = cost1 < cost2 ? nodes_[index].child1 : nodes_[index].child2;
+	}
+
+	// Create a new parent for the sibling and leaf
+	int sibling    = index;
+	int old_parent = nodes_[sibling].parent;
+	int new_parent = allocateNode();
+	nodes_[new_parent].parent = old_parent;
+	nodes_[new_parent].box    = nodes_[sibling].box;
+	nodes_[new_parent].box.extend(leaf_box);
+	nodes_[new_parent].child1 = sibling;
+	nodes_[new_parent].child2 = leaf;
+	nodes_[sibling].parent    = new_parent;
+	nodes_[leaf].parent       = new_parent;
+
+	if (old_parent < 0)
+		root_ = new_parent;
+	else if (nodes_[old_parent].child1 == sibling)
+		nodes_[old_parent].child1 = new_parent;
+	else
+		nodes_[old_parent].child2 = new_parent;
+
+	// Update ancestor boxes
+	refit(old_parent);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [leaf] from the tree (the node itself isn't freed)
+// -----------------------------------------------------------------------------
+void AABBTree::removeLeaf(int leaf)
+{
+	if (leaf == root_)
+	{
+		root_ = -1;
+		return;
+	}
+
+	// Replace the leaf's parent with its sibling
+	int parent      = nodes_[leaf].parent;
+	int grandparent = nodes_[parent].parent;
+	int sibling     = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+	if (grandparent < 0)
+	{
+		root_                  = sibling;
+		nodes_[sibling].parent = -1;
+	}
+	else
+	{
+		if (nodes_[grandparent].child1 == parent)
+			nodes_[grandparent].child1 = sibling;
+		else
+			nodes_[grandparent].child2 = sibling;
+		nodes_[sibling].parent = grandparent;
+	}
+	freeNode(parent);
+
+	// Update ancestor boxes
+	refit(grandparent);
+}
+
+// -----------------------------------------------------------------------------
+// Recalculates the boxes of [node] and all its ancestors from their children
+// -----------------------------------------------------------------------------
+void AABBTree::refit(int node)
+{
+	while (node >= 0)
+	{
+		nodes_[node].box = nodes_[nodes_[node].child1].box;
+		nodes_[node].box.extend(nodes_[nodes_[node].child2].box);
+		node = nodes_[node].parent;
+	}
+}
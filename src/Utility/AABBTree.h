@@ -0,0 +1,116 @@
+#pragma once
+
+// A dynamic bounding volume hierarchy of axis-aligned boxes, each with an
+// associated item id. Boxes can be inserted, moved and removed at any time
+// without rebuilding the whole tree
+class AABBTree
+{
+public:
+	struct Box
+	{
+		fpoint3_t min;
+		fpoint3_t max;
+
+		Box() {}
+		Box(fpoint3_t min, fpoint3_t max) : min{ min }, max{ max } {}
+
+		void   extend(fpoint3_t point);
+		void   extend(const Box& box);
+		void   expand(double amount);
+		double surfaceArea() const;
+		bool   operator==(const Box& other) const;
+		bool   rayIntersect(fpoint3_t origin, fpoint3_t inv_dir, double max_dist, double& dist) const;
+	};
+
+	AABBTree() {}
+
+	int  insert(const Box& box, int item);
+	void remove(int proxy);
+	void update(int proxy, const Box& box);
+	void clear();
+
+	int        item(int proxy) const { return nodes_[proxy].item; }
+	const Box& box(int proxy) const { return nodes_[proxy].box; }
+	unsigned   size() const { return n_leaves_; }
+
+	// Calls [func(item, max_dist)] for each item whose box is hit by the ray
+	// from [origin] along [dir] within [max_dist]. [func] returns the new max
+	// distance (eg. the distance to the closest hit so far), nodes further
+	// away than that are skipped. Closer nodes are checked first
+	template<typename F> void raycast(fpoint3_t origin, fpoint3_t dir, double max_dist, F func) const
+	{
+		if (root_ < 0)
+			return;
+
+		fpoint3_t inv_dir(1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z);
+		double    dist;
+		if (!nodes_[root_].box.rayIntersect(origin, inv_dir, max_dist, dist))
+			return;
+
+		struct Entry
+		{
+			int    node;
+			double dist;
+		};
+		vector<Entry> stack{ { root_, dist } };
+		while (!stack.empty())
+		{
+			auto entry = stack.back();
+			stack.pop_back();
+			if (entry.dist > max_dist)
+				continue;
+
+			auto& node = nodes_[entry.node];
+			if (node.isLeaf())
+			{
+				max_dist = func(node.item, max_dist);
+				continue;
+			}
+
+			// Push the further child first so the closer one is checked first
+			double d1, d2;
+			bool   hit1 = nodes_[node.child1].box.rayIntersect(origin, inv_dir, max_dist, d1);
+			bool   hit2 = nodes_[node.child2].box.rayIntersect(origin, inv_dir, max_dist, d2);
+			if (hit1 && hit2)
+			{
+				if (d1 <= d2)
+				{
+					stack.push_back({ node.child2, d2 });
+					stack.push_back({ node.child1, d1 });
+				}
+				else
+				{
+					stack.push_back({ node.child1, d1 });
+					stack.push_back({ node.child2, d2 });
+				}
+			}
+			else if (hit1)
+				stack.push_back({ node.child1, d1 });
+			else if (hit2)
+				stack.push_back({ node.child2, d2 });
+		}
+	}
+
+private:
+	struct Node
+	{
+		Box box;
+		int parent = -1; // Next free node if the node is unused
+		int child1 = -1;
+		int child2 = -1;
+		int item   = -1;
+
+		bool isLeaf() const { return child1 < 0; }
+	};
+
+	vector<Node> nodes_;
+	int          root_     = -1;
+	int          free_     = -1;
+	unsigned     n_leaves_ = 0;
+
+	int  allocateNode();
+	void freeNode(int node);
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+	void refit(int node);
+};
@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MemoryArena.cpp
+// Description: MemoryArena class - a simple block allocator for lots of small
+//              allocations that all have the same lifetime (eg. the nodes of
+//              a parse tree), which are then freed all at once
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MemoryArena.h"
+
+
+// -----------------------------------------------------------------------------
+//
+// MemoryArena Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a pointer to [size] bytes of memory aligned to [align] (which must be
+// a power of 2), allocating a new block if the current one is full
+// -----------------------------------------------------------------------------
+void* MemoryArena::allocate(size_t size, size_t align)
+{
+	// Align within the current block
+	auto padding = (align - (reinterpret_cast<uintptr_t>(current_) & (align - 1))) & (align - 1);
+	if (!current_ || padding + size > remaining_)
+	{
+		// Allocations larger than a block get a block of their own
+		auto block_size = std::max(block_size_, size + align);
+		blocks_.emplace_back(new uint8_t[block_size]);
+		current_   = blocks_.back().get();
+		remaining_ = block_size;
+		bytes_reserved_ += block_size;
+		padding = (align - (reinterpret_cast<uintptr_t>(current_) & (align - 1))) & (align - 1);
+	}
+
+	auto ptr = current_ + padding;
+	current_ += padding + size;
+	remaining_ -= padding + size;
+	bytes_used_ += size;
+
+	return ptr;
+}
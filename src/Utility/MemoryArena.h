@@ -0,0 +1,61 @@
+#pragma once
+
+// Allocates memory in large blocks which are all freed together when the
+// arena is destroyed. Individual allocations can't be freed, and destructors
+// of objects created in the arena aren't called
+class MemoryArena
+{
+public:
+	MemoryArena(size_t block_size = 64 * 1024) : block_size_{ block_size } {}
+	~MemoryArena() = default;
+
+	// Non-copyable
+	MemoryArena(const MemoryArena&) = delete;
+	MemoryArena& operator=(const MemoryArena&) = delete;
+
+	void*  allocate(size_t size, size_t align = alignof(double));
+	size_t bytesUsed() const { return bytes_used_; }
+	size_t bytesReserved() const { return bytes_reserved_; }
+
+private:
+	vector<std::unique_ptr<uint8_t[]>> blocks_;
+	size_t                             block_size_;
+	uint8_t*                           current_        = nullptr;
+	size_t                             remaining_      = 0;
+	size_t                             bytes_used_     = 0;
+	size_t                             bytes_reserved_ = 0;
+};
+
+// Standard allocator that uses a MemoryArena if one is given, or the heap
+// otherwise. Allows containers to be kept in an arena, where they don't need
+// to be destroyed as long as their elements don't either
+template<typename T> class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	ArenaAllocator(MemoryArena* arena = nullptr) noexcept : arena_{ arena } {}
+	template<typename U> ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_{ other.arena() } {}
+
+	MemoryArena* arena() const { return arena_; }
+
+	T* allocate(size_t n)
+	{
+		if (arena_)
+			return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, size_t)
+	{
+		if (!arena_)
+			::operator delete(p);
+	}
+
+	template<typename U> bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena(); }
+	template<typename U> bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena(); }
+
+private:
+	MemoryArena* arena_;
+};
@@ -0,0 +1,192 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2017 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Parallel.cpp
+// Description: Simple helpers for spreading independent work across threads
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Parallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, max_worker_threads, 0, CVAR_SAVE) // 0 = number of hardware threads
+
+
+// -----------------------------------------------------------------------------
+//
+// Parallel Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the number of worker threads to use for parallel operations
+// -----------------------------------------------------------------------------
+unsigned Parallel::numThreads()
+{
+	if (max_worker_threads > 0)
+		return max_worker_threads;
+
+	auto hw_threads = std::thread::hardware_concurrency();
+	return hw_threads > 0 ? hw_threads : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] once for each index in [0, count), spread across up to
+// numThreads() threads (including the calling thread). Indices are handed out
+// in order but may complete in any order, so [func] should only write to its
+// own index's results. Returns once all calls have completed
+// -----------------------------------------------------------------------------
+void Parallel::forEach(size_t count, const std::function<void(size_t)>& func)
+{
+	auto num_threads = std::min<size_t>(numThreads(), count);
+
+	// Not worth starting threads
+	if (num_threads <= 1)
+	{
+		for (size_t a = 0; a < count; ++a)
+			func(a);
+		return;
+	}
+
+	std::atomic<size_t> next{ 0 };
+	auto                worker = [&]() {
+		for (auto index = next++; index < count; index = next++)
+			func(index);
+	};
+
+	vector<std::thread> threads;
+	for (size_t a = 1; a < num_threads; ++a)
+		threads.emplace_back(worker);
+	worker();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+// -----------------------------------------------------------------------------
+// Calls [work] once for each index in [0, count) on worker threads, and
+// [commit] once for each index on the calling thread, strictly in index order
+// as soon as that index's [work] has completed. Workers stop taking new
+// indices while [max_pending] results are waiting to be committed, so memory
+// use stays bounded no matter how slow [commit] is.
+//
+// If [commit] returns false, no further indices are started or committed and
+// false is returned once all in-flight [work] calls have finished
+// -----------------------------------------------------------------------------
+bool Parallel::forEachOrdered(
+	size_t                             count,
+	const std::function<void(size_t)>& work,
+	const std::function<bool(size_t)>& commit,
+	size_t                             max_pending)
+{
+	auto num_threads = std::min<size_t>(numThreads(), count);
+
+	// Not worth starting threads
+	if (num_threads <= 1)
+	{
+		for (size_t a = 0; a < count; ++a)
+		{
+			work(a);
+			if (!commit(a))
+				return false;
+		}
+		return true;
+	}
+
+	if (max_pending == 0)
+		max_pending = num_threads * 2;
+
+	std::mutex              mutex;
+	std::condition_variable cv;
+	vector<bool>            done(count, false);
+	size_t                  next      = 0;
+	size_t                  committed = 0;
+	bool                    cancelled = false;
+
+	auto worker = [&]() {
+		while (true)
+		{
+			size_t index;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [&]() { return cancelled || next >= count || next < committed + max_pending; });
+				if (cancelled || next >= count)
+					return;
+				index = next++;
+			}
+
+			work(index);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				done[index] = true;
+			}
+			cv.notify_all();
+		}
+	};
+
+	// All threads work, the calling thread commits
+	vector<std::thread> threads;
+	for (size_t a = 0; a < num_threads; ++a)
+		threads.emplace_back(worker);
+
+	bool ok = true;
+	for (size_t a = 0; a < count; ++a)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv.wait(lock, [&]() { return done[a]; });
+		}
+
+		ok = commit(a);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (ok)
+				committed = a + 1;
+			else
+				cancelled = true;
+		}
+		cv.notify_all();
+
+		if (!ok)
+			break;
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return ok;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace Parallel
+{
+// Returns the number of worker threads to use for parallel operations
+unsigned numThreads();
+
+// Calls [func] once for each index in [0, count), spread across up to
+// numThreads() threads. Returns once all calls have completed
+void forEach(size_t count, const std::function<void(size_t)>& func);
+
+// Calls [work] for each index in [0, count) on worker threads, and [commit]
+// for each index on the calling thread in index order. At most [max_pending]
+// finished results are buffered ahead of [commit] (0 = 2 per thread).
+// Returns false if [commit] returned false to cancel the remaining indices
+bool forEachOrdered(
+	size_t                             count,
+	const std::function<void(size_t)>& work,
+	const std::function<bool(size_t)>& commit,
+	size_t                             max_pending = 0);
+} // namespace Parallel
@@ -37,6 +37,25 @@
 #include "Utility/Tokenizer.h"
 
 
+// ----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// ----------------------------------------------------------------------------
+namespace
+{
+	// Returns the arena to allocate from for a node with [parent] or [parser]
+	MemoryArena* treeArena(ParseTreeNode* parent, Parser* parser)
+	{
+		if (parent)
+			return &parent->storage().arena;
+		if (parser)
+			return &parser->storage().arena;
+		return nullptr;
+	}
+}
+
+
 // ----------------------------------------------------------------------------
 //
 // ParseTreeNode Class Functions
@@ -47,7 +66,8 @@
 // ----------------------------------------------------------------------------
 // ParseTreeNode::ParseTreeNode
 //
-// ParseTreeNode class constructor
+// ParseTreeNode class constructor. The node uses the storage of [parent] or
+// [parser] if given, otherwise it creates its own (for standalone trees)
 // ----------------------------------------------------------------------------
 ParseTreeNode::ParseTreeNode(
 	ParseTreeNode* parent,
@@ -55,11 +75,46 @@ ParseTreeNode::ParseTreeNode(
 	ArchiveTreeNode* archive_dir,
 	string type
 ) :
-	STreeNode{ parent },
-	type_{ type },
+	STreeNode{ nullptr, treeArena(parent, parser) },
+	storage_{ parent ? parent->storage_ : parser ? &parser->storage() : nullptr },
+	values_{ ArenaAllocator<Value>(treeArena(parent, parser)) },
 	parser_{ parser },
 	archive_dir_{ archive_dir }
 {
+	if (!storage_)
+	{
+		own_storage_ = std::make_unique<ParseTreeStorage>();
+		storage_ = own_storage_.get();
+	}
+
+	name_ = storage_->intern(wxEmptyString);
+	inherit_ = name_;
+	type_ = storage_->intern(type);
+
+	allowDup(true);
+
+	// Add to parent (after the storage is set up)
+	if (parent)
+		parent->addChild(this);
+}
+
+// ----------------------------------------------------------------------------
+// ParseTreeNode::ParseTreeNode
+//
+// ParseTreeNode class constructor for child nodes allocated from [storage]
+// ----------------------------------------------------------------------------
+ParseTreeNode::ParseTreeNode(ParseTreeStorage* storage, Parser* parser) :
+	STreeNode{ nullptr, &storage->arena },
+	storage_{ storage },
+	in_arena_{ true },
+	values_{ ArenaAllocator<Value>(&storage->arena) },
+	parser_{ parser },
+	archive_dir_{ nullptr }
+{
+	name_ = storage_->intern(wxEmptyString);
+	inherit_ = name_;
+	type_ = name_;
+
 	allowDup(true);
 }
 
@@ -70,6 +125,44 @@ ParseTreeNode::ParseTreeNode(
 // ----------------------------------------------------------------------------
 ParseTreeNode::~ParseTreeNode()
 {
+	// Child nodes allocated from the tree storage are never destroyed
+	// individually, their memory is released all at once with the storage.
+	// Only delete any that were created on the heap
+	for (auto child : children)
+		if (!static_cast<ParseTreeNode*>(child)->in_arena_)
+			delete child;
+
+	children.clear();
+}
+
+// ----------------------------------------------------------------------------
+// ParseTreeNode::values
+//
+// Returns all of the node's values as Properties
+// ----------------------------------------------------------------------------
+vector<Property> ParseTreeNode::values() const
+{
+	vector<Property> props;
+	props.reserve(values_.size());
+	for (auto& value : values_)
+		props.push_back(value.property());
+	return props;
+}
+
+// ----------------------------------------------------------------------------
+// ParseTreeNode::Value::property
+//
+// Returns the value as a Property
+// ----------------------------------------------------------------------------
+Property ParseTreeNode::Value::property() const
+{
+	switch (type)
+	{
+	case PROP_BOOL: return Property(boolean);
+	case PROP_INT: return Property(integer);
+	case PROP_FLOAT: return Property(floating);
+	default: return Property(*str);
+	}
 }
 
 // ----------------------------------------------------------------------------
@@ -84,7 +177,7 @@ Property ParseTreeNode::value(unsigned index)
 	if (index >= values_.size())
 		return Property(false);
 
-	return values_[index];
+	return values_[index].property();
 }
 
 // ----------------------------------------------------------------------------
@@ -99,7 +192,10 @@ string ParseTreeNode::stringValue(unsigned index)
 	if (index >= values_.size())
 		return wxEmptyString;
 
-	return values_[index].getStringValue();
+	if (values_[index].type == PROP_STRING)
+		return *values_[index].str;
+
+	return values_[index].property().getStringValue();
 }
 
 // ----------------------------------------------------------------------------
@@ -112,7 +208,7 @@ vector<string> ParseTreeNode::stringValues()
 	vector<string> string_values;
 	for (unsigned idx = 0; idx < values_.size(); ++idx)
 	{
-		string_values.push_back(values_[idx].getStringValue());
+		string_values.push_back(stringValue(idx));
 	}
 	return string_values;
 }
@@ -129,7 +225,7 @@ int ParseTreeNode::intValue(unsigned index)
 	if (index >= values_.size())
 		return 0;
 
-	return (int)values_[index];
+	return values_[index].property().getIntValue();
 }
 
 // ----------------------------------------------------------------------------
@@ -144,7 +240,7 @@ bool ParseTreeNode::boolValue(unsigned index)
 	if (index >= values_.size())
 		return false;
 
-	return (bool)values_[index];
+	return values_[index].property().getBoolValue();
 }
 
 // ----------------------------------------------------------------------------
@@ -159,7 +255,7 @@ double ParseTreeNode::floatValue(unsigned index)
 	if (index >= values_.size())
 		return 0.0f;
 
-	return (double)values_[index];
+	return values_[index].property().getFloatValue();
 }
 
 // ----------------------------------------------------------------------------
@@ -169,8 +265,43 @@ double ParseTreeNode::floatValue(unsigned index)
 // ----------------------------------------------------------------------------
 ParseTreeNode* ParseTreeNode::addChildPTN(const string& name, const string& type)
 {
-	auto node = static_cast<ParseTreeNode*>(addChild(name));
-	node->type_ = type;
+	ParseTreeNode* node;
+
+	// Names containing a path (or duplicate checks) need to go through
+	// STreeNode::addChild, otherwise the node can be added directly
+	if (!allow_dup_child || name.empty() || name.find_first_of(wxFileName::GetPathSeparators()) != string::npos)
+		node = static_cast<ParseTreeNode*>(addChild(name));
+	else
+	{
+		node = newChild(name);
+		addChild(node);
+	}
+
+	node->type_ = storage_->intern(type);
+	return node;
+}
+
+// ----------------------------------------------------------------------------
+// ParseTreeNode::createChild
+//
+// Creates a new (parentless) child node of [name]
+// ----------------------------------------------------------------------------
+STreeNode* ParseTreeNode::createChild(string name)
+{
+	return newChild(name);
+}
+
+// ----------------------------------------------------------------------------
+// ParseTreeNode::newChild
+//
+// Allocates a new node of [name] from the tree storage. The node is not added
+// to this node's children
+// ----------------------------------------------------------------------------
+ParseTreeNode* ParseTreeNode::newChild(const string& name)
+{
+	auto mem = storage_->arena.allocate(sizeof(ParseTreeNode), alignof(ParseTreeNode));
+	auto node = new (mem) ParseTreeNode(storage_, parser_);
+	node->name_ = storage_->intern(name);
 	return node;
 }
 
@@ -201,7 +332,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 	// #define
 	if (tz.current() == "#define")
-		parser_->define(tz.next().text);
+		parser_->define(tz.next().text());
 
 	// #if(n)def
 	else if (tz.current() == "#ifdef" || tz.current() == "#ifndef")
@@ -210,7 +341,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 		bool test = true;
 		if (tz.current() == "#ifndef")
 			test = false;
-		string define = tz.next().text;
+		string define = tz.next().text();
 		if (parser_->defined(define) == test)
 			return true;
 
@@ -239,7 +370,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 		if (archive_dir_)
 		{
 			// Get entry to include
-			auto inc_path = tz.next().text;
+			auto inc_path = tz.next().text();
 			auto archive = archive_dir_->archive();
 			auto inc_entry = archive->entryAtPath(archive_dir_->getPath() + inc_path);
 			if (!inc_entry) // Try absolute path
@@ -278,7 +409,7 @@ bool ParseTreeNode::parsePreprocessor(Tokenizer& tz)
 
 	// Unrecognised
 	else
-		logError(tz, S_FMT("Unrecognised preprocessor directive \"%s\"", CHR(tz.current().text)));
+		logError(tz, S_FMT("Unrecognised preprocessor directive \"%s\"", CHR(tz.current().text())));
 
 	return true;
 }
@@ -307,39 +438,21 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 		if (token == list_end && !token.quoted_string)
 			break;
 
-		// Setup value
-		Property value;
-
-		// Detect value type
+		// Detect value type and add it
 		if (token.quoted_string)	// Quoted string
-			value = token.text;
+			child->addStringValue(token.text());
 		else if (token == "true")	// Boolean (true)
-			value = true;
+			child->addBoolValue(true);
 		else if (token == "false")	// Boolean (false)
-			value = false;
+			child->addBoolValue(false);
 		else if (token.isInteger())	// Integer
-		{
-			long val;
-			token.text.ToLong(&val);
-			value = (int)val;
-		}
+			child->addIntValue(token.asInt());
 		else if (token.isHex())  	// Hex (0xXXXXXX)
-		{
-			long val;
-			token.text.ToLong(&val, 0);
-			value = (int)val;
-		}
+			child->addIntValue(token.asInt(0));
 		else if (token.isFloat())	// Floating point
-		{
-			double val;
-			token.text.ToDouble(&val);
-			value = val;
-		}
+			child->addFloatValue(token.asFloat());
 		else						// Unknown, just treat as string
-			value = token.text;
-
-		// Add value
-		child->values_.push_back(value);
+			child->addStringValue(token.text());
 
 		// Check for ,
 		if (tz.peek() == ',')
@@ -348,7 +461,7 @@ bool ParseTreeNode::parseAssignment(Tokenizer& tz, ParseTreeNode* child) const
 		{
 			logError(
 				tz,
-				S_FMT("Expected \",\" or \"%c\", got \"%s\"", list_end, CHR(tz.peek().text))
+				S_FMT("Expected \",\" or \"%c\", got \"%s\"", list_end, CHR(tz.peek().text()))
 			);
 			return false;
 		}
@@ -389,14 +502,14 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		}
 
 		// If it's a special character (ie not a valid name), parsing fails
-		if (tz.isSpecialCharacter(tz.current().text[0]))
+		if (tz.isSpecialCharacter(tz.current().text()[0]))
 		{
-			logError(tz, S_FMT("Unexpected special character '%s'", CHR(tz.current().text)));
+			logError(tz, S_FMT("Unexpected special character '%s'", CHR(tz.current().text())));
 			return false;
 		}
 
 		// So we have either a node or property name
-		name = tz.current().text;
+		name = tz.current().text();
 		type.Empty();
 		if (name.empty())
 		{
@@ -408,7 +521,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		if (tz.peek() != '=' && tz.peek() != '{' && tz.peek() != ';' && tz.peek() != ':')
 		{
 			type = name;
-			name = tz.next().text;
+			name = tz.next().text();
 
 			if (name.empty())
 			{
@@ -450,7 +563,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			{
 				// Add child node
 				auto child = addChildPTN(name, type);
-				child->inherit_ = tz.current().text;
+				child->inherit_ = storage_->intern(tz.current().text());
 
 				// Skip {
 				tz.adv(2);
@@ -463,7 +576,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			{
 				// Add child node
 				auto child = addChildPTN(name, type);
-				child->inherit_ = tz.current().text;
+				child->inherit_ = storage_->intern(tz.current().text());
 
 				// Skip ;
 				tz.adv(2);
@@ -472,7 +585,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 			}
 			else
 			{
-				logError(tz, S_FMT("Expecting \"{\" or \";\", got \"%s\"", CHR(tz.next().text)));
+				logError(tz, S_FMT("Expecting \"{\" or \";\", got \"%s\"", CHR(tz.next().text())));
 				return false;
 			}
 		}
@@ -480,7 +593,7 @@ bool ParseTreeNode::parse(Tokenizer& tz)
 		// Unexpected token
 		else
 		{
-			logError(tz, S_FMT("Unexpected token \"%s\"", CHR(tz.next().text)));
+			logError(tz, S_FMT("Unexpected token \"%s\"", CHR(tz.next().text())));
 			return false;
 		}
 
@@ -514,18 +627,18 @@ void ParseTreeNode::write(string& out, int indent) const
 
 	// Type
 	out += tabs;
-	if (!type_.empty())
-		out += type_ + " ";
+	if (!type_->empty())
+		out += *type_ + " ";
 
 	// Name
-	if (name_.Contains(" ") || name_.empty())
-		out += S_FMT("\"%s\"", CHR(name_));
+	if (name_->Contains(" ") || name_->empty())
+		out += S_FMT("\"%s\"", CHR(*name_));
 	else
-		out += S_FMT("%s", CHR(name_));
+		out += S_FMT("%s", CHR(*name_));
 
 	// Inherit
-	if (!inherit_.empty())
-		out += " : " + inherit_;
+	if (!inherit_->empty())
+		out += " : " + *inherit_;
 
 	// Leaf node - write value(s)
 	if (children.size() == 0)
@@ -539,19 +652,16 @@ void ParseTreeNode::write(string& out, int indent) const
 				out += ", ";
 			first = false;
 
-			switch (value.getType())
+			switch (value.type)
 			{
 			case PROP_BOOL:
-			case PROP_FLAG:
-				out += value.getBoolValue() ? "true" : "false"; break;
+				out += value.boolean ? "true" : "false"; break;
 			case PROP_INT:
-				out += S_FMT("%d", value.getIntValue()); break;
+				out += S_FMT("%d", value.integer); break;
 			case PROP_FLOAT:
-				out += S_FMT("%1.3f", value.getFloatValue()); break;
-			case PROP_UINT:
-				out += S_FMT("%u", value.getUnsignedValue()); break;
+				out += S_FMT("%1.3f", value.floating); break;
 			default:
-				out += S_FMT("\"%s\"", value.getStringValue()); break;
+				out += S_FMT("\"%s\"", *value.str); break;
 			}
 		}
 
@@ -665,3 +775,92 @@ bool Parser::parseText(string& text, string source)
 	// Do parsing
 	return pt_root_->parse(tz);
 }
+
+
+// ----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// ----------------------------------------------------------------------------
+#include "General/Console/Console.h"
+#include "Archive/ArchiveManager.h"
+#include "App.h"
+#include "StringUtils.h"
+
+namespace
+{
+	// Returns the number of nodes in the tree starting at [node]
+	unsigned countNodes(ParseTreeNode* node)
+	{
+		unsigned count = 1;
+		for (unsigned a = 0; a < node->nChildren(); a++)
+			count += countNodes(node->getChildPTN(a));
+		return count;
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Parser benchmark. Parses all game configurations in the program resource
+// [iterations] times, and shows the time taken and parse tree memory usage
+// ----------------------------------------------------------------------------
+CONSOLE_COMMAND(bench_parser, 0, false)
+{
+	long iterations = 10;
+	if (!args.empty())
+		args[0].ToLong(&iterations);
+
+	auto dir = App::archiveManager().programResourceArchive()->getDir("config/games");
+	if (!dir)
+		return;
+
+	// Get full configuration text (with includes)
+	vector<string> configs;
+	size_t total_size = 0;
+	for (auto& entry : dir->entries())
+	{
+		string text;
+		StringUtils::processIncludes(entry.get(), text);
+		total_size += text.length();
+		configs.push_back(text);
+	}
+
+	if (configs.empty())
+		return;
+
+	unsigned num_nodes = 0;
+	size_t arena_used = 0;
+	size_t arena_reserved = 0;
+	size_t num_strings = 0;
+	long time = App::runTimer();
+	for (long a = 0; a < iterations; a++)
+	{
+		num_nodes = 0;
+		arena_used = arena_reserved = num_strings = 0;
+		for (auto& text : configs)
+		{
+			Parser parser;
+			parser.define("MAP_UDMF");
+			parser.parseText(text, "bench_parser");
+
+			num_nodes += countNodes(parser.parseTreeRoot());
+			arena_used += parser.storage().arena.bytesUsed();
+			arena_reserved += parser.storage().arena.bytesReserved();
+			num_strings += parser.storage().numStrings();
+		}
+	}
+	time = std::max(App::runTimer() - time, 1l);
+
+	Log::console(S_FMT(
+		"Parsed %d configurations (%1.2f MB) x%d in %dms (%1.1fms each)",
+		(int)configs.size(),
+		(double)total_size / (1024.0 * 1024.0),
+		iterations,
+		time,
+		(double)time / iterations / configs.size()));
+	Log::console(S_FMT(
+		"%d nodes, %d unique strings, arena %1.2f MB used / %1.2f MB reserved",
+		num_nodes,
+		(int)num_strings,
+		(double)arena_used / (1024.0 * 1024.0),
+		(double)arena_reserved / (1024.0 * 1024.0)));
+}
@@ -4,11 +4,29 @@
 
 #include "Tree.h"
 #include "PropertyList/Property.h"
+#include <unordered_set>
 
 class ArchiveTreeNode;
 class Parser;
 class Tokenizer;
 
+// Memory for the nodes, names and values of a parse tree. Nodes are allocated
+// from an arena and all names and string values are interned, so the whole
+// tree can be released at once rather than node by node
+class ParseTreeStorage
+{
+public:
+	MemoryArena	arena;
+
+	const string*	intern(const string& str) { return &*strings_.insert(str).first; }
+	size_t			numStrings() const { return strings_.size(); }
+
+private:
+	std::unordered_set<string, wxStringHash, wxStringEqual>	strings_;
+};
+
+// Note: nodes added to a tree should be created with addChildPTN (or addChild),
+// which allocates them from the tree's storage
 class ParseTreeNode : public STreeNode
 {
 public:
@@ -20,12 +38,12 @@ public:
 	);
 	~ParseTreeNode();
 
-	string	getName() override { return name_; }
-	void	setName(string name) override { this->name_ = name; }
+	string	getName() override { return *name_; }
+	void	setName(string name) override { name_ = storage_->intern(name); }
 
-	const string&			inherit() const { return inherit_; }
-	const string&			type() const { return type_; }
-	const vector<Property>&	values() const { return values_; }
+	const string&		inherit() const { return *inherit_; }
+	const string&		type() const { return *type_; }
+	vector<Property>	values() const;
 
 	size_t			nValues() const { return values_.size(); }
 	Property		value(unsigned index = 0);
@@ -42,33 +60,56 @@ public:
 					{ return static_cast<ParseTreeNode*>(getChild(index)); }
 
 	ParseTreeNode*	addChildPTN(const string& name, const string& type = "");
-	void			addStringValue(const string& value) { values_.push_back({value}); }
-	void			addIntValue(int value) { values_.push_back({value}); }
-	void			addBoolValue(bool value) { values_.push_back({value}); }
-	void			addFloatValue(double value) { values_.push_back({value}); }
+	void			addStringValue(const string& value) { values_.push_back(Value(storage_->intern(value))); }
+	void			addIntValue(int value) { values_.push_back(Value(value)); }
+	void			addBoolValue(bool value) { values_.push_back(Value(value)); }
+	void			addFloatValue(double value) { values_.push_back(Value(value)); }
 
 	bool	parse(Tokenizer& tz);
 	void	write(string& out, int indent = 0) const;
 
+	ParseTreeStorage&	storage() const { return *storage_; }
+
 	typedef std::unique_ptr<ParseTreeNode> UPtr;
 
 protected:
-	STreeNode* createChild(string name) override
-	{
-		ParseTreeNode* ret = new ParseTreeNode();
-		ret->setName(name);
-		ret->parser_ = parser_;
-		return ret;
-	}
+	STreeNode* createChild(string name) override;
 
 private:
-	string				name_;
-	string				inherit_;
-	string				type_;
-	vector<Property>	values_;
-	Parser*				parser_;
-	ArchiveTreeNode*	archive_dir_;
-
+	// A node value. Strings are interned in the tree storage so values don't
+	// need to be destroyed
+	struct Value
+	{
+		uint8_t type;
+		union
+		{
+			bool			boolean;
+			int				integer;
+			double			floating;
+			const string*	str;
+		};
+
+		Value(bool value) : type{ PROP_BOOL }, boolean{ value } {}
+		Value(int value) : type{ PROP_INT }, integer{ value } {}
+		Value(double value) : type{ PROP_FLOAT }, floating{ value } {}
+		Value(const string* value) : type{ PROP_STRING }, str{ value } {}
+
+		Property	property() const;
+	};
+
+	ParseTreeStorage*					storage_;
+	std::unique_ptr<ParseTreeStorage>	own_storage_;	// Root nodes without a parser only
+	bool								in_arena_ = false;
+	const string*						name_;
+	const string*						inherit_;
+	const string*						type_;
+	vector<Value, ArenaAllocator<Value>>	values_;
+	Parser*								parser_;
+	ArchiveTreeNode*					archive_dir_;
+
+	ParseTreeNode(ParseTreeStorage* storage, Parser* parser);
+
+	ParseTreeNode*	newChild(const string& name);
 	void	logError(const Tokenizer& tz, const string& error) const;
 	bool	parsePreprocessor(Tokenizer& tz);
 	bool	parseAssignment(Tokenizer& tz, ParseTreeNode* child) const;
@@ -80,7 +121,8 @@ public:
 	Parser(ArchiveTreeNode* dir_root = nullptr);
 	~Parser();
 
-	ParseTreeNode*	parseTreeRoot() const { return pt_root_.get(); }
+	ParseTreeNode*		parseTreeRoot() const { return pt_root_.get(); }
+	ParseTreeStorage&	storage() { return storage_; }
 
 	void	setCaseSensitive(bool cs) { case_sensitive_ = cs; }
 
@@ -93,6 +135,7 @@ public:
 	static ParseTreeNode*	node(STreeNode* node) { return static_cast<ParseTreeNode*>(node); }
 
 private:
+	ParseTreeStorage	storage_;	// Must be destroyed after the tree
 	ParseTreeNode::UPtr	pt_root_;
 	vector<string>		defines_;
 	ArchiveTreeNode*	archive_dir_root_	= nullptr;
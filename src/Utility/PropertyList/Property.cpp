@@ -456,3 +456,66 @@ string Property::typeString() const
 		return "Unknown";
 	}
 }
+
+/* Property::write
+ * Writes the property type and value to binary stream [out]
+ *******************************************************************/
+void Property::write(wxDataOutputStream& out) const
+{
+	out.Write8(type);
+	out.Write8(has_value ? 1 : 0);
+
+	switch (type)
+	{
+	case PROP_BOOL:
+	case PROP_FLAG:
+		out.Write8(value.Boolean ? 1 : 0);
+		break;
+	case PROP_INT:
+		out.Write32(value.Integer);
+		break;
+	case PROP_FLOAT:
+		out.WriteDouble(value.Floating);
+		break;
+	case PROP_STRING:
+		out.WriteString(val_string);
+		break;
+	case PROP_UINT:
+		out.Write32(value.Unsigned);
+		break;
+	default:
+		break;
+	}
+}
+
+/* Property::read
+ * Reads the property type and value from binary stream [in], as
+ * written by Property::write
+ *******************************************************************/
+void Property::read(wxDataInputStream& in)
+{
+	changeType(in.Read8());
+	has_value = in.Read8() > 0;
+
+	switch (type)
+	{
+	case PROP_BOOL:
+	case PROP_FLAG:
+		value.Boolean = in.Read8() > 0;
+		break;
+	case PROP_INT:
+		value.Integer = (int)in.Read32();
+		break;
+	case PROP_FLOAT:
+		value.Floating = in.ReadDouble();
+		break;
+	case PROP_STRING:
+		val_string = in.ReadString();
+		break;
+	case PROP_UINT:
+		value.Unsigned = in.Read32();
+		break;
+	default:
+		break;
+	}
+}
@@ -66,6 +66,10 @@ public:
 	void	setValue(unsigned val);
 
 	string	typeString() const;
+
+	// Binary (cache) serialization
+	void	write(wxDataOutputStream& out) const;
+	void	read(wxDataInputStream& in);
 };
 
 #endif//__PROPERTY_H__
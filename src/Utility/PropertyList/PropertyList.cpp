@@ -178,3 +178,32 @@ void PropertyList::allPropertyNames(vector<string>& list)
 		i++;
 	}
 }
+
+/* PropertyList::write
+ * Writes all properties to binary stream [out]
+ *******************************************************************/
+void PropertyList::write(wxDataOutputStream& out) const
+{
+	out.Write32(properties.size());
+	for (auto& i : properties)
+	{
+		out.WriteString(i.first);
+		i.second.write(out);
+	}
+}
+
+/* PropertyList::read
+ * Replaces all properties with those read from binary stream [in],
+ * as written by PropertyList::write
+ *******************************************************************/
+void PropertyList::read(wxDataInputStream& in)
+{
+	properties.clear();
+
+	unsigned count = in.Read32();
+	for (unsigned a = 0; a < count; a++)
+	{
+		string key = in.ReadString();
+		properties[key].read(in);
+	}
+}
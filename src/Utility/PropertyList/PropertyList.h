@@ -27,6 +27,10 @@ public:
 	bool	isEmpty() { return properties.empty(); }
 
 	string	toString(bool condensed = false);
+
+	// Binary (cache) serialization
+	void	write(wxDataOutputStream& out) const;
+	void	read(wxDataInputStream& in);
 };
 
 #endif//__PROPERTY_LIST_H__
@@ -105,7 +105,7 @@ void StringUtils::processIncludes(string filename, string& out)
 			tz.adv();	// Skip #include
 
 			// Process the file
-			processIncludes(path + tz.next().text, out);
+			processIncludes(path + tz.next().text(), out);
 		}
 		else
 			out.Append(line + "\n");
@@ -148,14 +148,14 @@ void StringUtils::processIncludes(ArchiveEntry* entry, string& out, bool use_res
 		{
 			// Get name of entry to include
 			tz.openString(line);
-			string name = entry->getPath() + tz.next().text;
+			string name = entry->getPath() + tz.next().text();
 
 			// Get the entry
 			bool done = false;
 			ArchiveEntry* entry_inc = entry->getParent()->entryAtPath(name);
 			// DECORATE paths start from the root, not from the #including entry's directory
 			if (!entry_inc)
-				entry_inc = entry->getParent()->entryAtPath(tz.current().text);
+				entry_inc = entry->getParent()->entryAtPath(tz.current().text());
 			if (entry_inc)
 			{
 				processIncludes(entry_inc, out);
@@ -167,7 +167,7 @@ void StringUtils::processIncludes(ArchiveEntry* entry, string& out, bool use_res
 			// Look in resource pack
 			if (use_res && !done && App::archiveManager().programResourceArchive())
 			{
-				name = "config/games/" + tz.current().text;
+				name = "config/games/" + tz.current().text();
 				entry_inc = App::archiveManager().programResourceArchive()->entryAtPath(name);
 				if (entry_inc)
 				{
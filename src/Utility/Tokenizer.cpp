@@ -40,7 +40,7 @@
 //
 // ----------------------------------------------------------------------------
 const string Tokenizer::DEFAULT_SPECIAL_CHARACTERS = ";,:|={}/";
-Tokenizer::Token Tokenizer::invalid_token_{ "", 0, false, 0, 0, 0, false };
+Tokenizer::Token Tokenizer::invalid_token_;
 
 
 // ----------------------------------------------------------------------------
@@ -60,6 +60,43 @@ namespace
 		// Whitespace is either a newline, tab character or space
 		return p == '\n' || p == 13 || p == ' ' || p == '\t';
 	}
+
+	// ------------------------------------------------------------------------
+	// isDigit
+	//
+	// Returns true if [p] is a decimal digit
+	// ------------------------------------------------------------------------
+	bool isDigit(char p)
+	{
+		return p >= '0' && p <= '9';
+	}
+
+	// ------------------------------------------------------------------------
+	// lower
+	//
+	// Returns [p] in lower case (ASCII only)
+	// ------------------------------------------------------------------------
+	char lower(char p)
+	{
+		return (p >= 'A' && p <= 'Z') ? p + 32 : p;
+	}
+
+	// ------------------------------------------------------------------------
+	// numberString
+	//
+	// Copies [size] characters from [chars] to [buf] as a null-terminated
+	// string, for use with the C number conversion functions. Returns false if
+	// it doesn't fit, which is never the case for a valid number
+	// ------------------------------------------------------------------------
+	bool numberString(const char* chars, unsigned size, char (&buf)[64])
+	{
+		if (size >= sizeof(buf))
+			return false;
+
+		memcpy(buf, chars, size);
+		buf[size] = 0;
+		return true;
+	}
 }
 
 
@@ -70,6 +107,107 @@ namespace
 // ----------------------------------------------------------------------------
 
 
+// ----------------------------------------------------------------------------
+// Token::text
+//
+// Returns the token text as a string. The string is only created the first
+// time it is needed, except for empty tokens. The shared invalid token is
+// empty, so it is never written to when used from several threads at once
+// ----------------------------------------------------------------------------
+const string& Tokenizer::Token::text() const
+{
+	static const string empty;
+	if (!chars_ && buffer_.empty())
+		return empty;
+
+	if (!text_valid_)
+	{
+		text_       = wxString::From8BitData(chars(), size());
+		text_valid_ = true;
+	}
+
+	return text_;
+}
+
+// ----------------------------------------------------------------------------
+// Token::equals
+//
+// Returns true if the token text is [cmp]
+// ----------------------------------------------------------------------------
+bool Tokenizer::Token::equals(const string& cmp) const
+{
+	auto len = size();
+	if (cmp.length() != len)
+		return false;
+
+	auto c = chars();
+	auto a = 0u;
+	for (auto i = cmp.begin(); i != cmp.end(); ++i, ++a)
+		if ((*i).GetValue() != (uint8_t)c[a])
+			return false;
+
+	return true;
+}
+bool Tokenizer::Token::equals(const char* cmp) const
+{
+	auto len = size();
+	return strncmp(chars(), cmp, len) == 0 && cmp[len] == 0;
+}
+
+// ----------------------------------------------------------------------------
+// Token::equalsNoCase
+//
+// Returns true if the token text is [cmp], ignoring case
+// ----------------------------------------------------------------------------
+bool Tokenizer::Token::equalsNoCase(const string& cmp) const
+{
+	// Only need to handle ASCII case here, non-ASCII tokens can just use the
+	// string comparison
+	auto len = size();
+	if (cmp.length() != len)
+		return false;
+
+	auto c = chars();
+	auto a = 0u;
+	for (auto i = cmp.begin(); i != cmp.end(); ++i, ++a)
+	{
+		auto v = (*i).GetValue();
+		if (v > 127 || c[a] & 0x80)
+			return S_CMPNOCASE(text(), cmp);
+		if (lower((char)v) != lower(c[a]))
+			return false;
+	}
+
+	return true;
+}
+bool Tokenizer::Token::equalsNoCase(const char* cmp) const
+{
+	auto len = size();
+	auto c   = chars();
+	for (unsigned a = 0; a < len; ++a)
+	{
+		if (cmp[a] == 0)
+			return false;
+		if ((cmp[a] | c[a]) & 0x80)
+			return S_CMPNOCASE(text(), cmp);
+		if (lower(c[a]) != lower(cmp[a]))
+			return false;
+	}
+
+	return cmp[len] == 0;
+}
+
+// ----------------------------------------------------------------------------
+// Token::startsWith
+//
+// Returns true if the token text begins with [cmp]
+// ----------------------------------------------------------------------------
+bool Tokenizer::Token::startsWith(const char* cmp) const
+{
+	auto len = strlen(cmp);
+	return len <= size() && strncmp(chars(), cmp, len) == 0;
+}
+
 // ----------------------------------------------------------------------------
 // Token::isInteger
 //
@@ -78,7 +216,22 @@ namespace
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::isInteger(bool allow_hex) const
 {
-	return StringUtils::isInteger(text, allow_hex);
+	if (allow_hex && isHex())
+		return true;
+
+	auto c   = chars();
+	auto len = size();
+	auto a   = 0u;
+	if (len > 0 && (c[0] == '+' || c[0] == '-'))
+		++a;
+	if (a == len)
+		return false;
+
+	for (; a < len; ++a)
+		if (!isDigit(c[a]))
+			return false;
+
+	return true;
 }
 
 // ----------------------------------------------------------------------------
@@ -88,7 +241,16 @@ bool Tokenizer::Token::isInteger(bool allow_hex) const
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::isHex() const
 {
-	return StringUtils::isHex(text);
+	auto c   = chars();
+	auto len = size();
+	if (len < 3 || c[0] != '0' || c[1] != 'x')
+		return false;
+
+	for (unsigned a = 2; a < len; ++a)
+		if (!isxdigit((uint8_t)c[a]))
+			return false;
+
+	return true;
 }
 
 // ----------------------------------------------------------------------------
@@ -98,7 +260,58 @@ bool Tokenizer::Token::isHex() const
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::isFloat() const
 {
-	return StringUtils::isFloat(text);
+	auto c   = chars();
+	auto len = size();
+	auto a   = 0u;
+
+	// Sign
+	if (len > 0 && (c[0] == '+' || c[0] == '-'))
+		++a;
+
+	// Integer part, decimal point and fractional part
+	// (must have at least one digit in either part)
+	auto start = a;
+	while (a < len && isDigit(c[a]))
+		++a;
+	auto digits = a - start;
+	if (a < len && c[a] == '.')
+		++a;
+	start = a;
+	while (a < len && isDigit(c[a]))
+		++a;
+	digits += a - start;
+	if (digits == 0)
+		return false;
+
+	// Exponent
+	if (a < len && (c[a] == 'e' || c[a] == 'E'))
+	{
+		++a;
+		if (a < len && (c[a] == '+' || c[a] == '-'))
+			++a;
+		start = a;
+		while (a < len && isDigit(c[a]))
+			++a;
+		if (a == start)
+			return false;
+	}
+
+	return a == len;
+}
+
+// ----------------------------------------------------------------------------
+// Token::asInt
+//
+// Returns the token as an integer value, in [base] (0 to detect from any
+// prefix, eg. 0x for hex)
+// ----------------------------------------------------------------------------
+int Tokenizer::Token::asInt(int base) const
+{
+	char buf[64];
+	if (!numberString(chars(), size(), buf))
+		return 0;
+
+	return (int)strtol(buf, nullptr, base);
 }
 
 // ----------------------------------------------------------------------------
@@ -109,22 +322,21 @@ bool Tokenizer::Token::isFloat() const
 // ----------------------------------------------------------------------------
 bool Tokenizer::Token::asBool() const
 {
-	return !(S_CMPNOCASE(text, "false") ||
-			 S_CMPNOCASE(text, "no") ||
-			 S_CMPNOCASE(text, "0"));
+	return !(equalsNoCase("false") || equalsNoCase("no") || equals("0"));
 }
 
 // ----------------------------------------------------------------------------
-// Token::toBool
+// Token::asFloat
 //
-// Sets [val] to the token as a bool value.
-// "false", "no" and "0" are false, anything else is true.
+// Returns the token as a floating point value
 // ----------------------------------------------------------------------------
-void Tokenizer::Token::toBool(bool& val) const
+double Tokenizer::Token::asFloat() const
 {
-	val = !(S_CMPNOCASE(text, "false") ||
-			S_CMPNOCASE(text, "no") ||
-			S_CMPNOCASE(text, "0"));
+	char buf[64];
+	if (!numberString(chars(), size(), buf))
+		return 0;
+
+	return atof(buf);
 }
 
 
@@ -172,7 +384,7 @@ const Tokenizer::Token& Tokenizer::next()
 	if (!token_next_.valid)
 		return invalid_token_;
 
-	token_current_ = token_next_;
+	token_current_ = std::move(token_next_);
 	readNext();
 	return token_current_;
 }
@@ -190,7 +402,7 @@ void Tokenizer::adv(size_t inc)
 	for (size_t a = 0; a < inc - 1; a++)
 		readNext();
 
-	token_current_ = token_next_;
+	token_current_ = std::move(token_next_);
 	readNext();
 }
 
@@ -237,7 +449,7 @@ bool Tokenizer::advIf(char check, size_t inc)
 // ----------------------------------------------------------------------------
 bool Tokenizer::advIfNC(const char* check, size_t inc)
 {
-	if (S_CMPNOCASE(token_current_.text, check))
+	if (token_current_.equalsNoCase(check))
 	{
 		adv(inc);
 		return true;
@@ -247,7 +459,7 @@ bool Tokenizer::advIfNC(const char* check, size_t inc)
 }
 bool Tokenizer::advIfNC(const string& check, size_t inc)
 {
-	if (S_CMPNOCASE(token_current_.text, check))
+	if (token_current_.equalsNoCase(check))
 	{
 		adv(inc);
 		return true;
@@ -311,7 +523,7 @@ bool Tokenizer::advIfNextNC(const char* check, size_t inc)
 	if (!token_next_.valid)
 		return false;
 
-	if (S_CMPNOCASE(token_next_.text, check))
+	if (token_next_.equalsNoCase(check))
 	{
 		adv(inc);
 		return true;
@@ -476,9 +688,12 @@ string Tokenizer::getLine(bool from_start)
 		state_.current_line = token_next_.line_no;
 	}
 
-	string line;
-	while (data_[state_.position] != '\n' && data_[state_.position] != '\r')
-		line += data_[state_.position++];
+	auto start = state_.position;
+	while (state_.position < state_.size &&
+			data_[state_.position] != '\n' &&
+			data_[state_.position] != '\r')
+		++state_.position;
+	string line = wxString::From8BitData(data_ + start, state_.position - start);
 
 	readNext(&token_current_);
 	readNext(&token_next_);
@@ -517,7 +732,7 @@ bool Tokenizer::checkOrEndNC(const char* check) const
 	if (!token_next_.valid)
 		return true;
 
-	return S_CMPNOCASE(token_current_.text, check);
+	return token_current_.equalsNoCase(check);
 }
 
 // ----------------------------------------------------------------------------
@@ -552,7 +767,7 @@ bool Tokenizer::checkNextNC(const char* check) const
 	if (!token_next_.valid)
 		return false;
 
-	return S_CMPNOCASE(token_next_.text, check);
+	return token_next_.equalsNoCase(check);
 }
 
 // ----------------------------------------------------------------------------
@@ -582,9 +797,11 @@ bool Tokenizer::openFile(const string& filename, size_t offset, size_t length)
 		length = (size_t) file.Length() - offset;
 
 	// Read the file portion
-	data_.resize((size_t) length, 0);
+	data_buffer_.resize((size_t) length);
 	file.Seek(offset, wxFromStart);
-	file.Read(data_.data(), (size_t) length);
+	file.Read(data_buffer_.data(), (size_t) length);
+	data_ = data_buffer_.data();
+	data_size_ = data_buffer_.size();
 
 	reset();
 
@@ -608,7 +825,9 @@ bool Tokenizer::openString(const string& text, size_t offset, size_t length, con
 		length = ascii.length() - offset;
 
 	// Copy the string portion
-	data_.assign(ascii.data() + offset, ascii.data() + offset + length);
+	data_buffer_.assign(ascii.data() + offset, ascii.data() + offset + length);
+	data_ = data_buffer_.data();
+	data_size_ = data_buffer_.size();
 
 	reset();
 
@@ -618,12 +837,15 @@ bool Tokenizer::openString(const string& text, size_t offset, size_t length, con
 // ----------------------------------------------------------------------------
 // Tokenizer::openMem
 //
-// Opens text from memory [mem], reading [length] bytes
+// Opens text from memory [mem], reading [length] bytes. The data isn't copied
+// so it must remain valid (and unmodified) while it is being tokenized
 // ----------------------------------------------------------------------------
 bool Tokenizer::openMem(const char* mem, size_t length, const string& source)
 {
 	source_ = source;
-	data_.assign(mem, mem + length);
+	data_buffer_.clear();
+	data_ = mem;
+	data_size_ = length;
 
 	reset();
 
@@ -633,16 +855,12 @@ bool Tokenizer::openMem(const char* mem, size_t length, const string& source)
 // ----------------------------------------------------------------------------
 // Tokenizer::openMem
 //
-// Opens text from a MemChunk [mc]
+// Opens text from a MemChunk [mc]. The data isn't copied so [mc] must remain
+// valid (and unmodified) while it is being tokenized
 // ----------------------------------------------------------------------------
 bool Tokenizer::openMem(const MemChunk& mc, const string& source)
 {
-	source_ = source;
-	data_.assign(mc.getData(), mc.getData() + mc.getSize());
-
-	reset();
-
-	return true;
+	return openMem((const char*)mc.getData(), mc.getSize(), source);
 }
 
 // ----------------------------------------------------------------------------
@@ -654,7 +872,7 @@ void Tokenizer::reset()
 {
 	// Init tokenizing state
 	state_ = TokenizeState{};
-	state_.size = data_.size();
+	state_.size = data_size_;
 
 	// Read first tokens
 	readNext(&token_current_);
@@ -877,7 +1095,7 @@ void Tokenizer::tokenizeWhitespace()
 // ----------------------------------------------------------------------------
 bool Tokenizer::readNext(Token* target)
 {
-	if (data_.empty() || state_.position >= state_.size)
+	if (data_size_ == 0 || state_.position >= state_.size)
 	{
 		if (target) target->valid = false;
 		return false;
@@ -905,19 +1123,37 @@ bool Tokenizer::readNext(Token* target)
 	// Write to target token (if specified)
 	if (target)
 	{
-		// How is this slower than using += in a loop as below? Just wxString things >_>
-		//target->text.assign(
-		//	data_.data() + state_.current_token.pos_start,
-		//	state_.position - state_.current_token.pos_start
-		//);
-		
-		target->text.Empty();
-		for (unsigned a = state_.current_token.pos_start; a < state_.position; ++a)
+		auto start = data_ + state_.current_token.pos_start;
+		auto end = data_ + state_.position;
+
+		target->chars_ = start;
+		target->size_ = end - start;
+		target->buffer_.clear();
+		target->text_valid_ = false;
+
+		// Remove escape characters from quoted strings (only copying the
+		// text if there are any)
+		if (state_.current_token.quoted_string && memchr(start, '\\', end - start))
 		{
-			if (state_.current_token.quoted_string && data_[a] == '\\')
-				++a;
+			for (auto c = start; c < end; ++c)
+			{
+				if (*c == '\\' && c + 1 < end)
+					++c;
+
+				target->buffer_ += *c;
+			}
+			target->chars_ = nullptr;
+		}
 
-			target->text += data_[a];
+		// Convert to lowercase if configured to and it isn't a quoted string
+		// (again only copying the text if needed)
+		else if (read_lowercase_ && !state_.current_token.quoted_string &&
+				std::any_of(start, end, [](char c) { return c >= 'A' && c <= 'Z'; }))
+		{
+			target->buffer_.assign(start, end);
+			for (auto& c : target->buffer_)
+				c = lower(c);
+			target->chars_ = nullptr;
 		}
 
 		target->line_no = state_.current_token.line_no;
@@ -926,10 +1162,6 @@ bool Tokenizer::readNext(Token* target)
 		target->pos_end = state_.position;
 		target->length = target->pos_end - target->pos_start;
 		target->valid = true;
-
-		// Convert to lowercase if configured to and it isn't a quoted string
-		if (read_lowercase_ && !target->quoted_string)
-			target->text.LowerCase();
 	}
 
 	// Skip closing " if it was a quoted string
@@ -937,7 +1169,7 @@ bool Tokenizer::readNext(Token* target)
 		++state_.position;
 
 	if (debug_)
-		Log::debug(S_FMT("%d: \"%s\"", token_current_.line_no, CHR(token_current_.text)));
+		Log::debug(S_FMT("%d: \"%s\"", token_current_.line_no, CHR(token_current_.text())));
 		
 	return true;
 }
@@ -969,6 +1201,7 @@ void Tokenizer::resetToLineStart()
 #include "General/Console/Console.h"
 #include "MainEditor/MainEditor.h"
 #include "Archive/ArchiveEntry.h"
+#include "Archive/ArchiveManager.h"
 #include "App.h"
 
 CONSOLE_COMMAND(test_tokenizer, 0, false)
@@ -1002,7 +1235,7 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 		while (!tz.atEnd())
 		{
 			if (a == 0)
-				t_new.push_back({ tz.current().text, tz.current().quoted_string, tz.current().line_no });
+				t_new.push_back({ tz.current().text(), tz.current().quoted_string, tz.current().line_no });
 
 			tz.next();
 		}
@@ -1043,3 +1276,88 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 			Log::debug(S_FMT("%d: \"%s\"%s", token.line_no, CHR(token.text), token.quoted_string ? " (quoted)" : ""));
 	}
 }
+
+// ----------------------------------------------------------------------------
+// Tokenizer throughput benchmark. Tokenizes all text entries in the current
+// archive (or the program resource if none is open) [iterations] times, both
+// just reading the tokens and getting each token's text as a string
+// ----------------------------------------------------------------------------
+CONSOLE_COMMAND(bench_tokenizer, 0, false)
+{
+	long iterations = 10;
+	if (!args.empty())
+		args[0].ToLong(&iterations);
+
+	auto archive = MainEditor::currentArchive();
+	if (!archive)
+		archive = App::archiveManager().programResourceArchive();
+	if (!archive)
+		return;
+
+	// Get representative text lumps
+	vector<ArchiveEntry*> all_entries, entries;
+	archive->getEntryTreeAsList(all_entries);
+	size_t total_size = 0;
+	for (auto entry : all_entries)
+		if (entry->getType()->formatId() == "text" || entry->getType()->id() == "udmf_textmap")
+		{
+			entry->getMCData();
+			entries.push_back(entry);
+			total_size += entry->getSize();
+		}
+
+	if (entries.empty() || total_size == 0)
+	{
+		Log::console("No text entries to tokenize");
+		return;
+	}
+
+	// Tokenizes all entries [iterations] times, returning the time taken
+	size_t num_tokens = 0;
+	auto tokenize = [&](bool get_text)
+	{
+		Tokenizer tz;
+		size_t text_length = 0;
+		num_tokens = 0;
+		long time = App::runTimer();
+		for (long a = 0; a < iterations; a++)
+		{
+			for (auto entry : entries)
+			{
+				tz.openMem(entry->getMCData(), entry->getName());
+				while (!tz.atEnd())
+				{
+					if (get_text)
+						text_length += tz.current().text().length();
+					++num_tokens;
+					tz.adv();
+				}
+			}
+		}
+
+		// Make sure the text isn't optimised away
+		if (get_text && text_length == 0)
+			Log::debug("No token text");
+
+		return std::max(App::runTimer() - time, 1l);
+	};
+
+	double mbytes = (double)total_size * iterations / (1024.0 * 1024.0);
+	auto report = [&](const char* name, long time)
+	{
+		Log::console(S_FMT(
+			"%s: %dms, %1.1f MB/s, %1.2f million tokens/s",
+			name,
+			time,
+			mbytes * 1000.0 / time,
+			(double)num_tokens / time / 1000.0));
+	};
+
+	Log::console(S_FMT(
+		"Tokenizing %d entries (%1.2f MB) x%d",
+		(int)entries.size(),
+		(double)total_size / (1024.0 * 1024.0),
+		iterations));
+	report("Tokens", tokenize(false));
+	report("Tokens + text", tokenize(true));
+}
@@ -14,39 +14,63 @@ public:
 		Default = CStyle | CPPStyle | DoubleHash,
 	};
 
+	// A token read by the tokenizer. The token text is a view of the
+	// tokenizer's data (unless it had to be modified, eg. to remove escape
+	// characters), so it is only valid while the tokenizer's data is.
+	// Use text() to get it as a string, which is created on first use
 	struct Token
 	{
-		string		text;
-		unsigned	line_no;
-		bool		quoted_string;
-		unsigned	pos_start;
-		unsigned	pos_end;
-		unsigned	length;
-		bool		valid;
-
-		explicit	operator	string() const { return text; }
-		explicit	operator	const string() const { return text; }
-		explicit	operator	const char*() const { return CHR(text); }
-		bool		operator	==(const string& cmp) const { return text == cmp; }
-		bool		operator	==(const char* cmp) const { return text.Cmp(cmp) == 0; }
-		bool		operator	==(char cmp) const { return length == 1 && text[0] == cmp; }
-		bool		operator	!=(const string& cmp) const { return text != cmp; }
-		bool		operator	!=(const char* cmp) const { return text.Cmp(cmp) != 0; }
-		bool		operator	!=(char cmp) const { return length != 1 || text[0] != cmp; }
-		char		operator	[](unsigned index) const { return text[index]; }
+		unsigned	line_no = 0;
+		bool		quoted_string = false;
+		unsigned	pos_start = 0;
+		unsigned	pos_end = 0;
+		unsigned	length = 0;
+		bool		valid = false;
+
+		const char*		chars() const { return chars_ ? chars_ : buffer_.data(); }
+		unsigned		size() const { return chars_ ? size_ : buffer_.size(); }
+		bool			empty() const { return size() == 0; }
+		const string&	text() const;
+		std::string		stdString() const { return std::string(chars(), size()); }
+
+		explicit	operator	string() const { return text(); }
+		explicit	operator	const string() const { return text(); }
+		explicit	operator	const char*() const { return CHR(text()); }
+		bool		operator	==(const string& cmp) const { return equals(cmp); }
+		bool		operator	==(const char* cmp) const { return equals(cmp); }
+		bool		operator	==(char cmp) const { return size() == 1 && chars()[0] == cmp; }
+		bool		operator	!=(const string& cmp) const { return !equals(cmp); }
+		bool		operator	!=(const char* cmp) const { return !equals(cmp); }
+		bool		operator	!=(char cmp) const { return size() != 1 || chars()[0] != cmp; }
+		char		operator	[](unsigned index) const { return index < size() ? chars()[index] : 0; }
+
+		bool	equals(const string& cmp) const;
+		bool	equals(const char* cmp) const;
+		bool	equalsNoCase(const string& cmp) const;
+		bool	equalsNoCase(const char* cmp) const;
+		bool	startsWith(const char* cmp) const;
 
 		bool	isInteger(bool allow_hex = false) const;
 		bool	isHex() const;
 		bool	isFloat() const;
 
-		int		asInt() const { return wxAtoi(text); }
+		int		asInt(int base = 10) const;
 		bool	asBool() const;
-		double 	asFloat() const { return wxAtof(text); }
+		double 	asFloat() const;
 
-		void 	toInt(int& val) const { val = wxAtoi(text); }
-		void 	toBool(bool& val) const;
-		void 	toFloat(double& val) const { val = wxAtof(text); }
-		void	toFloat(float& val) const { val = (float) wxAtof(text); }
+		void 	toInt(int& val) const { val = asInt(); }
+		void 	toBool(bool& val) const { val = asBool(); }
+		void 	toFloat(double& val) const { val = asFloat(); }
+		void	toFloat(float& val) const { val = (float)asFloat(); }
+
+	private:
+		friend class Tokenizer;
+
+		const char*		chars_ = nullptr;		// Token characters in the tokenizer data
+		unsigned		size_ = 0;
+		std::string		buffer_;				// Modified token characters (if chars_ is null)
+		mutable string	text_;					// Token text as a string, created on first use
+		mutable bool	text_valid_ = false;
 	};
 
 	struct TokenizeState
@@ -122,7 +146,7 @@ public:
 	bool	checkOrEnd(const char* check) const;
 	bool	checkOrEnd(const string& check) const;
 	bool	checkOrEnd(char check) const;
-	bool	checkNC(const char* check) const { return S_CMPNOCASE(token_current_.text, check); }
+	bool	checkNC(const char* check) const { return token_current_.equalsNoCase(check); }
 	bool	checkOrEndNC(const char* check) const;
 	bool	checkNext(const char* check) const;
 	bool	checkNext(const string& check) const;
@@ -130,6 +154,7 @@ public:
 	bool	checkNextNC(const char* check) const;
 
 	// Load Data
+	// (openMem doesn't copy the data, it must stay valid while tokenizing)
 	bool	openFile(const string& filename, size_t offset = 0, size_t length = 0);
 	bool	openString(
 				const  string& text,
@@ -147,10 +172,10 @@ public:
 
 	// Old tokenizer interface bridge (don't use)
 	string		getToken()
-				{ if (atEnd()) return ""; string t = token_current_.text; adv(); return t; }
+				{ if (atEnd()) return ""; string t = token_current_.text(); adv(); return t; }
 	void		getToken(string* str)
-				{ if (atEnd()) *str = ""; else *str = token_current_.text; adv(); }
-	string		peekToken() const { if (atEnd()) return ""; return token_next_.text; }
+				{ if (atEnd()) *str = ""; else *str = token_current_.text(); adv(); }
+	string		peekToken() const { if (atEnd()) return ""; return token_next_.text(); }
 	int			getInteger()
 				{ if (atEnd()) return 0; int v = token_current_.asInt(); adv(); return v; }
 	double		getDouble()
@@ -167,7 +192,9 @@ public:
 	static const Token&	invalidToken() { return invalid_token_; }
 
 private:
-	vector<char>	data_;
+	const char*		data_ = nullptr;
+	size_t			data_size_ = 0;
+	vector<char>	data_buffer_;	// Copy of the data being tokenized (openFile/openString only)
 	Token			token_current_;
 	Token			token_next_;
 	TokenizeState	state_;
@@ -39,9 +39,11 @@
  *******************************************************************/
 
 /* STreeNode::STreeNode
- * STreeNode class constructor
+ * STreeNode class constructor. If [arena] is given, the list of
+ * child nodes is allocated from it
  *******************************************************************/
-STreeNode::STreeNode(STreeNode* parent)
+STreeNode::STreeNode(STreeNode* parent, MemoryArena* arena) :
+	children(ArenaAllocator<STreeNode*>(arena))
 {
 	if (parent)
 		parent->addChild(this);
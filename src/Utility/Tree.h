@@ -2,21 +2,27 @@
 #ifndef __TREE_H__
 #define __TREE_H__
 
+#include "MemoryArena.h"
+
 /* Some notes:
 	createChild should simply create a STreeNode of the derived type, NOT set its parent (via the constructor or otherwise)
 	deleting a STreeNode will not remove it from its parent, this must be done manually
+	if an arena is given, the child list is allocated from it (see ParseTreeNode)
 */
 class STreeNode
 {
+public:
+	typedef vector<STreeNode*, ArenaAllocator<STreeNode*>> ChildList;
+
 protected:
-	vector<STreeNode*>	children;
+	ChildList			children;
 	STreeNode*			parent;
 	bool				allow_dup_child;
 
 	virtual STreeNode*	createChild(string name) = 0;
 
 public:
-	STreeNode(STreeNode* parent);
+	STreeNode(STreeNode* parent, MemoryArena* arena = nullptr);
 	virtual ~STreeNode();
 
 	void	allowDup(bool dup) { allow_dup_child = dup; }
@@ -34,7 +40,7 @@ public:
 	virtual void 				addChild(STreeNode* child);
 	virtual STreeNode*			addChild(string name);
 	virtual bool 				removeChild(STreeNode* child);
-	const vector<STreeNode*>&	allChildren() const { return children; }
+	const ChildList&			allChildren() const { return children; }
 
 	virtual bool	isLeaf() { return children.empty(); }
 };
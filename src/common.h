@@ -109,6 +109,8 @@
 #include <wx/radiobut.h>
 #include <wx/mediactrl.h>
 #include <wx/statline.h>
+#include <wx/datstrm.h>
+#include <wx/mstream.h>
 
 #ifndef USE_WEBVIEW_STARTPAGE
 #include <wx/html/htmlwin.h>
@@ -140,6 +142,8 @@
 
 // C++
 #include <map>
+#include <unordered_map>
+#include <mutex>
 #include <vector>
 #include <functional>
 #include <algorithm>